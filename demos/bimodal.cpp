@@ -259,6 +259,19 @@ int main(int argc, char** argv)
      */
     std::vector<double> lambdas(2);
 
+    // Time step associated with the iteration.
+    double timeStep;
+
+    // Constraint distance vector.
+    std::vector<double> constraintDistances(1);
+
+    /* Initialise the optimisation object.
+       The same object is reused for every iteration, with the boundary
+       points and constraint distances updated by calling reset.
+     */
+    slsm::Optimise optimise(boundary.points, constraintDistances,
+        lambdas, timeStep, levelSet.moveLimit);
+
     std::cout << "\nStarting bimodal demo...\n\n";
 
     // Print output header.
@@ -288,21 +301,14 @@ int main(int argc, char** argv)
         // Apply deterministic Ito correction.
         sensitivity.itoCorrection(boundary, temperature);
 
-        // Time step associated with the iteration.
-        double timeStep;
-
-        // Constraint distance vector.
-        std::vector<double> constraintDistances;
-
         // Current area mismatch.
         double mismatch = computeMismatch(levelSet.mesh, targetArea);
 
-        // Push current distance from constraint violation into vector.
-        constraintDistances.push_back(meshArea*maxMismatch - mismatch);
+        // Store current distance from constraint violation.
+        constraintDistances[0] = meshArea*maxMismatch - mismatch;
 
-        // Initialise the optimisation object.
-        slsm::Optimise optimise(boundary.points, constraintDistances,
-            lambdas, timeStep, levelSet.moveLimit);
+        // Reset the optimisation object.
+        optimise.reset(boundary.points, constraintDistances);
 
         // Perform the optimisation.
         optimise.solve();
@@ -292,7 +292,7 @@ int main(int argc, char** argv)
     double runningTime = 0;
 
     // Backup the signed distance function.
-    std::vector<double> signedDistance = levelSet.signedDistance;
+    std::vector<slsm::Real> signedDistance = levelSet.signedDistance;
 
     // Compute the initial centre of mass.
     double xCentreOfMass, tmp;
@@ -308,6 +308,20 @@ int main(int argc, char** argv)
      */
     std::vector<double> lambdas(2);
 
+    // Time step associated with the iteration.
+    double timeStep;
+
+    // Constraint distance vector.
+    std::vector<double> constraintDistances(1);
+
+    /* Initialise the optimisation object.
+       The same object is reused for every iteration, with the boundary
+       points and constraint distances updated by calling reset. This
+       retains the optimiser's memory and solver state between iterations.
+     */
+    slsm::Optimise optimise(boundary.points, constraintDistances,
+        lambdas, timeStep, levelSet.moveLimit, false);
+
     // Set up file name.
     std::ostringstream fileName, fileName2, fileName3;
     fileName.precision(2);
@@ -365,32 +379,14 @@ int main(int argc, char** argv)
                 // Apply deterministic Ito correction.
                 sensitivity.itoCorrection(boundary, temperature);
 
-                // Time step associated with the iteration.
-                double timeStep;
-
-                // Constraint distance vector.
-                std::vector<double> constraintDistances;
-
                 // Current area mismatch.
                 double mismatch = computeMismatch(levelSet.mesh, targetArea);
 
-                // Push current distance from constraint violation into vector.
-                constraintDistances.push_back(meshArea*maxMismatch - mismatch);
-
-                // Set constraint type.
-                std::vector<bool> isEquality;
-                isEquality.push_back(false);
-
-                /* Initialise the optimisation object.
+                // Store current distance from constraint violation.
+                constraintDistances[0] = meshArea*maxMismatch - mismatch;
 
-                The Optimise class is a lightweight object so there is no cost for
-                reinitialising at every iteration. A smart compiler will optimise
-                this anyway, i.e. the same memory space will be reused. It is better
-                to place objects in the correct scope in order to aid readability
-                and to avoid unintended name clashes, etc.
-                */
-                slsm::Optimise optimise(boundary.points, constraintDistances,
-                    lambdas, timeStep, levelSet.moveLimit, false);
+                // Reset the optimisation object.
+                optimise.reset(boundary.points, constraintDistances);
 
                 // Perform the optimisation.
                 optimise.solve();
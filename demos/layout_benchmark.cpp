@@ -0,0 +1,154 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "slsm.h"
+
+/*! \file layout_benchmark.cpp
+
+    \brief A benchmark comparing the node orderings of the level set mesh.
+
+    For each mesh size, a square level set domain is initialised with a
+    regular array of holes and evolved for a fixed number of steps at unit
+    velocity using each of the node orderings (row-major, Z-order, and tiled).
+    The time spent in each stage of an optimisation step is reported, i.e.
+    boundary discretisation, velocity extension, gradient computation, and
+    the level set update, along with the time for the initial (full)
+    reinitialisation of the signed distance function.
+
+    The final boundary length is printed for each ordering as a check that
+    the results don't depend on the layout of the data.
+
+    Mesh sizes can be passed on the command line, e.g.
+
+        ./demos/layout_benchmark 1000 4000 8000
+
+    which is the default. Note that an 8000x8000 mesh requires several
+    gigabytes of memory.
+ */
+
+// Return the time elapsed since a given instant (in seconds).
+double elapsed(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    // Print git commit info, if present.
+#ifdef COMMIT
+    std::cout << "Git commit: " << COMMIT << "\n";
+#endif
+
+    // Print git branch info, if present.
+#ifdef BRANCH
+    std::cout << "Git branch: " << BRANCH << "\n";
+#endif
+
+    // Mesh sizes.
+    std::vector<unsigned int> sizes;
+    for (int i=1;i<argc;i++) sizes.push_back(atoi(argv[i]));
+    if (sizes.empty()) sizes = {1000, 4000, 8000};
+
+    // Number of steps for each mesh size.
+    unsigned int nSteps = 5;
+
+    // Node orderings.
+    const slsm::NodeOrdering::NodeOrdering orderings[3] =
+        {slsm::NodeOrdering::ROW_MAJOR, slsm::NodeOrdering::MORTON, slsm::NodeOrdering::TILED};
+    const char* names[3] = {"row-major", "morton", "tiled"};
+
+    std::cout << "\nStarting node ordering benchmark...\n\n";
+
+    // Print output header.
+    printf("-------------------------------------------------------------------------------------\n");
+    printf("%6s %10s %10s %10s %10s %10s %10s %10s %10s\n", "Size", "Ordering",
+        "Discretise", "Velocity", "Gradient", "Update", "Reinit", "Total", "Length");
+    printf("-------------------------------------------------------------------------------------\n");
+
+    for (unsigned int i=0;i<sizes.size();i++)
+    {
+        unsigned int size = sizes[i];
+
+        // Create a 4x4 array of holes.
+        std::vector<slsm::Hole> holes;
+        for (unsigned int j=0;j<4;j++)
+        {
+            for (unsigned int k=0;k<4;k++)
+                holes.push_back(slsm::Hole((j + 0.5)*size/4, (k + 0.5)*size/4, 0.08*size));
+        }
+
+        for (unsigned int j=0;j<3;j++)
+        {
+            // Initialise the level set domain.
+            slsm::LevelSet levelSet(size, size, holes, 0.5, 6, true, orderings[j]);
+
+            // Initialise the boundary object.
+            slsm::Boundary boundary;
+
+            // Time spent in each stage.
+            double times[5] = {0, 0, 0, 0, 0};
+
+            auto start = std::chrono::steady_clock::now();
+            levelSet.reinitialise();
+            times[4] += elapsed(start);
+
+            for (unsigned int k=0;k<nSteps;k++)
+            {
+                start = std::chrono::steady_clock::now();
+                boundary.discretise(levelSet);
+                times[0] += elapsed(start);
+
+                // Move all boundary points inwards at unit velocity.
+                for (unsigned int l=0;l<boundary.nPoints;l++)
+                    boundary.points[l].velocity = 1;
+
+                start = std::chrono::steady_clock::now();
+                levelSet.computeVelocities(boundary.points);
+                times[1] += elapsed(start);
+
+                start = std::chrono::steady_clock::now();
+                levelSet.computeGradients();
+                times[2] += elapsed(start);
+
+                start = std::chrono::steady_clock::now();
+                levelSet.update(0.5);
+                times[3] += elapsed(start);
+            }
+
+            // Compute the final boundary.
+            start = std::chrono::steady_clock::now();
+            boundary.discretise(levelSet);
+            times[0] += elapsed(start);
+
+            double total = times[0] + times[1] + times[2] + times[3] + times[4];
+
+            // Print statistics.
+            printf("%6d %10s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.2f\n", size, names[j],
+                times[0], times[1], times[2], times[3], times[4], total, boundary.length);
+        }
+    }
+
+    printf("-------------------------------------------------------------------------------------\n");
+
+    std::cout << "\nDone!\n";
+
+    return (EXIT_SUCCESS);
+}
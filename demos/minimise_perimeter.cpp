@@ -172,36 +172,16 @@ int main(int argc, char** argv)
         // Perform the optimisation.
         optimise.solve();
 
-        // Extend boundary point velocities to all narrow band nodes.
-        levelSet.computeVelocities(boundary.points);
-
-        // Compute gradient of the signed distance function within the narrow band.
-        levelSet.computeGradients();
-
-        // Update the level set function.
-        bool isReinitialised = levelSet.update(timeStep);
-
-        // Reinitialise the signed distance function, if necessary.
-        if (!isReinitialised)
-        {
-            // Reinitialise at least every 20 iterations.
-            if (nReinit == 20)
-            {
-                levelSet.reinitialise();
-                nReinit = 0;
-            }
-        }
-        else nReinit = 0;
+        /* Extend boundary point velocities, update the level set function, and
+           compute the new discretised boundary and normal vectors in a single
+           step. The signed distance function is reinitialised at least every
+           20 iterations.
+         */
+        if (levelSet.step(boundary, timeStep, (nReinit == 20))) nReinit = 0;
 
         // Increment the number of steps since reinitialisation.
         nReinit++;
 
-        // Compute the new discretised boundary.
-        boundary.discretise(levelSet);
-
-        // Compute the boundary point normal vectors.
-        boundary.computeNormalVectors(levelSet);
-
         // Increment the time.
         runningTime += timeStep;
 
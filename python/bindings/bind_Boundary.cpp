@@ -65,6 +65,9 @@ void bind_Boundary(py::module &m)
         .def_readwrite("isFixed", &BoundaryPoint::isFixed,
             "Whether the point is fixed.")
 
+        .def_readwrite("isGhost", &BoundaryPoint::isGhost,
+            "Whether the point is owned by another rank (distributed level sets).")
+
         .def_readonly("nSegments", &BoundaryPoint::nSegments,
             "The number of boundary segments that the point belongs to.")
 
@@ -111,14 +114,19 @@ void bind_Boundary(py::module &m)
 
         // Constructors.
 
-        .def(py::init<>(), "Default constructor.")
+        .def(py::init<bool>(), "Constructor.",
+            py::arg("isIncremental") = false)
 
         // Member functions.
 
-        .def("discretise", &Boundary::discretise,
+        .def("discretise", (void (Boundary::*)(LevelSet&, bool)) &Boundary::discretise,
             "Use linear interpolation to compute the discretised boundary.",
             py::arg("levelSet"), py::arg("isTarget") = false)
 
+        .def("discretise", (void (Boundary::*)(SparseLevelSet&)) &Boundary::discretise,
+            "Use linear interpolation to compute the discretised boundary.",
+            py::arg("levelSet"))
+
         .def("computeNormalVectors", &Boundary::computeNormalVectors,
             "Compute the local normal vector at each boundary point.",
             py::arg("levelSet"))
@@ -0,0 +1,48 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+#include "Communicator.cpp"
+
+using namespace slsm;
+
+void bind_Communicator(py::module &m)
+{
+    // Enum definition.
+    py::enum_<ReduceOp::ReduceOp>(m, "ReduceOp", py::module_local(),
+        "The operation used to combine values across ranks.")
+        .value("SUM", ReduceOp::SUM)
+        .value("MIN", ReduceOp::MIN)
+        .value("MAX", ReduceOp::MAX);
+
+    // Class definition.
+    py::class_<Communicator>(m, "Communicator", py::module_local(),
+        "An abstract interface for message passing between ranks.")
+
+        // Member functions.
+
+        .def("rank", &Communicator::rank, "Return the index of this rank.")
+
+        .def("size", &Communicator::size, "Return the number of ranks.")
+
+        .def("allReduce", (double (Communicator::*)(double, ReduceOp::ReduceOp)) &Communicator::allReduce,
+            "Combine a value across all ranks.",
+            py::arg("value"), py::arg("op"));
+}
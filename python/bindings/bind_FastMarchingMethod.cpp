@@ -22,28 +22,41 @@ namespace py = pybind11;
 
 #include "FastMarchingMethod.cpp"
 #include "Heap.cpp"
+#include "UntidyQueue.cpp"
 
 using namespace slsm;
 
 void bind_FastMarchingMethod(py::module &m)
 {
+    // Priority queue type.
+    py::enum_<FMM_Queue::FMM_Queue>(m, "FMM_Queue", py::module_local(),
+        "The priority queue used to order trial nodes.")
+        .value("BINARY_HEAP", FMM_Queue::BINARY_HEAP)
+        .value("UNTIDY", FMM_Queue::UNTIDY);
+
     // Class definition.
     py::class_<FastMarchingMethod>(m, "FastMarchingMethod", py::module_local(),
         "Find approximate solitions to boundary value problems of the Eikonal equation.")
 
         // Constructors.
 
-        .def(py::init<const Mesh&, bool>(),
-            "Constructor.", py::arg("mesh"), py::arg("isTest") = false)
+        .def(py::init<const Mesh&, bool, FMM_Queue::FMM_Queue>(),
+            "Constructor.", py::arg("mesh"), py::arg("isTest") = false,
+            py::arg("queueType") = FMM_Queue::BINARY_HEAP)
 
         // Member functions.
 
-        .def("march", (void (FastMarchingMethod::*)(std::vector<double>&)) &FastMarchingMethod::march,
+        .def("march", (void (FastMarchingMethod::*)(std::vector<Real>&)) &FastMarchingMethod::march,
             "Reinitialise a signed distance function.",
             py::arg("signedDistance"))
 
-        .def("march", (void (FastMarchingMethod::*)(std::vector<double>&,
-            std::vector<double>&)) &FastMarchingMethod::march,
+        .def("march", (void (FastMarchingMethod::*)(const std::vector<Real>&,
+            std::vector<Real>&)) &FastMarchingMethod::march,
             "Extend boundary point velocities to nodes within the narrow band region.",
-            py::arg("signedDistance"), py::arg("velocity"));
+            py::arg("signedDistance"), py::arg("velocity"))
+
+        .def("march", (void (FastMarchingMethod::*)(std::vector<Real>&,
+            const std::vector<unsigned int>&, unsigned int, double)) &FastMarchingMethod::march,
+            "Reinitialise a signed distance function within a narrow band.",
+            py::arg("signedDistance"), py::arg("narrowBand"), py::arg("nNarrowBand"), py::arg("maxDistance"));
 }
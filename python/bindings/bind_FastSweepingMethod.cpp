@@ -0,0 +1,47 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <pybind11/pybind11.h>
+#include <pybind11/stl_bind.h>
+
+namespace py = pybind11;
+
+#include "FastSweepingMethod.cpp"
+
+using namespace slsm;
+
+void bind_FastSweepingMethod(py::module &m)
+{
+    // Class definition.
+    py::class_<FastSweepingMethod>(m, "FastSweepingMethod", py::module_local(),
+        "A parallel alternative to the Fast Marching Method.")
+
+        // Constructors.
+
+        .def(py::init<const Mesh&, unsigned int>(),
+            "Constructor.", py::arg("mesh"), py::arg("nThreads") = 0)
+
+        // Member functions.
+
+        .def("march", (void (FastSweepingMethod::*)(std::vector<Real>&)) &FastSweepingMethod::march,
+            "Reinitialise a signed distance function.",
+            py::arg("signedDistance"))
+
+        .def("march", (void (FastSweepingMethod::*)(std::vector<Real>&,
+            std::vector<Real>&)) &FastSweepingMethod::march,
+            "Extend boundary point velocities to nodes within the narrow band region.",
+            py::arg("signedDistance"), py::arg("velocity"));
+}
@@ -21,6 +21,9 @@
 namespace py = pybind11;
 
 #include "LevelSet.cpp"
+#include "ClosestPointExtension.cpp"
+#include "ThreadPool.cpp"
+#include "WENOGradient.cpp"
 
 using namespace slsm;
 
@@ -39,44 +42,62 @@ void bind_LevelSet(py::module &m)
 
         // Constructors.
 
-        .def(py::init<unsigned int, unsigned int, double, unsigned int, bool>(),
+        .def(py::init<unsigned int, unsigned int, double, unsigned int, bool,
+            NodeOrdering::NodeOrdering>(),
             "Constructor.", py::arg("width"), py::arg("height"),
             py::arg("moveLimit") = 0.5, py::arg("bandWidth") = 6,
-            py::arg("isFixedDomain") = false)
+            py::arg("isFixedDomain") = false,
+            py::arg("nodeOrdering") = NodeOrdering::ROW_MAJOR)
 
         .def(py::init<unsigned int, unsigned int, const std::vector<Hole>&, double,
-            unsigned int, bool>(), "Constructor.", py::arg("width"),
-            py::arg("height"), py::arg("holes"), py::arg("moveLimit") = 0.5,
-            py::arg("bandWidth") = 6, py::arg("isFixedDomain") = false)
+            unsigned int, bool, NodeOrdering::NodeOrdering>(), "Constructor.",
+            py::arg("width"), py::arg("height"), py::arg("holes"), py::arg("moveLimit") = 0.5,
+            py::arg("bandWidth") = 6, py::arg("isFixedDomain") = false,
+            py::arg("nodeOrdering") = NodeOrdering::ROW_MAJOR)
 
         .def(py::init<unsigned int, unsigned int, const std::vector<Coord>&, double,
-            unsigned int, bool>(), "Constructor.", py::arg("width"),
-            py::arg("height"), py::arg("points"), py::arg("moveLimit") = 0.5,
-            py::arg("bandWidth") = 6, py::arg("isFixedDomain") = false)
+            unsigned int, bool, NodeOrdering::NodeOrdering>(), "Constructor.",
+            py::arg("width"), py::arg("height"), py::arg("points"), py::arg("moveLimit") = 0.5,
+            py::arg("bandWidth") = 6, py::arg("isFixedDomain") = false,
+            py::arg("nodeOrdering") = NodeOrdering::ROW_MAJOR)
 
         .def(py::init<unsigned int, unsigned int, const std::vector<Hole>&,
-            const std::vector<Hole>&, double, unsigned int, bool>(),
+            const std::vector<Hole>&, double, unsigned int, bool,
+            NodeOrdering::NodeOrdering>(),
             "Constructor.", py::arg("width"), py::arg("height"),
             py::arg("initialHoles"), py::arg("targetHoles"), py::arg("moveLimit") = 0.5,
-            py::arg("bandWidth") = 6, py::arg("isFixedDomain") = false)
+            py::arg("bandWidth") = 6, py::arg("isFixedDomain") = false,
+            py::arg("nodeOrdering") = NodeOrdering::ROW_MAJOR)
 
         .def(py::init<unsigned int, unsigned int, const std::vector<Hole>&,
-            const std::vector<Coord>&, double, unsigned int, bool>(),
+            const std::vector<Coord>&, double, unsigned int, bool,
+            NodeOrdering::NodeOrdering>(),
             "Constructor.", py::arg("width"), py::arg("height"),
             py::arg("initialHoles"), py::arg("targetPoints"), py::arg("moveLimit") = 0.5,
-            py::arg("bandWidth") = 6, py::arg("isFixedDomain") = false)
+            py::arg("bandWidth") = 6, py::arg("isFixedDomain") = false,
+            py::arg("nodeOrdering") = NodeOrdering::ROW_MAJOR)
 
         .def(py::init<unsigned int, unsigned int, const std::vector<Coord>&,
-            const std::vector<Coord>&, double, unsigned int, bool>(),
+            const std::vector<Coord>&, double, unsigned int, bool,
+            NodeOrdering::NodeOrdering>(),
             "Constructor.", py::arg("width"), py::arg("height"),
             py::arg("initialPoints"), py::arg("targetPoints"), py::arg("moveLimit") = 0.5,
-            py::arg("bandWidth") = 6, py::arg("isFixedDomain") = false)
+            py::arg("bandWidth") = 6, py::arg("isFixedDomain") = false,
+            py::arg("nodeOrdering") = NodeOrdering::ROW_MAJOR)
 
         // Member functions.
 
         .def("update", &LevelSet::update, "Update the level-set function."
             " The return value indicates whether the signed distance was reinitialised.",
-            py::arg("timeStep"))
+            py::arg("timeStep"), py::arg("isReinitialise") = true)
+
+        .def("step", &LevelSet::step, "Advance the level-set by a single iteration:"
+            " velocity extension, update, boundary discretisation, area fractions, and normal vectors."
+            " The return value indicates whether the signed distance was reinitialised.",
+            py::arg("boundary"), py::arg("timeStep"), py::arg("isReinitialise") = false)
+
+        .def("initialiseNarrowBand", &LevelSet::initialiseNarrowBand,
+            "Initialise the narrow band region.")
 
         .def("mask", (void (LevelSet::*)(const std::vector<Hole>&)) &LevelSet::mask,
             "Mask off a region of the domain.",
@@ -87,13 +108,20 @@ void bind_LevelSet(py::module &m)
             py::arg("points"))
 
         .def("reinitialise", &LevelSet::reinitialise,
-            "Reinitialise the level set to a signed distance function.")
+            "Reinitialise the level set to a signed distance function.",
+            py::arg("isBanded") = false)
 
         .def("computeVelocities", (void (LevelSet::*)(const std::vector<BoundaryPoint>&))
             &LevelSet::computeVelocities,
             "Extend boundary point velocities to the level-set nodes.",
             py::arg("boundaryPoints"))
 
+        .def("computeVelocities", (void (LevelSet::*)(const Boundary&))
+            &LevelSet::computeVelocities,
+            "Extend boundary point velocities to the narrow band by projecting"
+            " each node onto the closest boundary segment.",
+            py::arg("boundary"))
+
         .def("computeVelocities", (double (LevelSet::*)(std::vector<BoundaryPoint>&,
             MutableFloat&, const double, MersenneTwister&)) &LevelSet::computeVelocities,
             "Extend boundary point velocities to the level-set nodes."
@@ -104,6 +132,10 @@ void bind_LevelSet(py::module &m)
         .def("computeGradients", &LevelSet::computeGradients,
             "Compute the modulus of the gradient of the signed distance function.")
 
+        .def("setThreads", &LevelSet::setThreads,
+            "Set the number of threads used for narrow band operations.",
+            py::arg("nThreads"))
+
         .def("computeAreaFractions", &LevelSet::computeAreaFractions,
             "Compute the material area fraction enclosed by the discretised boundary.")
 
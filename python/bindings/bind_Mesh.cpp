@@ -16,7 +16,6 @@
 */
 
 #include <pybind11/pybind11.h>
-#include <pybind11/stl_bind.h>
 
 namespace py = pybind11;
 
@@ -24,55 +23,70 @@ namespace py = pybind11;
 
 using namespace slsm;
 
-PYBIND11_MAKE_OPAQUE(std::vector<Element>)
-PYBIND11_MAKE_OPAQUE(std::vector<Node>)
-
 void bind_Mesh(py::module &m)
 {
-    // STL containers.
-    py::bind_vector<std::vector<Element>>(m, "VectorElement", py::module_local());
-    py::bind_vector<std::vector<Node>>(m, "VectorNode", py::module_local());
+    // Node numbering scheme.
+    py::enum_<NodeOrdering::NodeOrdering>(m, "NodeOrdering", py::module_local(),
+        "The numbering scheme for mesh nodes.")
+        .value("ROW_MAJOR", NodeOrdering::ROW_MAJOR)
+        .value("MORTON", NodeOrdering::MORTON)
+        .value("TILED", NodeOrdering::TILED);
 
     // Class definition.
-    py::class_<Element>(m, "Element", py::module_local(),
+    py::class_<ConstElement>(m, "Element", py::module_local(),
         "Data for an element in the two-dimensional fixed-grid mesh.")
 
-        // Constructors
-
-        .def(py::init<>(), "Constructor.")
-
         // Member data.
 
-        .def_readonly("coord", &Element::coord,
+        .def_readonly("coord", &ConstElement::coord,
             "The coordinates of the element centre.")
 
-        .def_readonly("area", &Element::area,
+        .def_readonly("area", &ConstElement::area,
             "The material area fraction of the element.");
 
     // Class definition.
-    py::class_<Node>(m, "Node", py::module_local(),
+    py::class_<ConstNode>(m, "Node", py::module_local(),
         "Data for a node in the two-dimensional fixed-grid mesh.")
 
-        // Constructors
-
-        .def(py::init<>(), "Constructor.")
-
         // Member data.
 
-        .def_readonly("coord", &Node::coord,
+        .def_readonly("coord", &ConstNode::coord,
             "The coordinates of the node.")
 
-        .def_readonly("neighbours", &Node::neighbours,
+        .def_property_readonly("neighbours", [](const ConstNode& node)
+            {
+                py::list neighbours;
+                for (unsigned int i=0;i<4;i++) neighbours.append(node.neighbours[i]);
+                return neighbours;
+            },
             "The indices of the neighbouring nodes.");
 
+    // Array views of the mesh elements and nodes.
+    py::class_<ElementArray>(m, "ElementArray", py::module_local())
+        .def("__len__", &ElementArray::size)
+        .def("__getitem__", [](const ElementArray& elements, unsigned int i)
+            {
+                if (i >= elements.size()) throw py::index_error();
+                return elements[i];
+            }, py::keep_alive<0, 1>());
+
+    py::class_<NodeArray>(m, "NodeArray", py::module_local())
+        .def("__len__", &NodeArray::size)
+        .def("__getitem__", [](const NodeArray& nodes, unsigned int i)
+            {
+                if (i >= nodes.size()) throw py::index_error();
+                return nodes[i];
+            }, py::keep_alive<0, 1>());
+
     // Class definition.
     py::class_<Mesh>(m, "Mesh", py::module_local(),
         "A two-dimensional fixed-grid mesh for the level-set domain.")
 
         // Constructors.
 
-        .def(py::init<unsigned int, unsigned int>(),
-            "Constructor.", py::arg("width"), py::arg("height"))
+        .def(py::init<unsigned int, unsigned int, NodeOrdering::NodeOrdering>(),
+            "Constructor.", py::arg("width"), py::arg("height"),
+            py::arg("ordering") = NodeOrdering::ROW_MAJOR)
 
         // Member functions.
 
@@ -92,6 +106,10 @@ void bind_Mesh(py::module &m)
             "For a given coordinate, find the element that contains that point.",
             py::arg("x"), py::arg("y"))
 
+        .def("xyToIndex", &Mesh::xyToIndex,
+            "Return the index of the node at a given position.",
+            py::arg("x"), py::arg("y"))
+
         // Member data.
 
         .def_readonly("nodes", &Mesh::nodes,
@@ -110,5 +128,8 @@ void bind_Mesh(py::module &m)
             "The number of elements in the mesh.")
 
         .def_readonly("nNodes", &Mesh::nNodes,
-            "The number of nodes in the mesh.");
+            "The number of nodes in the mesh.")
+
+        .def_readonly("ordering", &Mesh::ordering,
+            "The numbering scheme for the nodes.");
 }
@@ -21,6 +21,7 @@
 namespace py = pybind11;
 
 #include "Optimise.cpp"
+#include "Simplex.cpp"
 
 using namespace slsm;
 
@@ -40,10 +41,18 @@ void bind_Optimise(py::module &m)
 
         // Member functions.
 
+        .def("reset", &Optimise::reset,
+            "Reset the optimiser for a new iteration, retaining memory and solver state.",
+            py::arg("boundaryPoints"), py::arg("constraintDistances"))
+
         .def("solve", &Optimise::solve,
             "Execute the NLopt solver to find the optimium velocity vector."
             " Returns the optimum change in the objective function.")
 
         .def("queryReturnCode", &Optimise::queryReturnCode,
-            "Query the NLopt return code.");
+            "Query the NLopt return code.")
+
+        .def("setThreads", &Optimise::setThreads,
+            "Set the number of threads used for boundary point loops.",
+            py::arg("nThreads"));
 }
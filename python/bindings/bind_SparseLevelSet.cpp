@@ -0,0 +1,91 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl_bind.h>
+
+namespace py = pybind11;
+
+#include "SparseLevelSet.cpp"
+
+using namespace slsm;
+
+void bind_SparseLevelSet(py::module &m)
+{
+    // Class definition.
+    py::class_<SparseLevelSet>(m, "SparseLevelSet", py::module_local(),
+        "A two-dimensional level-set domain that only stores tiles close to the zero contour.")
+
+        // Constructors.
+
+        .def(py::init<unsigned int, unsigned int, const std::vector<Hole>&, double,
+            unsigned int, bool>(), "Constructor.",
+            py::arg("width"), py::arg("height"), py::arg("holes"), py::arg("moveLimit") = 0.5,
+            py::arg("bandWidth") = 6, py::arg("isFixedDomain") = false)
+
+        // Member functions.
+
+        .def("update", &SparseLevelSet::update, "Update the level-set function."
+            " The return value indicates whether the signed distance was reinitialised.",
+            py::arg("timeStep"))
+
+        .def("reinitialise", &SparseLevelSet::reinitialise,
+            "Reinitialise the level set to a signed distance function.")
+
+        .def("computeVelocities", &SparseLevelSet::computeVelocities,
+            "Extend boundary point velocities to the level-set nodes.",
+            py::arg("boundaryPoints"))
+
+        .def("computeGradients", &SparseLevelSet::computeGradients,
+            "Compute the modulus of the gradient of the signed distance function.")
+
+        .def("setThreads", &SparseLevelSet::setThreads,
+            "Set the number of threads used for narrow band operations.",
+            py::arg("nThreads"))
+
+        .def("getSignedDistance", &SparseLevelSet::getSignedDistance,
+            "Return the signed distance at a node.",
+            py::arg("x"), py::arg("y"))
+
+        .def("getVelocity", &SparseLevelSet::getVelocity,
+            "Return the normal velocity at a node.",
+            py::arg("x"), py::arg("y"))
+
+        .def("getGradient", &SparseLevelSet::getGradient,
+            "Return the modulus of the gradient of the signed distance function at a node.",
+            py::arg("x"), py::arg("y"))
+
+        .def("memoryUsage", &SparseLevelSet::memoryUsage,
+            "Return the memory used by the level set data (in bytes).")
+
+        // Member variables.
+
+        .def_readonly("width", &SparseLevelSet::width,
+            "The width of the domain.")
+
+        .def_readonly("height", &SparseLevelSet::height,
+            "The height of the domain.")
+
+        .def_readonly("nTiles", &SparseLevelSet::nTiles,
+            "The number of allocated tiles.")
+
+        .def_readonly("nNarrowBand", &SparseLevelSet::nNarrowBand,
+            "The number of nodes in the narrow band.")
+
+        .def_readonly("moveLimit", &SparseLevelSet::moveLimit,
+            "The boundary movement limit (CFL condition).");
+}
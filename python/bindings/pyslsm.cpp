@@ -18,15 +18,20 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl_bind.h>
 
+#include "Common.h"
+
 namespace py = pybind11;
 
 PYBIND11_MAKE_OPAQUE(std::vector<int>)
 PYBIND11_MAKE_OPAQUE(std::vector<unsigned int>)
 PYBIND11_MAKE_OPAQUE(std::vector<double>)
 PYBIND11_MAKE_OPAQUE(std::vector<bool>)
+PYBIND11_MAKE_OPAQUE(std::vector<float>)
 
 void bind_Boundary(py::module &);
+void bind_Communicator(py::module &);
 void bind_FastMarchingMethod(py::module &);
+void bind_FastSweepingMethod(py::module &);
 void bind_Hole(py::module &);
 void bind_InputOutput(py::module &);
 void bind_LevelSet(py::module &);
@@ -34,6 +39,7 @@ void bind_MersenneTwister(py::module &);
 void bind_Mesh(py::module &);
 void bind_Optimise(py::module &);
 void bind_Sensitivity(py::module &);
+void bind_SparseLevelSet(py::module &);
 
 PYBIND11_MODULE(pyslsm, m)
 {
@@ -43,14 +49,22 @@ PYBIND11_MODULE(pyslsm, m)
     py::bind_vector<std::vector<double>>(m, "VectorDouble", py::module_local());
     py::bind_vector<std::vector<bool>>(m, "VectorBool", py::module_local());
 
-    // Class bindings.
+    // Level set fields in a single precision build.
+    if (sizeof(slsm::Real) < sizeof(double))
+        py::bind_vector<std::vector<float>>(m, "VectorFloat", py::module_local());
+
+    // Class bindings. The mesh is bound first, since its node ordering
+    // is used as a default argument by the level set constructors.
+    bind_Mesh(m);
     bind_Boundary(m);
+    bind_Communicator(m);
     bind_FastMarchingMethod(m);
+    bind_FastSweepingMethod(m);
     bind_Hole(m);
     bind_InputOutput(m);
     bind_LevelSet(m);
     bind_MersenneTwister(m);
-    bind_Mesh(m);
     bind_Optimise(m);
     bind_Sensitivity(m);
+    bind_SparseLevelSet(m);
 }
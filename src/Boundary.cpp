@@ -15,11 +15,14 @@
   along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 #include "Boundary.h"
 #include "LevelSet.h"
 #include "Mesh.h"
+#include "SparseLevelSet.h"
 
 /*! \file Boundary.cpp
     \brief A class for the discretised boundary.
@@ -34,6 +37,7 @@ namespace slsm
         positiveLimit(0),
         isDomain(false),
         isFixed(false),
+        isGhost(false),
         nSegments(0),
         segments(2, 0),
         nNeighbours(0),
@@ -42,6 +46,24 @@ namespace slsm
     {
     }
 
+    void BoundaryPoint::reset()
+    {
+        coord = Coord();
+        normal = Coord();
+        length = 0;
+        velocity = 0;
+        negativeLimit = 0;
+        positiveLimit = 0;
+        isDomain = false;
+        isFixed = false;
+        isGhost = false;
+        nSegments = 0;
+        segments.assign(2, 0);
+        nNeighbours = 0;
+        neighbours.assign(2, 0);
+        sensitivities.assign(2, 0);
+    }
+
     BoundarySegment::BoundarySegment() :
         start(0),
         end(0),
@@ -50,18 +72,50 @@ namespace slsm
     {
     }
 
-    Boundary::Boundary()
+    Boundary::Boundary(bool isIncremental_) :
+        nPoints(0),
+        nSegments(0),
+        length(0),
+        isIncremental(isIncremental_),
+        discretisedLevelSet(nullptr),
+        none(std::numeric_limits<unsigned int>::max())
     {
     }
 
     void Boundary::discretise(LevelSet& levelSet, bool isTarget)
     {
+        // Update the existing discretisation, as long as this was the last
+        // boundary to be computed from the level set.
+        if (isIncremental && !isTarget && (discretisedLevelSet == &levelSet)
+            && (levelSet.discretisedBoundary == this))
+        {
+            updateDiscretisation(levelSet);
+            return;
+        }
+
         // Clear and reserve vector memory.
         points.clear();
         segments.clear();
         points.reserve(levelSet.mesh.nNodes);
         segments.reserve(levelSet.mesh.nNodes);
 
+        // Clear the edge to boundary point lookup (the point edges aren't
+        // stored for a sparse discretisation).
+        if ((edgePoints.size() != 3*levelSet.mesh.nNodes) || (pointNodes.size() != 2*nPoints))
+            edgePoints.assign(3*levelSet.mesh.nNodes, none);
+        else
+        {
+            for (unsigned int i=0;i<nPoints;i++)
+                edgePoints[edgeKey(levelSet.mesh, pointNodes[2*i], pointNodes[2*i+1])] = none;
+        }
+
+        // Clear the incremental bookkeeping.
+        pointNodes.clear();
+        isPointFree.clear();
+        isSegmentFree.clear();
+        freePoints.clear();
+        freeSegments.clear();
+
         // Reset the number of points and segments.
         nPoints = nSegments = 0;
 
@@ -69,7 +123,7 @@ namespace slsm
         length = 0;
 
         // Initialise a pointer to the signed distance vector.
-        std::vector<double>* signedDistance;
+        std::vector<Real>* signedDistance;
 
         // Point to the target signed distance.
         if (isTarget) signedDistance = &levelSet.target;
@@ -79,489 +133,817 @@ namespace slsm
 
         // Compute the status of nodes and elements in level-set mesh.
         computeMeshStatus(levelSet.mesh, signedDistance);
+        levelSet.isTargetDiscretised = isTarget;
 
         // Loop over all elements.
         for (unsigned int i=0;i<levelSet.mesh.nElements;i++)
         {
             // The element isn't outside of the structure.
             if (levelSet.mesh.elements[i].status != ElementStatus::OUTSIDE)
+                discretiseElement(levelSet, *signedDistance, i, isTarget);
+        }
+
+        // Work out boundary integral length associated with each boundary point.
+        computePointLengths();
+
+        // The node status now reflects the target, so neither discretisation
+        // can be updated incrementally.
+        if (isTarget)
+        {
+            discretisedLevelSet = nullptr;
+            levelSet.discretisedBoundary = nullptr;
+        }
+        else
+        {
+            discretisedLevelSet = &levelSet;
+            levelSet.discretisedBoundary = this;
+
+            // Start tracking sign changes afresh.
+            std::fill(levelSet.isSignChanged.begin(), levelSet.isSignChanged.end(), false);
+        }
+    }
+
+    void Boundary::discretise(SparseLevelSet& levelSet)
+    {
+        const unsigned int tileSize = SparseLevelSet::tileSize;
+        const unsigned int tileNodes = SparseLevelSet::tileNodes;
+
+        // Clear vector memory.
+        points.clear();
+        segments.clear();
+
+        // The edge lookup is indexed by the position of nodes in the tile arrays.
+        edgePoints.assign(3*levelSet.signedDistance.size(), none);
+
+        // Clear the incremental bookkeeping.
+        pointNodes.clear();
+        isPointFree.clear();
+        isSegmentFree.clear();
+        freePoints.clear();
+        freeSegments.clear();
+
+        // Reset the number of points and segments.
+        nPoints = nSegments = 0;
+
+        // Zero the boundary length.
+        length = 0;
+
+        // Loop over all allocated tiles.
+        for (unsigned int slot=0;slot<levelSet.isTileFree.size();slot++)
+        {
+            if (levelSet.isTileFree[slot]) continue;
+
+            // Loop over the elements whose bottom left node lies in the tile.
+            for (unsigned int i=0;i<tileNodes;i++)
             {
-                // Number of cut edges.
-                unsigned int nCut = 0;
+                unsigned int x = levelSet.tileX[slot]*tileSize + (i % tileSize);
+                unsigned int y = levelSet.tileY[slot]*tileSize + (i / tileSize);
+
+                if ((x >= levelSet.width) || (y >= levelSet.height)) continue;
 
-                // Existing boundary points associated with a node.
-                unsigned int boundaryPoints[4];
+                // Indices of the element nodes (anticlockwise from the bottom left).
+                unsigned int nodes[4];
+                nodes[0] = slot*tileNodes + i;
 
-                // Look at each edge of the node to determine whether it is cut,
-                // or if it's part of the boundary.
-                for (unsigned int j=0;j<4;j++)
+                // Nodes within the same tile.
+                if (((i % tileSize) < (tileSize - 1)) && (i < (tileNodes - tileSize)))
+                {
+                    nodes[1] = nodes[0] + 1;
+                    nodes[2] = nodes[0] + tileSize + 1;
+                    nodes[3] = nodes[0] + tileSize;
+                }
+                else
                 {
-                    // Index of first node on edge.
-                    unsigned int n1 = levelSet.mesh.elements[i].nodes[j];
+                    nodes[1] = levelSet.findNode(x + 1, y);
+                    nodes[2] = levelSet.findNode(x + 1, y + 1);
+                    nodes[3] = levelSet.findNode(x, y + 1);
+
+                    // An element with a node in an unallocated tile lies far from
+                    // the zero contour.
+                    if ((nodes[1] == SparseLevelSet::none) || (nodes[2] == SparseLevelSet::none) ||
+                        (nodes[3] == SparseLevelSet::none)) continue;
+                }
+
+                discretiseElement(levelSet, x, y, nodes);
+            }
+        }
+
+        // Work out boundary integral length associated with each boundary point.
+        computePointLengths();
+
+        // The discretisation can't be updated incrementally.
+        discretisedLevelSet = nullptr;
+    }
+
+    NodeStatus::NodeStatus Boundary::computeNodeStatus(double signedDistance)
+    {
+        // Flag node as being on the boundary if the signed distance is within
+        // a small tolerance of the zero contour. This avoids problems with
+        // rounding errors when generating the discretised boundary.
+        if (std::abs(signedDistance) < 1e-6) return NodeStatus::BOUNDARY;
+        else if (signedDistance < 0) return NodeStatus::OUTSIDE;
+        else return NodeStatus::INSIDE;
+    }
+
+    void Boundary::updateDiscretisation(LevelSet& levelSet)
+    {
+        Mesh& mesh = levelSet.mesh;
+
+        // Resize scratch arrays (memory is retained between calls).
+        isElementChanged.resize(mesh.nElements, false);
+        changedElements.clear();
+
+        /* Only nodes in the narrow band are moved by LevelSet::update, and
+           reinitialisation preserves the sign of the signed distance function.
+           Nodes that leave (or enter) the band lie far from the zero contour,
+           so the set of edges that is considered is also unchanged.
+         */
+        for (unsigned int i=0;i<levelSet.nNarrowBand;i++)
+        {
+            unsigned int node = levelSet.narrowBand[i];
 
-                    // Index of second node (reconnecting to 0th node).
-                    // Edge connectivity goes: 0 --> 1, 1 --> 2, 2 --> 3, 3 --> 0
-                    unsigned int n2 = (j == 3) ? 0 : (j + 1);
+            if (levelSet.isSignChanged[node])
+            {
+                levelSet.isSignChanged[node] = false;
+
+                NodeStatus::NodeStatus status = computeNodeStatus(levelSet.signedDistance[node]);
 
-                    // Convert to node index.
-                    n2 = levelSet.mesh.elements[i].nodes[n2];
+                // Flag all elements connected to the node.
+                if (status != mesh.nodes[node].status)
+                {
+                    mesh.nodes[node].status = status;
 
-                    // If not performing discretisation of a target structure check that at least
-                    // one node lies in the narrow band region, or is masked.
-                    if (isTarget                                                             ||
-                       (levelSet.mesh.nodes[n1].isActive | levelSet.mesh.nodes[n1].isMasked) ||
-                       (levelSet.mesh.nodes[n2].isActive | levelSet.mesh.nodes[n2].isMasked))
+                    for (unsigned int j=0;j<mesh.nodes[node].nElements;j++)
                     {
-                        // One node is inside, the other is outside. The edge is cut.
-                        if ((levelSet.mesh.nodes[n1].status|levelSet.mesh.nodes[n2].status) == NodeStatus::CUT)
+                        unsigned int element = mesh.nodes[node].elements[j];
+
+                        if (!isElementChanged[element])
                         {
-                            // Compute the distance from node 1 to the intersection point (by interpolation).
-                            double d = (*signedDistance)[n1]
-                                     / ((*signedDistance)[n1] - (*signedDistance)[n2]);
-
-                            // Initialise boundary point coordinate.
-                            Coord coord;
-
-                            // Make sure that the boundary point hasn't already been added.
-                            int index = isAdded(levelSet.mesh, coord, n1, j, d);
-
-                            // Boundary point is new.
-                            if (index < 0)
-                            {
-                                levelSet.mesh.nodes[n1].boundaryPoints[levelSet.mesh.nodes[n1].nBoundaryPoints] = nPoints;
-                                levelSet.mesh.nodes[n2].boundaryPoints[levelSet.mesh.nodes[n2].nBoundaryPoints] = nPoints;
-                                levelSet.mesh.nodes[n1].nBoundaryPoints++;
-                                levelSet.mesh.nodes[n2].nBoundaryPoints++;
-
-                                // Store boundary point for cut edge.
-                                boundaryPoints[nCut] = nPoints;
-
-                                // Initialise boundary point.
-                                BoundaryPoint point;
-                                initialisePoint(levelSet, point, coord);
-                                points.push_back(point);
-
-                                // Increment number of boundary points.
-                                nPoints++;
-                            }
-                            else
-                            {
-                                // Store existing boundary point.
-                                boundaryPoints[nCut] = index;
-                            }
-
-                            // Increment number of cut edges.
-                            nCut++;
+                            isElementChanged[element] = true;
+                            changedElements.push_back(element);
                         }
+                    }
+                }
+            }
+        }
 
-                        // Both nodes lie on the boundary.
-                        else if ((levelSet.mesh.nodes[n1].status & NodeStatus::BOUNDARY) &&
-                                 (levelSet.mesh.nodes[n2].status & NodeStatus::BOUNDARY))
-                        {
-                            // Initialise boundary point coordinate.
-                            Coord coord;
+        // Elements cut by four edges depend on the level set at their centre,
+        // so must always be rediscretised.
+        for (unsigned int i=0;i<nSegments;i++)
+        {
+            unsigned int element = segments[i].element;
+
+            if (!isElementChanged[element] && (mesh.elements[element].status &
+                (ElementStatus::CENTRE_INSIDE|ElementStatus::CENTRE_OUTSIDE)))
+            {
+                isElementChanged[element] = true;
+                changedElements.push_back(element);
+            }
+        }
 
-                            // Create boundary segment.
-                            BoundarySegment segment;
+        // Sort the elements so that new points are located in the same way as
+        // for a full discretisation.
+        std::sort(changedElements.begin(), changedElements.end());
 
-                            // Assign element index.
-                            segment.element = i;
+        // Free the segments of the changed elements.
+        for (unsigned int i=0;i<changedElements.size();i++)
+        {
+            unsigned int element = changedElements[i];
 
-                            // Make sure that the start boundary point hasn't already been added.
-                            int index = isAdded(levelSet.mesh, coord, n1, 0, 0);
+            for (unsigned int j=0;j<mesh.elements[element].nBoundarySegments;j++)
+            {
+                unsigned int segment = mesh.elements[element].boundarySegments[j];
 
-                            // Boundary point is new.
-                            if (index < 0)
-                            {
-                                // Set index equal to current number of points.
-                                index = nPoints;
+                isSegmentFree[segment] = true;
+                freeSegments.push_back(segment);
+            }
 
-                                levelSet.mesh.nodes[n1].boundaryPoints[levelSet.mesh.nodes[n1].nBoundaryPoints] = nPoints;
-                                levelSet.mesh.nodes[n1].nBoundaryPoints++;
+            mesh.elements[element].nBoundarySegments = 0;
+            computeElementStatus(mesh, element);
+        }
 
-                                // Initialise boundary point.
-                                BoundaryPoint point;
-                                initialisePoint(levelSet, point, coord);
-                                points.push_back(point);
+        // Move the existing boundary points, freeing any that no longer lie on
+        // the zero contour.
+        for (unsigned int i=0;i<nPoints;i++)
+        {
+            unsigned int n1 = pointNodes[2*i];
+            unsigned int n2 = pointNodes[2*i+1];
 
-                                // Increment number of boundary points.
-                                nPoints++;
-                            }
+            bool isValid;
 
-                            // Assign start point index.
-                            segment.start = index;
+            // Point lies on a node.
+            if (n1 == n2) isValid = (mesh.nodes[n1].status & NodeStatus::BOUNDARY);
 
-                            // Make sure that the end boundary point hasn't already been added.
-                            index = isAdded(levelSet.mesh, coord, n2, 0, 0);
+            // Point lies on an edge.
+            else isValid = ((mesh.nodes[n1].status|mesh.nodes[n2].status) == NodeStatus::CUT);
 
-                            // Boundary point is new.
-                            if (index < 0)
-                            {
-                                // Set index equal to current number of points.
-                                index = nPoints;
+            if (isValid)
+            {
+                Coord coord;
+                computePointCoord(mesh, levelSet.signedDistance, n1, n2, coord);
 
-                                levelSet.mesh.nodes[n2].boundaryPoints[levelSet.mesh.nodes[n2].nBoundaryPoints] = nPoints;
-                                levelSet.mesh.nodes[n2].nBoundaryPoints++;
+                // Reset the point.
+                points[i].reset();
+                initialisePoint(levelSet, points[i], coord);
+            }
+            else if (!isPointFree[i])
+            {
+                isPointFree[i] = true;
+                freePoints.push_back(i);
+                edgePoints[edgeKey(mesh, n1, n2)] = none;
+            }
+        }
 
-                                // Initialise boundary point.
-                                BoundaryPoint point;
-                                initialisePoint(levelSet, point, coord);
-                                points.push_back(point);
+        // Rediscretise the changed elements.
+        for (unsigned int i=0;i<changedElements.size();i++)
+        {
+            unsigned int element = changedElements[i];
 
-                                // Increment number of boundary points.
-                                nPoints++;
-                            }
+            if (mesh.elements[element].status != ElementStatus::OUTSIDE)
+                discretiseElement(levelSet, levelSet.signedDistance, element, false);
 
-                            // Assign end point index.
-                            segment.end = index;
+            isElementChanged[element] = false;
+        }
 
-                            // Compute the length of the boundary segment.
-                            segment.length = segmentLength(segment);
+        // Flag points that are used by a segment.
+        isPointUsed.assign(nPoints, false);
+        for (unsigned int i=0;i<nSegments;i++)
+        {
+            if (!isSegmentFree[i])
+            {
+                isPointUsed[segments[i].start] = true;
+                isPointUsed[segments[i].end] = true;
+            }
+        }
 
-                            // Update total boundary length.
-                            length += segment.length;
+        // Points on nodes only exist as segment end points.
+        for (unsigned int i=0;i<nPoints;i++)
+        {
+            if (!isPointFree[i] && !isPointUsed[i] && (pointNodes[2*i] == pointNodes[2*i+1]))
+            {
+                isPointFree[i] = true;
+                freePoints.push_back(i);
+                edgePoints[edgeKey(mesh, pointNodes[2*i], pointNodes[2*i])] = none;
+            }
+        }
 
-                            // Create element to segment lookup.
-                            levelSet.mesh.elements[i].boundarySegments[levelSet.mesh.elements[i].nBoundarySegments] = nSegments;
-                            levelSet.mesh.elements[i].nBoundarySegments++;
+        /* Fill any remaining free slots by moving points and segments from the
+           end of the arrays, so that they remain contiguous.
+         */
 
-                            // Add segment to vector.
-                            segments.push_back(segment);
-                            nSegments++;
-                        }
+        // Compact the points.
+        indexMap.resize(nPoints);
+        for (unsigned int i=0;i<nPoints;i++) indexMap[i] = i;
+
+        std::sort(freePoints.begin(), freePoints.end());
+
+        for (unsigned int i=0;i<freePoints.size();i++)
+        {
+            // Skip free points at the end of the array.
+            while ((nPoints > 0) && isPointFree[nPoints-1]) nPoints--;
+
+            unsigned int slot = freePoints[i];
+            if (slot >= nPoints) break;
+
+            // Move the last point into the slot.
+            nPoints--;
+            std::swap(points[slot], points[nPoints]);
+            pointNodes[2*slot] = pointNodes[2*nPoints];
+            pointNodes[2*slot+1] = pointNodes[2*nPoints+1];
+            isPointFree[slot] = false;
+            indexMap[nPoints] = slot;
+            edgePoints[edgeKey(mesh, pointNodes[2*slot], pointNodes[2*slot+1])] = slot;
+        }
+        while ((nPoints > 0) && isPointFree[nPoints-1]) nPoints--;
+
+        points.resize(nPoints);
+        pointNodes.resize(2*nPoints);
+        isPointFree.resize(nPoints);
+        freePoints.clear();
+
+        // Update the segment end points.
+        for (unsigned int i=0;i<nSegments;i++)
+        {
+            if (!isSegmentFree[i])
+            {
+                segments[i].start = indexMap[segments[i].start];
+                segments[i].end = indexMap[segments[i].end];
+            }
+        }
+
+        // Compact the segments.
+        std::sort(freeSegments.begin(), freeSegments.end());
+
+        for (unsigned int i=0;i<freeSegments.size();i++)
+        {
+            // Skip free segments at the end of the array.
+            while ((nSegments > 0) && isSegmentFree[nSegments-1]) nSegments--;
+
+            unsigned int slot = freeSegments[i];
+            if (slot >= nSegments) break;
+
+            // Move the last segment into the slot.
+            nSegments--;
+            segments[slot] = segments[nSegments];
+            isSegmentFree[slot] = false;
+
+            // Update the element to segment lookup.
+            Element element = mesh.elements[segments[slot].element];
+            for (unsigned int j=0;j<element.nBoundarySegments;j++)
+            {
+                if (element.boundarySegments[j] == nSegments)
+                    element.boundarySegments[j] = slot;
+            }
+        }
+        while ((nSegments > 0) && isSegmentFree[nSegments-1]) nSegments--;
+
+        segments.resize(nSegments);
+        isSegmentFree.resize(nSegments);
+        freeSegments.clear();
+
+        // All points have moved, so recompute the segment lengths.
+        length = 0;
+        for (unsigned int i=0;i<nSegments;i++)
+        {
+            segments[i].length = segmentLength(segments[i]);
+            length += segments[i].length;
+        }
+
+        // Work out boundary integral length associated with each boundary point.
+        computePointLengths();
+    }
+
+    void Boundary::discretiseElement(LevelSet& levelSet,
+        const std::vector<Real>& signedDistance, unsigned int element, bool isTarget)
+    {
+        Mesh& mesh = levelSet.mesh;
+
+        // Indices of the element nodes.
+        unsigned int nodes[4];
+        mesh.getElementNodes(element, nodes);
+
+        // Number of cut edges.
+        unsigned int nCut = 0;
+
+        // Existing boundary points associated with a node.
+        unsigned int boundaryPoints[4];
+
+        // Look at each edge of the node to determine whether it is cut,
+        // or if it's part of the boundary.
+        for (unsigned int j=0;j<4;j++)
+        {
+            // Index of first node on edge.
+            unsigned int n1 = nodes[j];
+
+            // Index of second node (reconnecting to 0th node).
+            // Edge connectivity goes: 0 --> 1, 1 --> 2, 2 --> 3, 3 --> 0
+            unsigned int n2 = (j == 3) ? 0 : (j + 1);
+
+            // Convert to node index.
+            n2 = nodes[n2];
+
+            // If not performing discretisation of a target structure check that at least
+            // one node lies in the narrow band region, or is masked.
+            if (isTarget                                                             ||
+               (mesh.nodes[n1].isActive | mesh.nodes[n1].isMasked) ||
+               (mesh.nodes[n2].isActive | mesh.nodes[n2].isMasked))
+            {
+                // One node is inside, the other is outside. The edge is cut.
+                if ((mesh.nodes[n1].status|mesh.nodes[n2].status) == NodeStatus::CUT)
+                {
+                    // Make sure that the boundary point hasn't already been added.
+                    unsigned int index = edgePoints[edgeKey(mesh, n1, n2)];
+
+                    // Boundary point is new.
+                    if (index == none)
+                    {
+                        // Compute the intersection point (by interpolation).
+                        Coord coord;
+                        computePointCoord(mesh, signedDistance, n1, n2, coord);
+
+                        // Add the boundary point and store it for the cut edge.
+                        boundaryPoints[nCut] = addPoint(levelSet, coord, n1, n2);
+                    }
+                    else
+                    {
+                        // Store existing boundary point.
+                        boundaryPoints[nCut] = index;
                     }
-                }
 
-                // If the element was cut, determine the boundary segment(s).
+                    // Increment number of cut edges.
+                    nCut++;
+                }
 
-                // If two edges are cut, then a boundary segment must cross both.
-                if (nCut == 2)
+                // Both nodes lie on the boundary.
+                else if ((mesh.nodes[n1].status & NodeStatus::BOUNDARY) &&
+                         (mesh.nodes[n2].status & NodeStatus::BOUNDARY))
                 {
+
                     // Create boundary segment.
                     BoundarySegment segment;
-                    segment.start = boundaryPoints[0];
-                    segment.end = boundaryPoints[1];
-                    segment.element = i;
 
-                    // Compute the length of the boundary segment.
-                    segment.length = segmentLength(segment);
+                    // Assign element index.
+                    segment.element = element;
 
-                    // Update total boundary length.
-                    length += segment.length;
+                    // Make sure that the start boundary point hasn't already been added.
+                    unsigned int index = edgePoints[edgeKey(mesh, n1, n1)];
+
+                    // Boundary point is new.
+                    if (index == none)
+                    {
+                        // Add the boundary point.
+                        index = addPoint(levelSet, mesh.nodes[n1].coord, n1, n1);
+                    }
+
+                    // Assign start point index.
+                    segment.start = index;
+
+                    // Make sure that the end boundary point hasn't already been added.
+                    index = edgePoints[edgeKey(mesh, n2, n2)];
+
+                    // Boundary point is new.
+                    if (index == none)
+                    {
+                        // Add the boundary point.
+                        index = addPoint(levelSet, mesh.nodes[n2].coord, n2, n2);
+                    }
 
-                    // Create element to segment lookup.
-                    levelSet.mesh.elements[i].boundarySegments[levelSet.mesh.elements[i].nBoundarySegments] = nSegments;
-                    levelSet.mesh.elements[i].nBoundarySegments++;
+                    // Assign end point index.
+                    segment.end = index;
 
-                    // Add segment to vector.
-                    segments.push_back(segment);
-                    nSegments++;
+                    // Add the segment.
+                    addSegment(mesh, segment);
                 }
+            }
+        }
+
+        // If the element was cut, determine the boundary segment(s).
+
+        // If two edges are cut, then a boundary segment must cross both.
+        if (nCut == 2)
+        {
+            // Create boundary segment.
+            BoundarySegment segment;
+            segment.start = boundaryPoints[0];
+            segment.end = boundaryPoints[1];
+            segment.element = element;
+
+            // Add the segment.
+            addSegment(mesh, segment);
+        }
+
+        // If there is only one cut edge, then the boundary must also cross an element node.
+        else if (nCut == 1)
+        {
+            // Find a node that is on the boundary and has a neighbour that is outside.
+            for (unsigned int j=0;j<4;j++)
+            {
+                // Node index.
+                unsigned int node = nodes[j];
 
-                // If there is only one cut edge, then the boundary must also cross an element node.
-                else if (nCut == 1)
+                // Node is on the boundary, check its neighbours.
+                if (mesh.nodes[node].status & NodeStatus::BOUNDARY)
                 {
-                    // Find a node that is on the boundary and has a neighbour that is outside.
-                    for (unsigned int j=0;j<4;j++)
+                    // Index of next node.
+                    unsigned int nAfter = (j == 3) ? 0 : (j + 1);
+
+                    // Index of previous node.
+                    unsigned int nBefore = (j == 0) ? 3 : (j - 1);
+
+                    // Convert to node indices.
+                    nAfter = nodes[nAfter];
+                    nBefore = nodes[nBefore];
+
+                    // If a neighbour is outside the boundary, then add a boundary segment.
+                    if ((mesh.nodes[nAfter].status & NodeStatus::OUTSIDE) ||
+                        (mesh.nodes[nBefore].status & NodeStatus::OUTSIDE))
                     {
-                        // Node index.
-                        unsigned int node = levelSet.mesh.elements[i].nodes[j];
+                        // Create boundary segment.
+                        BoundarySegment segment;
+                        segment.start = boundaryPoints[0];
+                        segment.element = element;
 
-                        // Node is on the boundary, check its neighbours.
-                        if (levelSet.mesh.nodes[node].status & NodeStatus::BOUNDARY)
+
+                        // Make sure that the end boundary point hasn't already been added.
+                        unsigned int index = edgePoints[edgeKey(mesh, node, node)];
+
+                        // Boundary point is new.
+                        if (index == none)
                         {
-                            // Index of next node.
-                            unsigned int nAfter = (j == 3) ? 0 : (j + 1);
-
-                            // Index of previous node.
-                            unsigned int nBefore = (j == 0) ? 3 : (j - 1);
-
-                            // Convert to node indices.
-                            nAfter = levelSet.mesh.elements[i].nodes[nAfter];
-                            nBefore = levelSet.mesh.elements[i].nodes[nBefore];
-
-                            // If a neighbour is outside the boundary, then add a boundary segment.
-                            if ((levelSet.mesh.nodes[nAfter].status & NodeStatus::OUTSIDE) ||
-                                (levelSet.mesh.nodes[nBefore].status & NodeStatus::OUTSIDE))
-                            {
-                                // Create boundary segment.
-                                BoundarySegment segment;
-                                segment.start = boundaryPoints[0];
-                                segment.element = i;
-
-                                // Initialise boundary point coordinate.
-                                Coord coord;
-
-                                // Make sure that the end boundary point hasn't already been added.
-                                int index = isAdded(levelSet.mesh, coord, node, 0, 0);
-
-                                // Boundary point is new.
-                                if (index < 0)
-                                {
-                                    // Set index equal to current number of points.
-                                    index = nPoints;
-
-                                    levelSet.mesh.nodes[node].boundaryPoints[levelSet.mesh.nodes[node].nBoundaryPoints] = nPoints;
-                                    levelSet.mesh.nodes[node].nBoundaryPoints++;
-
-                                    // Initialise boundary point.
-                                    BoundaryPoint point;
-                                    initialisePoint(levelSet, point, coord);
-                                    points.push_back(point);
-
-                                    // Increment number of boundary points.
-                                    nPoints++;
-                                }
-
-                                // Assign end point index.
-                                segment.end = index;
-
-                                // Compute the length of the boundary segment.
-                                segment.length = segmentLength(segment);
-
-                                // Update total boundary length.
-                                length += segment.length;
-
-                                // Create element to segment lookup.
-                                levelSet.mesh.elements[i].boundarySegments[levelSet.mesh.elements[i].nBoundarySegments] = nSegments;
-                                levelSet.mesh.elements[i].nBoundarySegments++;
-
-                                // Add segment to vector.
-                                segments.push_back(segment);
-                                nSegments++;
-                            }
+                            // Add the boundary point.
+                            index = addPoint(levelSet, mesh.nodes[node].coord, node, node);
                         }
+
+                        // Assign end point index.
+                        segment.end = index;
+
+                        // Add the segment.
+                        addSegment(mesh, segment);
                     }
                 }
+            }
+        }
 
-                // If there are four cut edges, then determine which
-                // boundary node pairs form the boundary.
-                else if (nCut == 4)
-                {
-                    double lsfSum = 0;
+        // If there are four cut edges, then determine which
+        // boundary node pairs form the boundary.
+        else if (nCut == 4)
+        {
+            double lsfSum = 0;
 
-                    // Evaluate level set value at element centre.
-                    for (unsigned int j=0;j<4;j++)
-                    {
-                        // Node index.
-                        unsigned int node = levelSet.mesh.elements[i].nodes[j];
+            // Evaluate level set value at element centre.
+            for (unsigned int j=0;j<4;j++)
+            {
+                // Node index.
+                unsigned int node = nodes[j];
 
-                        lsfSum += (*signedDistance)[node];
-                    }
+                lsfSum += signedDistance[node];
+            }
 
-                    // Create boundary segment.
-                    BoundarySegment segment;
+            // Create boundary segment.
+            BoundarySegment segment;
 
-                    // Store the status of the first node.
-                    unsigned int node = levelSet.mesh.elements[i].nodes[0];
-                    NodeStatus::NodeStatus status = levelSet.mesh.nodes[node].status;
+            // Store the status of the first node.
+            unsigned int node = nodes[0];
+            NodeStatus::NodeStatus status = mesh.nodes[node].status;
 
-                    if (((status & NodeStatus::INSIDE) && (lsfSum > 0))  ||
-                        ((status & NodeStatus::OUTSIDE) && (lsfSum < 0)))
-                    {
-                        segment.start = boundaryPoints[0];
-                        segment.end = boundaryPoints[1];
-                        segment.element = i;
+            if (((status & NodeStatus::INSIDE) && (lsfSum > 0))  ||
+                ((status & NodeStatus::OUTSIDE) && (lsfSum < 0)))
+            {
+                segment.start = boundaryPoints[0];
+                segment.end = boundaryPoints[1];
+                segment.element = element;
+
+                // Add the segment.
+                addSegment(mesh, segment);
+
+                segment.start = boundaryPoints[2];
+                segment.end = boundaryPoints[3];
+                segment.element = element;
+
+                // Add the segment.
+                addSegment(mesh, segment);
+            }
 
-                        // Compute the length of the boundary segment.
-                        segment.length = segmentLength(segment);
+            else
+            {
+                segment.start = boundaryPoints[0];
+                segment.end = boundaryPoints[3];
+                segment.element = element;
 
-                        // Update total boundary length.
-                        length += segment.length;
+                // Add the segment.
+                addSegment(mesh, segment);
 
-                        // Create element to segment lookup.
-                        levelSet.mesh.elements[i].boundarySegments[levelSet.mesh.elements[i].nBoundarySegments] = nSegments;
-                        levelSet.mesh.elements[i].nBoundarySegments++;
+                segment.start = boundaryPoints[1];
+                segment.end = boundaryPoints[2];
+                segment.element = element;
 
-                        // Add segment to vector.
-                        segments.push_back(segment);
-                        nSegments++;
+                // Add the segment.
+                addSegment(mesh, segment);
+            }
 
-                        segment.start = boundaryPoints[2];
-                        segment.end = boundaryPoints[3];
-                        segment.element = i;
+            // Update element status to indicate whether centre is in or out.
+            mesh.elements[element].status = (lsfSum > 0) ? ElementStatus::CENTRE_INSIDE : ElementStatus::CENTRE_OUTSIDE;
+        }
 
-                        // Compute the length of the boundary segment.
-                        segment.length = segmentLength(segment);
+        // If no edges are cut and element is not inside structure
+        // then the boundary segment must cross the diagonal.
+        else if ((nCut == 0) && (mesh.elements[element].status != ElementStatus::INSIDE))
+        {
+            // Node index.
+            unsigned int node;
 
-                        // Update total boundary length.
-                        length += segment.length;
+            // Find the two boundary nodes.
+            for (unsigned int j=0;j<4;j++)
+            {
+                // Node index.
+                node = nodes[j];
 
-                        // Create element to segment lookup.
-                        levelSet.mesh.elements[i].boundarySegments[levelSet.mesh.elements[i].nBoundarySegments] = nSegments;
-                        levelSet.mesh.elements[i].nBoundarySegments++;
+                if (mesh.nodes[node].status & NodeStatus::BOUNDARY)
+                {
+                    boundaryPoints[nCut] = node;
+                    nCut++;
+                }
+            }
 
-                        // Add segment to vector.
-                        segments.push_back(segment);
-                        nSegments++;
-                    }
+            // Create boundary segment.
+            BoundarySegment segment;
+            segment.element = element;
 
-                    else
-                    {
-                        segment.start = boundaryPoints[0];
-                        segment.end = boundaryPoints[3];
-                        segment.element = i;
 
-                        // Compute the length of the boundary segment.
-                        segment.length = segmentLength(segment);
+            // Make sure that the start boundary point hasn't already been added.
+            node = boundaryPoints[0];
+            unsigned int index = edgePoints[edgeKey(mesh, node, node)];
 
-                        // Update total boundary length.
-                        length += segment.length;
+            // Boundary point is new.
+            if (index == none)
+            {
+                // Add the boundary point.
+                index = addPoint(levelSet, mesh.nodes[node].coord, node, node);
+            }
 
-                        // Create element to segment lookup.
-                        levelSet.mesh.elements[i].boundarySegments[levelSet.mesh.elements[i].nBoundarySegments] = nSegments;
-                        levelSet.mesh.elements[i].nBoundarySegments++;
+            // Assign start point index.
+            segment.start = index;
 
-                        // Add segment to vector.
-                        segments.push_back(segment);
-                        nSegments++;
+            // Make sure that the end boundary point hasn't already been added.
+            node = boundaryPoints[1];
+            index = edgePoints[edgeKey(mesh, node, node)];
 
-                        segment.start = boundaryPoints[1];
-                        segment.end = boundaryPoints[2];
-                        segment.element = i;
+            // Boundary point is new.
+            if (index == none)
+            {
+                // Add the boundary point.
+                index = addPoint(levelSet, mesh.nodes[node].coord, node, node);
+            }
 
-                        // Compute the length of the boundary segment.
-                        segment.length = segmentLength(segment);
+            // Assign end point index.
+            segment.end = index;
 
-                        // Update total boundary length.
-                        length += segment.length;
+            // Add the segment.
+            addSegment(mesh, segment);
+        }
+    }
 
-                        // Create element to segment lookup.
-                        levelSet.mesh.elements[i].boundarySegments[levelSet.mesh.elements[i].nBoundarySegments] = nSegments;
-                        levelSet.mesh.elements[i].nBoundarySegments++;
+    void Boundary::discretiseElement(const SparseLevelSet& levelSet,
+        unsigned int x, unsigned int y, const unsigned int* nodes)
+    {
+        // Status of each node.
+        NodeStatus::NodeStatus status[4];
 
-                        // Add segment to vector.
-                        segments.push_back(segment);
-                        nSegments++;
-                    }
+        // Tally counters for the element's node statistics.
+        unsigned int tallyInside = 0;
+        unsigned int tallyOutside = 0;
 
-                    // Update element status to indicate whether centre is in or out.
-                    levelSet.mesh.elements[i].status = (lsfSum > 0) ? ElementStatus::CENTRE_INSIDE : ElementStatus::CENTRE_OUTSIDE;
-                }
+        for (unsigned int j=0;j<4;j++)
+        {
+            status[j] = computeNodeStatus(levelSet.signedDistance[nodes[j]]);
 
-                // If no edges are cut and element is not inside structure
-                // then the boundary segment must cross the diagonal.
-                else if ((nCut == 0) && (levelSet.mesh.elements[i].status != ElementStatus::INSIDE))
-                {
-                    // Node index.
-                    unsigned int node;
+            if (status[j] & NodeStatus::INSIDE) tallyInside++;
+            else if (status[j] & NodeStatus::OUTSIDE) tallyOutside++;
+        }
 
-                    // Find the two boundary nodes.
-                    for (unsigned int j=0;j<4;j++)
-                    {
-                        // Node index.
-                        node = levelSet.mesh.elements[i].nodes[j];
+        // Element is outside the structure.
+        if ((tallyOutside > 0) && (tallyInside == 0)) return;
 
-                        if (levelSet.mesh.nodes[node].status & NodeStatus::BOUNDARY)
-                        {
-                            boundaryPoints[nCut] = node;
-                            nCut++;
-                        }
-                    }
+        // Coordinates of the element nodes.
+        Coord coords[4] = {Coord(x, y), Coord(x + 1, y), Coord(x + 1, y + 1), Coord(x, y + 1)};
 
-                    // Create boundary segment.
-                    BoundarySegment segment;
-                    segment.element = i;
+        // Lookup keys for the element edges (owned by the node to the left of,
+        // or below, the edge) and nodes.
+        unsigned int edgeKeys[4] = {3*nodes[0], 3*nodes[1] + 1, 3*nodes[3], 3*nodes[0] + 1};
+        unsigned int nodeKeys[4] = {3*nodes[0] + 2, 3*nodes[1] + 2, 3*nodes[2] + 2, 3*nodes[3] + 2};
 
-                    // Initialise boundary point coordinate.
-                    Coord coord;
+        // Number of cut edges.
+        unsigned int nCut = 0;
 
-                    // Make sure that the start boundary point hasn't already been added.
-                    node = boundaryPoints[0];
-                    int index = isAdded(levelSet.mesh, coord, node, 0, 0);
+        // Boundary points on the cut edges.
+        unsigned int boundaryPoints[4];
 
-                    // Boundary point is new.
-                    if (index < 0)
-                    {
-                        // Set index equal to current number of points.
-                        index = nPoints;
+        // Look at each edge of the element, using the same rules as for a LevelSet.
+        for (unsigned int j=0;j<4;j++)
+        {
+            // Index of second node (reconnecting to 0th node).
+            unsigned int k = (j == 3) ? 0 : (j + 1);
 
-                        levelSet.mesh.nodes[node].boundaryPoints[levelSet.mesh.nodes[node].nBoundaryPoints] = nPoints;
-                        levelSet.mesh.nodes[node].nBoundaryPoints++;
+            unsigned int n1 = nodes[j];
+            unsigned int n2 = nodes[k];
 
-                        // Initialise boundary point.
-                        BoundaryPoint point;
-                        initialisePoint(levelSet, point, coord);
-                        points.push_back(point);
+            // Check that at least one node lies in the narrow band region.
+            if (!((levelSet.nodeFlags[n1] | levelSet.nodeFlags[n2]) & SparseNodeFlag::ACTIVE)) continue;
 
-                        // Increment number of boundary points.
-                        nPoints++;
-                    }
+            // One node is inside, the other is outside. The edge is cut.
+            if ((status[j]|status[k]) == NodeStatus::CUT)
+            {
+                // Compute the intersection point (by interpolation).
+                double d = levelSet.signedDistance[n1] / (levelSet.signedDistance[n1] - levelSet.signedDistance[n2]);
+                Coord coord(coords[j].x + d*(coords[k].x - coords[j].x), coords[j].y + d*(coords[k].y - coords[j].y));
 
-                    // Assign start point index.
-                    segment.start = index;
+                boundaryPoints[nCut] = addPoint(levelSet, coord, edgeKeys[j]);
+                nCut++;
+            }
 
-                    // Make sure that the end boundary point hasn't already been added.
-                    node = boundaryPoints[1];
-                    index = isAdded(levelSet.mesh, coord, node, 0, 0);
+            // Both nodes lie on the boundary.
+            else if ((status[j] & NodeStatus::BOUNDARY) && (status[k] & NodeStatus::BOUNDARY))
+            {
+                BoundarySegment segment;
+                segment.element = nodes[0];
+                segment.start = addPoint(levelSet, coords[j], nodeKeys[j]);
+                segment.end = addPoint(levelSet, coords[k], nodeKeys[k]);
+                addSegment(segment);
+            }
+        }
 
-                    // Boundary point is new.
-                    if (index < 0)
-                    {
-                        // Set index equal to current number of points.
-                        index = nPoints;
+        // Create boundary segment.
+        BoundarySegment segment;
+        segment.element = nodes[0];
 
-                        levelSet.mesh.nodes[node].boundaryPoints[levelSet.mesh.nodes[node].nBoundaryPoints] = nPoints;
-                        levelSet.mesh.nodes[node].nBoundaryPoints++;
+        // If two edges are cut, then a boundary segment must cross both.
+        if (nCut == 2)
+        {
+            segment.start = boundaryPoints[0];
+            segment.end = boundaryPoints[1];
+            addSegment(segment);
+        }
 
-                        // Initialise boundary point.
-                        BoundaryPoint point;
-                        initialisePoint(levelSet, point, coord);
-                        points.push_back(point);
+        // If there is only one cut edge, then the boundary must also cross an element node.
+        else if (nCut == 1)
+        {
+            for (unsigned int j=0;j<4;j++)
+            {
+                if (status[j] & NodeStatus::BOUNDARY)
+                {
+                    unsigned int after = (j == 3) ? 0 : (j + 1);
+                    unsigned int before = (j == 0) ? 3 : (j - 1);
 
-                        // Increment number of boundary points.
-                        nPoints++;
+                    // If a neighbour is outside the boundary, then add a boundary segment.
+                    if ((status[after] & NodeStatus::OUTSIDE) || (status[before] & NodeStatus::OUTSIDE))
+                    {
+                        segment.start = boundaryPoints[0];
+                        segment.end = addPoint(levelSet, coords[j], nodeKeys[j]);
+                        addSegment(segment);
                     }
+                }
+            }
+        }
 
-                    // Assign end point index.
-                    segment.end = index;
+        // If there are four cut edges, then the boundary depends on the
+        // level set at the element centre.
+        else if (nCut == 4)
+        {
+            double lsfSum = 0;
+            for (unsigned int j=0;j<4;j++) lsfSum += levelSet.signedDistance[nodes[j]];
 
-                    // Compute the length of the boundary segment.
-                    segment.length = segmentLength(segment);
+            if (((status[0] & NodeStatus::INSIDE) && (lsfSum > 0))  ||
+                ((status[0] & NodeStatus::OUTSIDE) && (lsfSum < 0)))
+            {
+                segment.start = boundaryPoints[0];
+                segment.end = boundaryPoints[1];
+                addSegment(segment);
 
-                    // Update total boundary length.
-                    length += segment.length;
+                segment.start = boundaryPoints[2];
+                segment.end = boundaryPoints[3];
+                addSegment(segment);
+            }
+            else
+            {
+                segment.start = boundaryPoints[0];
+                segment.end = boundaryPoints[3];
+                addSegment(segment);
 
-                    // Create element to segment lookup.
-                    levelSet.mesh.elements[i].boundarySegments[levelSet.mesh.elements[i].nBoundarySegments] = nSegments;
-                    levelSet.mesh.elements[i].nBoundarySegments++;
+                segment.start = boundaryPoints[1];
+                segment.end = boundaryPoints[2];
+                addSegment(segment);
+            }
+        }
 
-                    // Add segment to vector.
-                    segments.push_back(segment);
-                    nSegments++;
+        // If no edges are cut and element is not inside structure
+        // then the boundary segment must cross the diagonal.
+        else if ((nCut == 0) && (tallyOutside > 0))
+        {
+            // Find the two boundary nodes.
+            for (unsigned int j=0;j<4;j++)
+            {
+                if (status[j] & NodeStatus::BOUNDARY)
+                {
+                    boundaryPoints[nCut] = addPoint(levelSet, coords[j], nodeKeys[j]);
+                    nCut++;
                 }
             }
-        }
 
-        // Work out boundary integral length associated with each boundary point.
-        computePointLengths();
+            segment.start = boundaryPoints[0];
+            segment.end = boundaryPoints[1];
+            addSegment(segment);
+        }
     }
 
     void Boundary::computeNormalVectors(const LevelSet& levelSet)
     {
-        // Whether the normal vector at a boundary point has been set.
-        bool isSet[nPoints];
-
-        // Weighting factor for each point.
-        double weight[nPoints];
+        // Resize scratch arrays (memory is retained between calls).
+        isNormalSet.resize(nPoints);
+        normalWeight.resize(nPoints);
 
         // Initialise arrays.
         for (unsigned int i=0;i<nPoints;i++)
         {
-            isSet[i] = false;
-            weight[i] = 0;
+            isNormalSet[i] = false;
+            normalWeight[i] = 0;
             points[i].normal.x = 0;
             points[i].normal.y = 0;
         }
 
+        // Boundary points associated with a node.
+        unsigned int nodePoints[4];
+
         // Loop over all narrow band nodes.
         for (unsigned int i=0;i<levelSet.nNarrowBand;i++)
         {
             // Node index.
             unsigned int node = levelSet.narrowBand[i];
 
+            // Find the boundary points associated with the node.
+            unsigned int nNodePoints = getNodePoints(levelSet.mesh, node, nodePoints);
+
             // Make sure the node has at least one neighbouring boundary point.
-            if (levelSet.mesh.nodes[node].nBoundaryPoints > 0)
+            if (nNodePoints > 0)
             {
                 // Nodal coordinates.
                 unsigned int x = levelSet.mesh.nodes[node].coord.x;
@@ -576,24 +958,24 @@ namespace slsm
                 if (x == 0)
                 {
                     // Forward difference.
-                    gradX = levelSet.signedDistance[levelSet.mesh.xyToIndex[x+1][y]]
-                          - levelSet.signedDistance[levelSet.mesh.xyToIndex[x][y]];
+                    gradX = levelSet.signedDistance[levelSet.mesh.xyToIndex(x+1, y)]
+                          - levelSet.signedDistance[levelSet.mesh.xyToIndex(x, y)];
                 }
 
                 // Right edge of mesh.
                 else if (x == levelSet.mesh.width)
                 {
                     // Backward difference.
-                    gradX = levelSet.signedDistance[levelSet.mesh.xyToIndex[x][y]]
-                          - levelSet.signedDistance[levelSet.mesh.xyToIndex[x-1][y]];
+                    gradX = levelSet.signedDistance[levelSet.mesh.xyToIndex(x, y)]
+                          - levelSet.signedDistance[levelSet.mesh.xyToIndex(x-1, y)];
                 }
 
                 // Bulk of mesh.
                 else
                 {
                     // Central difference.
-                    gradX = 0.5*(levelSet.signedDistance[levelSet.mesh.xyToIndex[x+1][y]]
-                          - levelSet.signedDistance[levelSet.mesh.xyToIndex[x-1][y]]);
+                    gradX = 0.5*(levelSet.signedDistance[levelSet.mesh.xyToIndex(x+1, y)]
+                          - levelSet.signedDistance[levelSet.mesh.xyToIndex(x-1, y)]);
                 }
 
                 // y direction
@@ -602,24 +984,24 @@ namespace slsm
                 if (y == 0)
                 {
                     // Forward difference.
-                    gradY = levelSet.signedDistance[levelSet.mesh.xyToIndex[x][y+1]]
-                          - levelSet.signedDistance[levelSet.mesh.xyToIndex[x][y]];
+                    gradY = levelSet.signedDistance[levelSet.mesh.xyToIndex(x, y+1)]
+                          - levelSet.signedDistance[levelSet.mesh.xyToIndex(x, y)];
                 }
 
                 // Top edge of mesh.
                 else if (y == levelSet.mesh.height)
                 {
                     // Backward difference.
-                    gradY = levelSet.signedDistance[levelSet.mesh.xyToIndex[x][y]]
-                          - levelSet.signedDistance[levelSet.mesh.xyToIndex[x][y-1]];
+                    gradY = levelSet.signedDistance[levelSet.mesh.xyToIndex(x, y)]
+                          - levelSet.signedDistance[levelSet.mesh.xyToIndex(x, y-1)];
                 }
 
                 // Bulk of mesh.
                 else
                 {
                     // Central difference.
-                    gradY = 0.5*(levelSet.signedDistance[levelSet.mesh.xyToIndex[x][y+1]]
-                          - levelSet.signedDistance[levelSet.mesh.xyToIndex[x][y-1]]);
+                    gradY = 0.5*(levelSet.signedDistance[levelSet.mesh.xyToIndex(x, y+1)]
+                          - levelSet.signedDistance[levelSet.mesh.xyToIndex(x, y-1)]);
                 }
 
                 // Absolute gradient.
@@ -630,10 +1012,10 @@ namespace slsm
                 double yNormal = gradY / grad;
 
                 // Loop over all boundary points.
-                for (unsigned int j=0;j<levelSet.mesh.nodes[node].nBoundaryPoints;j++)
+                for (unsigned int j=0;j<nNodePoints;j++)
                 {
                     // Boundary point index.
-                    unsigned int point = levelSet.mesh.nodes[node].boundaryPoints[j];
+                    unsigned int point = nodePoints[j];
 
                     // Distance from the boundary point to the node.
                     double dx = levelSet.mesh.nodes[node].coord.x - points[point].coord.x;
@@ -648,18 +1030,18 @@ namespace slsm
                     {
                         points[point].normal.x = xNormal;
                         points[point].normal.y = yNormal;
-                        weight[point] = 1.0;
-                        isSet[point] = true;
+                        normalWeight[point] = 1.0;
+                        isNormalSet[point] = true;
                     }
 
                     else
                     {
                         // Update normal vector estimate if not already set.
-                        if (!isSet[point])
+                        if (!isNormalSet[point])
                         {
                             points[point].normal.x += xNormal / rSqd;
                             points[point].normal.y += yNormal / rSqd;
-                            weight[point] += 1.0 / rSqd;
+                            normalWeight[point] += 1.0 / rSqd;
                         }
                     }
                 }
@@ -671,8 +1053,8 @@ namespace slsm
         {
             if (!points[i].isDomain)
             {
-                points[i].normal.x /= weight[i];
-                points[i].normal.y /= weight[i];
+                points[i].normal.x /= normalWeight[i];
+                points[i].normal.y /= normalWeight[i];
 
                 // Compute the new vector norm.
                 double norm = sqrt(points[i].normal.x*points[i].normal.x
@@ -684,6 +1066,44 @@ namespace slsm
         }
     }
 
+    unsigned int Boundary::getNodePoints(const Mesh& mesh, unsigned int node, unsigned int* nodePoints) const
+    {
+        unsigned int nNodePoints = 0;
+
+        // Point lies on the node (the adjoining edges can't be cut).
+        if (edgePoints[3*node + 2] != none)
+        {
+            nodePoints[0] = edgePoints[3*node + 2];
+            return 1;
+        }
+
+        // Check the edges to the left, right, below, and above the node.
+        for (unsigned int i=0;i<4;i++)
+        {
+            unsigned int neighbour = mesh.nodes[node].neighbours[i];
+
+            if (neighbour < mesh.nNodes)
+            {
+                unsigned int index = edgePoints[edgeKey(mesh, node, neighbour)];
+
+                if (index != none)
+                {
+                    // Insert the point in ascending order.
+                    unsigned int j = nNodePoints;
+                    while ((j > 0) && (nodePoints[j-1] > index))
+                    {
+                        nodePoints[j] = nodePoints[j-1];
+                        j--;
+                    }
+                    nodePoints[j] = index;
+                    nNodePoints++;
+                }
+            }
+        }
+
+        return nNodePoints;
+    }
+
     double Boundary::computePerimeter(const BoundaryPoint& point)
     {
         double length = 0;
@@ -700,133 +1120,137 @@ namespace slsm
         return length;
     }
 
-    void Boundary::computeMeshStatus(Mesh& mesh, const std::vector<double>* signedDistance) const
+    void Boundary::computeMeshStatus(Mesh& mesh, const std::vector<Real>* signedDistance) const
     {
         // Calculate node status.
         for (unsigned int i=0;i<mesh.nNodes;i++)
-        {
-            // Reset the number of boundary points associated with the element.
-            mesh.nodes[i].nBoundaryPoints = 0;
-
-            // Flag node as being on the boundary if the signed distance is within
-            // a small tolerance of the zero contour. This avoids problems with
-            // rounding errors when generating the discretised boundary.
-            if (std::abs((*signedDistance)[i]) < 1e-6)
-            {
-                mesh.nodes[i].status = NodeStatus::BOUNDARY;
-            }
-            else if ((*signedDistance)[i] < 0)
-            {
-                mesh.nodes[i].status = NodeStatus::OUTSIDE;
-            }
-            else mesh.nodes[i].status = NodeStatus::INSIDE;
-        }
+            mesh.nodes[i].status = computeNodeStatus((*signedDistance)[i]);
 
         // Calculate element status.
         for (unsigned int i=0;i<mesh.nElements;i++)
         {
-            // Tally counters for the element's node statistics.
-            unsigned int tallyInside = 0;
-            unsigned int tallyOutside = 0;
-
             // Reset the number of boundary segments associated with the element.
             mesh.elements[i].nBoundarySegments = 0;
 
-            // Loop over each node of the element.
-            for (unsigned int j=0;j<4;j++)
-            {
-                unsigned int node = mesh.elements[i].nodes[j];
-
-                if (mesh.nodes[node].status & NodeStatus::INSIDE) tallyInside++;
-                else if (mesh.nodes[node].status & NodeStatus::OUTSIDE) tallyOutside++;
-            }
+            computeElementStatus(mesh, i);
+        }
+    }
 
-            // No nodes are outside: element is inside the structure.
-            if (tallyOutside == 0) mesh.elements[i].status = ElementStatus::INSIDE;
+    void Boundary::computeElementStatus(Mesh& mesh, unsigned int element) const
+    {
+        // Tally counters for the element's node statistics.
+        unsigned int tallyInside = 0;
+        unsigned int tallyOutside = 0;
 
-            // No nodes are inside: element is outside the structure.
-            else if (tallyInside == 0) mesh.elements[i].status = ElementStatus::OUTSIDE;
+        // Indices of the element nodes.
+        unsigned int nodes[4];
+        mesh.getElementNodes(element, nodes);
 
-            // Otherwise no status.
-            else mesh.elements[i].status = ElementStatus::NONE;
+        // Loop over each node of the element.
+        for (unsigned int j=0;j<4;j++)
+        {
+            if (mesh.nodes[nodes[j]].status & NodeStatus::INSIDE) tallyInside++;
+            else if (mesh.nodes[nodes[j]].status & NodeStatus::OUTSIDE) tallyOutside++;
         }
+
+        // No nodes are outside: element is inside the structure.
+        if (tallyOutside == 0) mesh.elements[element].status = ElementStatus::INSIDE;
+
+        // No nodes are inside: element is outside the structure.
+        else if (tallyInside == 0) mesh.elements[element].status = ElementStatus::OUTSIDE;
+
+        // Otherwise no status.
+        else mesh.elements[element].status = ElementStatus::NONE;
     }
 
-    int Boundary::isAdded(Mesh& mesh, Coord& point, const unsigned int& node,
-        const unsigned int& edge, const double& distance)
+    unsigned int Boundary::edgeKey(const Mesh& mesh, unsigned int node1, unsigned int node2) const
     {
-        // Work out the coordinates of the point (depends on which edge we are considering).
-        // Set edge and distance equal to zero when considering boundary points lying exactly
-        // on top of a mesh node.
+        // Point lies on a node.
+        if (node1 == node2) return 3*node1 + 2;
 
-        // Bottom edge.
-        if (edge == 0)
-        {
-            point.x = mesh.nodes[node].coord.x + distance;
-            point.y = mesh.nodes[node].coord.y;
-        }
-        // Right edge.
-        else if (edge == 1)
-        {
-            point.x = mesh.nodes[node].coord.x;
-            point.y = mesh.nodes[node].coord.y + distance;
-        }
-        // Top edge.
-        else if (edge == 2)
-        {
-            point.x = mesh.nodes[node].coord.x - distance;
-            point.y = mesh.nodes[node].coord.y;
-        }
-        // Left edge.
-        else
+        // Edges are owned by the node to the left or below (node indices
+        // increase with x and y for all node orderings).
+        unsigned int node = std::min(node1, node2);
+
+        // Horizontal edge.
+        if (mesh.nodeY[node1] == mesh.nodeY[node2]) return 3*node;
+
+        // Vertical edge.
+        else return 3*node + 1;
+    }
+
+    void Boundary::computePointCoord(const Mesh& mesh, const std::vector<Real>& signedDistance,
+        unsigned int node1, unsigned int node2, Coord& coord) const
+    {
+        coord = mesh.nodes[node1].coord;
+
+        if (node1 != node2)
         {
-            point.x = mesh.nodes[node].coord.x;
-            point.y = mesh.nodes[node].coord.y - distance;
+            // Compute the distance from node 1 to the intersection point (by interpolation).
+            double d = signedDistance[node1] / (signedDistance[node1] - signedDistance[node2]);
+
+            // Move along the edge.
+            coord.x += d*(mesh.nodes[node2].coord.x - mesh.nodes[node1].coord.x);
+            coord.y += d*(mesh.nodes[node2].coord.y - mesh.nodes[node1].coord.y);
         }
+    }
 
-        // Check all points adjacent to the node.
-        for (unsigned int i=0;i<mesh.nodes[node].nBoundaryPoints;i++)
+    void Boundary::initialisePoint(LevelSet& levelSet, BoundaryPoint& point, const Coord& coord)
+    {
+        // Set the position and movement limits.
+        initialisePoint(point, coord, levelSet.moveLimit, levelSet.mesh.width, levelSet.mesh.height);
+
+        // Index of nearest node on the mesh.
+        unsigned int node = levelSet.mesh.getClosestNode(coord);
+
+        // Check to see if point lies on, or near, a masked region.
+        if (levelSet.mesh.nodes[node].isMasked)
         {
-            // Index of the ith boundary point connected to the node.
-            unsigned int index = mesh.nodes[node].boundaryPoints[i];
+            // Distance to masked node.
+            double dx = levelSet.mesh.nodes[node].coord.x - coord.x;
+            double dy = levelSet.mesh.nodes[node].coord.y - coord.y;
 
-            // Point already exists.
-            if ((std::abs(point.x - points[index].coord.x) < 1e-6) &&
-                (std::abs(point.y - points[index].coord.y) < 1e-6))
+            // Lies on the masked node.
+            if ((std::abs(dx) < 1e-6) && (std::abs(dy) < 1e-6))
+                point.isFixed = true;
+
+            // Update negative move limit.
+            else
             {
-                // Boundary point is already added, return index.
-                return index;
+                // Work out distance to the node.
+                double d = sqrt(dx*dx + dy*dy);
+
+                // Update negative move limit.
+                if (-d > point.negativeLimit) point.negativeLimit = -d;
             }
         }
-
-        // If we've made it this far, then point is new.
-        return -1;
     }
 
-    void Boundary::initialisePoint(LevelSet& levelSet, BoundaryPoint& point, const Coord& coord)
+    void Boundary::initialisePoint(BoundaryPoint& point, const Coord& coord,
+        double moveLimit, unsigned int width, unsigned int height)
     {
         // Set the boundary point coordinates.
         point.coord = coord;
 
         // Initialise movement limit (CFL condition).
-        point.negativeLimit = -levelSet.moveLimit;
-        point.positiveLimit =  levelSet.moveLimit;
+        point.negativeLimit = -moveLimit;
+        point.positiveLimit =  moveLimit;
 
         // Check whether point lies within the move limit of the domain boundary.
         // If so, modify the lower movement limit so that point can't move outside of
         // the domain.
 
         // Closest distance to domain boundary in x.
-        double minX = std::min(coord.x, levelSet.mesh.width - coord.x);
+        double minX = std::min(coord.x, width - coord.x);
 
         // Closest distance to domain boundary in y.
-        double minY = std::min(coord.y, levelSet.mesh.height - coord.y);
+        double minY = std::min(coord.y, height - coord.y);
 
         // Closest distance to any domain boundary.
         double minBoundary = std::min(minX, minY);
 
         // Modify lower move limit.
-        if (minBoundary < levelSet.moveLimit)
+        if (minBoundary < moveLimit)
         {
             point.negativeLimit = -minBoundary;
 
@@ -834,31 +1258,106 @@ namespace slsm
             if (minBoundary < 1e-6)
                 point.isDomain = true;
         }
+    }
 
-        // Index of nearest node on the mesh.
-        unsigned int node = levelSet.mesh.getClosestNode(coord);
+    unsigned int Boundary::addPoint(LevelSet& levelSet, const Coord& coord,
+        unsigned int node1, unsigned int node2)
+    {
+        unsigned int index;
 
-        // Check to see if point lies on, or near, a masked region.
-        if (levelSet.mesh.nodes[node].isMasked)
+        // Reuse a free slot.
+        if (!freePoints.empty())
         {
-            // Distance to masked node.
-            double dx = levelSet.mesh.nodes[node].coord.x - coord.x;
-            double dy = levelSet.mesh.nodes[node].coord.y - coord.y;
+            index = freePoints.back();
+            freePoints.pop_back();
+            isPointFree[index] = false;
+            points[index].reset();
+        }
 
-            // Lies on the masked node.
-            if ((std::abs(dx) < 1e-6) && (std::abs(dy) < 1e-6))
-                point.isFixed = true;
+        // Add to the end of the array.
+        else
+        {
+            index = nPoints;
+            points.push_back(BoundaryPoint());
+            pointNodes.resize(2*(nPoints+1));
+            isPointFree.push_back(false);
 
-            // Update negative move limit.
-            else
-            {
-                // Work out distance to the node.
-                double d = sqrt(dx*dx + dy*dy);
+            // Increment number of boundary points.
+            nPoints++;
+        }
 
-                // Update negative move limit.
-                if (-d > point.negativeLimit) point.negativeLimit = -d;
-            }
+        // Initialise boundary point.
+        initialisePoint(levelSet, points[index], coord);
+
+        // Store the edge on which the point lies.
+        pointNodes[2*index] = node1;
+        pointNodes[2*index+1] = node2;
+
+        // Create edge to boundary point lookup.
+        edgePoints[edgeKey(levelSet.mesh, node1, node2)] = index;
+
+        return index;
+    }
+
+    unsigned int Boundary::addPoint(const SparseLevelSet& levelSet, const Coord& coord, unsigned int key)
+    {
+        // The boundary point has already been added.
+        if (edgePoints[key] != none) return edgePoints[key];
+
+        unsigned int index = nPoints;
+
+        // Add to the end of the array (there are no free slots).
+        points.push_back(BoundaryPoint());
+        isPointFree.push_back(false);
+        nPoints++;
+
+        // Initialise boundary point.
+        initialisePoint(points[index], coord, levelSet.moveLimit, levelSet.width, levelSet.height);
+
+        // Create edge to boundary point lookup.
+        edgePoints[key] = index;
+
+        return index;
+    }
+
+    void Boundary::addSegment(Mesh& mesh, BoundarySegment& segment)
+    {
+        unsigned int index = addSegment(segment);
+
+        // Create element to segment lookup.
+        mesh.elements[segment.element].boundarySegments[mesh.elements[segment.element].nBoundarySegments] = index;
+        mesh.elements[segment.element].nBoundarySegments++;
+    }
+
+    unsigned int Boundary::addSegment(BoundarySegment& segment)
+    {
+        // Compute the length of the boundary segment.
+        segment.length = segmentLength(segment);
+
+        // Update total boundary length.
+        length += segment.length;
+
+        unsigned int index;
+
+        // Reuse a free slot.
+        if (!freeSegments.empty())
+        {
+            index = freeSegments.back();
+            freeSegments.pop_back();
+            isSegmentFree[index] = false;
+            segments[index] = segment;
+        }
+
+        // Add segment to vector.
+        else
+        {
+            index = nSegments;
+            segments.push_back(segment);
+            isSegmentFree.push_back(false);
+            nSegments++;
         }
+
+        return index;
     }
 
     double Boundary::segmentLength(const BoundarySegment& segment)
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "Common.h"
+#include "Mesh.h"
 
 /*! \file Boundary.h
     \brief A class for the discretised boundary.
@@ -31,7 +32,7 @@ namespace slsm
     // FORWARD DECLARATIONS
 
     class LevelSet;
-    class Mesh;
+    class SparseLevelSet;
 
     // ASSOCIATED DATA TYPES
 
@@ -42,6 +43,9 @@ namespace slsm
         //! Constructor.
         BoundaryPoint();
 
+        //! Restore the default state, keeping the capacity of the vectors.
+        void reset();
+
         Coord coord;                            //!< Coordinate of the boundary point.
         Coord normal;                           //!< Inward pointing normal vector.
         double length;                          //!< Integral length of the boundary point.
@@ -50,6 +54,7 @@ namespace slsm
         double positiveLimit;                   //!< Movement limit in positive direction (outwards).
         bool isDomain;                          //!< Whether the point lies close to the domain boundary.
         bool isFixed;                           //!< Whether the point is fixed.
+        bool isGhost;                           //!< Whether the point is owned by another rank (distributed level sets).
         unsigned int nSegments;                 //!< The number of boundary segments that a point belongs to.
         std::vector<unsigned int> segments;     //!< The indices of the two segments to which a point belongs.
         unsigned int nNeighbours;               //!< The number of neighbouring boundary points.
@@ -89,12 +94,33 @@ namespace slsm
         of the zero contour, to evaluate the perimeter of the boundary, to calculate
         the amount of material area in each of the cells of the level set domain,
         and to determine the inward pointing normal vector at each boundary point.
+
+        In incremental mode, successive discretisations of the same level set
+        only rebuild the elements that contain a node whose status (inside,
+        outside, or on the boundary) has changed since the previous call, along
+        with any element cut by four edges (where the boundary depends on the
+        value at the element centre). The remaining points are simply moved to
+        their new positions along the same edges. Points and segments that
+        survive keep their indices, while new ones fill the slots of those that
+        were removed. For this to work, changes to the signed distance function
+        must be made using the LevelSet class, which records nodes that change
+        sign. A full discretisation is performed on the first call, when
+        discretising a target, or after a full reinitialisation.
+
+        A SparseLevelSet can also be discretised, in which case only the
+        elements of its allocated tiles are considered. The mesh isn't used,
+        so the element of each boundary segment is instead identified by the
+        index of its bottom left node in the tile arrays of the level set.
+        Sparse discretisations are never incremental.
      */
     class Boundary
     {
     public:
         //! Constructor.
-        Boundary();
+        /*! \param isIncremental_
+                Whether to update the discretisation incrementally (optional).
+         */
+        Boundary(bool isIncremental_ = false);
 
         //! Use linear interpolation to compute the discretised boundary
         /*! \param levelSet
@@ -105,6 +131,21 @@ namespace slsm
          */
         void discretise(LevelSet&, bool isTarget = false);
 
+        //! Use linear interpolation to compute the discretised boundary of a sparse level set.
+        /*! \param levelSet
+                A reference to the sparse level set object.
+         */
+        void discretise(SparseLevelSet&);
+
+        //! Determine the status of a node from its signed distance.
+        /*! \param signedDistance
+                The signed distance at the node.
+
+            \return
+                Whether the node is inside, outside, or on the boundary.
+         */
+        static NodeStatus::NodeStatus computeNodeStatus(double);
+
         //! Compute the local normal vector at each boundary point.
         /*! \param levelSet
                 A reference to the level set object.
@@ -120,6 +161,22 @@ namespace slsm
          */
         double computePerimeter(const BoundaryPoint&);
 
+        //! Find the boundary points associated with a node.
+        /*! \param mesh
+                A reference to the fixed-grid mesh.
+
+            \param node
+                The index of the node.
+
+            \param nodePoints
+                An array (of length four) for the indices of the boundary
+                points, in ascending order.
+
+            \return
+                The number of boundary points associated with the node.
+         */
+        unsigned int getNodePoints(const Mesh&, unsigned int, unsigned int*) const;
+
         /// Vector of boundary points.
         std::vector<BoundaryPoint> points;
 
@@ -136,6 +193,91 @@ namespace slsm
         double length;
 
     private:
+        /// Whether the discretisation is updated incrementally.
+        bool isIncremental;
+
+        /// The level set that was last discretised (null for a target).
+        const LevelSet* discretisedLevelSet;
+
+        /// The pair of nodes on the edge containing each boundary point
+        /// (both are the same for a point that lies on a node).
+        std::vector<unsigned int> pointNodes;
+
+        /// The boundary point on each edge, indexed by the node to the left
+        /// of (or below) the edge. Each node has three entries: the edge to
+        /// the right, the edge above, and the node itself.
+        std::vector<unsigned int> edgePoints;
+
+        /// Null entry for the edge lookup table.
+        unsigned int none;
+
+        /// Whether each boundary point slot is free (incremental mode).
+        std::vector<char> isPointFree;
+
+        /// Whether each boundary point is used by a segment (scratch).
+        std::vector<char> isPointUsed;
+
+        /// Whether each boundary segment slot is free (incremental mode).
+        std::vector<char> isSegmentFree;
+
+        /// Indices of free boundary point slots.
+        std::vector<unsigned int> freePoints;
+
+        /// Indices of free boundary segment slots.
+        std::vector<unsigned int> freeSegments;
+
+        /// Whether each element needs to be rediscretised (scratch).
+        std::vector<char> isElementChanged;
+
+        /// Indices of elements that need to be rediscretised.
+        std::vector<unsigned int> changedElements;
+
+        /// Map from old to new boundary point indices (scratch).
+        std::vector<unsigned int> indexMap;
+
+        /// Whether the normal vector at each boundary point has been set (scratch).
+        std::vector<char> isNormalSet;
+
+        /// Weighting factor for the normal vector at each boundary point (scratch).
+        std::vector<double> normalWeight;
+
+        //! Update the previous discretisation of the level set.
+        /*! \param levelSet
+                A reference to the level set object.
+         */
+        void updateDiscretisation(LevelSet&);
+
+        //! Compute the boundary points and segments within an element.
+        /*! \param levelSet
+                A reference to the level set object.
+
+            \param signedDistance
+                The signed distance function that is being discretised.
+
+            \param element
+                The index of the element.
+
+            \param isTarget
+                Whether the target signed distance function is being discretised.
+         */
+        void discretiseElement(LevelSet&, const std::vector<Real>&, unsigned int, bool);
+
+        //! Compute the boundary points and segments within an element of a sparse level set.
+        /*! \param levelSet
+                A reference to the sparse level set object.
+
+            \param x
+                The x coordinate of the bottom left node of the element.
+
+            \param y
+                The y coordinate of the bottom left node of the element.
+
+            \param nodes
+                The indices of the element nodes in the tile arrays
+                (anticlockwise from the bottom left).
+         */
+        void discretiseElement(const SparseLevelSet&, unsigned int, unsigned int, const unsigned int*);
+
         //! Determine the status of the elements and nodes of the level set mesh.
         /*! \param mesh
                 A reference to the fixed-grid mesh.
@@ -143,28 +285,51 @@ namespace slsm
             \param signedDistance
                 A pointer to the signed distance function vector.
          */
-        void computeMeshStatus(Mesh&, const std::vector<double>* signedDistance) const;
+        void computeMeshStatus(Mesh&, const std::vector<Real>* signedDistance) const;
 
-        //! Check whether a boundary point has already been added.
+        //! Determine the status of an element from that of its nodes.
         /*! \param mesh
                 A reference to the fixed-grid mesh.
 
-            \param point
-                The coordinates of the boundary point (to be determined).
+            \param element
+                The index of the element.
+         */
+        void computeElementStatus(Mesh&, unsigned int) const;
 
-            \param node
-                The index of the adjacent node.
+        //! Return the key of an edge (or node) in the boundary point lookup table.
+        /*! \param mesh
+                A reference to the fixed-grid mesh.
 
-            \param edge
-                The index of the element edge.
+            \param node1
+                The index of the first node on the edge.
 
-            \param distance
-                The distance from the node.
+            \param node2
+                The index of the second node on the edge (the same as the
+                first for a point that lies on a node).
 
             \return
-                The index of the boundary point if previously added, minus one if not.
+                The index of the edge in the lookup table.
+         */
+        unsigned int edgeKey(const Mesh&, unsigned int, unsigned int) const;
+
+        //! Compute the position of a boundary point by linear interpolation.
+        /*! \param mesh
+                A reference to the fixed-grid mesh.
+
+            \param signedDistance
+                The signed distance function that is being discretised.
+
+            \param node1
+                The index of the first node on the edge.
+
+            \param node2
+                The index of the second node on the edge.
+
+            \param coord
+                The coordinates of the boundary point (to be determined).
          */
-        int isAdded(Mesh&, Coord&, const unsigned int&, const unsigned int&, const double&);
+        void computePointCoord(const Mesh&, const std::vector<Real>&,
+            unsigned int, unsigned int, Coord&) const;
 
         //! Initialise a boundary point.
         /*! \param levelSet
@@ -178,6 +343,76 @@ namespace slsm
          */
         void initialisePoint(LevelSet&, BoundaryPoint&, const Coord&);
 
+        //! Initialise the position and movement limits of a boundary point.
+        /*! \param point
+                A reference to a boundary point.
+
+            \param coord
+                The position vector of the boundary point.
+
+            \param moveLimit
+                The boundary movement limit (CFL condition).
+
+            \param width
+                The width of the domain.
+
+            \param height
+                The height of the domain.
+         */
+        void initialisePoint(BoundaryPoint&, const Coord&, double, unsigned int, unsigned int);
+
+        //! Add a boundary point, reusing a free slot if possible.
+        /*! \param levelSet
+                A reference to the level set object.
+
+            \param coord
+                The position vector of the boundary point.
+
+            \param node1
+                The index of the first node on the edge.
+
+            \param node2
+                The index of the second node on the edge (the same as the
+                first if the point lies on a node).
+
+            \return
+                The index of the boundary point.
+         */
+        unsigned int addPoint(LevelSet&, const Coord&, unsigned int, unsigned int);
+
+        //! Add a boundary point of a sparse level set, unless one already exists.
+        /*! \param levelSet
+                A reference to the sparse level set object.
+
+            \param coord
+                The position vector of the boundary point.
+
+            \param key
+                The key of the edge (or node) in the boundary point lookup table.
+
+            \return
+                The index of the boundary point.
+         */
+        unsigned int addPoint(const SparseLevelSet&, const Coord&, unsigned int);
+
+        //! Add a boundary segment, reusing a free slot if possible.
+        /*! \param mesh
+                A reference to the fixed-grid mesh.
+
+            \param segment
+                A reference to the boundary segment.
+         */
+        void addSegment(Mesh&, BoundarySegment&);
+
+        //! Add a boundary segment, reusing a free slot if possible.
+        /*! \param segment
+                A reference to the boundary segment.
+
+            \return
+                The index of the boundary segment.
+         */
+        unsigned int addSegment(BoundarySegment&);
+
         //! Return the length of a boundary segment.
         /*! \param segment
                 A reference to the boundary segment.
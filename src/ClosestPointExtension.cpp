@@ -0,0 +1,187 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <limits>
+
+#include "Boundary.h"
+#include "ClosestPointExtension.h"
+#include "Mesh.h"
+#include "ThreadPool.h"
+
+/*! \file ClosestPointExtension.cpp
+    \brief Velocity extension by projection onto the closest boundary segment.
+ */
+
+namespace slsm
+{
+    ClosestPointExtension::ClosestPointExtension(const Mesh& mesh_) :
+        mesh(mesh_)
+    {
+        // Cells cover all nodes, including those on the top and right edges.
+        nCellsX = (mesh.width / cellSize) + 1;
+        nCellsY = (mesh.height / cellSize) + 1;
+    }
+
+    void ClosestPointExtension::extend(const Boundary& boundary, const std::vector<unsigned int>& nodes,
+        unsigned int nNodes, std::vector<Real>& velocity, ThreadPool& threadPool)
+    {
+        // There is nothing to extend from.
+        if (boundary.segments.empty())
+        {
+            for (unsigned int i=0;i<nNodes;i++)
+                velocity[nodes[i]] = 0;
+
+            return;
+        }
+
+        initialiseCells(boundary);
+
+        threadPool.run([&](unsigned int thread)
+        {
+            unsigned int start, end;
+            threadPool.range(nNodes, thread, start, end);
+
+            for (unsigned int i=start;i<end;i++)
+            {
+                unsigned int node = nodes[i];
+                velocity[node] = closestVelocity(boundary, mesh.nodes[node].coord.x, mesh.nodes[node].coord.y);
+            }
+        });
+    }
+
+    void ClosestPointExtension::initialiseCells(const Boundary& boundary)
+    {
+        unsigned int nCells = nCellsX*nCellsY;
+
+        // Reset the cell counters (memory is retained between calls).
+        cellStart.assign(nCells + 1, 0);
+
+        // Two passes: count the segments in each cell, then fill the list.
+        for (unsigned int pass=0;pass<2;pass++)
+        {
+            if (pass == 1)
+            {
+                // Convert counts to offsets.
+                for (unsigned int i=0;i<nCells;i++)
+                    cellStart[i+1] += cellStart[i];
+
+                cellSegments.resize(cellStart[nCells]);
+            }
+
+            for (unsigned int i=0;i<boundary.segments.size();i++)
+            {
+                const Coord& p1 = boundary.points[boundary.segments[i].start].coord;
+                const Coord& p2 = boundary.points[boundary.segments[i].end].coord;
+
+                // The range of cells spanned by the segment's bounding box.
+                unsigned int minX = std::min(nCellsX - 1, (unsigned int)(std::min(p1.x, p2.x) / cellSize));
+                unsigned int maxX = std::min(nCellsX - 1, (unsigned int)(std::max(p1.x, p2.x) / cellSize));
+                unsigned int minY = std::min(nCellsY - 1, (unsigned int)(std::min(p1.y, p2.y) / cellSize));
+                unsigned int maxY = std::min(nCellsY - 1, (unsigned int)(std::max(p1.y, p2.y) / cellSize));
+
+                for (unsigned int y=minY;y<=maxY;y++)
+                {
+                    for (unsigned int x=minX;x<=maxX;x++)
+                    {
+                        unsigned int cell = x + y*nCellsX;
+
+                        // Count the segment (shifted by one, so that the prefix sum gives the start).
+                        if (pass == 0) cellStart[cell + 1]++;
+
+                        // Add the segment, using the start offset as a cursor.
+                        else cellSegments[cellStart[cell]++] = i;
+                    }
+                }
+            }
+        }
+
+        // The cursors now point at the end of each cell, i.e. the start of the next.
+        for (unsigned int i=nCells;i>0;i--)
+            cellStart[i] = cellStart[i-1];
+        cellStart[0] = 0;
+    }
+
+    double ClosestPointExtension::closestVelocity(const Boundary& boundary, double x, double y) const
+    {
+        // The cell containing the position.
+        int cellX = std::min(nCellsX - 1, (unsigned int)(x / cellSize));
+        int cellY = std::min(nCellsY - 1, (unsigned int)(y / cellSize));
+
+        // The closest squared distance and the velocity at that point.
+        double minDistSqd = std::numeric_limits<double>::max();
+        double minVelocity = 0;
+
+        // The largest ring needed to cover the whole grid.
+        int maxRing = std::max(std::max(cellX, int(nCellsX) - 1 - cellX), std::max(cellY, int(nCellsY) - 1 - cellY));
+
+        for (int ring=0;ring<=maxRing;ring++)
+        {
+            // Loop over the cells in the square ring (the cell itself for ring zero).
+            for (int j=cellY-ring;j<=cellY+ring;j++)
+            {
+                if ((j < 0) || (j >= int(nCellsY))) continue;
+
+                // Only the first and last rows of the ring are filled.
+                int step = ((j == (cellY - ring)) || (j == (cellY + ring))) ? 1 : std::max(1, 2*ring);
+
+                for (int i=cellX-ring;i<=cellX+ring;i+=step)
+                {
+                    if ((i < 0) || (i >= int(nCellsX))) continue;
+
+                    unsigned int cell = i + j*nCellsX;
+
+                    for (unsigned int k=cellStart[cell];k<cellStart[cell+1];k++)
+                    {
+                        const BoundarySegment& segment = boundary.segments[cellSegments[k]];
+                        const BoundaryPoint& p1 = boundary.points[segment.start];
+                        const BoundaryPoint& p2 = boundary.points[segment.end];
+
+                        // Project the position onto the segment.
+                        double dx = p2.coord.x - p1.coord.x;
+                        double dy = p2.coord.y - p1.coord.y;
+                        double lengthSqd = dx*dx + dy*dy;
+
+                        double t = 0;
+                        if (lengthSqd > 0)
+                        {
+                            t = ((x - p1.coord.x)*dx + (y - p1.coord.y)*dy) / lengthSqd;
+                            t = std::max(0.0, std::min(1.0, t));
+                        }
+
+                        // Squared distance to the closest point.
+                        double px = p1.coord.x + t*dx - x;
+                        double py = p1.coord.y + t*dy - y;
+                        double distSqd = px*px + py*py;
+
+                        if (distSqd < minDistSqd)
+                        {
+                            minDistSqd = distSqd;
+                            minVelocity = p1.velocity + t*(p2.velocity - p1.velocity);
+                        }
+                    }
+                }
+            }
+
+            // Cells beyond this ring are at least ring*cellSize away.
+            double bound = ring*double(cellSize);
+            if (minDistSqd <= bound*bound) break;
+        }
+
+        return minVelocity;
+    }
+}
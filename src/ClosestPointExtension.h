@@ -0,0 +1,125 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CLOSESTPOINTEXTENSION_H
+#define _CLOSESTPOINTEXTENSION_H
+
+#include <vector>
+
+#include "Common.h"
+
+/*! \file ClosestPointExtension.h
+    \brief Velocity extension by projection onto the closest boundary segment.
+ */
+
+namespace slsm
+{
+    // FORWARD DECLARATIONS
+
+    class Boundary;
+    class Mesh;
+    class ThreadPool;
+
+    // MAIN CLASS
+
+    /*! \brief Extends boundary point velocities to the level set nodes by
+        projecting each node onto the closest boundary segment.
+
+        This provides an alternative to velocity extension with the Fast
+        Marching Method. The velocity at a node is interpolated linearly
+        between the two points of the closest segment of the discretised
+        boundary, i.e. the velocity is constant along the normal to the
+        boundary. The signed distance function isn't read or modified.
+
+        Segments are sorted into a uniform grid of square cells. The closest
+        segment to a node is then found by searching rings of cells around
+        the node, stopping once no unsearched cell can hold a closer segment.
+        Each node is computed independently, so the work can be shared between
+        the threads of a thread pool and the result doesn't depend on the
+        number of threads.
+     */
+    class ClosestPointExtension
+    {
+    public:
+        //! Constructor.
+        /*! \param mesh_
+                A reference to the level set mesh.
+         */
+        ClosestPointExtension(const Mesh&);
+
+        //! Extend boundary point velocities to a set of nodes.
+        /*! \param boundary
+                A reference to the discretised boundary.
+
+            \param nodes
+                The indices of the nodes.
+
+            \param nNodes
+                The number of nodes.
+
+            \param velocity
+                The nodal velocities (only the given nodes are modified).
+
+            \param threadPool
+                The threads that share the work.
+         */
+        void extend(const Boundary&, const std::vector<unsigned int>&,
+            unsigned int, std::vector<Real>&, ThreadPool&);
+
+    private:
+        /// A reference to the level set mesh.
+        const Mesh& mesh;
+
+        /// The width of a grid cell (in units of the mesh grid spacing).
+        static const unsigned int cellSize = 4;
+
+        /// The number of cells in the x direction.
+        unsigned int nCellsX;
+
+        /// The number of cells in the y direction.
+        unsigned int nCellsY;
+
+        /// The first entry of each cell in the segment list (plus one past the last).
+        std::vector<unsigned int> cellStart;
+
+        /// The indices of the segments in each cell.
+        std::vector<unsigned int> cellSegments;
+
+        //! Sort the boundary segments into the cell grid.
+        /*! \param boundary
+                A reference to the discretised boundary.
+         */
+        void initialiseCells(const Boundary&);
+
+        //! Find the velocity at the closest point on the boundary.
+        /*! \param boundary
+                A reference to the discretised boundary.
+
+            \param x
+                The x coordinate of the position.
+
+            \param y
+                The y coordinate of the position.
+
+            \return
+                The interpolated velocity.
+         */
+        double closestVelocity(const Boundary&, double, double) const;
+    };
+}
+
+#endif  /* _CLOSESTPOINTEXTENSION_H */
@@ -22,8 +22,22 @@
     \brief Common data types.
  */
 
+// The scalar type of the nodal level set fields (double or float).
+#ifndef SLSM_REAL
+    #define SLSM_REAL double
+#endif
+
 namespace slsm
 {
+    //! The scalar type of the nodal level set fields.
+    /*! This is set at build time by defining SLSM_REAL. Single precision
+        halves the memory footprint (and bandwidth) of the signed distance,
+        velocity, and gradient fields. Arithmetic on these fields is still
+        performed in double precision where accuracy matters, e.g. when
+        solving the Eikonal equation.
+     */
+    typedef SLSM_REAL Real;
+
     //! Two-dimensional coordinate information.
     struct Coord
     {
@@ -0,0 +1,208 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "Communicator.h"
+#include "Debug.h"
+
+/*! \file Communicator.cpp
+    \brief Message passing between the ranks of a distributed level set.
+ */
+
+namespace slsm
+{
+    double Communicator::allReduce(double value, ReduceOp::ReduceOp op)
+    {
+        std::vector<double> values(1, value);
+        allReduce(values, op);
+
+        return values[0];
+    }
+
+    LocalGroup::LocalGroup(unsigned int nRanks_) :
+        nRanks(nRanks_),
+        nWaiting(0),
+        generation(0),
+        reduceBuffers(nRanks_),
+        mailboxes(nRanks_*nRanks_)
+    {
+    }
+
+    void LocalGroup::barrier()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        unsigned long current = generation;
+
+        // The last rank to arrive releases the others.
+        if (++nWaiting == nRanks)
+        {
+            nWaiting = 0;
+            generation++;
+            released.notify_all();
+        }
+        else released.wait(lock, [&]{ return generation != current; });
+    }
+
+    std::vector<LocalCommunicator> LocalCommunicator::create(unsigned int nRanks)
+    {
+        std::vector<LocalCommunicator> comms;
+        std::shared_ptr<LocalGroup> group;
+
+        errno = EINVAL;
+        slsm_check(nRanks > 0, "There must be at least one rank.");
+
+        // All ranks share the same state.
+        group = std::make_shared<LocalGroup>(nRanks);
+
+        for (unsigned int i=0;i<nRanks;i++)
+            comms.push_back(LocalCommunicator(group, i));
+
+        return comms;
+
+    error:
+        exit(EXIT_FAILURE);
+    }
+
+    LocalCommunicator::LocalCommunicator(const std::shared_ptr<LocalGroup>& group_, unsigned int index_) :
+        group(group_),
+        index(index_)
+    {
+    }
+
+    unsigned int LocalCommunicator::rank() const
+    {
+        return index;
+    }
+
+    unsigned int LocalCommunicator::size() const
+    {
+        return group->nRanks;
+    }
+
+    void LocalCommunicator::allReduce(std::vector<double>& values, ReduceOp::ReduceOp op)
+    {
+        // Publish the values from this rank.
+        group->reduceBuffers[index] = values;
+        group->barrier();
+
+        errno = EINVAL;
+
+        // Combine the values in rank order, so that all ranks agree.
+        for (unsigned int i=0;i<group->nRanks;i++)
+        {
+            const std::vector<double>& buffer = group->reduceBuffers[i];
+
+            slsm_check(buffer.size() == values.size(), "Mismatched reduction size.");
+
+            if (i == 0) values = buffer;
+            else
+            {
+                for (unsigned int j=0;j<values.size();j++)
+                {
+                    if      (op == ReduceOp::SUM) values[j] += buffer[j];
+                    else if (op == ReduceOp::MIN) values[j] = std::min(values[j], buffer[j]);
+                    else                          values[j] = std::max(values[j], buffer[j]);
+                }
+            }
+        }
+
+        // Don't let the buffers be overwritten until all ranks are done.
+        group->barrier();
+
+        return;
+
+    error:
+        exit(EXIT_FAILURE);
+    }
+
+    void LocalCommunicator::exchange(const std::vector<unsigned int>& ranks,
+        const std::vector<std::vector<double> >& send, std::vector<std::vector<double> >& receive)
+    {
+        unsigned int nRanks = group->nRanks;
+
+        // Post the outgoing messages.
+        for (unsigned int i=0;i<ranks.size();i++)
+            group->mailboxes[index*nRanks + ranks[i]] = send[i];
+
+        group->barrier();
+
+        errno = EINVAL;
+
+        // Collect the incoming messages.
+        for (unsigned int i=0;i<ranks.size();i++)
+        {
+            const std::vector<double>& message = group->mailboxes[ranks[i]*nRanks + index];
+
+            slsm_check(message.size() == receive[i].size(), "Mismatched message size.");
+            std::copy(message.begin(), message.end(), receive[i].begin());
+        }
+
+        // Don't let the mailboxes be overwritten until all ranks are done.
+        group->barrier();
+
+        return;
+
+    error:
+        exit(EXIT_FAILURE);
+    }
+
+#ifdef SLSM_MPI
+    MPICommunicator::MPICommunicator(MPI_Comm comm_) :
+        comm(comm_)
+    {
+    }
+
+    unsigned int MPICommunicator::rank() const
+    {
+        int rank;
+        MPI_Comm_rank(comm, &rank);
+
+        return rank;
+    }
+
+    unsigned int MPICommunicator::size() const
+    {
+        int size;
+        MPI_Comm_size(comm, &size);
+
+        return size;
+    }
+
+    void MPICommunicator::allReduce(std::vector<double>& values, ReduceOp::ReduceOp op)
+    {
+        MPI_Op mpiOp = (op == ReduceOp::SUM) ? MPI_SUM : ((op == ReduceOp::MIN) ? MPI_MIN : MPI_MAX);
+
+        MPI_Allreduce(MPI_IN_PLACE, values.data(), values.size(), MPI_DOUBLE, mpiOp, comm);
+    }
+
+    void MPICommunicator::exchange(const std::vector<unsigned int>& ranks,
+        const std::vector<std::vector<double> >& send, std::vector<std::vector<double> >& receive)
+    {
+        std::vector<MPI_Request> requests(2*ranks.size());
+
+        for (unsigned int i=0;i<ranks.size();i++)
+        {
+            MPI_Irecv(receive[i].data(), receive[i].size(), MPI_DOUBLE, ranks[i], 0, comm, &requests[2*i]);
+            MPI_Isend(const_cast<double*>(send[i].data()), send[i].size(), MPI_DOUBLE, ranks[i], 0, comm, &requests[2*i+1]);
+        }
+
+        MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+    }
+#endif
+}
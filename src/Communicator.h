@@ -0,0 +1,219 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _COMMUNICATOR_H
+#define _COMMUNICATOR_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef SLSM_MPI
+#include <mpi.h>
+#endif
+
+/*! \file Communicator.h
+    \brief Message passing between the ranks of a distributed level set.
+ */
+
+namespace slsm
+{
+    // ASSOCIATED DATA TYPES
+
+    //! The operation used to combine values across ranks.
+    namespace ReduceOp
+    {
+        enum ReduceOp
+        {
+            SUM = 0,        //!< Sum of the values.
+            MIN,            //!< Minimum value.
+            MAX             //!< Maximum value.
+        };
+    }
+
+    // MAIN CLASS
+
+    /*! \brief An abstract interface for message passing between ranks.
+
+        A distributed computation is split between a number of ranks, each of
+        which owns part of the data. Ranks communicate through collective
+        operations only, i.e. every rank in the group must make the same
+        sequence of calls. The result of a reduction is identical on all ranks.
+
+        Two transports are provided: LocalCommunicator, which runs each rank
+        on a separate thread of the same process (useful for testing), and
+        MPICommunicator, which is available when the library is compiled with
+        SLSM_MPI defined.
+     */
+    class Communicator
+    {
+    public:
+        //! Destructor.
+        virtual ~Communicator() {}
+
+        //! Return the index of this rank.
+        /*! \return
+                The rank.
+         */
+        virtual unsigned int rank() const = 0;
+
+        //! Return the number of ranks.
+        /*! \return
+                The number of ranks.
+         */
+        virtual unsigned int size() const = 0;
+
+        //! Combine values element-wise across all ranks.
+        /*! \param values
+                The values on this rank. On return, the combined values.
+
+            \param op
+                The reduction operation.
+         */
+        virtual void allReduce(std::vector<double>&, ReduceOp::ReduceOp) = 0;
+
+        //! Combine a single value across all ranks.
+        /*! \param value
+                The value on this rank.
+
+            \param op
+                The reduction operation.
+
+            \return
+                The combined value.
+         */
+        double allReduce(double, ReduceOp::ReduceOp);
+
+        //! Exchange buffers with a set of neighbouring ranks.
+        /*! Each rank in the list must also list this rank, with buffers of
+            matching size.
+
+            \param ranks
+                The neighbouring ranks.
+
+            \param send
+                The buffer to send to each neighbour.
+
+            \param receive
+                The buffer to receive from each neighbour. Buffers must be
+                sized before the call.
+         */
+        virtual void exchange(const std::vector<unsigned int>&,
+            const std::vector<std::vector<double> >&, std::vector<std::vector<double> >&) = 0;
+    };
+
+    //! Shared state for a group of LocalCommunicator objects.
+    struct LocalGroup
+    {
+        //! Constructor.
+        /*! \param nRanks
+                The number of ranks.
+         */
+        LocalGroup(unsigned int);
+
+        //! Wait until all ranks have reached the barrier.
+        void barrier();
+
+        unsigned int nRanks;                                //!< The number of ranks.
+        unsigned int nWaiting;                              //!< The number of ranks waiting at the barrier.
+        unsigned long generation;                           //!< The number of completed barriers.
+        std::mutex mutex;                                   //!< Mutex for the barrier.
+        std::condition_variable released;                   //!< Signals that the barrier is complete.
+        std::vector<std::vector<double> > reduceBuffers;    //!< The reduction input of each rank.
+        std::vector<std::vector<double> > mailboxes;        //!< Messages, indexed by sender*nRanks + receiver.
+    };
+
+    /*!\brief An in-process communicator for testing distributed algorithms.
+
+        Each rank must run on its own thread, e.g.
+
+        \code
+        std::vector<slsm::LocalCommunicator> comms = slsm::LocalCommunicator::create(4);
+
+        std::vector<std::thread> threads;
+        for (unsigned int i=0;i<4;i++)
+            threads.push_back(std::thread([&, i]{ run(comms[i]); }));
+        for (unsigned int i=0;i<4;i++) threads[i].join();
+        \endcode
+
+        Reductions combine values in rank order, so results are reproducible.
+     */
+    class LocalCommunicator : public Communicator
+    {
+    public:
+        //! Create a communicator for each rank of a new group.
+        /*! \param nRanks
+                The number of ranks.
+
+            \return
+                The communicators, indexed by rank.
+         */
+        static std::vector<LocalCommunicator> create(unsigned int);
+
+        unsigned int rank() const;
+        unsigned int size() const;
+        void allReduce(std::vector<double>&, ReduceOp::ReduceOp);
+        void exchange(const std::vector<unsigned int>&,
+            const std::vector<std::vector<double> >&, std::vector<std::vector<double> >&);
+
+        using Communicator::allReduce;
+
+    private:
+        //! Constructor.
+        /*! \param group_
+                The shared state of the group.
+
+            \param index_
+                The index of this rank.
+         */
+        LocalCommunicator(const std::shared_ptr<LocalGroup>&, unsigned int);
+
+        /// The shared state of the group.
+        std::shared_ptr<LocalGroup> group;
+
+        /// The index of this rank.
+        unsigned int index;
+    };
+
+#ifdef SLSM_MPI
+    //! \brief A communicator that uses MPI.
+    class MPICommunicator : public Communicator
+    {
+    public:
+        //! Constructor.
+        /*! \param comm_
+                The MPI communicator (MPI must already be initialised).
+         */
+        MPICommunicator(MPI_Comm comm_ = MPI_COMM_WORLD);
+
+        unsigned int rank() const;
+        unsigned int size() const;
+        void allReduce(std::vector<double>&, ReduceOp::ReduceOp);
+        void exchange(const std::vector<unsigned int>&,
+            const std::vector<std::vector<double> >&, std::vector<std::vector<double> >&);
+
+        using Communicator::allReduce;
+
+    private:
+        /// The MPI communicator.
+        MPI_Comm comm;
+    };
+#endif
+}
+
+#endif  /* _COMMUNICATOR_H */
@@ -0,0 +1,312 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "Boundary.h"
+#include "Communicator.h"
+#include "Debug.h"
+#include "DistributedLevelSet.h"
+#include "Hole.h"
+
+/*! \file DistributedLevelSet.cpp
+    \brief A domain-decomposed level set, distributed between ranks.
+ */
+
+namespace slsm
+{
+    DistributedLevelSet::DistributedLevelSet(Communicator& comm_, unsigned int width_, unsigned int height_,
+        const std::vector<Hole>& holes, unsigned int nRanksX_, unsigned int nRanksY_, double moveLimit_,
+        unsigned int bandWidth_, bool isFixedDomain_, unsigned int ghostWidth_) :
+        width(width_),
+        height(height_),
+        nRanksX(std::max(nRanksX_, 1u)),
+        nRanksY(std::max(nRanksY_, 1u)),
+        rankX(comm_.rank() % nRanksX),
+        rankY(comm_.rank() / nRanksX),
+        ghostWidth((ghostWidth_ > 0) ? ghostWidth_ : (bandWidth_ + 1)),
+        originX(localStart(rankX, nRanksX, width, ghostWidth)),
+        originY(localStart(rankY, nRanksY, height, ghostWidth)),
+        levelSet(localLength(rankX, nRanksX, width, ghostWidth), localLength(rankY, nRanksY, height, ghostWidth),
+            std::vector<Hole>(), moveLimit_, bandWidth_, isFixedDomain_),
+        comm(comm_)
+    {
+        errno = EINVAL;
+        slsm_check((nRanksX_*nRanksY_) == comm.size(), "The number of sub-domains must match the number of ranks.");
+        slsm_check(ghostWidth >= 3, "The ghost layer must be at least three nodes wide.");
+        slsm_check(((width/nRanksX) >= ghostWidth) && ((height/nRanksY) >= ghostWidth),
+            "Sub-domains must be at least as wide as the ghost layer.");
+
+        // Initialise the level set function from the hole array.
+        initialise(holes);
+
+        // Initialise the nodes that are exchanged with the neighbouring ranks.
+        initialiseHalos();
+
+        return;
+
+    error:
+        exit(EXIT_FAILURE);
+    }
+
+    bool DistributedLevelSet::update(double timeStep)
+    {
+        // Update the local level set, deferring reinitialisation.
+        levelSet.update(timeStep, false);
+
+        // Ghost nodes near the edge of the local mesh have inaccurate gradients,
+        // so take the updated values from their owners.
+        exchangeSignedDistance();
+
+        // Only check mines at owned nodes, since those in the ghost layer may
+        // have been triggered by inaccurate values.
+        bool isTriggered = false;
+        for (unsigned int i=0;i<levelSet.nMines;i++)
+        {
+            unsigned int node = levelSet.mines[i];
+            Coord coord(levelSet.mesh.nodes[node].coord.x + originX, levelSet.mesh.nodes[node].coord.y + originY);
+
+            if (isOwned(coord) && (std::abs(levelSet.signedDistance[node]) < 1.0))
+            {
+                isTriggered = true;
+                break;
+            }
+        }
+
+        // Reinitialise on all ranks if a mine was triggered on any of them.
+        if (comm.allReduce(isTriggered ? 1.0 : 0.0, ReduceOp::MAX) > 0)
+        {
+            reinitialise();
+            return true;
+        }
+
+        return false;
+    }
+
+    void DistributedLevelSet::reinitialise()
+    {
+        /* Each rank marches outwards from the part of the zero contour that
+           lies on its local mesh, which includes everything within the narrow
+           band of the owned nodes. The owners then overwrite the ghost values.
+         */
+        levelSet.reinitialise(true);
+        exchangeSignedDistance();
+
+        /* The local march can't see parts of the zero contour that lie beyond
+           the edge of the local mesh, so the narrow band is rebuilt from the
+           exchanged values. The boundary can then move into the ghost layer
+           from outside without leaving the band.
+         */
+        levelSet.initialiseNarrowBand();
+    }
+
+    void DistributedLevelSet::computeVelocities(const std::vector<BoundaryPoint>& boundaryPoints)
+    {
+        levelSet.computeVelocities(boundaryPoints);
+        exchangeHalo(levelSet.velocity);
+    }
+
+    void DistributedLevelSet::computeGradients()
+    {
+        levelSet.computeGradients();
+    }
+
+    void DistributedLevelSet::discretise(Boundary& boundary)
+    {
+        boundary.discretise(levelSet);
+
+        // Flag points that are owned by other ranks.
+        for (unsigned int i=0;i<boundary.nPoints;i++)
+        {
+            Coord coord(boundary.points[i].coord.x + originX, boundary.points[i].coord.y + originY);
+            boundary.points[i].isGhost = !isOwned(coord);
+        }
+    }
+
+    void DistributedLevelSet::exchangeHalo(std::vector<Real>& field)
+    {
+        // Pack the values at owned nodes.
+        for (unsigned int i=0;i<halos.size();i++)
+        {
+            for (unsigned int j=0;j<halos[i].sendNodes.size();j++)
+                sendBuffers[i][j] = field[halos[i].sendNodes[j]];
+        }
+
+        comm.exchange(neighbours, sendBuffers, receiveBuffers);
+
+        // Unpack the values at ghost nodes.
+        for (unsigned int i=0;i<halos.size();i++)
+        {
+            for (unsigned int j=0;j<halos[i].receiveNodes.size();j++)
+                field[halos[i].receiveNodes[j]] = receiveBuffers[i][j];
+        }
+    }
+
+    bool DistributedLevelSet::isOwned(const Coord& coord) const
+    {
+        return isOwned(coord, rankX, rankY);
+    }
+
+    bool DistributedLevelSet::isOwned(const Coord& coord, unsigned int x, unsigned int y) const
+    {
+        // Extent of the sub-domain.
+        unsigned int minX = partition(x, nRanksX, width);
+        unsigned int maxX = partition(x + 1, nRanksX, width);
+        unsigned int minY = partition(y, nRanksY, height);
+        unsigned int maxY = partition(y + 1, nRanksY, height);
+
+        // Sub-domains at the top and right also own the domain boundary.
+        bool isOwnedX = (coord.x >= minX) && ((coord.x < maxX) || ((x == (nRanksX - 1)) && (coord.x <= maxX)));
+        bool isOwnedY = (coord.y >= minY) && ((coord.y < maxY) || ((y == (nRanksY - 1)) && (coord.y <= maxY)));
+
+        return (isOwnedX && isOwnedY);
+    }
+
+    unsigned int DistributedLevelSet::partition(unsigned int part, unsigned int nParts, unsigned int length)
+    {
+        return (static_cast<unsigned long long>(part)*length) / nParts;
+    }
+
+    unsigned int DistributedLevelSet::localStart(unsigned int part, unsigned int nParts,
+        unsigned int length, unsigned int ghostWidth)
+    {
+        unsigned int start = partition(part, nParts, length);
+
+        return (start > ghostWidth) ? (start - ghostWidth) : 0;
+    }
+
+    unsigned int DistributedLevelSet::localLength(unsigned int part, unsigned int nParts,
+        unsigned int length, unsigned int ghostWidth)
+    {
+        unsigned int end = std::min(length, partition(part + 1, nParts, length) + ghostWidth);
+
+        return end - localStart(part, nParts, length, ghostWidth);
+    }
+
+    void DistributedLevelSet::initialise(const std::vector<Hole>& holes)
+    {
+        /* This is the same as LevelSet::initialise, except that distances are
+           measured to the edges of the global domain rather than the local mesh.
+         */
+
+        Mesh& mesh = levelSet.mesh;
+
+        for (unsigned int i=0;i<mesh.nNodes;i++)
+        {
+            // Global nodal coordinates.
+            unsigned int x = originX + mesh.nodes[i].coord.x;
+            unsigned int y = originY + mesh.nodes[i].coord.y;
+
+            // Closest edge in x and y.
+            unsigned int minX = std::min(x, width - x);
+            unsigned int minY = std::min(y, height - y);
+
+            // Distance from the closest domain boundary.
+            levelSet.signedDistance[i] = double(std::min(minX, minY));
+
+            // Test the signed distance against the surface of each hole.
+            for (unsigned int j=0;j<holes.size();j++)
+            {
+                double dx = holes[j].coord.x - x;
+                double dy = holes[j].coord.y - y;
+
+                // Signed distance from the hole surface.
+                double dist = sqrt(dx*dx + dy*dy) - holes[j].r;
+
+                if (dist < levelSet.signedDistance[i])
+                    levelSet.signedDistance[i] = dist;
+            }
+        }
+
+        levelSet.initialiseNarrowBand();
+    }
+
+    void DistributedLevelSet::initialiseHalos()
+    {
+        halos.clear();
+        neighbours.clear();
+
+        // Global extent of the local mesh (inclusive).
+        unsigned int localMaxX = originX + levelSet.mesh.width;
+        unsigned int localMaxY = originY + levelSet.mesh.height;
+
+        for (int j=-1;j<=1;j++)
+        {
+            for (int i=-1;i<=1;i++)
+            {
+                if ((i == 0) && (j == 0)) continue;
+
+                int x = rankX + i;
+                int y = rankY + j;
+
+                // Neighbour lies outside of the domain.
+                if ((x < 0) || (y < 0) || (x >= int(nRanksX)) || (y >= int(nRanksY))) continue;
+
+                HaloRegion halo;
+                halo.rank = x + y*nRanksX;
+
+                // Global extent of the neighbour's local mesh (inclusive).
+                unsigned int neighbourMinX = localStart(x, nRanksX, width, ghostWidth);
+                unsigned int neighbourMinY = localStart(y, nRanksY, height, ghostWidth);
+                unsigned int neighbourMaxX = neighbourMinX + localLength(x, nRanksX, width, ghostWidth);
+                unsigned int neighbourMaxY = neighbourMinY + localLength(y, nRanksY, height, ghostWidth);
+
+                // Nodes are enumerated in global row-major order on both
+                // sides, so the buffers need no further indexing.
+                for (unsigned int yy=originY;yy<=localMaxY;yy++)
+                {
+                    for (unsigned int xx=originX;xx<=localMaxX;xx++)
+                    {
+                        unsigned int node = levelSet.mesh.xyToIndex(xx - originX, yy - originY);
+                        Coord coord(xx, yy);
+
+                        // An owned node that lies on the neighbour's local mesh.
+                        if (isOwned(coord) && (xx >= neighbourMinX) && (xx <= neighbourMaxX)
+                            && (yy >= neighbourMinY) && (yy <= neighbourMaxY))
+                            halo.sendNodes.push_back(node);
+
+                        // A ghost node that is owned by the neighbour.
+                        else if (isOwned(coord, x, y))
+                            halo.receiveNodes.push_back(node);
+                    }
+                }
+
+                halos.push_back(halo);
+                neighbours.push_back(halo.rank);
+                sendBuffers.push_back(std::vector<double>(halo.sendNodes.size()));
+                receiveBuffers.push_back(std::vector<double>(halo.receiveNodes.size()));
+            }
+        }
+    }
+
+    void DistributedLevelSet::exchangeSignedDistance()
+    {
+        exchangeHalo(levelSet.signedDistance);
+
+        // Flag ghost nodes whose status differs from the discretised boundary.
+        for (unsigned int i=0;i<halos.size();i++)
+        {
+            for (unsigned int j=0;j<halos[i].receiveNodes.size();j++)
+            {
+                unsigned int node = halos[i].receiveNodes[j];
+                levelSet.isSignChanged[node] = (Boundary::computeNodeStatus(levelSet.signedDistance[node])
+                    != levelSet.mesh.nodes[node].status);
+            }
+        }
+    }
+}
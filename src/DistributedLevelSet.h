@@ -0,0 +1,271 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _DISTRIBUTEDLEVELSET_H
+#define _DISTRIBUTEDLEVELSET_H
+
+#include <vector>
+
+#include "Common.h"
+#include "LevelSet.h"
+
+/*! \file DistributedLevelSet.h
+    \brief A domain-decomposed level set, distributed between ranks.
+ */
+
+namespace slsm
+{
+    // FORWARD DECLARATIONS
+
+    class Boundary;
+    class BoundaryPoint;
+    class Communicator;
+    class Hole;
+
+    // ASSOCIATED DATA TYPES
+
+    //! The nodes exchanged with a neighbouring rank.
+    struct HaloRegion
+    {
+        unsigned int rank;                          //!< The neighbouring rank.
+        std::vector<unsigned int> sendNodes;        //!< Owned nodes needed by the neighbour (local indices).
+        std::vector<unsigned int> receiveNodes;     //!< Ghost nodes owned by the neighbour (local indices).
+    };
+
+    // MAIN CLASS
+
+    /*!\brief A level set domain that is decomposed between ranks.
+
+        The global domain is split into a regular grid of nRanksX by nRanksY
+        rectangular sub-domains. Rank r owns sub-domain (r % nRanksX, r / nRanksX),
+        i.e. the elements in that block, along with the nodes at their bottom
+        left corners (ranks at the top and right of the domain also own the
+        nodes on the domain boundary). Each rank stores its sub-domain, plus
+        a layer of ghost nodes owned by its neighbours, as an ordinary LevelSet
+        that uses local coordinates, i.e. local node (0, 0) lies at global
+        position (originX, originY).
+
+        Ghost nodes are refreshed by halo exchange after each operation that
+        modifies them. The ghost layer must be at least three nodes wide for
+        the WENO gradient stencil. Reinitialisation and velocity extension are
+        performed independently on each rank, so the ghost layer should also
+        contain the part of the boundary that lies within the narrow band of
+        the owned nodes, i.e. be at least bandWidth + 1 nodes wide (the
+        default). Results then closely match those of a single LevelSet. Small
+        differences remain near the edges of each sub-domain, where the fast
+        marching front sees a truncated zero contour. Reinitialisation is only
+        triggered by mines at owned nodes, and happens on all ranks at once.
+
+        Boundary points that lie in the ghost layer are flagged with isGhost,
+        so that boundary integrals only count each point once. Pass the
+        communicator to the Optimise constructor so that its boundary integrals
+        are summed over all ranks. Velocities are then computed for ghost points
+        too, which keeps velocity extension consistent between ranks, provided
+        that each rank computes the same sensitivities for the same point.
+
+        Boundary objects used with a distributed level set should discretise
+        from scratch every iteration, i.e. not be incremental.
+     */
+    class DistributedLevelSet
+    {
+    public:
+        //! Constructor.
+        /*! \param comm_
+                The communicator (one rank per sub-domain).
+
+            \param width_
+                The width of the global domain.
+
+            \param height_
+                The height of the global domain.
+
+            \param holes
+                A vector of holes (in global coordinates).
+
+            \param nRanksX_
+                The number of sub-domains in the x direction.
+
+            \param nRanksY_
+                The number of sub-domains in the y direction.
+
+            \param moveLimit_
+                The CFL limit (in units of the mesh grid spacing).
+
+            \param bandWidth_
+                The width of the narrow band region.
+
+            \param isFixedDomain_
+                Whether the domain boundary is fixed.
+
+            \param ghostWidth_
+                The width of the ghost layer (zero for bandWidth + 1).
+         */
+        DistributedLevelSet(Communicator&, unsigned int, unsigned int, const std::vector<Hole>&,
+            unsigned int, unsigned int, double moveLimit_ = 0.5, unsigned int bandWidth_ = 6,
+            bool isFixedDomain_ = false, unsigned int ghostWidth_ = 0);
+
+        //! Update the level set function.
+        /*! \param timeStep
+                The time step.
+
+            \return
+                Whether the signed distance was reinitialised (on all ranks).
+         */
+        bool update(double);
+
+        //! Reinitialise the level set to a signed distance function. The zero
+        //! contour must lie inside the current narrow band.
+        void reinitialise();
+
+        //! Extend boundary point velocities to the level set nodes.
+        /*! \param boundaryPoints
+                A reference to the local vector of boundary points.
+         */
+        void computeVelocities(const std::vector<BoundaryPoint>&);
+
+        //! Compute the modulus of the gradient of the signed distance function.
+        //! (Gradients are only valid at owned nodes.)
+        void computeGradients();
+
+        //! Discretise the local part of the boundary, and flag ghost points.
+        /*! \param boundary
+                A reference to the boundary.
+         */
+        void discretise(Boundary&);
+
+        //! Copy the values at owned nodes to the ghost nodes of the neighbouring ranks.
+        /*! \param field
+                The nodal field (indexed by local node).
+         */
+        void exchangeHalo(std::vector<Real>&);
+
+        //! Whether a position in the global domain is owned by this rank.
+        /*! \param coord
+                The position (in global coordinates).
+
+            \return
+                Whether the position is owned.
+         */
+        bool isOwned(const Coord&) const;
+
+        const unsigned int width;               //!< The width of the global domain.
+        const unsigned int height;              //!< The height of the global domain.
+        const unsigned int nRanksX;             //!< The number of sub-domains in the x direction.
+        const unsigned int nRanksY;             //!< The number of sub-domains in the y direction.
+        const unsigned int rankX;               //!< The x position of this rank's sub-domain.
+        const unsigned int rankY;               //!< The y position of this rank's sub-domain.
+        const unsigned int ghostWidth;          //!< The width of the ghost layer.
+        const unsigned int originX;             //!< The global x coordinate of local node (0, 0).
+        const unsigned int originY;             //!< The global y coordinate of local node (0, 0).
+
+        LevelSet levelSet;                      //!< The local level set (owned and ghost nodes).
+
+    private:
+        /// The communicator.
+        Communicator& comm;
+
+        /// The nodes exchanged with each neighbouring rank.
+        std::vector<HaloRegion> halos;
+
+        /// The neighbouring ranks.
+        std::vector<unsigned int> neighbours;
+
+        /// Halo exchange buffers.
+        std::vector<std::vector<double> > sendBuffers;
+        std::vector<std::vector<double> > receiveBuffers;
+
+        //! Whether a position in the global domain is owned by a given sub-domain.
+        /*! \param coord
+                The position (in global coordinates).
+
+            \param x
+                The x position of the sub-domain.
+
+            \param y
+                The y position of the sub-domain.
+
+            \return
+                Whether the position is owned.
+         */
+        bool isOwned(const Coord&, unsigned int, unsigned int) const;
+
+        //! Compute the first element of a sub-domain along one axis.
+        /*! \param part
+                The index of the sub-domain.
+
+            \param nParts
+                The number of sub-domains.
+
+            \param length
+                The length of the domain.
+
+            \return
+                The first element (length if part == nParts).
+         */
+        static unsigned int partition(unsigned int, unsigned int, unsigned int);
+
+        //! Compute the first local node along one axis.
+        /*! \param part
+                The index of the sub-domain.
+
+            \param nParts
+                The number of sub-domains.
+
+            \param length
+                The length of the domain.
+
+            \param ghostWidth
+                The width of the ghost layer.
+
+            \return
+                The global position of the first local node.
+         */
+        static unsigned int localStart(unsigned int, unsigned int, unsigned int, unsigned int);
+
+        //! Compute the number of local elements along one axis.
+        /*! \param part
+                The index of the sub-domain.
+
+            \param nParts
+                The number of sub-domains.
+
+            \param length
+                The length of the domain.
+
+            \param ghostWidth
+                The width of the ghost layer.
+
+            \return
+                The number of elements in the local mesh.
+         */
+        static unsigned int localLength(unsigned int, unsigned int, unsigned int, unsigned int);
+
+        //! Initialise the signed distance function from a set of holes.
+        /*! \param holes
+                A vector of holes (in global coordinates).
+         */
+        void initialise(const std::vector<Hole>&);
+
+        //! Initialise the halo regions.
+        void initialiseHalos();
+
+        //! Exchange the signed distance function, flagging ghost nodes whose sign changes.
+        void exchangeSignedDistance();
+    };
+}
+
+#endif  /* _DISTRIBUTEDLEVELSET_H */
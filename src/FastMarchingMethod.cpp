@@ -31,35 +31,82 @@
 
 namespace slsm
 {
-    FastMarchingMethod::FastMarchingMethod(const Mesh& mesh_, bool isTest_) :
+    FastMarchingMethod::FastMarchingMethod(const Mesh& mesh_, bool isTest_, FMM_Queue::FMM_Queue queueType_) :
         mesh(mesh_),
+        queueType(queueType_),
+        heap((queueType_ == FMM_Queue::BINARY_HEAP) ? mesh_.nNodes : 0, isTest_),
+        untidyQueue((queueType_ == FMM_Queue::UNTIDY) ? mesh_.nNodes : 0),
         isTest(isTest_),
-        outOfBounds(mesh.nNodes)
+        nx(mesh_.width + 1),
+        stride(mesh_.width + 3),
+        nVisited(0),
+        isBanded(false),
+        nCandidates(0),
+        nInner(0)
     {
-        heap = nullptr;
+        // Neighbours are ordered: left, right, down, up.
+        nodeOffset[0] = -1;
+        nodeOffset[1] = 1;
+        nodeOffset[2] = -int(nx);
+        nodeOffset[3] = nx;
+
+        paddedOffset[0] = -1;
+        paddedOffset[1] = 1;
+        paddedOffset[2] = -int(stride);
+        paddedOffset[3] = stride;
 
         // Resize data structures.
         heapPtr.resize(mesh.nNodes);
-        nodeStatus.resize(mesh.nNodes);
         signedDistanceCopy.resize(mesh.nNodes);
-    }
+        visited.resize(mesh.nNodes);
+        toFreeze.resize(mesh.nNodes);
+        candidates.resize(mesh.nNodes);
 
-    FastMarchingMethod::~FastMarchingMethod()
-    {
-        delete heap;
+        // Status arrays are padded with a layer of ghost nodes on each side.
+        nodeStatus.resize(stride * (mesh.height + 3), FMM_NodeStatus::GHOST);
+        isCandidate.resize(stride * (mesh.height + 3), true);
+
+        // For block node orderings, store the mapping between node indices and
+        // padded indices, since it can't be computed cheaply.
+        if (mesh.ordering != NodeOrdering::ROW_MAJOR)
+        {
+            paddedIndex.resize(mesh.nNodes);
+            meshIndex.resize(stride * (mesh.height + 3), mesh.nNodes);
+
+            for (unsigned int y=0;y<=mesh.height;y++)
+            {
+                for (unsigned int x=0;x<=mesh.width;x++)
+                {
+                    unsigned int node = mesh.xyToIndex(x, y);
+                    unsigned int pnode = (x + 1) + (y + 1)*stride;
+
+                    paddedIndex[node] = pnode;
+                    meshIndex[pnode] = node;
+                }
+            }
+        }
+
+        // Clear the status of all nodes within the mesh.
+        for (unsigned int i=0;i<mesh.nNodes;i++)
+        {
+            nodeStatus[padded(i)] = FMM_NodeStatus::NONE;
+            isCandidate[padded(i)] = false;
+        }
     }
 
-    void FastMarchingMethod::march(std::vector<double>& signedDistance_)
+    void FastMarchingMethod::march(std::vector<Real>& signedDistance_)
     {
         signedDistance = &signedDistance_;
+        initialSignedDistance = &signedDistanceCopy;
         isVelocity = false;
+        isBanded = false;
+
+        // Clear node status and heap data from the previous march.
+        reset();
 
         // Initialise the set of frozen boundary nodes.
         initialiseFrozen();
 
-        // Initialise the heap data structure.
-        initialiseHeap();
-
         // Initialise the set of trial nodes adjacent to the boundary.
         initialiseTrial();
 
@@ -67,24 +114,62 @@ namespace slsm
         solve();
     }
 
-    void FastMarchingMethod::march(std::vector<double>& signedDistance_, std::vector<double>& velocity_)
+    void FastMarchingMethod::march(const std::vector<Real>& signedDistance_, std::vector<Real>& velocity_)
     {
         /* Extend boundary velocities to all nodes within the narrow band region.
 
            Note that this method assumes that boundary point velocities have
            already been mapped to the level set nodes using inverse squared
            distance interpolation, or similar.
+
+           The signed distance function is only read. Tentative distances are
+           written to the private copy buffer, and only at nodes that are
+           reached by the march, so no full-grid copy is needed.
          */
 
-        signedDistance = &signedDistance_;
+        signedDistance = &signedDistanceCopy;
+        initialSignedDistance = &signedDistance_;
         velocity = &velocity_;
         isVelocity = true;
+        isBanded = false;
+
+        // Clear node status and heap data from the previous march.
+        reset();
 
         // Initialise the set of frozen boundary nodes.
         initialiseFrozen();
 
-        // Initialise the heap data structure.
-        initialiseHeap();
+        // Initialise the set of trial nodes adjacent to the boundary.
+        initialiseTrial();
+
+        // Find the fast marching solution.
+        solve();
+    }
+
+    void FastMarchingMethod::march(std::vector<Real>& signedDistance_,
+        const std::vector<unsigned int>& narrowBand, unsigned int nNarrowBand, double maxDistance_)
+    {
+        /* Reinitialise the signed distance function in the vicinity of the
+           zero contour only.
+
+           Note that this method assumes that the zero contour lies inside the
+           narrow band, i.e. the boundary hasn't moved beyond the mine nodes.
+         */
+
+        signedDistance = &signedDistance_;
+        initialSignedDistance = &signedDistanceCopy;
+        isVelocity = false;
+        isBanded = true;
+        maxDistance = maxDistance_;
+
+        // Clear node status and heap data from the previous march.
+        reset();
+
+        // Collect the nodes from which to initialise the march.
+        initialiseCandidates(narrowBand, nNarrowBand);
+
+        // Initialise the set of frozen boundary nodes.
+        initialiseFrozen();
 
         // Initialise the set of trial nodes adjacent to the boundary.
         initialiseTrial();
@@ -92,8 +177,144 @@ namespace slsm
         // Find the fast marching solution.
         solve();
 
-        // Restore the original signed distance function. Only update velocities.
-        (*signedDistance) = signedDistanceCopy;
+        // Clamp nodes that lie beyond the cutoff.
+        clampFarField();
+    }
+
+    unsigned int FastMarchingMethod::numVisited() const
+    {
+        return nVisited;
+    }
+
+    const std::vector<unsigned int>& FastMarchingMethod::visitedNodes() const
+    {
+        return visited;
+    }
+
+    void FastMarchingMethod::reset()
+    {
+        // Only nodes that were given a status during the last march need to
+        // be cleared, which avoids a sweep over the entire mesh.
+        for (unsigned int i=0;i<nVisited;i++)
+            nodeStatus[padded(visited[i])] = FMM_NodeStatus::NONE;
+
+        // Zero the number of visited nodes.
+        nVisited = 0;
+
+        // Clear candidate flags.
+        for (unsigned int i=0;i<nCandidates;i++)
+            isCandidate[padded(candidates[i])] = false;
+
+        // Zero the number of candidate nodes.
+        nCandidates = 0;
+        nInner = 0;
+
+        // Empty the priority queue.
+        if (queueType == FMM_Queue::UNTIDY) untidyQueue.clear();
+        else heap.clear();
+    }
+
+    unsigned int FastMarchingMethod::padded(unsigned int node) const
+    {
+        // Shift by one ghost node in each direction, plus two per row below.
+        if (mesh.ordering == NodeOrdering::ROW_MAJOR)
+            return node + 2*(node / nx) + stride + 1;
+
+        return paddedIndex[node];
+    }
+
+    inline unsigned int FastMarchingMethod::neighbourIndex(unsigned int node,
+        unsigned int pneighbour, unsigned int direction) const
+    {
+        if (mesh.ordering == NodeOrdering::ROW_MAJOR)
+            return node + nodeOffset[direction];
+
+        return meshIndex[pneighbour];
+    }
+
+    unsigned int FastMarchingMethod::queuePush(unsigned int node, double value)
+    {
+        if (queueType == FMM_Queue::UNTIDY) return untidyQueue.push(node, value);
+        else return heap.push(node, value);
+    }
+
+    void FastMarchingMethod::queuePop(unsigned int& node, double& value)
+    {
+        if (queueType == FMM_Queue::UNTIDY) untidyQueue.pop(node, value);
+        else heap.pop(node, value);
+    }
+
+    void FastMarchingMethod::queueSet(unsigned int index, double value)
+    {
+        if (queueType == FMM_Queue::UNTIDY) untidyQueue.set(index, value);
+        else heap.set(index, value);
+    }
+
+    bool FastMarchingMethod::queueEmpty() const
+    {
+        if (queueType == FMM_Queue::UNTIDY) return untidyQueue.empty();
+        else return heap.empty();
+    }
+
+    double FastMarchingMethod::queuePeek() const
+    {
+        if (queueType == FMM_Queue::UNTIDY) return untidyQueue.peek();
+        else return heap.peek();
+    }
+
+    void FastMarchingMethod::setStatus(unsigned int node, unsigned int pnode, FMM_NodeStatus::FMM_NodeStatus status)
+    {
+        // Store the node so that its status can be reset before the next march.
+        visited[nVisited] = node;
+        nVisited++;
+
+        nodeStatus[pnode] = status;
+    }
+
+    void FastMarchingMethod::initialiseCandidates(const std::vector<unsigned int>& narrowBand, unsigned int nNarrowBand)
+    {
+        // Add all nodes in the narrow band.
+        for (unsigned int i=0;i<nNarrowBand;i++)
+        {
+            candidates[nCandidates] = narrowBand[i];
+            isCandidate[padded(narrowBand[i])] = true;
+            nCandidates++;
+        }
+
+        // Index of the first node in the current layer.
+        unsigned int start = 0;
+
+        // Add two layers of neighbouring nodes. The first layer catches nodes that
+        // span the zero contour with a node at the edge of the band (e.g. fixed
+        // nodes on the domain boundary), the second their potential trial neighbours.
+        for (unsigned int i=0;i<2;i++)
+        {
+            // Index of the last node in the current layer.
+            unsigned int end = nCandidates;
+
+            for (unsigned int j=start;j<end;j++)
+            {
+                unsigned int node = candidates[j];
+                unsigned int pnode = padded(node);
+
+                // Loop over all neighbours.
+                for (unsigned int k=0;k<4;k++)
+                {
+                    // Neighbour hasn't already been added (ghost nodes are always flagged).
+                    if (!isCandidate[pnode + paddedOffset[k]])
+                    {
+                        candidates[nCandidates] = neighbourIndex(node, pnode + paddedOffset[k], k);
+                        isCandidate[pnode + paddedOffset[k]] = true;
+                        nCandidates++;
+                    }
+                }
+            }
+
+            // Store the number of nodes in the band and first layer.
+            if (i == 0) nInner = nCandidates;
+
+            start = end;
+        }
     }
 
     void FastMarchingMethod::initialiseFrozen()
@@ -101,20 +322,29 @@ namespace slsm
         // The number of frozen nodes.
         unsigned int nFrozen = 0;
 
+        // The number of nodes to check (only candidates for a banded march).
+        unsigned int nNodes = isBanded ? nCandidates : mesh.nNodes;
+
         // First find all zero values of the level set.
-        for (unsigned int i=0;i<mesh.nNodes;i++)
+        for (unsigned int n=0;n<nNodes;n++)
         {
-            // Store a copy of the level set.
-            signedDistanceCopy[i] = (*signedDistance)[i];
+            unsigned int i = isBanded ? candidates[n] : n;
+            unsigned int pi = padded(i);
+
+            // Store a copy of the level set (velocity extension only reads it).
+            if (!isVelocity) signedDistanceCopy[i] = (*signedDistance)[i];
 
-            // Make sure node isn't masked.
-            if (nodeStatus[i] != FMM_NodeStatus::MASKED)
+            // Make sure node isn't masked, or in the outer candidate layer.
+            if ((nodeStatus[pi] != FMM_NodeStatus::MASKED) && (!isBanded || n < nInner))
             {
                 // Zero contour passes through node.
-                if (signedDistanceCopy[i] == 0)
+                if ((*initialSignedDistance)[i] == 0)
                 {
+                    // Initialise the working distance.
+                    if (isVelocity) (*signedDistance)[i] = 0;
+
                     // Mark node as frozen.
-                    nodeStatus[i] = FMM_NodeStatus::FROZEN;
+                    setStatus(i, pi, FMM_NodeStatus::FROZEN);
 
                     // Increment number of frozen nodes.
                     nFrozen++;
@@ -122,15 +352,21 @@ namespace slsm
             }
         }
 
+        // Only check the band and first layer of neighbours for a banded march.
+        if (isBanded) nNodes = nInner;
+
         // Now check whether the neighbours of each node (in any direction)
         // are on opposite sides of the zero contour.
-        for (unsigned int i=0;i<mesh.nNodes;i++)
+        for (unsigned int n=0;n<nNodes;n++)
         {
+            unsigned int i = isBanded ? candidates[n] : n;
+            unsigned int pi = padded(i);
+
             // Whether level set changes sign between a node and its neighbour.
             bool isBorder = false;
 
             // Only consider nodes that haven't yet been frozen.
-            if (nodeStatus[i] == FMM_NodeStatus::NONE)
+            if (nodeStatus[pi] == FMM_NodeStatus::NONE)
             {
                 // Initialise distance array.
                 double dist[2] = {0, 0};
@@ -141,18 +377,19 @@ namespace slsm
                     // Neighbours are ordered: left, right, down, up.
 
                     // Get index of neighbour.
-                    unsigned int neighbour = mesh.nodes[i].neighbours[j];
+                    unsigned int neighbour = neighbourIndex(i, pi + paddedOffset[j], j);
 
                     // Make sure neighbour lies inside domain boundary.
-                    if (neighbour != outOfBounds)
+                    if (!(nodeStatus[pi + paddedOffset[j]] & FMM_NodeStatus::GHOST))
                     {
                         // Level set changes sign along direction.
-                        if ((signedDistanceCopy[i] * signedDistanceCopy[neighbour]) < 0)
+                        if (((*initialSignedDistance)[i] * (*initialSignedDistance)[neighbour]) < 0)
                         {
                             isBorder = true;
 
                             // Calculate the distance to the zero contour (linear interpolation).
-                            double d = signedDistanceCopy[i] / (signedDistanceCopy[i] - signedDistanceCopy[neighbour]);
+                            double d = (*initialSignedDistance)[i]
+                                / ((*initialSignedDistance)[i] - (*initialSignedDistance)[neighbour]);
 
                             // Set dimension (neighbours 0 and 1 are x dimension, 2 and 3 are y).
                             unsigned int dim = (j < 2) ? 0 : 1;
@@ -178,11 +415,11 @@ namespace slsm
                     }
 
                     // Update signed distance.
-                    if (signedDistanceCopy[i] < 0) (*signedDistance)[i] = -sqrt(1.0 / distSum);
+                    if ((*initialSignedDistance)[i] < 0) (*signedDistance)[i] = -sqrt(1.0 / distSum);
                     else (*signedDistance)[i] = sqrt(1.0 / distSum);
 
                     // Flag node as frozen.
-                    nodeStatus[i] = FMM_NodeStatus::FROZEN;
+                    setStatus(i, pi, FMM_NodeStatus::FROZEN);
 
                     // Increment number of frozen nodes.
                     nFrozen++;
@@ -199,73 +436,60 @@ namespace slsm
         exit(EXIT_FAILURE);
     }
 
-    void FastMarchingMethod::initialiseHeap()
-    {
-        // Initialise the maximum heap size.
-        unsigned int maxHeapSize = 0;
-
-        // Loop over all nodes.
-        for (unsigned int i=0;i<mesh.nNodes;i++)
-        {
-            // Find nodes without a status (far field).
-            if (nodeStatus[i] == FMM_NodeStatus::NONE)
-                maxHeapSize++;
-        }
-
-        heap = new Heap(maxHeapSize, isTest);
-    }
-
     void FastMarchingMethod::initialiseTrial()
     {
         // For each node, check whether it has a frozen neighbour.
         // If so, calculate the distance from the zero contour and insert into heap.
 
-        for (unsigned int i=0;i<mesh.nNodes;i++)
+        // The number of nodes to check (only candidates for a banded march).
+        unsigned int nNodes = isBanded ? nCandidates : mesh.nNodes;
+
+        for (unsigned int n=0;n<nNodes;n++)
         {
+            unsigned int i = isBanded ? candidates[n] : n;
+            unsigned int pi = padded(i);
+
             // Node hasn't yet been given a status.
-            if (nodeStatus[i] == FMM_NodeStatus::NONE)
+            if (nodeStatus[pi] == FMM_NodeStatus::NONE)
             {
                 // Loop over all nearest neighbour nodes.
                 for (unsigned int j=0;j<4;j++)
                 {
-                    unsigned int neighbour = mesh.nodes[i].neighbours[j];
-
-                    // Neighbour lies within the domain boundary.
-                    if (neighbour != outOfBounds)
+                    // Neighbour is frozen (ghost nodes never are).
+                    if (nodeStatus[pi + paddedOffset[j]] & FMM_NodeStatus::FROZEN)
                     {
-                        // Neighbour is frozen.
-                        if (nodeStatus[neighbour] & FMM_NodeStatus::FROZEN)
+                        // Check that node status hasn't been updated.
+                        if (nodeStatus[pi] == FMM_NodeStatus::NONE)
                         {
-                            // Check that node status hasn't been updated.
-                            if (nodeStatus[i] == FMM_NodeStatus::NONE)
+                            if (isVelocity)
                             {
-                                if (isVelocity)
-                                {
-                                    // Node lies inside the narrow band region.
-                                    if (mesh.nodes[i].isActive)
-                                    {
-                                        // Flag node as in trial band.
-                                        nodeStatus[i] = FMM_NodeStatus::TRIAL;
-
-                                        // Get distance from zero contour.
-                                        (*signedDistance)[i] = updateNode(i);
-
-                                        // Add to heap.
-                                        heapPtr[i] = heap->push(i, std::abs((*signedDistance)[i]));
-                                    }
-                                }
-                                else
+                                // Node lies inside the narrow band region.
+                                if (mesh.nodes[i].isActive)
                                 {
                                     // Flag node as in trial band.
-                                    nodeStatus[i] = FMM_NodeStatus::TRIAL;
+                                    setStatus(i, pi, FMM_NodeStatus::TRIAL);
+
+                                    // Initialise the working distance.
+                                    (*signedDistance)[i] = (*initialSignedDistance)[i];
 
                                     // Get distance from zero contour.
-                                    (*signedDistance)[i] = updateNode(i);
+                                    (*signedDistance)[i] = updateNode(i, pi);
 
                                     // Add to heap.
-                                    heapPtr[i] = heap->push(i, std::abs((*signedDistance)[i]));
+                                    heapPtr[i] = queuePush(i, std::abs((*signedDistance)[i]));
                                 }
                             }
+                            else
+                            {
+                                // Flag node as in trial band.
+                                setStatus(i, pi, FMM_NodeStatus::TRIAL);
+
+                                // Get distance from zero contour.
+                                (*signedDistance)[i] = updateNode(i, pi);
+
+                                // Add to heap.
+                                heapPtr[i] = queuePush(i, std::abs((*signedDistance)[i]));
+                            }
                         }
                     }
                 }
@@ -273,6 +497,29 @@ namespace slsm
         }
     }
 
+    void FastMarchingMethod::clampFarField()
+    {
+        /* Candidate nodes that weren't frozen lie further than the cutoff from
+           the zero contour, but may still hold stale values from before the
+           boundary moved. Any other nodes either weren't touched, or are trial
+           nodes whose distance estimate already exceeds the cutoff.
+         */
+
+        for (unsigned int n=0;n<nCandidates;n++)
+        {
+            unsigned int i = candidates[n];
+
+            if (nodeStatus[padded(i)] != FMM_NodeStatus::FROZEN)
+            {
+                if (std::abs((*signedDistance)[i]) < maxDistance)
+                {
+                    if ((*initialSignedDistance)[i] < 0) (*signedDistance)[i] = -maxDistance;
+                    else (*signedDistance)[i] = maxDistance;
+                }
+            }
+        }
+    }
+
     void FastMarchingMethod::solve()
     {
         /* This is the fast marching method main loop. The order
@@ -294,11 +541,11 @@ namespace slsm
         // Number of nodes to freeze.
         unsigned int nFrozen;
 
-        // Indices of nodes that are to be frozen.
-        std::vector<unsigned int> toFreeze(mesh.nNodes);
-
-        while (!heap->empty())
+        while (!queueEmpty())
         {
+            // The front has passed the cutoff distance.
+            if (isBanded && (queuePeek() > maxDistance)) break;
+
             unsigned int addr;
             double value;
 
@@ -306,13 +553,16 @@ namespace slsm
             nFrozen = 0;
 
             // Pop top entry off heap.
-            heap->pop(addr, value);
+            queuePop(addr, value);
+
+            // Padded index of the node.
+            unsigned int paddr = padded(addr);
 
             // Mark node as frozen.
-            nodeStatus[addr] = FMM_NodeStatus::FROZEN;
+            nodeStatus[paddr] = FMM_NodeStatus::FROZEN;
 
             // Set final velocity.
-            if (isVelocity) finaliseVelocity(addr);
+            if (isVelocity) finaliseVelocity(addr, paddr);
 
             // Increment number of frozen nodes.
             toFreeze[nFrozen] = addr;
@@ -323,19 +573,22 @@ namespace slsm
 
             while (!isDone)
             {
-                if (!heap->empty() && (value == heap->peek()))
+                if (!queueEmpty() && (value == queuePeek()))
                 {
                     unsigned int l_addr;
                     double l_value;
 
                     // Pop top entry off heap.
-                    heap->pop(l_addr, l_value);
+                    queuePop(l_addr, l_value);
+
+                    // Padded index of the node.
+                    unsigned int l_paddr = padded(l_addr);
 
                     // Mark node as frozen.
-                    nodeStatus[l_addr] = FMM_NodeStatus::FROZEN;
+                    nodeStatus[l_paddr] = FMM_NodeStatus::FROZEN;
 
                     // Set final velocity.
-                    if (isVelocity) finaliseVelocity(l_addr);
+                    if (isVelocity) finaliseVelocity(l_addr, l_paddr);
 
                     // Increment number of frozen nodes.
                     toFreeze[nFrozen] = l_addr;
@@ -349,74 +602,83 @@ namespace slsm
             {
                 // Get node address.
                 unsigned int addr = toFreeze[i];
+                unsigned int paddr = padded(addr);
 
                 // Loop over all neighbours of frozen node.
                 for (unsigned int j=0;j<4;j++)
                 {
-                    // Get address of neighbour.
-                    unsigned int naddr = mesh.nodes[addr].neighbours[j];
+                    // Get padded address of neighbour.
+                    unsigned int pnaddr = paddr + paddedOffset[j];
 
-                    // Neighbour lies within domain boundary.
-                    if (naddr != outOfBounds)
+                    // Neighbour lies within domain boundary and hasn't been frozen.
+                    if (!(nodeStatus[pnaddr] & (FMM_NodeStatus::FROZEN | FMM_NodeStatus::GHOST)))
                     {
-                        // Neighbour hasn't been frozen.
-                        if (nodeStatus[naddr] != FMM_NodeStatus::FROZEN)
+                        // Get address of neighbour.
+                        unsigned int naddr = neighbourIndex(addr, pnaddr, j);
+
+                        // For a banded march, the level set has only been copied
+                        // for candidate nodes. Far field nodes retain their
+                        // original value until given a status. For velocity
+                        // extension, the working distance of a far field node
+                        // is initialised when it is first reached.
+                        if (nodeStatus[pnaddr] == FMM_NodeStatus::NONE)
                         {
-                            // Calculate and store udpdated distance estimate.
-                            double d = updateNode(naddr);
-                            (*signedDistance)[naddr] = d;
+                            if (isBanded) signedDistanceCopy[naddr] = (*signedDistance)[naddr];
+                            else if (isVelocity) (*signedDistance)[naddr] = (*initialSignedDistance)[naddr];
+                        }
 
-                            // Neighbour is in trial band.
-                            if (nodeStatus[naddr] & FMM_NodeStatus::TRIAL)
-                            {
-                                // Update value in heap.
-                                heap->set(heapPtr[naddr], std::abs(d));
-                            }
-                            // Neighbour has no status (far field).
-                            else if (nodeStatus[naddr] == FMM_NodeStatus::NONE)
+                        // Calculate and store udpdated distance estimate.
+                        double d = updateNode(naddr, pnaddr);
+                        (*signedDistance)[naddr] = d;
+
+                        // Neighbour is in trial band.
+                        if (nodeStatus[pnaddr] & FMM_NodeStatus::TRIAL)
+                        {
+                            // Update value in heap.
+                            queueSet(heapPtr[naddr], std::abs(d));
+                        }
+                        // Neighbour has no status (far field).
+                        else if (nodeStatus[pnaddr] == FMM_NodeStatus::NONE)
+                        {
+                            if (isVelocity)
                             {
-                                if (isVelocity)
-                                {
-                                    // Node lies inside the narrow band region.
-                                    if (mesh.nodes[naddr].isActive)
-                                    {
-                                        // Mark node as in trial band.
-                                        nodeStatus[naddr] = FMM_NodeStatus::TRIAL;
-
-                                        // Push onto heap.
-                                        heapPtr[naddr] = heap->push(naddr, std::abs(d));
-                                    }
-                                }
-                                else
+                                // Node lies inside the narrow band region.
+                                if (mesh.nodes[naddr].isActive)
                                 {
                                     // Mark node as in trial band.
-                                    nodeStatus[naddr] = FMM_NodeStatus::TRIAL;
+                                    setStatus(naddr, pnaddr, FMM_NodeStatus::TRIAL);
 
                                     // Push onto heap.
-                                    heapPtr[naddr] = heap->push(naddr, std::abs(d));
+                                    heapPtr[naddr] = queuePush(naddr, std::abs(d));
                                 }
                             }
+                            else
+                            {
+                                // Mark node as in trial band.
+                                setStatus(naddr, pnaddr, FMM_NodeStatus::TRIAL);
 
-                            // Now update the far field point in the second order stencil.
-                            // "jump" over a frozen node if needed.
+                                // Push onto heap.
+                                heapPtr[naddr] = queuePush(naddr, std::abs(d));
+                            }
+                        }
 
-                            // Address of second nearest neighbour in the same direction.
-                            naddr = mesh.nodes[naddr].neighbours[j];
+                        // Now update the far field point in the second order stencil.
+                        // "jump" over a frozen node if needed.
 
-                            // Next nearest neighbour lies within domain boundary.
-                            if (naddr != outOfBounds)
-                            {
-                                // Neighbour is in the trial band.
-                                if (nodeStatus[naddr] & FMM_NodeStatus::TRIAL)
-                                {
-                                    // Calculate and store udpdated distance estimate.
-                                    double d = updateNode(naddr);
-                                    (*signedDistance)[naddr] = d;
+                        // Padded address of second nearest neighbour in the same direction.
+                        pnaddr += paddedOffset[j];
 
-                                    // Update value in heap.
-                                    heap->set(heapPtr[naddr], std::abs(d));
-                                }
-                            }
+                        // Neighbour is in the trial band (ghost nodes never are).
+                        if (nodeStatus[pnaddr] & FMM_NodeStatus::TRIAL)
+                        {
+                            naddr = neighbourIndex(naddr, pnaddr, j);
+
+                            // Calculate and store udpdated distance estimate.
+                            double d = updateNode(naddr, pnaddr);
+                            (*signedDistance)[naddr] = d;
+
+                            // Update value in heap.
+                            queueSet(heapPtr[naddr], std::abs(d));
                         }
                     }
                 }
@@ -424,7 +686,7 @@ namespace slsm
         }
     }
 
-    double FastMarchingMethod::updateNode(unsigned int node)
+    double FastMarchingMethod::updateNode(unsigned int node, unsigned int pnode)
     {
         // Reused constants.
         const double aa = 9.0/4.0;
@@ -452,36 +714,32 @@ namespace slsm
                 unsigned int index = 2*i + j;
 
                 // First neighbour.
-                unsigned int n1 = mesh.nodes[node].neighbours[index];
+                unsigned int pn1 = pnode + paddedOffset[index];
 
-                // Neighbour is within the domain boundary.
-                if (n1 != outOfBounds)
+                // Neighbour is frozen (ghost nodes outside the domain never are).
+                if (nodeStatus[pn1] & FMM_NodeStatus::FROZEN)
                 {
-                    // Neighbour is frozen.
-                    if (nodeStatus[n1] & FMM_NodeStatus::FROZEN)
+                    unsigned int n1 = neighbourIndex(node, pn1, index);
+
+                    // Make sure neighbour is closer to the zero contour (upwind).
+                    if (std::abs((*signedDistance)[n1]) < std::abs(dist1))
                     {
-                        // Make sure neighbour is closer to the zero contour (upwind).
-                        if (std::abs((*signedDistance)[n1]) < std::abs(dist1))
-                        {
-                            // Store distance.
-                            dist1 = (*signedDistance)[n1];
+                        // Store distance.
+                        dist1 = (*signedDistance)[n1];
+
+                        // Second neighbour in same direction.
+                        unsigned int pn2 = pn1 + paddedOffset[index];
 
-                            // Second neighbour in same direction.
-                            unsigned int n2 = mesh.nodes[n1].neighbours[index];
+                        // Neighbour is frozen.
+                        if (nodeStatus[pn2] & FMM_NodeStatus::FROZEN)
+                        {
+                            unsigned int n2 = neighbourIndex(n1, pn2, index);
 
-                            // Neighbour is within the domain boundary.
-                            if (n2 != outOfBounds)
+                            // Make sure neighbour is closer to the zero contour (upwind).
+                            if (std::abs((*signedDistance)[n2]) <= std::abs(dist1))
                             {
-                                // Neighbour is frozen.
-                                if (nodeStatus[n2] & FMM_NodeStatus::FROZEN)
-                                {
-                                    // Make sure neighbour is closer to the zero contour (upwind).
-                                    if (std::abs((*signedDistance)[n2]) <= std::abs(dist1))
-                                    {
-                                        // Store distance.
-                                        dist2 = (*signedDistance)[n2];
-                                    }
-                                }
+                                // Store distance.
+                                dist2 = (*signedDistance)[n2];
                             }
                         }
                     }
@@ -512,7 +770,7 @@ namespace slsm
         return solveQuadratic(node, a, b, c);
     }
 
-    void FastMarchingMethod::finaliseVelocity(unsigned int node)
+    void FastMarchingMethod::finaliseVelocity(unsigned int node, unsigned int pnode)
     {
         // Set the velocity of this node, i.e.
         // find v_ext, where grad v_ext . grad phi = 0
@@ -538,34 +796,30 @@ namespace slsm
             // Set dimension (neighbours 0 and 1 are x dimension, 2 and 3 are y).
             unsigned int dim = (i < 2) ? 0 : 1;
 
-            // Get index of neighbour.
-            unsigned int neighbour = mesh.nodes[node].neighbours[i];
-
-            // Neighbour is within domain boundary.
-            if (neighbour != outOfBounds)
+            // Neighbour is frozen (ghost nodes outside the domain never are).
+            if (nodeStatus[pnode + paddedOffset[i]] & FMM_NodeStatus::FROZEN)
             {
-                // Neighbour is frozen.
-                if (nodeStatus[neighbour] & FMM_NodeStatus::FROZEN)
-                {
-                    // Absolute signed distance of the neighbouring node.
-                    double d = std::abs((*signedDistance)[neighbour]);
+                // Get index of neighbour.
+                unsigned int neighbour = neighbourIndex(node, pnode + paddedOffset[i], i);
 
-                    // Check whether the neighbour is closer to the zero contour.
-                    if (!isSet[dim] || (frontDist[dim] > d))
-                    {
-                        // Store updated distance to the front.
-                        frontDist[dim] = d;
+                // Absolute signed distance of the neighbouring node.
+                double d = std::abs((*signedDistance)[neighbour]);
 
-                        // Flag that the front distance has been set.
-                        isSet[dim] = true;
+                // Check whether the neighbour is closer to the zero contour.
+                if (!isSet[dim] || (frontDist[dim] > d))
+                {
+                    // Store updated distance to the front.
+                    frontDist[dim] = d;
 
-                        // Calculate the distance to the front in this direction.
-                        d = (*signedDistance)[node] - (*signedDistance)[neighbour];
+                    // Flag that the front distance has been set.
+                    isSet[dim] = true;
 
-                        // Store absolute distance and velocity.
-                        dist[dim] = std::abs(d);
-                        vel[dim] = (*velocity)[neighbour];
-                    }
+                    // Calculate the distance to the front in this direction.
+                    d = (*signedDistance)[node] - (*signedDistance)[neighbour];
+
+                    // Store absolute distance and velocity.
+                    dist[dim] = std::abs(d);
+                    vel[dim] = (*velocity)[neighbour];
                 }
             }
         }
@@ -591,6 +845,11 @@ namespace slsm
     }
 
     double FastMarchingMethod::solveQuadratic(unsigned int node, const double& a, const double& b, const double& c) const
+    {
+        return solveQuadratic(a, b, c, (*signedDistance)[node], (*initialSignedDistance)[node] > doubleEpsilon);
+    }
+
+    double FastMarchingMethod::solveQuadratic(double a, double b, double c, double previous, bool isPositive)
     {
         // Initialise roots.
         double r0, r1;
@@ -605,9 +864,9 @@ namespace slsm
             r1 = (-b - sqrt(discrim)) / (2.0 * a);
         }
         // Use previous estimate.
-        else return (*signedDistance)[node];
+        else return previous;
 
-        if (signedDistanceCopy[node] > doubleEpsilon) return r0;
+        if (isPositive) return r0;
         else return r1;
     }
 }
@@ -24,6 +24,10 @@
 #include <limits>
 #include <vector>
 
+#include "Common.h"
+#include "Heap.h"
+#include "UntidyQueue.h"
+
 /*! \file FastMarchingMethod.h
     \brief An implementation of the Fast Marching Method.
  */
@@ -32,7 +36,6 @@ namespace slsm
 {
     // FORWARD DECLARATIONS
 
-    class Heap;
     class Mesh;
 
     // ASSOCIATED DATA TYPES
@@ -48,6 +51,17 @@ namespace slsm
             FROZEN = (1 << 0),  //!< Node lies on boundary or has been frozen.
             TRIAL  = (1 << 1),  //!< Node is adjacent to a frozen node.
             MASKED = (1 << 2),  //!< Node has been masked.
+            GHOST  = (1 << 3),  //!< Node lies in the ghost border outside the mesh.
+        };
+    }
+
+    //! The priority queue used to order trial nodes.
+    namespace FMM_Queue
+    {
+        enum FMM_Queue
+        {
+            BINARY_HEAP = 0,    //!< Exact ordering using a binary heap, O(log N) per node.
+            UNTIDY      = 1,    //!< Approximate ordering using a bucketed queue, O(1) per node.
         };
     }
 
@@ -62,6 +76,33 @@ namespace slsm
         This object can be used to reinitialise the level set to a signed
         distance function, or to compute extension velocities using known
         values at the boundary.
+
+        All workspace (node status, heap, back pointers, etc.) is allocated
+        once on construction and recycled between calls to march. At the start
+        of each march only the nodes that were given a status during the
+        previous march are reset, so a long-lived object performs no memory
+        allocation in the hot loop.
+
+        Reinitialisation can also be restricted to the region around an existing
+        narrow band. In this case the frozen and trial sets are only initialised
+        from nodes in, or adjacent to, the band and marching stops once the front
+        passes a cutoff distance. Nodes that aren't reached have their signed
+        distance clamped to the cutoff, so the cost scales with the length of
+        the boundary rather than the area of the domain.
+
+        Node status flags are packed into a byte array that is padded with a
+        single layer of ghost nodes around the mesh. Neighbours are found by
+        adding fixed offsets to the node index, rather than by looking up the
+        neighbour vector of each mesh node, and ghost nodes are never frozen or
+        added to the trial set, so no bounds checks are needed in the main loop.
+
+        Trial nodes are ordered using a binary heap by default. Alternatively,
+        an untidy priority queue can be used, where nodes are placed in buckets
+        with a width of a fraction of the grid spacing. This makes the march
+        linear in the number of nodes, at the cost of a small error from the
+        approximate ordering. For the default bucket width of 0.05 grid spacings,
+        the signed distance differs from the binary heap solution by less than
+        0.05 grid spacings at any node, and by around 1e-4 on average.
      */
     class FastMarchingMethod
     {
@@ -72,33 +113,90 @@ namespace slsm
 
             \param isTest_
                 Whether to test the heap following each update.
-         */
-        FastMarchingMethod(const Mesh&, bool isTest_=false);
 
-        //! Destructor.
-        ~FastMarchingMethod();
+            \param queueType_
+                The type of priority queue (default = binary heap).
+         */
+        FastMarchingMethod(const Mesh&, bool isTest_=false,
+            FMM_Queue::FMM_Queue queueType_=FMM_Queue::BINARY_HEAP);
 
         //! Excecute Fast Marching for reinitialisation of the signed distance function.
         /*! \param signedDistance_
                 The nodal signed distance function (level set).
          */
-        void march(std::vector<double>&);
+        void march(std::vector<Real>&);
 
         //! Excecute Fast Marching for velocity extension.
         /*! \param signedDistance_
-                The nodal signed distance function (level set).
+                The nodal signed distance function (level set). This is
+                never modified.
 
             \param velocity_
                 The nodal velocities.
          */
-        void march(std::vector<double>&, std::vector<double>&);
+        void march(const std::vector<Real>&, std::vector<Real>&);
+
+        //! Excecute Fast Marching for reinitialisation within a narrow band.
+        /*! \param signedDistance_
+                The nodal signed distance function (level set).
+
+            \param narrowBand
+                The indices of nodes in the current narrow band.
+
+            \param nNarrowBand
+                The number of nodes in the narrow band.
+
+            \param maxDistance_
+                The cutoff distance at which to stop marching.
+         */
+        void march(std::vector<Real>&, const std::vector<unsigned int>&, unsigned int, double);
+
+        //! Get the number of nodes that were visited during the last march.
+        /*! \return
+                The number of visited nodes.
+         */
+        unsigned int numVisited() const;
+
+        //! Get the indices of nodes that were visited during the last march.
+        /*! \return
+                A reference to the vector of visited nodes. Only the first
+                numVisited() entries are valid.
+         */
+        const std::vector<unsigned int>& visitedNodes() const;
+
+        //! Solve the quadratic equation for the updated distance at a node.
+        /*! \param a
+                The first quadratic coefficient.
+
+            \param b
+                The second quadratic coefficient.
+
+            \param c
+                The third quadratic coefficient.
+
+            \param previous
+                The value to return if there are no real roots.
+
+            \param isPositive
+                Whether the node lies inside the structure (positive signed distance).
+
+            \return
+                The correct root of the equation.
+         */
+        static double solveQuadratic(double, double, double, double, bool);
 
     private:
         /// A const reference to the level set mesh.
         const Mesh& mesh;
 
+        /// The type of priority queue.
+        FMM_Queue::FMM_Queue queueType;
+
         /// The ascending unsigned distance priority queue.
-        Heap *heap;
+        Heap heap;
+
+        /// The untidy priority queue.
+        UntidyQueue untidyQueue;
 
         /// Back pointers to the heap.
         std::vector<unsigned int> heapPtr;
@@ -109,31 +207,170 @@ namespace slsm
         /// Whether velocity extension is active (distance extension if not).
         bool isVelocity;
 
-        /// Out of bounds neighbour flag.
-        unsigned int outOfBounds;
+        /// The number of nodes in each row of the mesh.
+        unsigned int nx;
+
+        /// The row stride of the padded status arrays.
+        unsigned int stride;
 
-        /// The status of each node.
-        std::vector<FMM_NodeStatus::FMM_NodeStatus> nodeStatus;
+        /// Index offsets to the neighbours of a mesh node (left, right, down, up),
+        /// for row-major node numbering.
+        int nodeOffset[4];
 
-        /// A copy of the initial signed distance function.
-        std::vector<double> signedDistanceCopy;
+        /// Index offsets to the neighbours of a node in the padded status arrays.
+        int paddedOffset[4];
+
+        /// The status of each node (padded with a layer of ghost nodes).
+        std::vector<unsigned char> nodeStatus;
+
+        /// A copy of the initial signed distance function. During velocity
+        /// extension this holds the working distances of visited nodes instead.
+        std::vector<Real> signedDistanceCopy;
 
         /// A pointer to the signed distance vector.
-        std::vector<double>* signedDistance;
+        std::vector<Real>* signedDistance;
+
+        /// A pointer to the initial signed distance function (read only).
+        const std::vector<Real>* initialSignedDistance;
 
         /// A pointer to the velocity vector.
-        std::vector<double>* velocity;
+        std::vector<Real>* velocity;
+
+        /// Indices of nodes that were given a status during the current march.
+        std::vector<unsigned int> visited;
+
+        /// The number of visited nodes.
+        unsigned int nVisited;
+
+        /// Indices of nodes that are to be frozen (scratch space for solve).
+        std::vector<unsigned int> toFreeze;
+
+        /// Whether marching is restricted to the narrow band.
+        bool isBanded;
+
+        /// The cutoff distance for a banded march.
+        double maxDistance;
+
+        /// Indices of the nodes used to initialise a banded march.
+        std::vector<unsigned int> candidates;
+
+        /// The number of candidate nodes.
+        unsigned int nCandidates;
+
+        /// The number of candidate nodes in the band and its first halo layer.
+        unsigned int nInner;
+
+        /// Whether each node is a candidate (padded, ghost nodes are flagged).
+        std::vector<unsigned char> isCandidate;
+
+        /// The padded index of each node (block node orderings only).
+        std::vector<unsigned int> paddedIndex;
+
+        /// The node index of each padded node (block node orderings only).
+        std::vector<unsigned int> meshIndex;
+
+        //! Reset the workspace following a previous march.
+        void reset();
+
+        //! Convert a node index to its index in the padded status arrays.
+        /*! \param node
+                The index of the node.
+
+            \return
+                The padded index.
+         */
+        unsigned int padded(unsigned int) const;
+
+        //! Return the index of a neighbouring node.
+        /*! \param node
+                The index of the node.
+
+            \param pneighbour
+                The padded index of the neighbour.
+
+            \param direction
+                The direction of the neighbour (left, right, down, up).
+
+            \return
+                The index of the neighbour (undefined if it lies outside
+                the mesh, so check the padded status first).
+         */
+        unsigned int neighbourIndex(unsigned int, unsigned int, unsigned int) const;
+
+        //! Push a node onto the priority queue.
+        /*! \param node
+                The index of the node.
+
+            \param value
+                The unsigned distance of the node.
+
+            \return
+                The index of the node in the queue.
+         */
+        unsigned int queuePush(unsigned int, double);
+
+        //! Pop the next node from the priority queue.
+        /*! \param node
+                The index of the node.
+
+            \param value
+                The unsigned distance of the node.
+         */
+        void queuePop(unsigned int&, double&);
+
+        //! Update the value of a node in the priority queue.
+        /*! \param index
+                The index of the node in the queue.
+
+            \param value
+                The new unsigned distance of the node.
+         */
+        void queueSet(unsigned int, double);
+
+        //! Test whether the priority queue is empty.
+        /*! \return
+                Whether the queue is empty.
+         */
+        bool queueEmpty() const;
+
+        //! Return the value of the next node in the priority queue.
+        /*! \return
+                The unsigned distance of the next node.
+         */
+        double queuePeek() const;
+
+        //! Set the status of a node that doesn't yet have one.
+        /*! \param node
+                The index of the node.
+
+            \param pnode
+                The padded index of the node.
+
+            \param status
+                The new status of the node.
+         */
+        void setStatus(unsigned int, unsigned int, FMM_NodeStatus::FMM_NodeStatus);
+
+        //! Collect the narrow band nodes, along with two layers of neighbours.
+        /*! \param narrowBand
+                The indices of nodes in the current narrow band.
+
+            \param nNarrowBand
+                The number of nodes in the narrow band.
+         */
+        void initialiseCandidates(const std::vector<unsigned int>&, unsigned int);
 
         //! Find boundary nodes and flag them as frozen.
         void initialiseFrozen();
 
-        //! Initialise the heap data structure.
-        void initialiseHeap();
-
         //! Initialise the trial set. Find nodes adjacent to the boundary
         //! and mark them as trial nodes.
         void initialiseTrial();
 
+        //! Clamp the signed distance of candidate nodes that weren't frozen
+        //! during a banded march to the cutoff distance.
+        void clampFarField();
+
         //! Obtain the fast marching solution.
         void solve();
 
@@ -141,16 +378,22 @@ namespace slsm
         /*! \param node
                 The index of the node.
 
+            \param pnode
+                The padded index of the node.
+
             \return
                 The new value (distance or velocity) at the node.
          */
-        double updateNode(unsigned int);
+        double updateNode(unsigned int, unsigned int);
 
         //! Finalise the velocity at a node.
         /*! \param node
                 The index of the node.
+
+            \param pnode
+                The padded index of the node.
          */
-        void finaliseVelocity(unsigned int node);
+        void finaliseVelocity(unsigned int, unsigned int);
 
         //! Solve the quadratic equation.
         /*! \param node
@@ -0,0 +1,507 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "Debug.h"
+#include "FastMarchingMethod.h"
+#include "FastSweepingMethod.h"
+#include "Mesh.h"
+
+/*! \file FastSweepingMethod.cpp
+    \brief A parallel implementation of the Fast Sweeping Method.
+ */
+
+namespace slsm
+{
+    FastSweepingMethod::FastSweepingMethod(const Mesh& mesh_, unsigned int nThreads_) :
+        mesh(mesh_),
+        nThreads(nThreads_)
+    {
+        // Use all available hardware threads.
+        if (nThreads == 0) nThreads = std::thread::hardware_concurrency();
+        if (nThreads == 0) nThreads = 1;
+
+        // Start the worker threads.
+        threadPool.resize(nThreads);
+
+        // The number of rows of nodes.
+        unsigned int nRows = mesh.height + 1;
+
+        /* Use two blocks per thread, so that all threads are busy while sweeping
+           blocks of either colour. Blocks must be at least two rows high, since
+           the second order stencil reaches two nodes in each direction.
+         */
+        if (nThreads == 1) nBlocks = 1;
+        else nBlocks = std::max(1u, std::min(2*nThreads, nRows / 2));
+
+        // Work out the row decomposition.
+        blockRows.resize(nBlocks + 1);
+        for (unsigned int i=0;i<=nBlocks;i++)
+            blockRows[i] = (i * nRows) / nBlocks;
+
+        // Resize data structures.
+        isUpdated.resize(nBlocks);
+        isFrozen.resize(mesh.nNodes);
+        distance.resize(mesh.nNodes);
+        firstOrder.resize(mesh.nNodes);
+        signedDistanceCopy.resize(mesh.nNodes);
+    }
+
+    void FastSweepingMethod::march(std::vector<Real>& signedDistance_)
+    {
+        signedDistance = &signedDistance_;
+        isVelocity = false;
+
+        // Initialise the distance at boundary nodes.
+        initialiseFrozen();
+
+        // Sweep until the first order distance converges.
+        solve(SweepType::FIRST_ORDER);
+        firstOrder = distance;
+
+        // Apply second order corrections.
+        solve(SweepType::SECOND_ORDER);
+
+        // Update the signed distance function.
+        for (unsigned int i=0;i<mesh.nNodes;i++)
+        {
+            if (signedDistanceCopy[i] < 0) (*signedDistance)[i] = -distance[i];
+            else (*signedDistance)[i] = distance[i];
+        }
+    }
+
+    void FastSweepingMethod::march(std::vector<Real>& signedDistance_, std::vector<Real>& velocity_)
+    {
+        /* Extend boundary velocities to all nodes within the narrow band region.
+
+           Note that this method assumes that boundary point velocities have
+           already been mapped to the level set nodes using inverse squared
+           distance interpolation, or similar.
+
+           The distance from the zero contour is only used to determine the
+           upwind direction and the signed distance function is left unchanged.
+         */
+
+        signedDistance = &signedDistance_;
+        velocity = &velocity_;
+        isVelocity = true;
+
+        // Initialise the distance at boundary nodes.
+        initialiseFrozen();
+
+        // Sweep until the first order distance converges.
+        solve(SweepType::FIRST_ORDER);
+        firstOrder = distance;
+
+        // Apply second order corrections.
+        solve(SweepType::SECOND_ORDER);
+
+        // Sweep until the velocity converges.
+        solve(SweepType::VELOCITY);
+    }
+
+    void FastSweepingMethod::initialiseFrozen()
+    {
+        // The number of frozen nodes.
+        unsigned int nFrozen = 0;
+
+        // First find all zero values of the level set.
+        for (unsigned int i=0;i<mesh.nNodes;i++)
+        {
+            // Store a copy of the level set.
+            signedDistanceCopy[i] = (*signedDistance)[i];
+
+            // Zero contour passes through node.
+            if (signedDistanceCopy[i] == 0)
+            {
+                isFrozen[i] = true;
+                distance[i] = 0;
+
+                // Increment number of frozen nodes.
+                nFrozen++;
+            }
+            else
+            {
+                isFrozen[i] = false;
+                distance[i] = maxDouble;
+            }
+        }
+
+        // Now check whether the neighbours of each node (in any direction)
+        // are on opposite sides of the zero contour.
+        for (unsigned int i=0;i<mesh.nNodes;i++)
+        {
+            // Whether level set changes sign between a node and its neighbour.
+            bool isBorder = false;
+
+            // Only consider nodes that haven't yet been frozen.
+            if (!isFrozen[i])
+            {
+                // Initialise distance array.
+                double dist[2] = {0, 0};
+
+                // Loop over all neighbours.
+                for (unsigned int j=0;j<4;j++)
+                {
+                    // Get index of neighbour.
+                    unsigned int neighbour = mesh.nodes[i].neighbours[j];
+
+                    // Make sure neighbour lies inside domain boundary.
+                    if (neighbour != mesh.nNodes)
+                    {
+                        // Level set changes sign along direction.
+                        if ((signedDistanceCopy[i] * signedDistanceCopy[neighbour]) < 0)
+                        {
+                            isBorder = true;
+
+                            // Calculate the distance to the zero contour (linear interpolation).
+                            double d = signedDistanceCopy[i] / (signedDistanceCopy[i] - signedDistanceCopy[neighbour]);
+
+                            // Set dimension (neighbours 0 and 1 are x dimension, 2 and 3 are y).
+                            unsigned int dim = (j < 2) ? 0 : 1;
+
+                            // Check if distance is less than current value.
+                            if (dist[dim] == 0 || dist[dim] > d)
+                                dist[dim] = d;
+                        }
+                    }
+                }
+
+                // Node and neighbour span the zero contour.
+                if (isBorder)
+                {
+                    double distSum = 0;
+
+                    // Calculate perpendicular distance to boundary (Pythag.)
+                    for (unsigned int j=0;j<2;j++)
+                    {
+                        if (dist[j] > 0)
+                            distSum += 1.0 / (dist[j] * dist[j]);
+                    }
+
+                    isFrozen[i] = true;
+                    distance[i] = sqrt(1.0 / distSum);
+
+                    // Increment number of frozen nodes.
+                    nFrozen++;
+                }
+            }
+        }
+
+        errno = 0;
+        slsm_check(nFrozen > 0, "There are no frozen nodes!");
+
+        return;
+
+    error:
+        exit(EXIT_FAILURE);
+    }
+
+    void FastSweepingMethod::solve(SweepType::SweepType sweepType)
+    {
+        for (unsigned int n=0;n<maxIterations;n++)
+        {
+            // Sweep blocks of each colour in turn.
+            for (unsigned int colour=0;colour<2;colour++)
+            {
+                threadPool.run([&](unsigned int thread)
+                {
+                    sweepBlocks(colour, thread, sweepType);
+                });
+            }
+
+            // Check whether any block was updated.
+            bool isConverged = true;
+            for (unsigned int i=0;i<nBlocks;i++)
+            {
+                if (isUpdated[i])
+                {
+                    isConverged = false;
+                    break;
+                }
+            }
+
+            if (isConverged) return;
+        }
+
+        errno = 0;
+        slsm_log_warn("Fast Sweeping failed to converge after %u iterations!", maxIterations);
+    }
+
+    void FastSweepingMethod::sweepBlocks(unsigned int colour, unsigned int thread, SweepType::SweepType sweepType)
+    {
+        for (unsigned int i=colour+2*thread;i<nBlocks;i+=2*nThreads)
+            isUpdated[i] = sweepBlock(i, sweepType);
+    }
+
+    bool FastSweepingMethod::sweepBlock(unsigned int block, SweepType::SweepType sweepType)
+    {
+        // Whether any node was updated.
+        bool isChanged = false;
+
+        // The number of rows and columns in the block.
+        unsigned int nRows = blockRows[block+1] - blockRows[block];
+        unsigned int nColumns = mesh.width + 1;
+
+        // Sweep in each of the four grid orderings.
+        for (unsigned int i=0;i<4;i++)
+        {
+            bool isReverseX = (i == 1) || (i == 2);
+            bool isReverseY = (i > 1);
+
+            for (unsigned int j=0;j<nRows;j++)
+            {
+                unsigned int y = isReverseY ? (blockRows[block+1] - 1 - j) : (blockRows[block] + j);
+
+                for (unsigned int k=0;k<nColumns;k++)
+                {
+                    unsigned int x = isReverseX ? (nColumns - 1 - k) : k;
+                    unsigned int node = mesh.xyToIndex(x, y);
+
+                    if (isFree(node))
+                    {
+                        if (sweepType == SweepType::VELOCITY)
+                        {
+                            if (updateVelocity(node)) isChanged = true;
+                        }
+                        else if (sweepType == SweepType::FIRST_ORDER)
+                        {
+                            double d = updateNode(node, false);
+
+                            // Distances can only decrease.
+                            if (d < distance[node])
+                            {
+                                if ((distance[node] - d) > tolerance) isChanged = true;
+                                distance[node] = d;
+                            }
+                        }
+                        else
+                        {
+                            double d = updateNode(node, true);
+
+                            // Second order corrections can move the distance either way.
+                            if (std::abs(distance[node] - d) > tolerance) isChanged = true;
+                            distance[node] = d;
+                        }
+                    }
+                }
+            }
+        }
+
+        return isChanged;
+    }
+
+    double FastSweepingMethod::updateNode(unsigned int node, bool isSecondOrder) const
+    {
+        // Reused constants.
+        const double aa = 9.0/4.0;
+        const double oneThird = 1.0/3.0;
+
+        // Quadratic coefficients.
+        double a, b, c;
+
+        // Zero coefficients.
+        a = b = c = 0;
+
+        // Current distance estimate.
+        double current = distance[node];
+
+        /* The upwind direction is determined using the converged first order
+           solution when applying second order corrections. Fixing the stencil
+           in this way guarantees that the Gauss-Seidel iteration converges.
+         */
+        const std::vector<double>& order = isSecondOrder ? firstOrder : distance;
+
+        // Smallest and largest upwind distance over the two dimensions.
+        double minDist = maxDouble;
+        double maxDist = 0;
+
+        // Loop over all dimensions.
+        for (unsigned int i=0;i<2;i++)
+        {
+            // Initialise distances.
+            double dist1 = maxDouble;
+            double dist2 = maxDouble;
+
+            // The ordering distance of the upwind neighbour.
+            double upwind = maxDouble;
+
+            // Loop over all directions.
+            for (unsigned int j=0;j<2;j++)
+            {
+                // Work out index of neighbour.
+                unsigned int index = 2*i + j;
+
+                // First neighbour.
+                unsigned int n1 = mesh.nodes[node].neighbours[index];
+
+                // Neighbour is within the domain boundary and is upwind.
+                if ((n1 != mesh.nNodes) && (order[n1] < order[node]) && (order[n1] < upwind))
+                {
+                    // Store distance.
+                    upwind = order[n1];
+                    dist1 = distance[n1];
+                    dist2 = maxDouble;
+
+                    if (isSecondOrder)
+                    {
+                        // Second neighbour in same direction.
+                        unsigned int n2 = mesh.nodes[n1].neighbours[index];
+
+                        // Neighbour is within the domain boundary and is upwind.
+                        if ((n2 != mesh.nNodes) && (order[n2] <= upwind))
+                        {
+                            // The neighbour may lie on the opposite side of the zero contour.
+                            if ((signedDistanceCopy[n2] < 0) == (signedDistanceCopy[node] < 0))
+                                dist2 = distance[n2];
+                            else
+                                dist2 = -distance[n2];
+                        }
+                    }
+                }
+            }
+
+            // Second order finite difference.
+            if (dist2 < maxDouble)
+            {
+                double tp = oneThird*(4*dist1 - dist2);
+
+                a += aa;
+                b -= 2*aa*tp;
+                c += aa*tp*tp;
+            }
+            // First order finite difference.
+            else if (dist1 < maxDouble)
+            {
+                a += 1;
+                b -= 2*dist1;
+                c += dist1*dist1;
+            }
+
+            if (dist1 < maxDouble)
+            {
+                minDist = std::min(minDist, dist1);
+                maxDist = std::max(maxDist, dist1);
+            }
+        }
+
+        // No upwind neighbours.
+        if (a == 0) return current;
+
+        // Update coefficient.
+        c -= 1;
+
+        // Fall back to a one dimensional update if there are no real roots.
+        double d = FastMarchingMethod::solveQuadratic(a, b, c, minDist + 1, true);
+
+        // The solution must lie downwind of both neighbours (causality),
+        // otherwise the information comes from a single direction.
+        if (d < maxDist)
+        {
+            if (isSecondOrder) d = updateNode(node, false);
+            else d = minDist + 1;
+        }
+
+        return d;
+    }
+
+    bool FastSweepingMethod::updateVelocity(unsigned int node)
+    {
+        // Set the velocity of this node, i.e.
+        // find v_ext, where grad v_ext . grad phi = 0
+
+        // Initialise distance array.
+        double dist[2] = {0, 0};
+
+        // Initialise front (zero contour) distance array.
+        double frontDist[2] = {0, 0};
+
+        // Whether the front distance has been set.
+        bool isSet[2] = {false, false};
+
+        // Initialise velocity array.
+        double vel[2] = {0, 0};
+
+        // Loop over all neighbours of the node.
+        for (unsigned int i=0;i<4;i++)
+        {
+            // Set dimension (neighbours 0 and 1 are x dimension, 2 and 3 are y).
+            unsigned int dim = (i < 2) ? 0 : 1;
+
+            // Get index of neighbour.
+            unsigned int neighbour = mesh.nodes[node].neighbours[i];
+
+            // Neighbour is within domain boundary.
+            if (neighbour != mesh.nNodes)
+            {
+                // Neighbour is upwind, and is on the boundary or inside the narrow band.
+                if ((distance[neighbour] < distance[node]) &&
+                    (isFrozen[neighbour] || mesh.nodes[neighbour].isActive))
+                {
+                    // Check whether the neighbour is closer to the zero contour.
+                    if (!isSet[dim] || (frontDist[dim] > distance[neighbour]))
+                    {
+                        // Store updated distance to the front.
+                        frontDist[dim] = distance[neighbour];
+
+                        // Flag that the front distance has been set.
+                        isSet[dim] = true;
+
+                        // Store distance and velocity.
+                        dist[dim] = distance[node] - distance[neighbour];
+                        vel[dim] = (*velocity)[neighbour];
+                    }
+                }
+            }
+        }
+
+        double numerator = 0;
+        double denominator = 0;
+
+        for (unsigned int i=0;i<2;i++)
+        {
+            numerator += dist[i] * vel[i];
+            denominator += dist[i];
+        }
+
+        // No upwind information.
+        if (denominator == 0) return false;
+
+        double v = numerator / denominator;
+
+        // Whether the velocity has changed.
+        bool isChanged = (std::abs(v - (*velocity)[node]) > tolerance);
+
+        (*velocity)[node] = v;
+
+        return isChanged;
+    }
+
+    bool FastSweepingMethod::isFree(unsigned int node) const
+    {
+        // Boundary nodes are fixed.
+        if (isFrozen[node]) return false;
+
+        // Velocities are only extended within the narrow band.
+        if (isVelocity) return mesh.nodes[node].isActive;
+
+        return true;
+    }
+}
@@ -0,0 +1,220 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _FASTSWEEPINGMETHOD_H
+#define _FASTSWEEPINGMETHOD_H
+
+#include <limits>
+#include <vector>
+
+#include "Common.h"
+#include "ThreadPool.h"
+
+/*! \file FastSweepingMethod.h
+    \brief A parallel implementation of the Fast Sweeping Method.
+ */
+
+namespace slsm
+{
+    // FORWARD DECLARATIONS
+
+    class Mesh;
+
+    // ASSOCIATED DATA TYPES
+
+    //! The quantity that is updated during a Fast Sweeping iteration.
+    namespace SweepType
+    {
+        enum SweepType
+        {
+            FIRST_ORDER  = 0,   //!< Distance, using a first order stencil.
+            SECOND_ORDER = 1,   //!< Distance, using a second order stencil.
+            VELOCITY     = 2,   //!< Extension velocity.
+        };
+    }
+
+    // MAIN CLASS
+
+    /*! \brief A parallel implementation of the Fast Sweeping Method for finding
+        approximate solutions to boundary value problems of the Eikonal
+        equation:
+
+            F(x) | grad T(x) | = 1
+
+        This object provides a drop-in alternative to the FastMarchingMethod
+        class, with the same march interface for reinitialisation of the level
+        set and for velocity extension.
+
+        Nodes adjacent to the zero contour are initialised as for the Fast
+        Marching Method. The remaining nodes are then updated by Gauss-Seidel
+        iteration, sweeping in each of the four grid orderings until the solution
+        converges. A first order upwind stencil is used until convergence, since
+        its monotonicity guarantees that distances only decrease. This is followed
+        by further sweeps using the same second order upwind stencil (and quadratic
+        update) as the Fast Marching Method.
+
+        For parallel execution the mesh is decomposed into horizontal blocks of
+        rows, which are coloured alternately. Blocks of the same colour are swept
+        concurrently, while the neighbouring blocks (of the other colour) remain
+        fixed, so threads never write to nodes that are read by another thread.
+        Information crosses block boundaries as the colours alternate.
+     */
+    class FastSweepingMethod
+    {
+    public:
+        //! Constructor.
+        /*! \param mesh_
+                A reference to the level set mesh.
+
+            \param nThreads_
+                The number of threads (default = hardware concurrency).
+         */
+        FastSweepingMethod(const Mesh&, unsigned int nThreads_=0);
+
+        //! Excecute Fast Sweeping for reinitialisation of the signed distance function.
+        /*! \param signedDistance_
+                The nodal signed distance function (level set).
+         */
+        void march(std::vector<Real>&);
+
+        //! Excecute Fast Sweeping for velocity extension.
+        /*! \param signedDistance_
+                The nodal signed distance function (level set).
+
+            \param velocity_
+                The nodal velocities.
+         */
+        void march(std::vector<Real>&, std::vector<Real>&);
+
+    private:
+        /// A reference to the level set mesh.
+        const Mesh& mesh;
+
+        /// The number of threads.
+        unsigned int nThreads;
+
+        /// The pool of worker threads.
+        ThreadPool threadPool;
+
+        /// The number of blocks in the domain decomposition.
+        unsigned int nBlocks;
+
+        /// The first row of each block (plus one past the last row).
+        std::vector<unsigned int> blockRows;
+
+        /// Whether each block was updated during the last sweep.
+        std::vector<char> isUpdated;
+
+        /// Whether each node lies on the zero contour.
+        std::vector<char> isFrozen;
+
+        /// The unsigned distance from the zero contour.
+        std::vector<double> distance;
+
+        /// The converged first order distance (fixes the second order stencil).
+        std::vector<double> firstOrder;
+
+        /// A copy of the original signed distance function.
+        std::vector<Real> signedDistanceCopy;
+
+        /// A pointer to the signed distance function vector.
+        std::vector<Real>* signedDistance;
+
+        /// A pointer to the velocity vector.
+        std::vector<Real>* velocity;
+
+        /// Whether velocities are being extended.
+        bool isVelocity;
+
+        /// The maximum number of iterations (each of four sweeps).
+        const unsigned int maxIterations = 100;
+
+        /// The convergence tolerance (in units of the grid spacing). This must
+        /// exceed the round-off in the second order update at large distances.
+        const double tolerance = 1e-8;
+
+        //! Find boundary nodes and initialise their distance from the zero contour.
+        void initialiseFrozen();
+
+        //! Sweep until the distance (or velocity) converges.
+        /*! A warning is logged if the sweeps haven't converged after the
+            maximum number of iterations.
+
+            \param sweepType
+                The type of update to apply.
+         */
+        void solve(SweepType::SweepType);
+
+        //! Sweep all blocks of a given colour that are assigned to a thread.
+        /*! \param colour
+                The block colour (0 or 1).
+
+            \param thread
+                The thread index.
+
+            \param sweepType
+                The type of update to apply.
+         */
+        void sweepBlocks(unsigned int, unsigned int, SweepType::SweepType);
+
+        //! Perform the four Gauss-Seidel sweeps over a block.
+        /*! \param block
+                The block index.
+
+            \param sweepType
+                The type of update to apply.
+
+            \return
+                Whether any node in the block was updated.
+         */
+        bool sweepBlock(unsigned int, SweepType::SweepType);
+
+        //! Calculate the updated distance at a node.
+        /*! \param node
+                The index of the node.
+
+            \param isSecondOrder
+                Whether to use the second order stencil where possible.
+
+            \return
+                The new distance at the node.
+         */
+        double updateNode(unsigned int, bool) const;
+
+        //! Calculate the extension velocity at a node.
+        /*! \param node
+                The index of the node.
+
+            \return
+                Whether the velocity changed.
+         */
+        bool updateVelocity(unsigned int);
+
+        //! Whether a node needs to be updated.
+        /*! \param node
+                The index of the node.
+
+            \return
+                Whether the node is updated by the sweeps.
+         */
+        bool isFree(unsigned int) const;
+
+        const double maxDouble = std::numeric_limits<double>::max();
+    };
+}
+
+#endif  /* _FASTSWEEPINGMETHOD_H */
@@ -201,6 +201,13 @@ namespace slsm
         if (isTest) test();
     }
 
+    void Heap::clear()
+    {
+        // Entries are overwritten on push, so resetting the counters is sufficient.
+        heapLength = 0;
+        listLength = 0;
+    }
+
     bool Heap::empty() const
     {
         return (heapLength == 0) ? true : false;
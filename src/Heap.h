@@ -88,6 +88,9 @@ namespace slsm
          */
         void set(unsigned int, double);
 
+        //! Empty the heap, retaining the allocated storage for reuse.
+        void clear();
+
         //! Test whether the heap is empty.
         /*! \return
                 Whether the heap is empty (true) or contains entries (false).
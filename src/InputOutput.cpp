@@ -53,6 +53,9 @@ namespace slsm
     {
         FILE *pFile;
 
+        // The number of nodes in each row (data is written row by row).
+        unsigned int nx = levelSet.mesh.width + 1;
+
         pFile = fopen(fileName.c_str(), "w");
 
         errno = ENOENT;
@@ -75,7 +78,7 @@ namespace slsm
         fprintf(pFile, "SCALARS distance float 1\n");
         fprintf(pFile, "LOOKUP_TABLE default\n");
         for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
-            fprintf(pFile, "%lf\n", levelSet.signedDistance[i]);
+            fprintf(pFile, "%lf\n", levelSet.signedDistance[levelSet.mesh.xyToIndex(i % nx, i / nx)]);
 
         // Write the nodal velocity to file.
         if (isVelocity)
@@ -83,7 +86,7 @@ namespace slsm
             fprintf(pFile, "SCALARS velocity float 1\n");
             fprintf(pFile, "LOOKUP_TABLE default\n");
             for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
-                fprintf(pFile, "%lf\n", levelSet.velocity[i]);
+                fprintf(pFile, "%lf\n", levelSet.velocity[levelSet.mesh.xyToIndex(i % nx, i / nx)]);
         }
 
         // Write the nodal gradient to file.
@@ -92,7 +95,7 @@ namespace slsm
             fprintf(pFile, "SCALARS gradient float 1\n");
             fprintf(pFile, "LOOKUP_TABLE default\n");
             for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
-                fprintf(pFile, "%lf\n", levelSet.gradient[i]);
+                fprintf(pFile, "%lf\n", levelSet.gradient[levelSet.mesh.xyToIndex(i % nx, i / nx)]);
         }
 
         fclose(pFile);
@@ -33,11 +33,20 @@
 namespace slsm
 {
     LevelSet::LevelSet(unsigned int width, unsigned int height,
-        double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_) :
+        double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_,
+        NodeOrdering::NodeOrdering nodeOrdering) :
         moveLimit(moveLimit_),
-        mesh(Mesh(width, height)),
+        mesh(Mesh(width, height, nodeOrdering)),
+        isSignChanged(mesh.nNodes, false),
+        discretisedBoundary(nullptr),
+        isTargetDiscretised(false),
         bandWidth(bandWidth_),
-        isFixedDomain(isFixedDomain_)
+        isFixedDomain(isFixedDomain_),
+        fmm(mesh),
+        closestPoint(mesh),
+        wenoGradient(mesh),
+        isMineTriggered(1),
+        areaBoundary(nullptr)
     {
         int size = 0.2*mesh.nNodes;
 
@@ -68,11 +77,20 @@ namespace slsm
     }
 
     LevelSet::LevelSet(unsigned int width, unsigned int height, const std::vector<Hole>& holes,
-        double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_) :
+        double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_,
+        NodeOrdering::NodeOrdering nodeOrdering) :
         moveLimit(moveLimit_),
-        mesh(Mesh(width, height)),
+        mesh(Mesh(width, height, nodeOrdering)),
+        isSignChanged(mesh.nNodes, false),
+        discretisedBoundary(nullptr),
+        isTargetDiscretised(false),
         bandWidth(bandWidth_),
-        isFixedDomain(isFixedDomain_)
+        isFixedDomain(isFixedDomain_),
+        fmm(mesh),
+        closestPoint(mesh),
+        wenoGradient(mesh),
+        isMineTriggered(1),
+        areaBoundary(nullptr)
     {
         int size = 0.2*mesh.nNodes;
 
@@ -103,11 +121,20 @@ namespace slsm
     }
 
     LevelSet::LevelSet(unsigned int width, unsigned int height, const std::vector<Coord>& points,
-        double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_) :
+        double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_,
+        NodeOrdering::NodeOrdering nodeOrdering) :
         moveLimit(moveLimit_),
-        mesh(Mesh(width, height)),
+        mesh(Mesh(width, height, nodeOrdering)),
+        isSignChanged(mesh.nNodes, false),
+        discretisedBoundary(nullptr),
+        isTargetDiscretised(false),
         bandWidth(bandWidth_),
-        isFixedDomain(isFixedDomain_)
+        isFixedDomain(isFixedDomain_),
+        fmm(mesh),
+        closestPoint(mesh),
+        wenoGradient(mesh),
+        isMineTriggered(1),
+        areaBoundary(nullptr)
     {
         int size = 0.2*mesh.nNodes;
 
@@ -138,11 +165,20 @@ namespace slsm
     }
 
     LevelSet::LevelSet(unsigned int width, unsigned int height, const std::vector<Hole>& initialHoles,
-        const std::vector<Hole>& targetHoles, double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_) :
+        const std::vector<Hole>& targetHoles, double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_,
+        NodeOrdering::NodeOrdering nodeOrdering) :
         moveLimit(moveLimit_),
-        mesh(Mesh(width, height)),
+        mesh(Mesh(width, height, nodeOrdering)),
+        isSignChanged(mesh.nNodes, false),
+        discretisedBoundary(nullptr),
+        isTargetDiscretised(false),
         bandWidth(bandWidth_),
-        isFixedDomain(isFixedDomain_)
+        isFixedDomain(isFixedDomain_),
+        fmm(mesh),
+        closestPoint(mesh),
+        wenoGradient(mesh),
+        isMineTriggered(1),
+        areaBoundary(nullptr)
     {
         int size = 0.2*mesh.nNodes;
 
@@ -181,11 +217,20 @@ namespace slsm
     }
 
     LevelSet::LevelSet(unsigned int width, unsigned int height, const std::vector<Hole>& holes,
-        const std::vector<Coord>& points, double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_) :
+        const std::vector<Coord>& points, double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_,
+        NodeOrdering::NodeOrdering nodeOrdering) :
         moveLimit(moveLimit_),
-        mesh(Mesh(width, height)),
+        mesh(Mesh(width, height, nodeOrdering)),
+        isSignChanged(mesh.nNodes, false),
+        discretisedBoundary(nullptr),
+        isTargetDiscretised(false),
         bandWidth(bandWidth_),
-        isFixedDomain(isFixedDomain_)
+        isFixedDomain(isFixedDomain_),
+        fmm(mesh),
+        closestPoint(mesh),
+        wenoGradient(mesh),
+        isMineTriggered(1),
+        areaBoundary(nullptr)
     {
         int size = 0.2*mesh.nNodes;
 
@@ -224,11 +269,20 @@ namespace slsm
     }
 
     LevelSet::LevelSet(unsigned int width, unsigned int height, const std::vector<Coord>& initialPoints,
-        const std::vector<Coord>& targetPoints, double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_) :
+        const std::vector<Coord>& targetPoints, double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_,
+        NodeOrdering::NodeOrdering nodeOrdering) :
         moveLimit(moveLimit_),
-        mesh(Mesh(width, height)),
+        mesh(Mesh(width, height, nodeOrdering)),
+        isSignChanged(mesh.nNodes, false),
+        discretisedBoundary(nullptr),
+        isTargetDiscretised(false),
         bandWidth(bandWidth_),
-        isFixedDomain(isFixedDomain_)
+        isFixedDomain(isFixedDomain_),
+        fmm(mesh),
+        closestPoint(mesh),
+        wenoGradient(mesh),
+        isMineTriggered(1),
+        areaBoundary(nullptr)
     {
         int size = 0.2*mesh.nNodes;
 
@@ -266,34 +320,31 @@ namespace slsm
         exit(EXIT_FAILURE);
     }
 
-    bool LevelSet::update(double timeStep)
+    bool LevelSet::update(double timeStep, bool isReinitialise)
     {
-        // Loop over all nodes in the narrow band.
-        for (unsigned int i=0;i<nNarrowBand;i++)
+        /* The narrow band is partitioned between threads. Mine nodes are part
+           of the narrow band, so each thread checks its own mines once they
+           have been updated and the results are combined below.
+         */
+        threadPool.run([&](unsigned int thread)
         {
-            unsigned int node = narrowBand[i];
-            signedDistance[node] -= timeStep * gradient[node] * velocity[node];
+            unsigned int start, end;
+            threadPool.range(nNarrowBand, thread, start, end);
 
-            // If node is on domain boundary.
-            if (mesh.nodes[node].isDomain)
-            {
-                // Enforce boundary condition.
-                if (signedDistance[node] > 0)
-                    signedDistance[node] = 0;
-            }
+            isMineTriggered[thread] = updateNodes(timeStep, start, end);
+        });
 
-            // Reset the number of boundary points.
-            mesh.nodes[node].nBoundaryPoints = 0;
-        }
+        // The area fractions can no longer be updated within the narrow band.
+        areaBoundary = nullptr;
 
-        // Check mine nodes.
-        for (unsigned int i=0;i<nMines;i++)
+        // Check whether any thread triggered a mine.
+        for (unsigned int i=0;i<threadPool.size();i++)
         {
-            // Boundary is within one grid spacing of the mine.
-            if (std::abs(signedDistance[mines[i]]) < 1.0)
+            if (isMineTriggered[i])
             {
-                // Reinitialise the signed distance function.
-                reinitialise();
+                // Reinitialise the signed distance function (the boundary is
+                // still inside the narrow band).
+                if (isReinitialise) reinitialise(true);
 
                 return true;
             }
@@ -302,6 +353,99 @@ namespace slsm
         return false;
     }
 
+    bool LevelSet::step(Boundary& boundary, double timeStep, bool isReinitialise)
+    {
+        /* Gradients are evaluated in batches from finite differences of the
+           signed distance function within the narrow band. Once all gradients
+           are known, each thread updates its own batches of nodes, so only the
+           narrow band is visited. The boundary
+           is then rediscretised around nodes that have changed sign (for an
+           incremental boundary), and area fractions are only recomputed for
+           elements close to the boundary.
+         */
+
+        // Extend boundary point velocities to all narrow band nodes.
+        computeVelocities(boundary.points);
+
+        // Zero the gradient at nodes that may have left the narrow band.
+        for (unsigned int i=0;i<gradientNodes.size();i++)
+            gradient[gradientNodes[i]] = 0;
+
+        // Corner nodes may use a diagonal stencil, which isn't handled by the
+        // kernel, so compute their gradients before any node is updated.
+        unsigned int corners[4] = {mesh.xyToIndex(0, 0), mesh.xyToIndex(mesh.width, 0),
+            mesh.xyToIndex(0, mesh.height), mesh.xyToIndex(mesh.width, mesh.height)};
+        double cornerGradients[4];
+        unsigned int cornerEntries[4];
+
+        for (unsigned int i=0;i<4;i++)
+        {
+            // Find the entry of the corner in the (sorted) narrow band.
+            cornerEntries[i] = std::lower_bound(narrowBand.begin(),
+                narrowBand.begin() + nNarrowBand, corners[i]) - narrowBand.begin();
+
+            if (mesh.nodes[corners[i]].isActive)
+                cornerGradients[i] = computeGradient(corners[i]);
+            else cornerEntries[i] = nNarrowBand;
+        }
+
+        // Clear the mine flags for each thread.
+        std::fill(isMineTriggered.begin(), isMineTriggered.end(), false);
+
+        // Compute gradients, then update the level set batch by batch.
+        wenoGradient.compute(signedDistance, velocity, narrowBand, nNarrowBand, gradient, threadPool,
+            [&](unsigned int start, unsigned int end, unsigned int thread)
+        {
+            for (unsigned int i=0;i<4;i++)
+            {
+                if ((cornerEntries[i] >= start) && (cornerEntries[i] < end))
+                    gradient[corners[i]] = cornerGradients[i];
+            }
+
+            if (updateNodes(timeStep, start, end)) isMineTriggered[thread] = true;
+        });
+
+        // Store the nodes at which the gradient is non-zero.
+        gradientNodes.assign(narrowBand.begin(), narrowBand.begin() + nNarrowBand);
+
+        // Check whether any thread triggered a mine.
+        bool isReinitialised = false;
+        for (unsigned int i=0;i<threadPool.size();i++)
+        {
+            if (isMineTriggered[i]) isReinitialised = true;
+        }
+
+        // Reinitialise the signed distance function, if necessary.
+        if (isReinitialised) reinitialise(true);
+        else if (isReinitialise)
+        {
+            reinitialise();
+            isReinitialised = true;
+        }
+
+        /* Area fractions only need to be updated for elements that were cut
+           by the boundary, or that are connected to a node that has changed
+           status, as long as they were last computed from this boundary and
+           the level set hasn't been modified outside of the band since.
+         */
+        bool isUpdate = (areaBoundary == &boundary) && (discretisedBoundary == &boundary);
+
+        // Flag the elements to update (before the node status is reset).
+        if (isUpdate) flagChangedElements();
+
+        // Compute the new discretised boundary.
+        boundary.discretise(*this);
+
+        // Compute the element area fractions.
+        if (isUpdate) updateAreaFractions(boundary);
+        else computeAreaFractions(boundary);
+
+        // Compute the boundary point normal vectors.
+        boundary.computeNormalVectors(*this);
+
+        return isReinitialised;
+    }
+
     void LevelSet::mask(const std::vector<Hole>& holes)
     {
         // Loop over all nodes.
@@ -369,16 +513,36 @@ namespace slsm
         reinitialise();
     }
 
-    void LevelSet::reinitialise()
+    void LevelSet::reinitialise(bool isBanded)
     {
-        // Initialise fast marching method object.
-        FastMarchingMethod fmm(mesh, false);
+        if (isBanded)
+        {
+            // Reinitialise the signed distance function in the vicinity of
+            // the narrow band, stopping just beyond the band width.
+            fmm.march(signedDistance, narrowBand, nNarrowBand, bandWidth + 1);
 
-        // Reinitialise the signed distance function.
-        fmm.march(signedDistance);
+            // Nodes close to the zero contour may have changed status.
+            const std::vector<unsigned int>& visited = fmm.visitedNodes();
+            for (unsigned int i=0;i<fmm.numVisited();i++)
+            {
+                unsigned int node = visited[i];
+                isSignChanged[node] = (Boundary::computeNodeStatus(signedDistance[node]) != mesh.nodes[node].status);
+            }
 
-        // Reinitialise the narrow band.
-        initialiseNarrowBand();
+            // Update the narrow band.
+            updateNarrowBand();
+        }
+        else
+        {
+            // Reinitialise the signed distance function.
+            fmm.march(signedDistance);
+
+            // Reinitialise the narrow band.
+            initialiseNarrowBand();
+
+            // The boundary must be discretised from scratch.
+            discretisedBoundary = nullptr;
+        }
     }
 
     void LevelSet::computeVelocities(const std::vector<BoundaryPoint>& boundaryPoints)
@@ -386,13 +550,19 @@ namespace slsm
         // Initialise velocity (map boundary points to boundary nodes).
         initialiseVelocities(boundaryPoints);
 
-        // Initialise fast marching method object.
-        FastMarchingMethod fmm(mesh, false);
-
-        // Reinitialise the signed distance function.
+        // Extend velocities (the signed distance function is left unchanged).
         fmm.march(signedDistance, velocity);
     }
 
+    void LevelSet::computeVelocities(const Boundary& boundary)
+    {
+        // Nodes outside of the narrow band have no velocity.
+        std::fill(velocity.begin(), velocity.end(), 0.0);
+
+        // Interpolate the velocity at the closest boundary point to each node in the band.
+        closestPoint.extend(boundary, narrowBand, nNarrowBand, velocity, threadPool);
+    }
+
     double LevelSet::computeVelocities(std::vector<BoundaryPoint>& boundaryPoints,
         double& timeStep, const double temperature, MersenneTwister& rng)
     {
@@ -447,37 +617,88 @@ namespace slsm
 
         // Reset gradients.
         std::fill(gradient.begin(), gradient.end(), 0.0);
+        gradientNodes.clear();
 
-        // Loop over all nodes in the narrow band region.
-        for (unsigned int i=0;i<nNarrowBand;i++)
+        // Compute the gradient for all nodes in the narrow band region.
+        wenoGradient.compute(signedDistance, velocity, narrowBand, nNarrowBand, gradient, threadPool);
+
+        // Corner nodes may use a diagonal stencil, which isn't handled by the kernel.
+        unsigned int corners[4] = {mesh.xyToIndex(0, 0), mesh.xyToIndex(mesh.width, 0),
+            mesh.xyToIndex(0, mesh.height), mesh.xyToIndex(mesh.width, mesh.height)};
+
+        for (unsigned int i=0;i<4;i++)
         {
-            // Compute the nodal gradient.
-            unsigned int node = narrowBand[i];
-            gradient[node] = computeGradient(node);
+            if (mesh.nodes[corners[i]].isActive)
+                gradient[corners[i]] = computeGradient(corners[i]);
         }
     }
 
+    void LevelSet::setThreads(unsigned int nThreads)
+    {
+        threadPool.resize(nThreads);
+        isMineTriggered.resize(threadPool.size());
+    }
+
     double LevelSet::computeAreaFractions(const Boundary& boundary)
     {
-        // Zero the total area fraction.
-        area = 0;
+        /* Elements are partitioned between threads by row. The area enclosed
+           within each row is summed separately, then the row totals are summed
+           in order, so that the result is independent of the number of threads.
+         */
+
+        // Resize scratch arrays (memory is retained between calls).
+        rowAreas.resize(mesh.height);
+        threadCutElements.resize(threadPool.size());
 
-        for (unsigned int i=0;i<mesh.nElements;i++)
+        threadPool.run([&](unsigned int thread)
         {
-            // Element is inside structure.
-            if (mesh.elements[i].status & ElementStatus::INSIDE)
-                mesh.elements[i].area = 1.0;
+            unsigned int start, end;
+            threadPool.range(mesh.height, thread, start, end);
 
-            // Element is outside structure.
-            else if (mesh.elements[i].status & ElementStatus::OUTSIDE)
-                mesh.elements[i].area = 0.0;
+            std::vector<unsigned int>& cut = threadCutElements[thread];
+            cut.clear();
 
-            // Element is cut by the boundary.
-            else mesh.elements[i].area = cutArea(mesh.elements[i], boundary);
+            for (unsigned int y=start;y<end;y++)
+            {
+                double rowArea = 0;
 
-            // Add the area to the running total.
-            area += mesh.elements[i].area;
-        }
+                for (unsigned int i=y*mesh.width;i<(y+1)*mesh.width;i++)
+                {
+                    unsigned char status = mesh.elementStatus[i];
+
+                    // Element is inside structure.
+                    if (status & ElementStatus::INSIDE) mesh.elementArea[i] = 1.0;
+
+                    // Element is outside structure.
+                    else if (status & ElementStatus::OUTSIDE) mesh.elementArea[i] = 0.0;
+
+                    // Element is cut by the boundary.
+                    else
+                    {
+                        mesh.elementArea[i] = cutArea(i);
+                        cut.push_back(i);
+                    }
+
+                    rowArea += mesh.elementArea[i];
+                }
+
+                rowAreas[y] = rowArea;
+            }
+        });
+
+        // Sum the row areas.
+        area = 0;
+        for (unsigned int y=0;y<mesh.height;y++)
+            area += rowAreas[y];
+
+        // Store elements that are cut by the boundary (threads own
+        // consecutive rows, so these are in order).
+        cutElements.clear();
+        for (unsigned int i=0;i<threadCutElements.size();i++)
+            cutElements.insert(cutElements.end(), threadCutElements[i].begin(), threadCutElements[i].end());
+
+        // Store the boundary, so that area fractions can be updated by step.
+        areaBoundary = &boundary;
 
         return area;
     }
@@ -637,7 +858,11 @@ namespace slsm
 
     void LevelSet::initialiseNarrowBand()
     {
-        unsigned int mineWidth = bandWidth - 1;
+        // The boundary must be discretised from scratch.
+        discretisedBoundary = nullptr;
+
+        // Area fractions must be computed for the whole mesh.
+        areaBoundary = nullptr;
 
         // Reset the number of nodes in the narrow band.
         nNarrowBand = 0;
@@ -647,50 +872,204 @@ namespace slsm
 
         // Loop over all nodes.
         for (unsigned int i=0;i<mesh.nNodes;i++)
+            addToNarrowBand(i);
+    }
+
+    void LevelSet::updateNarrowBand()
+    {
+        // Clear the status of nodes in the existing narrow band.
+        for (unsigned int i=0;i<nNarrowBand;i++)
+        {
+            mesh.nodes[narrowBand[i]].isActive = false;
+            mesh.nodes[narrowBand[i]].isMine = false;
+        }
+
+        // Reset the number of nodes in the narrow band.
+        nNarrowBand = 0;
+
+        // Reset the number of mines.
+        nMines = 0;
+
+        /* Nodes within the cutoff distance of the boundary were all visited
+           during the banded reinitialisation. Any other node either lies outside
+           the band, or has been clamped to the cutoff.
+         */
+        const std::vector<unsigned int>& visited = fmm.visitedNodes();
+
+        // Loop over all visited nodes.
+        for (unsigned int i=0;i<fmm.numVisited();i++)
+            addToNarrowBand(visited[i]);
+
+        // Sort the narrow band and mines arrays to preserve the node ordering.
+        std::sort(narrowBand.begin(), narrowBand.begin() + nNarrowBand);
+        std::sort(mines.begin(), mines.begin() + nMines);
+    }
+
+    bool LevelSet::updateNodes(double timeStep, unsigned int start, unsigned int end)
+    {
+        // Whether the boundary is within one grid spacing of a mine.
+        bool isTriggered = false;
+
+        // Loop over the range of nodes in the narrow band.
+        for (unsigned int i=start;i<end;i++)
         {
-            // Flag node as inactive.
-            mesh.nodes[i].isActive = false;
-
-            /* Check that the node isn't in a masked region. If it's not, then check
-               whether it lies on the domain boundary, and if it does then check that
-               the boundary isn't fixed.
-             */
-            if (!mesh.nodes[i].isMasked && (!mesh.nodes[i].isDomain || !isFixedDomain))
+            unsigned int node = narrowBand[i];
+            signedDistance[node] -= timeStep * gradient[node] * velocity[node];
+
+            // If node is on domain boundary.
+            if (mesh.nodes[node].isDomain)
             {
-                // Absolute value of the signed distance function.
-                double absoluteSignedDistance = std::abs(signedDistance[i]);
+                // Enforce boundary condition.
+                if (signedDistance[node] > 0)
+                    signedDistance[node] = 0;
+            }
 
-                // Node lies inside band.
-                if (absoluteSignedDistance < bandWidth)
-                {
-                    // Flag node as active.
-                    mesh.nodes[i].isActive = true;
+            // Flag nodes whose status differs from the discretised boundary.
+            isSignChanged[node] = (Boundary::computeNodeStatus(signedDistance[node]) != mesh.nodes[node].status);
 
-                    // Update narrow band array.
-                    narrowBand[nNarrowBand] = i;
+            // Check mine nodes.
+            if (mesh.nodes[node].isMine && (std::abs(signedDistance[node]) < 1.0))
+                isTriggered = true;
+        }
+
+        return isTriggered;
+    }
+
+    double LevelSet::computeAreaFraction(unsigned int element) const
+    {
+        // Element is inside structure.
+        if (mesh.elements[element].status & ElementStatus::INSIDE) return 1.0;
+
+        // Element is outside structure.
+        else if (mesh.elements[element].status & ElementStatus::OUTSIDE) return 0.0;
+
+        // Element is cut by the boundary.
+        else return cutArea(element);
+    }
+
+    void LevelSet::flagChangedElements()
+    {
+        // Resize scratch array (memory is retained between calls).
+        isElementChanged.resize(mesh.nElements, false);
+        changedElements.clear();
+
+        // Elements that were cut by the boundary.
+        for (unsigned int i=0;i<cutElements.size();i++)
+        {
+            isElementChanged[cutElements[i]] = true;
+            changedElements.push_back(cutElements[i]);
+        }
+
+        // Elements connected to a node whose status has changed. Only nodes in
+        // the narrow band are moved, or change sign on reinitialisation.
+        for (unsigned int i=0;i<nNarrowBand;i++)
+        {
+            unsigned int node = narrowBand[i];
 
-                    // Increment number of nodes.
-                    nNarrowBand++;
+            if (isSignChanged[node])
+            {
+                unsigned int elements[4];
+                unsigned int nElements = mesh.getNodeElements(node, elements);
 
-                    // Node lines at edge of band.
-                    if (absoluteSignedDistance > mineWidth)
+                for (unsigned int j=0;j<nElements;j++)
+                {
+                    if (!isElementChanged[elements[j]])
                     {
-                        // Node is a mine.
-                        mesh.nodes[i].isMine = true;
+                        isElementChanged[elements[j]] = true;
+                        changedElements.push_back(elements[j]);
+                    }
+                }
+            }
+        }
+    }
 
-                        // Update mine array.
-                        mines[nMines] = i;
+    void LevelSet::updateAreaFractions(const Boundary& boundary)
+    {
+        // Resize scratch array (memory is retained between calls).
+        areaChanges.resize(changedElements.size());
 
-                        // Increment mine count.
-                        nMines++;
+        // Recompute the area fractions of the flagged elements in parallel.
+        threadPool.run([&](unsigned int thread)
+        {
+            unsigned int start, end;
+            threadPool.range(changedElements.size(), thread, start, end);
 
-                        // If needed, increase the size of the mines vector.
-                        if (nMines == mines.size())
-                        {
-                            // Double in size, unless that exceeds the number of nodes.
-                            unsigned int newSize = std::min(2*nMines, mesh.nNodes);
-                            mines.resize(newSize);
-                        }
+            for (unsigned int i=start;i<end;i++)
+            {
+                unsigned int element = changedElements[i];
+                isElementChanged[element] = false;
+
+                double elementArea = computeAreaFraction(element);
+                areaChanges[i] = elementArea - mesh.elementArea[element];
+                mesh.elementArea[element] = elementArea;
+            }
+        });
+
+        cutElements.clear();
+
+        // Replace each element's contribution to the total area (in order, so
+        // that the result is independent of the number of threads).
+        for (unsigned int i=0;i<changedElements.size();i++)
+        {
+            unsigned int element = changedElements[i];
+            area += areaChanges[i];
+
+            // Store elements that are cut by the boundary.
+            if (!(mesh.elementStatus[element] & (ElementStatus::INSIDE|ElementStatus::OUTSIDE)))
+                cutElements.push_back(element);
+        }
+
+        // Store the boundary, so that area fractions can be updated by step.
+        areaBoundary = &boundary;
+    }
+
+    void LevelSet::addToNarrowBand(unsigned int node)
+    {
+        unsigned int mineWidth = bandWidth - 1;
+
+        // Flag node as inactive.
+        mesh.nodes[node].isActive = false;
+        mesh.nodes[node].isMine = false;
+
+        /* Check that the node isn't in a masked region. If it's not, then check
+           whether it lies on the domain boundary, and if it does then check that
+           the boundary isn't fixed.
+         */
+        if (!mesh.nodes[node].isMasked && (!mesh.nodes[node].isDomain || !isFixedDomain))
+        {
+            // Absolute value of the signed distance function.
+            double absoluteSignedDistance = std::abs(signedDistance[node]);
+
+            // Node lies inside band.
+            if (absoluteSignedDistance < bandWidth)
+            {
+                // Flag node as active.
+                mesh.nodes[node].isActive = true;
+
+                // Update narrow band array.
+                narrowBand[nNarrowBand] = node;
+
+                // Increment number of nodes.
+                nNarrowBand++;
+
+                // Node lines at edge of band.
+                if (absoluteSignedDistance > mineWidth)
+                {
+                    // Node is a mine.
+                    mesh.nodes[node].isMine = true;
+
+                    // Update mine array.
+                    mines[nMines] = node;
+
+                    // Increment mine count.
+                    nMines++;
+
+                    // If needed, increase the size of the mines vector.
+                    if (nMines == mines.size())
+                    {
+                        // Double in size, unless that exceeds the number of nodes.
+                        unsigned int newSize = std::min(2*nMines, mesh.nNodes);
+                        mines.resize(newSize);
                     }
                 }
             }
@@ -702,17 +1081,15 @@ namespace slsm
         // Map boundary point velocities to nodes of the level set domain
         // using inverse squared distance interpolation.
 
-        // Whether the velocity at a node has been set.
-        bool isSet[mesh.nNodes];
-
-        // Weighting factor for each node.
-        double weight[mesh.nNodes];
+        // Resize scratch arrays (memory is retained between calls).
+        isVelocitySet.resize(mesh.nNodes);
+        velocityWeight.resize(mesh.nNodes);
 
         // Initialise arrays.
         for (unsigned int i=0;i<mesh.nNodes;i++)
         {
-            isSet[i] = false;
-            weight[i] = 0;
+            isVelocitySet[i] = false;
+            velocityWeight[i] = 0;
             velocity[i] = 0;
         }
 
@@ -734,16 +1111,16 @@ namespace slsm
             if (rSqd < 1e-6)
             {
                 velocity[node] = boundaryPoints[i].velocity;
-                weight[node] = 1.0;
-                isSet[node] = true;
+                velocityWeight[node] = 1.0;
+                isVelocitySet[node] = true;
             }
             else
             {
                 // Update velocity estimate if not already set.
-                if (!isSet[node])
+                if (!isVelocitySet[node])
                 {
                     velocity[node] += boundaryPoints[i].velocity / rSqd;
-                    weight[node] += 1.0 / rSqd;
+                    velocityWeight[node] += 1.0 / rSqd;
                 }
             }
 
@@ -768,16 +1145,16 @@ namespace slsm
                     if (rSqd < 1e-6)
                     {
                         velocity[neighbour] = boundaryPoints[i].velocity;
-                        weight[neighbour] = 1.0;
-                        isSet[neighbour] = true;
+                        velocityWeight[neighbour] = 1.0;
+                        isVelocitySet[neighbour] = true;
                     }
                     else if (rSqd <= 1.0)
                     {
                         // Update velocity estimate if not already set.
-                        if (!isSet[neighbour])
+                        if (!isVelocitySet[neighbour])
                         {
                             velocity[neighbour] += boundaryPoints[i].velocity / rSqd;
-                            weight[neighbour] += 1.0 / rSqd;
+                            velocityWeight[neighbour] += 1.0 / rSqd;
                         }
                     }
                 }
@@ -788,7 +1165,7 @@ namespace slsm
         for (unsigned int i=0;i<nNarrowBand;i++)
         {
             unsigned int node = narrowBand[i];
-            if (velocity[node]) velocity[node] /= weight[node];
+            if (velocity[node]) velocity[node] /= velocityWeight[node];
         }
     }
 
@@ -815,11 +1192,11 @@ namespace slsm
             {
                 // If signed distance at nodes to right and above is the same, then use
                 // the diagonal node for computing the gradient.
-                if ((std::abs(signedDistance[mesh.xyToIndex[x+1][y]] - lsf) < 1e-6) &&
-                    (std::abs(signedDistance[mesh.xyToIndex[x][y+1]] - lsf) < 1e-6))
+                if ((std::abs(signedDistance[mesh.xyToIndex(x+1, y)] - lsf) < 1e-6) &&
+                    (std::abs(signedDistance[mesh.xyToIndex(x, y+1)] - lsf) < 1e-6))
                 {
                     // Calculate signed distance to diagonal node.
-                    grad = std::abs(lsf - signedDistance[mesh.xyToIndex[x+1][y+1]]);
+                    grad = std::abs(lsf - signedDistance[mesh.xyToIndex(x+1, y+1)]);
                     grad *= sqrt(2.0);
                     isGradient = true;
                 }
@@ -830,11 +1207,11 @@ namespace slsm
             {
                 // If signed distance at nodes to right and below is the same, then use
                 // the diagonal node for computing the gradient.
-                if ((std::abs(signedDistance[mesh.xyToIndex[x+1][y]] - lsf) < 1e-6) &&
-                    (std::abs(signedDistance[mesh.xyToIndex[x][y-1]] - lsf) < 1e-6))
+                if ((std::abs(signedDistance[mesh.xyToIndex(x+1, y)] - lsf) < 1e-6) &&
+                    (std::abs(signedDistance[mesh.xyToIndex(x, y-1)] - lsf) < 1e-6))
                 {
                     // Calculate signed distance to diagonal node.
-                    grad = std::abs(lsf - signedDistance[mesh.xyToIndex[x+1][y-1]]);
+                    grad = std::abs(lsf - signedDistance[mesh.xyToIndex(x+1, y-1)]);
                     grad *= sqrt(2.0);
                     isGradient = true;
                 }
@@ -849,11 +1226,11 @@ namespace slsm
             {
                 // If signed distance at nodes to left and above is the same, then use
                 // the diagonal node for computing the gradient.
-                if ((std::abs(signedDistance[mesh.xyToIndex[x-1][y]] - lsf) < 1e-6) &&
-                    (std::abs(signedDistance[mesh.xyToIndex[x][y+1]] - lsf) < 1e-6))
+                if ((std::abs(signedDistance[mesh.xyToIndex(x-1, y)] - lsf) < 1e-6) &&
+                    (std::abs(signedDistance[mesh.xyToIndex(x, y+1)] - lsf) < 1e-6))
                 {
                     // Calculate signed distance to diagonal node.
-                    grad = std::abs(lsf - signedDistance[mesh.xyToIndex[x-1][y+1]]);
+                    grad = std::abs(lsf - signedDistance[mesh.xyToIndex(x-1, y+1)]);
                     grad *= sqrt(2.0);
                     isGradient = true;
                 }
@@ -864,11 +1241,11 @@ namespace slsm
             {
                 // If signed distance at nodes to left and below is the same, then use
                 // the diagonal node for computing the gradient.
-                if ((std::abs(signedDistance[mesh.xyToIndex[x-1][y]] - lsf) < 1e-6) &&
-                    (std::abs(signedDistance[mesh.xyToIndex[x][y-1]] - lsf) < 1e-6))
+                if ((std::abs(signedDistance[mesh.xyToIndex(x-1, y)] - lsf) < 1e-6) &&
+                    (std::abs(signedDistance[mesh.xyToIndex(x, y-1)] - lsf) < 1e-6))
                 {
                     // Calculate signed distance to diagonal node.
-                    grad = std::abs(lsf - signedDistance[mesh.xyToIndex[x-1][y-1]]);
+                    grad = std::abs(lsf - signedDistance[mesh.xyToIndex(x-1, y-1)]);
                     grad *= sqrt(2.0);
                     isGradient = true;
                 }
@@ -889,9 +1266,9 @@ namespace slsm
             // Node on left-hand edge.
             if (x == 0)
             {
-                v1 = signedDistance[mesh.xyToIndex[3][y]] - signedDistance[mesh.xyToIndex[2][y]];
-                v2 = signedDistance[mesh.xyToIndex[2][y]] - signedDistance[mesh.xyToIndex[1][y]];
-                v3 = signedDistance[mesh.xyToIndex[1][y]] - signedDistance[mesh.xyToIndex[0][y]];
+                v1 = signedDistance[mesh.xyToIndex(3, y)] - signedDistance[mesh.xyToIndex(2, y)];
+                v2 = signedDistance[mesh.xyToIndex(2, y)] - signedDistance[mesh.xyToIndex(1, y)];
+                v3 = signedDistance[mesh.xyToIndex(1, y)] - signedDistance[mesh.xyToIndex(0, y)];
 
                 // Approximate derivatives outside of domain.
                 v4 = v3;
@@ -901,10 +1278,10 @@ namespace slsm
             // One node to right of left-hand edge.
             else if (x == 1)
             {
-                v1 = signedDistance[mesh.xyToIndex[4][y]] - signedDistance[mesh.xyToIndex[3][y]];
-                v2 = signedDistance[mesh.xyToIndex[3][y]] - signedDistance[mesh.xyToIndex[2][y]];
-                v3 = signedDistance[mesh.xyToIndex[2][y]] - signedDistance[mesh.xyToIndex[1][y]];
-                v4 = signedDistance[mesh.xyToIndex[1][y]] - signedDistance[mesh.xyToIndex[0][y]];
+                v1 = signedDistance[mesh.xyToIndex(4, y)] - signedDistance[mesh.xyToIndex(3, y)];
+                v2 = signedDistance[mesh.xyToIndex(3, y)] - signedDistance[mesh.xyToIndex(2, y)];
+                v3 = signedDistance[mesh.xyToIndex(2, y)] - signedDistance[mesh.xyToIndex(1, y)];
+                v4 = signedDistance[mesh.xyToIndex(1, y)] - signedDistance[mesh.xyToIndex(0, y)];
 
                 // Approximate derivatives outside of domain.
                 v5 = v4;
@@ -913,8 +1290,8 @@ namespace slsm
             // Node on right-hand edge.
             else if (x == mesh.width)
             {
-                v5 = signedDistance[mesh.xyToIndex[x-1][y]] - signedDistance[mesh.xyToIndex[x-2][y]];
-                v4 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x-1][y]];
+                v5 = signedDistance[mesh.xyToIndex(x-1, y)] - signedDistance[mesh.xyToIndex(x-2, y)];
+                v4 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x-1, y)];
 
                 // Approximate derivatives outside of domain.
                 v3 = v4;
@@ -925,9 +1302,9 @@ namespace slsm
             // One node to left of right-hand edge.
             else if (x == (mesh.width - 1))
             {
-                v5 = signedDistance[mesh.xyToIndex[x-1][y]] - signedDistance[mesh.xyToIndex[x-2][y]];
-                v4 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x-1][y]];
-                v3 = signedDistance[mesh.xyToIndex[x+1][y]] - signedDistance[mesh.xyToIndex[x][y]];
+                v5 = signedDistance[mesh.xyToIndex(x-1, y)] - signedDistance[mesh.xyToIndex(x-2, y)];
+                v4 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x-1, y)];
+                v3 = signedDistance[mesh.xyToIndex(x+1, y)] - signedDistance[mesh.xyToIndex(x, y)];
 
                 // Approximate derivatives outside of domain.
                 v2 = v3;
@@ -937,10 +1314,10 @@ namespace slsm
             // Two nodes to left of right-hand edge.
             else if (x == (mesh.width - 2))
             {
-                v5 = signedDistance[mesh.xyToIndex[x-1][y]] - signedDistance[mesh.xyToIndex[x-2][y]];
-                v4 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x-1][y]];
-                v3 = signedDistance[mesh.xyToIndex[x+1][y]] - signedDistance[mesh.xyToIndex[x][y]];
-                v2 = signedDistance[mesh.xyToIndex[x+2][y]] - signedDistance[mesh.xyToIndex[x+1][y]];
+                v5 = signedDistance[mesh.xyToIndex(x-1, y)] - signedDistance[mesh.xyToIndex(x-2, y)];
+                v4 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x-1, y)];
+                v3 = signedDistance[mesh.xyToIndex(x+1, y)] - signedDistance[mesh.xyToIndex(x, y)];
+                v2 = signedDistance[mesh.xyToIndex(x+2, y)] - signedDistance[mesh.xyToIndex(x+1, y)];
 
                 // Approximate derivatives outside of domain.
                 v1 = v2;
@@ -949,11 +1326,11 @@ namespace slsm
             // Node lies in bulk.
             else
             {
-                v1 = signedDistance[mesh.xyToIndex[x+3][y]] - signedDistance[mesh.xyToIndex[x+2][y]];
-                v2 = signedDistance[mesh.xyToIndex[x+2][y]] - signedDistance[mesh.xyToIndex[x+1][y]];
-                v3 = signedDistance[mesh.xyToIndex[x+1][y]] - signedDistance[mesh.xyToIndex[x][y]];
-                v4 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x-1][y]];
-                v5 = signedDistance[mesh.xyToIndex[x-1][y]] - signedDistance[mesh.xyToIndex[x-2][y]];
+                v1 = signedDistance[mesh.xyToIndex(x+3, y)] - signedDistance[mesh.xyToIndex(x+2, y)];
+                v2 = signedDistance[mesh.xyToIndex(x+2, y)] - signedDistance[mesh.xyToIndex(x+1, y)];
+                v3 = signedDistance[mesh.xyToIndex(x+1, y)] - signedDistance[mesh.xyToIndex(x, y)];
+                v4 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x-1, y)];
+                v5 = signedDistance[mesh.xyToIndex(x-1, y)] - signedDistance[mesh.xyToIndex(x-2, y)];
             }
 
             double gradRight = sign * gradHJWENO(v1, v2, v3, v4, v5);
@@ -963,9 +1340,9 @@ namespace slsm
             // Node on right-hand edge.
             if (x == mesh.width)
             {
-                v1 = signedDistance[mesh.xyToIndex[x-2][y]] - signedDistance[mesh.xyToIndex[x-3][y]];
-                v2 = signedDistance[mesh.xyToIndex[x-1][y]] - signedDistance[mesh.xyToIndex[x-2][y]];
-                v3 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x-1][y]];
+                v1 = signedDistance[mesh.xyToIndex(x-2, y)] - signedDistance[mesh.xyToIndex(x-3, y)];
+                v2 = signedDistance[mesh.xyToIndex(x-1, y)] - signedDistance[mesh.xyToIndex(x-2, y)];
+                v3 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x-1, y)];
 
                 // Approximate derivatives outside of domain.
                 v4 = v3;
@@ -975,10 +1352,10 @@ namespace slsm
             // One node to left of right-hand edge.
             else if (x == (mesh.width-1))
             {
-                v1 = signedDistance[mesh.xyToIndex[x-2][y]] - signedDistance[mesh.xyToIndex[x-3][y]];
-                v2 = signedDistance[mesh.xyToIndex[x-1][y]] - signedDistance[mesh.xyToIndex[x-2][y]];
-                v3 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x-1][y]];
-                v4 = signedDistance[mesh.xyToIndex[x+1][y]] - signedDistance[mesh.xyToIndex[x][y]];
+                v1 = signedDistance[mesh.xyToIndex(x-2, y)] - signedDistance[mesh.xyToIndex(x-3, y)];
+                v2 = signedDistance[mesh.xyToIndex(x-1, y)] - signedDistance[mesh.xyToIndex(x-2, y)];
+                v3 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x-1, y)];
+                v4 = signedDistance[mesh.xyToIndex(x+1, y)] - signedDistance[mesh.xyToIndex(x, y)];
 
                 // Approximate derivatives outside of domain.
                 v5 = v4;
@@ -987,8 +1364,8 @@ namespace slsm
             // Node on left-hand edge.
             else if (x == 0)
             {
-                v5 = signedDistance[mesh.xyToIndex[2][y]] - signedDistance[mesh.xyToIndex[1][y]];
-                v4 = signedDistance[mesh.xyToIndex[1][y]] - signedDistance[mesh.xyToIndex[0][y]];
+                v5 = signedDistance[mesh.xyToIndex(2, y)] - signedDistance[mesh.xyToIndex(1, y)];
+                v4 = signedDistance[mesh.xyToIndex(1, y)] - signedDistance[mesh.xyToIndex(0, y)];
 
                 // Approximate derivatives outside of domain.
                 v3 = v4;
@@ -999,9 +1376,9 @@ namespace slsm
             // One node to right of left-hand edge.
             else if (x == 1)
             {
-                v5 = signedDistance[mesh.xyToIndex[3][y]] - signedDistance[mesh.xyToIndex[2][y]];
-                v4 = signedDistance[mesh.xyToIndex[2][y]] - signedDistance[mesh.xyToIndex[1][y]];
-                v3 = signedDistance[mesh.xyToIndex[1][y]] - signedDistance[mesh.xyToIndex[0][y]];
+                v5 = signedDistance[mesh.xyToIndex(3, y)] - signedDistance[mesh.xyToIndex(2, y)];
+                v4 = signedDistance[mesh.xyToIndex(2, y)] - signedDistance[mesh.xyToIndex(1, y)];
+                v3 = signedDistance[mesh.xyToIndex(1, y)] - signedDistance[mesh.xyToIndex(0, y)];
 
                 // Approximate derivatives outside of domain.
                 v2 = v3;
@@ -1011,10 +1388,10 @@ namespace slsm
             // Two nodes to right of left-hand edge.
             else if (x == 2)
             {
-                v5 = signedDistance[mesh.xyToIndex[4][y]] - signedDistance[mesh.xyToIndex[3][y]];
-                v4 = signedDistance[mesh.xyToIndex[3][y]] - signedDistance[mesh.xyToIndex[2][y]];
-                v3 = signedDistance[mesh.xyToIndex[2][y]] - signedDistance[mesh.xyToIndex[1][y]];
-                v2 = signedDistance[mesh.xyToIndex[1][y]] - signedDistance[mesh.xyToIndex[0][y]];
+                v5 = signedDistance[mesh.xyToIndex(4, y)] - signedDistance[mesh.xyToIndex(3, y)];
+                v4 = signedDistance[mesh.xyToIndex(3, y)] - signedDistance[mesh.xyToIndex(2, y)];
+                v3 = signedDistance[mesh.xyToIndex(2, y)] - signedDistance[mesh.xyToIndex(1, y)];
+                v2 = signedDistance[mesh.xyToIndex(1, y)] - signedDistance[mesh.xyToIndex(0, y)];
 
                 // Approximate derivatives outside of domain.
                 v1 = v2;
@@ -1023,11 +1400,11 @@ namespace slsm
             // Node lies in bulk.
             else
             {
-                v1 = signedDistance[mesh.xyToIndex[x-2][y]] - signedDistance[mesh.xyToIndex[x-3][y]];
-                v2 = signedDistance[mesh.xyToIndex[x-1][y]] - signedDistance[mesh.xyToIndex[x-2][y]];
-                v3 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x-1][y]];
-                v4 = signedDistance[mesh.xyToIndex[x+1][y]] - signedDistance[mesh.xyToIndex[x][y]];
-                v5 = signedDistance[mesh.xyToIndex[x+2][y]] - signedDistance[mesh.xyToIndex[x+1][y]];
+                v1 = signedDistance[mesh.xyToIndex(x-2, y)] - signedDistance[mesh.xyToIndex(x-3, y)];
+                v2 = signedDistance[mesh.xyToIndex(x-1, y)] - signedDistance[mesh.xyToIndex(x-2, y)];
+                v3 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x-1, y)];
+                v4 = signedDistance[mesh.xyToIndex(x+1, y)] - signedDistance[mesh.xyToIndex(x, y)];
+                v5 = signedDistance[mesh.xyToIndex(x+2, y)] - signedDistance[mesh.xyToIndex(x+1, y)];
             }
 
             double gradLeft = sign * gradHJWENO(v1, v2, v3, v4, v5);
@@ -1037,9 +1414,9 @@ namespace slsm
             // Node on bottom edge.
             if (y == 0)
             {
-                v1 = signedDistance[mesh.xyToIndex[x][3]] - signedDistance[mesh.xyToIndex[x][2]];
-                v2 = signedDistance[mesh.xyToIndex[x][2]] - signedDistance[mesh.xyToIndex[x][1]];
-                v3 = signedDistance[mesh.xyToIndex[x][1]] - signedDistance[mesh.xyToIndex[x][0]];
+                v1 = signedDistance[mesh.xyToIndex(x, 3)] - signedDistance[mesh.xyToIndex(x, 2)];
+                v2 = signedDistance[mesh.xyToIndex(x, 2)] - signedDistance[mesh.xyToIndex(x, 1)];
+                v3 = signedDistance[mesh.xyToIndex(x, 1)] - signedDistance[mesh.xyToIndex(x, 0)];
 
                 // Approximate derivatives outside of domain.
                 v4 = v3;
@@ -1049,10 +1426,10 @@ namespace slsm
             // One node above bottom edge.
             else if (y == 1)
             {
-                v1 = signedDistance[mesh.xyToIndex[x][4]] - signedDistance[mesh.xyToIndex[x][3]];
-                v2 = signedDistance[mesh.xyToIndex[x][3]] - signedDistance[mesh.xyToIndex[x][2]];
-                v3 = signedDistance[mesh.xyToIndex[x][2]] - signedDistance[mesh.xyToIndex[x][1]];
-                v4 = signedDistance[mesh.xyToIndex[x][1]] - signedDistance[mesh.xyToIndex[x][0]];
+                v1 = signedDistance[mesh.xyToIndex(x, 4)] - signedDistance[mesh.xyToIndex(x, 3)];
+                v2 = signedDistance[mesh.xyToIndex(x, 3)] - signedDistance[mesh.xyToIndex(x, 2)];
+                v3 = signedDistance[mesh.xyToIndex(x, 2)] - signedDistance[mesh.xyToIndex(x, 1)];
+                v4 = signedDistance[mesh.xyToIndex(x, 1)] - signedDistance[mesh.xyToIndex(x, 0)];
 
                 // Approximate derivatives outside of domain.
                 v5 = v4;
@@ -1061,8 +1438,8 @@ namespace slsm
             // Node is on top edge.
             else if (y == mesh.height)
             {
-                v5 = signedDistance[mesh.xyToIndex[x][y-1]] - signedDistance[mesh.xyToIndex[x][y-2]];
-                v4 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x][y-1]];
+                v5 = signedDistance[mesh.xyToIndex(x, y-1)] - signedDistance[mesh.xyToIndex(x, y-2)];
+                v4 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x, y-1)];
 
                 // Approximate derivatives outside of domain.
                 v3 = v4;
@@ -1073,9 +1450,9 @@ namespace slsm
             // One node below top edge.
             else if (y == (mesh.height - 1))
             {
-                v5 = signedDistance[mesh.xyToIndex[x][y-1]] - signedDistance[mesh.xyToIndex[x][y-2]];
-                v4 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x][y-1]];
-                v3 = signedDistance[mesh.xyToIndex[x][y+1]] - signedDistance[mesh.xyToIndex[x][y]];
+                v5 = signedDistance[mesh.xyToIndex(x, y-1)] - signedDistance[mesh.xyToIndex(x, y-2)];
+                v4 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x, y-1)];
+                v3 = signedDistance[mesh.xyToIndex(x, y+1)] - signedDistance[mesh.xyToIndex(x, y)];
 
                 // Approximate derivatives outside of domain.
                 v2 = v3;
@@ -1085,10 +1462,10 @@ namespace slsm
             // Two nodes below top edge.
             else if (y == (mesh.height - 2))
             {
-                v5 = signedDistance[mesh.xyToIndex[x][y-1]] - signedDistance[mesh.xyToIndex[x][y-2]];
-                v4 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x][y-1]];
-                v3 = signedDistance[mesh.xyToIndex[x][y+1]] - signedDistance[mesh.xyToIndex[x][y]];
-                v2 = signedDistance[mesh.xyToIndex[x][y+2]] - signedDistance[mesh.xyToIndex[x][y+1]];
+                v5 = signedDistance[mesh.xyToIndex(x, y-1)] - signedDistance[mesh.xyToIndex(x, y-2)];
+                v4 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x, y-1)];
+                v3 = signedDistance[mesh.xyToIndex(x, y+1)] - signedDistance[mesh.xyToIndex(x, y)];
+                v2 = signedDistance[mesh.xyToIndex(x, y+2)] - signedDistance[mesh.xyToIndex(x, y+1)];
 
                 // Approximate derivatives outside of domain.
                 v1 = v2;
@@ -1097,11 +1474,11 @@ namespace slsm
             // Node lies in bulk.
             else
             {
-                v1 = signedDistance[mesh.xyToIndex[x][y+3]] - signedDistance[mesh.xyToIndex[x][y+2]];
-                v2 = signedDistance[mesh.xyToIndex[x][y+2]] - signedDistance[mesh.xyToIndex[x][y+1]];
-                v3 = signedDistance[mesh.xyToIndex[x][y+1]] - signedDistance[mesh.xyToIndex[x][y]];
-                v4 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x][y-1]];
-                v5 = signedDistance[mesh.xyToIndex[x][y-1]] - signedDistance[mesh.xyToIndex[x][y-2]];
+                v1 = signedDistance[mesh.xyToIndex(x, y+3)] - signedDistance[mesh.xyToIndex(x, y+2)];
+                v2 = signedDistance[mesh.xyToIndex(x, y+2)] - signedDistance[mesh.xyToIndex(x, y+1)];
+                v3 = signedDistance[mesh.xyToIndex(x, y+1)] - signedDistance[mesh.xyToIndex(x, y)];
+                v4 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x, y-1)];
+                v5 = signedDistance[mesh.xyToIndex(x, y-1)] - signedDistance[mesh.xyToIndex(x, y-2)];
             }
 
             double gradUp = sign * gradHJWENO(v1, v2, v3, v4, v5);
@@ -1111,9 +1488,9 @@ namespace slsm
             // Node on top edge.
             if (y == mesh.height)
             {
-                v1 = signedDistance[mesh.xyToIndex[x][y-2]] - signedDistance[mesh.xyToIndex[x][y-3]];
-                v2 = signedDistance[mesh.xyToIndex[x][y-1]] - signedDistance[mesh.xyToIndex[x][y-2]];
-                v3 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x][y-1]];
+                v1 = signedDistance[mesh.xyToIndex(x, y-2)] - signedDistance[mesh.xyToIndex(x, y-3)];
+                v2 = signedDistance[mesh.xyToIndex(x, y-1)] - signedDistance[mesh.xyToIndex(x, y-2)];
+                v3 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x, y-1)];
 
                 // Approximate derivatives outside of domain.
                 v4 = v3;
@@ -1123,10 +1500,10 @@ namespace slsm
             // One node below top edge.
             else if (y == (mesh.height - 1))
             {
-                v1 = signedDistance[mesh.xyToIndex[x][y-2]] - signedDistance[mesh.xyToIndex[x][y-3]];
-                v2 = signedDistance[mesh.xyToIndex[x][y-1]] - signedDistance[mesh.xyToIndex[x][y-2]];
-                v3 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x][y-1]];
-                v4 = signedDistance[mesh.xyToIndex[x][y+1]] - signedDistance[mesh.xyToIndex[x][y]];
+                v1 = signedDistance[mesh.xyToIndex(x, y-2)] - signedDistance[mesh.xyToIndex(x, y-3)];
+                v2 = signedDistance[mesh.xyToIndex(x, y-1)] - signedDistance[mesh.xyToIndex(x, y-2)];
+                v3 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x, y-1)];
+                v4 = signedDistance[mesh.xyToIndex(x, y+1)] - signedDistance[mesh.xyToIndex(x, y)];
 
                 // Approximate derivatives outside of domain.
                 v5 = v4;
@@ -1135,8 +1512,8 @@ namespace slsm
             // Node lies on bottom edge
             else if (y == 0)
             {
-                v5 = signedDistance[mesh.xyToIndex[x][2]] - signedDistance[mesh.xyToIndex[x][1]];
-                v4 = signedDistance[mesh.xyToIndex[x][1]] - signedDistance[mesh.xyToIndex[x][0]];
+                v5 = signedDistance[mesh.xyToIndex(x, 2)] - signedDistance[mesh.xyToIndex(x, 1)];
+                v4 = signedDistance[mesh.xyToIndex(x, 1)] - signedDistance[mesh.xyToIndex(x, 0)];
 
                 // Approximate derivatives outside of domain.
                 v3 = v4;
@@ -1147,9 +1524,9 @@ namespace slsm
             // One node above bottom edge.
             else if (y == 1)
             {
-                v5 = signedDistance[mesh.xyToIndex[x][3]] - signedDistance[mesh.xyToIndex[x][2]];
-                v4 = signedDistance[mesh.xyToIndex[x][2]] - signedDistance[mesh.xyToIndex[x][1]];
-                v3 = signedDistance[mesh.xyToIndex[x][1]] - signedDistance[mesh.xyToIndex[x][0]];
+                v5 = signedDistance[mesh.xyToIndex(x, 3)] - signedDistance[mesh.xyToIndex(x, 2)];
+                v4 = signedDistance[mesh.xyToIndex(x, 2)] - signedDistance[mesh.xyToIndex(x, 1)];
+                v3 = signedDistance[mesh.xyToIndex(x, 1)] - signedDistance[mesh.xyToIndex(x, 0)];
 
                 // Approximate derivatives outside of domain.
                 v2 = v3;
@@ -1159,10 +1536,10 @@ namespace slsm
             // Two nodes above bottom edge.
             else if (y == 2)
             {
-                v5 = signedDistance[mesh.xyToIndex[x][4]] - signedDistance[mesh.xyToIndex[x][3]];
-                v4 = signedDistance[mesh.xyToIndex[x][3]] - signedDistance[mesh.xyToIndex[x][2]];
-                v3 = signedDistance[mesh.xyToIndex[x][2]] - signedDistance[mesh.xyToIndex[x][1]];
-                v2 = signedDistance[mesh.xyToIndex[x][1]] - signedDistance[mesh.xyToIndex[x][0]];
+                v5 = signedDistance[mesh.xyToIndex(x, 4)] - signedDistance[mesh.xyToIndex(x, 3)];
+                v4 = signedDistance[mesh.xyToIndex(x, 3)] - signedDistance[mesh.xyToIndex(x, 2)];
+                v3 = signedDistance[mesh.xyToIndex(x, 2)] - signedDistance[mesh.xyToIndex(x, 1)];
+                v2 = signedDistance[mesh.xyToIndex(x, 1)] - signedDistance[mesh.xyToIndex(x, 0)];
 
                 // Approximate derivatives outside of domain.
                 v1 = v2;
@@ -1171,11 +1548,11 @@ namespace slsm
             // Node lies in bulk.
             else
             {
-                v1 = signedDistance[mesh.xyToIndex[x][y-2]] - signedDistance[mesh.xyToIndex[x][y-3]];
-                v2 = signedDistance[mesh.xyToIndex[x][y-1]] - signedDistance[mesh.xyToIndex[x][y-2]];
-                v3 = signedDistance[mesh.xyToIndex[x][y]]   - signedDistance[mesh.xyToIndex[x][y-1]];
-                v4 = signedDistance[mesh.xyToIndex[x][y+1]] - signedDistance[mesh.xyToIndex[x][y]];
-                v5 = signedDistance[mesh.xyToIndex[x][y+2]] - signedDistance[mesh.xyToIndex[x][y+1]];
+                v1 = signedDistance[mesh.xyToIndex(x, y-2)] - signedDistance[mesh.xyToIndex(x, y-3)];
+                v2 = signedDistance[mesh.xyToIndex(x, y-1)] - signedDistance[mesh.xyToIndex(x, y-2)];
+                v3 = signedDistance[mesh.xyToIndex(x, y)]   - signedDistance[mesh.xyToIndex(x, y-1)];
+                v4 = signedDistance[mesh.xyToIndex(x, y+1)] - signedDistance[mesh.xyToIndex(x, y)];
+                v5 = signedDistance[mesh.xyToIndex(x, y+2)] - signedDistance[mesh.xyToIndex(x, y+1)];
             }
 
             double gradDown = sign * gradHJWENO(v1, v2, v3, v4, v5);
@@ -1194,7 +1571,7 @@ namespace slsm
         return grad;
     }
 
-    double LevelSet::gradHJWENO(double v1, double v2, double v3, double v4, double v5) const
+    double LevelSet::gradHJWENO(double v1, double v2, double v3, double v4, double v5)
     {
         // Calculate the gradient using the 5th order Hamilton-Jacobi WENO approximation.
         // Taken from pages 34-35 of "Level Set Methods and Dynamic Implicit Surfaces".
@@ -1338,146 +1715,80 @@ namespace slsm
             - (point.x -  vertex1.x) * (vertex2.y - vertex1.y));
     }
 
-    double LevelSet::cutArea(const Element& element, const Boundary& boundary) const
+    double LevelSet::cutArea(unsigned int element) const
     {
-        // Number of polygon vertices.
-        unsigned int nVertices = 0;
+        /* The material region within the element is the marching squares
+           polygon, traced by walking anticlockwise around the element edges.
+           Its vertices are the nodes inside the structure and the points where
+           the zero contour cuts an edge, which are interpolated in the same way
+           as boundary points. A node on the boundary is a vertex unless the
+           material only touches the element at that node. Since the vertices
+           are generated in order, the area follows from the shoelace formula.
+
+           If the centre of a saddle element lies outside of the structure then
+           the material region is split in two, so the (connected) region
+           outside of the structure is traced instead.
+         */
+
+        // The signed distance function that the node status was computed from.
+        const std::vector<Real>& field = isTargetDiscretised ? target : signedDistance;
 
-        // Polygon vertices (maximum of six).
-        std::vector<Coord> vertices(6);
+        unsigned int nodes[4];
+        mesh.getElementNodes(element, nodes);
 
-        // Whether we're searching for nodes that are inside or outside the boundary.
-        NodeStatus::NodeStatus status;
+        NodeStatus::NodeStatus status[4];
+        for (unsigned int i=0;i<4;i++)
+            status[i] = mesh.nodes[nodes[i]].status;
 
-        if (element.status & ElementStatus::CENTRE_OUTSIDE) status = NodeStatus::OUTSIDE;
-        else status = NodeStatus::INSIDE;
+        // Whether we're tracing the region inside or outside the boundary.
+        bool isCentreOutside = (mesh.elementStatus[element] & ElementStatus::CENTRE_OUTSIDE);
+        NodeStatus::NodeStatus vertexStatus = isCentreOutside ? NodeStatus::OUTSIDE : NodeStatus::INSIDE;
+
+        // Polygon vertices (at most one node and one edge crossing per side).
+        double x[8], y[8];
+        unsigned int nVertices = 0;
 
-        // Check all nodes of the element.
         for (unsigned int i=0;i<4;i++)
         {
-            // Node index;
-            unsigned int node = element.nodes[i];
+            unsigned int next = (i == 3) ? 0 : (i + 1);
+            unsigned int prev = (i == 0) ? 3 : (i - 1);
 
-            // Node matches status.
-            if (mesh.nodes[node].status & status)
-            {
-                // Add coordinates to vertex array.
-                vertices[nVertices].x = mesh.nodes[node].coord.x;
-                vertices[nVertices].y = mesh.nodes[node].coord.y;
+            bool isVertex = (status[i] & vertexStatus);
+
+            // Node is on the boundary and adjoins the material region.
+            if (!isVertex && (status[i] & NodeStatus::BOUNDARY))
+                isVertex = ((status[next] | status[prev]) & (NodeStatus::INSIDE | NodeStatus::BOUNDARY));
 
-                // Increment number of vertices.
+            if (isVertex)
+            {
+                x[nVertices] = mesh.nodeX[nodes[i]];
+                y[nVertices] = mesh.nodeY[nodes[i]];
                 nVertices++;
             }
 
-            // Node is on the boundary.
-            else if (mesh.nodes[node].status & NodeStatus::BOUNDARY)
+            // The edge to the next node is cut by the boundary.
+            if ((status[i] | status[next]) == NodeStatus::CUT)
             {
-                // Next node.
-                unsigned int n1 = (i == 3) ? 0 : (i + 1);
-                n1 = element.nodes[n1];
-
-                // Previous node.
-                unsigned int n2 = (i == 0) ? 3 : (i - 1);
-                n2 = element.nodes[n2];
-
-                // Check that node isn't part of a boundary segment, i.e. both of its
-                // neighbours are inside the structure.
-                if ((mesh.nodes[n1].status & NodeStatus::INSIDE) &&
-                    (mesh.nodes[n2].status & NodeStatus::INSIDE))
-                {
-                    // Add coordinates to vertex array.
-                    vertices[nVertices].x = mesh.nodes[node].coord.x;
-                    vertices[nVertices].y = mesh.nodes[node].coord.y;
+                double d = field[nodes[i]] / (field[nodes[i]] - field[nodes[next]]);
 
-                    // Increment number of vertices.
-                    nVertices++;
-                }
+                x[nVertices] = mesh.nodeX[nodes[i]] + d*(double(mesh.nodeX[nodes[next]]) - mesh.nodeX[nodes[i]]);
+                y[nVertices] = mesh.nodeY[nodes[i]] + d*(double(mesh.nodeY[nodes[next]]) - mesh.nodeY[nodes[i]]);
+                nVertices++;
             }
         }
 
-        // Add boundary segment start and end points.
-        for (unsigned int i=0;i<element.nBoundarySegments;i++)
-        {
-            // Segment index.
-            unsigned int segment = element.boundarySegments[i];
-
-            // Add start point coordinates to vertices array.
-            vertices[nVertices].x = boundary.points[boundary.segments[segment].start].coord.x;
-            vertices[nVertices].y = boundary.points[boundary.segments[segment].start].coord.y;
-
-            // Increment number of vertices.
-            nVertices++;
-
-            // Add end point coordinates to vertices array.
-            vertices[nVertices].x = boundary.points[boundary.segments[segment].end].coord.x;
-            vertices[nVertices].y = boundary.points[boundary.segments[segment].end].coord.y;
-
-            // Increment number of vertices.
-            nVertices++;
-        }
-
-        // Return area of the polygon.
-        if (element.status & ElementStatus::CENTRE_OUTSIDE)
-            return (1.0 - polygonArea(vertices, nVertices, element.coord));
-        else
-            return polygonArea(vertices, nVertices, element.coord);
-    }
-
-    bool LevelSet::isClockwise(const Coord& point1, const Coord& point2, const Coord& centre) const
-    {
-        if ((point1.x - centre.x) >= 0 && (point2.x - centre.x) < 0)
-            return false;
-
-        if ((point1.x - centre.x) < 0 && (point2.x - centre.x) >= 0)
-            return true;
-
-        if ((point1.x - centre.x) == 0 && (point2.x - centre.x) == 0)
-        {
-            if ((point1.y - centre.y) >= 0 || (point2.y - centre.y) >= 0)
-                return (point1.y > point2.y) ? false : true;
-
-            return (point2.y > point1.y) ? false : true;
-        }
-
-        // Compute the cross product of the vectors (centre --> point1) x (centre --> point2).
-        double det = (point1.x - centre.x) * (point2.y - centre.y)
-                   - (point2.x - centre.x) * (point1.y - centre.y);
-
-        if (det < 0) return false;
-        else return true;
-
-        // Points are on the same line from the centre, check which point is
-        // closer to the centre.
-
-        double d1 = (point1.x - centre.x) * (point1.x - centre.x)
-                  + (point1.y - centre.y) * (point1.y - centre.y);
-
-        double d2 = (point2.x - centre.x) * (point2.x - centre.x)
-                  + (point2.y - centre.y) * (point2.y - centre.y);
-
-        return (d1 > d2) ? false : true;
-    }
-
-    double LevelSet::polygonArea(std::vector<Coord>& vertices, const unsigned int& nVertices, const Coord& centre) const
-    {
         double area = 0;
 
-        // Sort vertices in anticlockwise order.
-        std::sort(vertices.begin(), vertices.begin() + nVertices, std::bind(&LevelSet::isClockwise,
-            this, std::placeholders::_1, std::placeholders::_2, centre));
-
-        // Loop over all vertices.
+        // Shoelace formula (vertices are in anticlockwise order).
         for (unsigned int i=0;i<nVertices;i++)
         {
-            // Next point around (looping back to beginning).
             unsigned int j = (i == (nVertices - 1)) ? 0 : (i + 1);
-
-            area += vertices[i].x * vertices[j].y;
-            area -= vertices[j].x * vertices[i].y;
+            area += x[i]*y[j] - x[j]*y[i];
         }
 
-        area *= 0.5;
+        area = 0.5*std::abs(area);
 
-        return (std::abs(area));
+        if (isCentreOutside) return (1.0 - area);
+        else return area;
     }
 }
@@ -18,8 +18,12 @@
 #ifndef _LEVELSET_H
 #define _LEVELSET_H
 
+#include "ClosestPointExtension.h"
 #include "Common.h"
+#include "FastMarchingMethod.h"
 #include "Mesh.h"
+#include "ThreadPool.h"
+#include "WENOGradient.h"
 
 /*! \file LevelSet.h
     \brief A class for the level set function.
@@ -74,9 +78,13 @@ namespace slsm
 
             \param isFixedDomain_
                 Whether the domain boundary is fixed.
+
+            \param nodeOrdering
+                The numbering scheme for the mesh nodes.
          */
         LevelSet(unsigned int, unsigned int, double moveLimit_ = 0.5,
-            unsigned int bandWidth_ = 6, bool isFixedDomain_ = false);
+            unsigned int bandWidth_ = 6, bool isFixedDomain_ = false,
+            NodeOrdering::NodeOrdering nodeOrdering = NodeOrdering::ROW_MAJOR);
 
         //! Constructor.
         /*! \param width
@@ -96,9 +104,13 @@ namespace slsm
 
             \param isFixedDomain_
                 Whether the domain boundary is fixed.
+
+            \param nodeOrdering
+                The numbering scheme for the mesh nodes.
          */
         LevelSet(unsigned int, unsigned int, const std::vector<Hole>&, double moveLimit_ = 0.5,
-            unsigned int bandWidth_ = 6, bool isFixedDomain_ = false);
+            unsigned int bandWidth_ = 6, bool isFixedDomain_ = false,
+            NodeOrdering::NodeOrdering nodeOrdering = NodeOrdering::ROW_MAJOR);
 
         //! Constructor.
         /*! \param width
@@ -118,9 +130,13 @@ namespace slsm
 
             \param isFixedDomain_
                 Whether the domain boundary is fixed.
+
+            \param nodeOrdering
+                The numbering scheme for the mesh nodes.
          */
         LevelSet(unsigned int, unsigned int, const std::vector<Coord>&, double moveLimit_ = 0.5,
-            unsigned int bandWidth_ = 6, bool isFixedDomain_ = false);
+            unsigned int bandWidth_ = 6, bool isFixedDomain_ = false,
+            NodeOrdering::NodeOrdering nodeOrdering = NodeOrdering::ROW_MAJOR);
 
         //! Constructor.
         /*! \param width
@@ -143,9 +159,13 @@ namespace slsm
 
             \param isFixedDomain_
                 Whether the domain boundary is fixed.
+
+            \param nodeOrdering
+                The numbering scheme for the mesh nodes.
          */
         LevelSet(unsigned int, unsigned int, const std::vector<Hole>&, const std::vector<Hole>&,
-            double moveLimit_ = 0.5, unsigned int bandWidth_ = 6, bool isFixedDomain_ = false);
+            double moveLimit_ = 0.5, unsigned int bandWidth_ = 6, bool isFixedDomain_ = false,
+            NodeOrdering::NodeOrdering nodeOrdering = NodeOrdering::ROW_MAJOR);
 
         //! Constructor.
         /*! \param width
@@ -168,9 +188,13 @@ namespace slsm
 
             \param isFixedDomain_
                 Whether the domain boundary is fixed.
+
+            \param nodeOrdering
+                The numbering scheme for the mesh nodes.
          */
         LevelSet(unsigned int, unsigned int, const std::vector<Hole>&, const std::vector<Coord>&,
-            double moveLimit_ = 0.5, unsigned int bandWidth_ = 6, bool isFixedDomain_ = false);
+            double moveLimit_ = 0.5, unsigned int bandWidth_ = 6, bool isFixedDomain_ = false,
+            NodeOrdering::NodeOrdering nodeOrdering = NodeOrdering::ROW_MAJOR);
 
         //! Constructor.
         /*! \param width
@@ -193,18 +217,50 @@ namespace slsm
 
             \param isFixedDomain_
                 Whether the domain boundary is fixed.
+
+            \param nodeOrdering
+                The numbering scheme for the mesh nodes.
          */
         LevelSet(unsigned int, unsigned int, const std::vector<Coord>&, const std::vector<Coord>&,
-            double moveLimit_ = 0.5, unsigned int bandWidth_ = 6, bool isFixedDomain_ = false);
+            double moveLimit_ = 0.5, unsigned int bandWidth_ = 6, bool isFixedDomain_ = false,
+            NodeOrdering::NodeOrdering nodeOrdering = NodeOrdering::ROW_MAJOR);
 
         //! Update the level set function.
         /*! \param timeStep
                 The time step.
 
+            \param isReinitialise
+                Whether to reinitialise the signed distance function when the
+                boundary nears the edge of the narrow band. If false, this is
+                left to the caller, e.g. so that distributed ranks can agree.
+
+            \return
+                Whether the signed distance was (or needs to be) reinitialised.
+         */
+        bool update(double, bool isReinitialise = true);
+
+        //! Advance the level set by a single iteration. This fuses the stages of an
+        //! iteration, i.e. velocity extension, gradient computation, the update,
+        //! boundary discretisation, area fractions, and normal vectors, to reduce
+        //! the number of passes over memory.
+        /*! \param boundary
+                A reference to the discretised boundary. Boundary point
+                velocities are extended to the narrow band, then the boundary
+                is replaced by the discretisation of the updated level set.
+
+            \param timeStep
+                The time step.
+
+            \param isReinitialise
+                Whether to reinitialise the full signed distance function after
+                the update (default = false). The signed distance is always
+                reinitialised when the boundary nears the edge of the narrow band.
+
             \return
-                Whether the signed distance was reinitialised.
+                Whether the signed distance was reinitialised. The element area
+                fractions are stored in the mesh, and their total in area.
          */
-        bool update(double);
+        bool step(Boundary&, double, bool isReinitialise = false);
 
         //! Mask off a region of the domain.
         /*! param holes
@@ -219,7 +275,12 @@ namespace slsm
         void mask(const std::vector<Coord>&);
 
         //! Reinitialise the level set to a signed distance function.
-        void reinitialise();
+        /*! \param isBanded
+                Whether to restrict reinitialisation to the region around the
+                current narrow band (default = full domain). This requires that
+                the zero contour lies within the narrow band.
+         */
+        void reinitialise(bool isBanded = false);
 
         //! Extend boundary point velocities to the level set nodes.
         /*! \param boundaryPoints
@@ -227,6 +288,14 @@ namespace slsm
          */
         void computeVelocities(const std::vector<BoundaryPoint>&);
 
+        //! Extend boundary point velocities to the narrow band by projecting each
+        //! node onto the closest boundary segment. This is an alternative to the
+        //! fast marching extension that doesn't modify the signed distance function.
+        /*! \param boundary
+                A reference to the discretised boundary.
+         */
+        void computeVelocities(const Boundary&);
+
         //! Extend boundary point velocities to the level set nodes.
         /*! \param boundaryPoints
                 A reference to a vector of boundary points.
@@ -268,6 +337,17 @@ namespace slsm
         //! Compute the modulus of the gradient of the signed distance function.
         void computeGradients();
 
+        //! Initialise the narrow band region. Call this after assigning the
+        //! signed distance function directly, if it isn't reinitialised.
+        void initialiseNarrowBand();
+
+        //! Set the number of threads used for narrow band operations.
+        /*! \param nThreads
+                The number of threads. The result of each operation is
+                independent of the number of threads.
+         */
+        void setThreads(unsigned int);
+
         //! Calculate material area fraction enclosed by the discretised boundary.
         /*! \param boundary
                 A reference to the discretised boundary.
@@ -277,10 +357,31 @@ namespace slsm
          */
         double computeAreaFractions(const Boundary&);
 
-        std::vector<double> signedDistance;     //!< The nodal signed distance function (level set).
-        std::vector<double> velocity;           //!< The nodal normal velocity.
-        std::vector<double> gradient;           //!< The nodal gradient of the level set function (modulus).
-        std::vector<double> target;             //!< Signed distance target (for shape matching).
+        //! Compute Hamilton-Jacobi WENO gradient approximation.
+        /*! \param v1
+                The value of the function at the first stencil point.
+
+            \param v2
+                The value of the function at the second stencil point.
+
+            \param v3
+                The value of the function at the third stencil point.
+
+            \param v4
+                The value of the function at the fourth stencil point.
+
+            \param v5
+                The value of the function at the fifth stencil point.
+
+            \return
+                The smoothed function (gradient).
+         */
+        static double gradHJWENO(double, double, double, double, double);
+
+        std::vector<Real>   signedDistance;     //!< The nodal signed distance function (level set).
+        std::vector<Real>   velocity;           //!< The nodal normal velocity.
+        std::vector<Real>   gradient;           //!< The nodal gradient of the level set function (modulus).
+        std::vector<Real>   target;             //!< Signed distance target (for shape matching).
         std::vector<unsigned int> narrowBand;   //!< Indices of nodes in the narrow band.
         std::vector<unsigned int> mines;        //!< Indices of nodes at the edge of the narrow band.
         unsigned int nNarrowBand;               //!< The number of nodes in narrow band.
@@ -290,9 +391,28 @@ namespace slsm
         double area;                            //!< The total mesh area fraction enclosed by the boundary.
         Mesh mesh;                              //!< The fixed-grid mesh.
 
+        std::vector<char> isSignChanged;        //!< Whether each node may have changed status since the last discretisation.
+        const Boundary* discretisedBoundary;    //!< The boundary that was last discretised (null if none).
+        bool isTargetDiscretised;               //!< Whether the mesh status was last computed from the target signed distance.
+
     private:
         unsigned int bandWidth;                 //!< The width of the narrow band region.
         bool isFixedDomain;                     //!< Whether the domain boundary is fixed.
+        FastMarchingMethod fmm;                 //!< Persistent fast marching workspace.
+        ClosestPointExtension closestPoint;     //!< Closest point velocity extension.
+        WENOGradient wenoGradient;              //!< Vectorised gradient kernel.
+        ThreadPool threadPool;                  //!< Threads for narrow band operations.
+        std::vector<char> isMineTriggered;      //!< Whether a mine was triggered (for each thread).
+        std::vector<char> isVelocitySet;        //!< Whether the velocity at a node has been set (scratch).
+        std::vector<double> velocityWeight;     //!< Velocity interpolation weight for each node (scratch).
+        const Boundary* areaBoundary;           //!< The boundary that area fractions were last computed from (null if stale).
+        std::vector<unsigned int> cutElements;  //!< Elements that were cut by the boundary when area fractions were last computed.
+        std::vector<char> isElementChanged;     //!< Whether the area fraction of an element needs updating (scratch).
+        std::vector<unsigned int> changedElements;  //!< Elements whose area fraction needs updating (scratch).
+        std::vector<unsigned int> gradientNodes;    //!< Nodes at which the gradient was last computed by step.
+        std::vector<double> rowAreas;           //!< The area fraction enclosed within each row of elements (scratch).
+        std::vector<double> areaChanges;        //!< The change in area fraction of each updated element (scratch).
+        std::vector<std::vector<unsigned int> > threadCutElements;  //!< Cut elements found by each thread (scratch).
 
         //! Default initialisation of the level set function (Swiss cheese configuration).
         void initialise();
@@ -313,8 +433,51 @@ namespace slsm
         //! Initialises the level set function as the distance to the closest domain boundary.
         void closestDomainBoundary();
 
-        //! Initialise the narrow band region.
-        void initialiseNarrowBand();
+        //! Update the narrow band region using the nodes visited during
+        //! a banded reinitialisation.
+        void updateNarrowBand();
+
+        //! Update the level set function for a range of narrow band nodes.
+        /*! \param timeStep
+                The time step.
+
+            \param start
+                The first entry in the narrow band.
+
+            \param end
+                One past the last entry in the narrow band.
+
+            \return
+                Whether the boundary is within one grid spacing of a mine.
+         */
+        bool updateNodes(double, unsigned int, unsigned int);
+
+        //! Calculate the material area fraction of an element.
+        /*! \param element
+                The element index.
+
+            \return
+                The area fraction.
+         */
+        double computeAreaFraction(unsigned int) const;
+
+        //! Flag elements whose area fraction may have changed since it was last
+        //! computed, i.e. elements that were cut by the boundary, or that are
+        //! connected to a node that has changed status.
+        void flagChangedElements();
+
+        //! Update the material area fractions of the flagged elements.
+        /*! \param boundary
+                A reference to the discretised boundary.
+         */
+        void updateAreaFractions(const Boundary&);
+
+        //! Check whether a node lies in the narrow band, or is a mine, and
+        //! add it to the appropriate arrays.
+        /*! \param node
+                The index of the node.
+         */
+        void addToNarrowBand(unsigned int);
 
         //! Initialise velocities for boundary nodes.
         /*! \param boundaryPoints
@@ -331,27 +494,6 @@ namespace slsm
          */
         double computeGradient(const unsigned int) const;
 
-        //! Compute Hamilton-Jacobi WENO gradient approximation.
-        /*! \param v1
-                The value of the function at the first stencil point.
-
-            \param v2
-                The value of the function at the second stencil point.
-
-            \param v3
-                The value of the function at the third stencil point.
-
-            \param v4
-                The value of the function at the fourth stencil point.
-
-            \param v5
-                The value of the function at the fifth stencil point.
-
-            \return
-                The smoothed function (gradient).
-         */
-        double gradHJWENO(double, double, double, double, double) const;
-
         //! Compute the minimum distance between a point and a line segment.
         /*! \param vertex1
                 The coordinate of the first vertex.
@@ -397,46 +539,16 @@ namespace slsm
         int isLeftOfLine(const Coord&, const Coord&, const Coord&) const;
 
         //! Calculate the material area for an element cut by the boundary.
-        /*! \param element
-                A reference to the element.
+        /*! The area is computed in closed form from the polygon traced by
+            marching around the element edges.
 
-            \param boundary
-                A reference to the discretised boundary.
+            \param element
+                The element index.
 
             \return
                 The area fraction.
          */
-        double cutArea(const Element&, const Boundary&) const;
-
-        //! Whether a point is clockwise of another. The origin point is 12 o'clock.
-        /*! \param point1
-                The coordinates of the first point.
-
-            \param point2
-                The coordinates of the second point.
-
-            \param centre
-                The coordinates of the element centre.
-
-            \return
-                Whether the first point is clockwise of the second.
-         */
-        bool isClockwise(const Coord&, const Coord&, const Coord&) const;
-
-        //! Return the area of a polygon.
-        /*! \param vertices
-                A clockwise ordered vector of polygon vertices.
-
-            \param nVertices
-                The number of vertices.
-
-            \param centre
-                The coordinates of the element centre.
-
-            \return
-                The area of the polygon.
-         */
-        double polygonArea(std::vector<Coord>&, const unsigned int&, const Coord&) const;
+        double cutArea(unsigned int) const;
     };
 }
 
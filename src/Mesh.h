@@ -18,6 +18,7 @@
 #ifndef _MESH_H
 #define _MESH_H
 
+#include <algorithm>
 #include <vector>
 
 #include "Common.h"
@@ -69,32 +70,447 @@ namespace slsm
         };
     }
 
-    //! Structure containing attributes for an individual grid element.
+    //! The numbering scheme for mesh nodes.
+    namespace NodeOrdering
+    {
+        enum NodeOrdering
+        {
+            ROW_MAJOR       = 0,                    //!< Nodes are numbered row by row.
+            MORTON          = 1,                    //!< Nodes are numbered in Z-order within square blocks.
+            TILED           = 2,                    //!< Nodes are numbered row by row within square blocks.
+        };
+    }
+
+    //! Insert a zero bit above each group of bits in an integer (one step of interleaveBits).
+    /*! \param x
+            The integer.
+
+        \param shift
+            The size of the groups of bits.
+
+        \param mask
+            The mask for the bits that remain after the groups are spread.
+
+        \return
+            The spread integer.
+     */
+    constexpr unsigned int spreadBits(unsigned int x, unsigned int shift, unsigned int mask)
+    {
+        return (x | (x << shift)) & mask;
+    }
+
+    //! Spread the lower 16 bits of an integer so that they occupy the even bits.
+    /*! \param x
+            The integer.
+
+        \return
+            The integer with a zero bit inserted above each of its bits.
+     */
+    constexpr unsigned int interleaveBits(unsigned int x)
+    {
+        return spreadBits(spreadBits(spreadBits(spreadBits(x & 0xffff,
+            8, 0x00ff00ff), 4, 0x0f0f0f0f), 2, 0x33333333), 1, 0x55555555);
+    }
+
+    //! Return the Z-order (Morton) index of a point on a grid.
+    /*! \param x
+            The x coordinate (less than 2^16).
+
+        \param y
+            The y coordinate (less than 2^16).
+
+        \return
+            The Morton index (x and y bits interleaved, starting with x).
+     */
+    constexpr unsigned int mortonIndex(unsigned int x, unsigned int y)
+    {
+        return interleaveBits(x) | (interleaveBits(y) << 1);
+    }
+
+    //! Return the row-major index of a point on a grid.
+    /*! \param x
+            The x coordinate.
+
+        \param y
+            The y coordinate.
+
+        \param nx
+            The number of points in each row.
+
+        \return
+            The row-major index.
+     */
+    constexpr unsigned int rowMajorIndex(unsigned int x, unsigned int y, unsigned int nx)
+    {
+        return x + y*nx;
+    }
+
+    //! Bit flags for the packed node attributes.
+    namespace NodeFlag
+    {
+        enum NodeFlag
+        {
+            NONE            = 0,                    //!< No flags.
+            ACTIVE          = (1 << 0),             //!< Node is active (part of narrow band, and not fixed).
+            DOMAIN          = (1 << 1),             //!< Node lies on the domain boundary.
+            MASKED          = (1 << 2),             //!< Node lies in a masked region.
+            MINE            = (1 << 3),             //!< Node lies on the edge of the narrow band.
+            STATUS          = (7 << 4),             //!< Bits holding the NodeStatus of the node.
+        };
+    }
+
+    //! \brief A reference to a bit field within a packed byte.
+    /*! The field is read and written as type T, which must be convertible
+        to and from an integer. This allows packed flags to be used in place
+        of plain bool or enum data members.
+     */
+    template <typename T>
+    class FieldRef
+    {
+    public:
+        //! Constructor.
+        /*! \param byte_
+                A reference to the byte that holds the field.
+
+            \param mask_
+                The bit mask of the field.
+
+            \param shift_
+                The position of the lowest bit of the field.
+         */
+        FieldRef(unsigned char& byte_, unsigned char mask_, unsigned char shift_) :
+            byte(byte_), mask(mask_), shift(shift_) {}
+
+        //! Read the value of the field.
+        operator T() const { return static_cast<T>((byte & mask) >> shift); }
+
+        //! Write the value of the field.
+        FieldRef& operator=(T value)
+        {
+            byte = (byte & ~mask) | ((static_cast<unsigned int>(value) << shift) & mask);
+            return *this;
+        }
+
+        //! Copy the value of another field.
+        FieldRef& operator=(const FieldRef& field) { return *this = T(field); }
+
+    private:
+        unsigned char& byte;        //!< The byte that holds the field.
+        const unsigned char mask;   //!< The bit mask of the field.
+        const unsigned char shift;  //!< The position of the lowest bit of the field.
+    };
+
+    // STORAGE CLASS
+
+    /*! \brief Compact structure-of-arrays storage for the fixed-grid mesh.
+
+        Node and element attributes are held in flat arrays, one entry per node
+        (or element), rather than in an array of structures. Connectivity isn't
+        stored at all: it is derived from the (x, y) position of a node or
+        element whenever it is needed. Node flags and status are packed into a
+        single byte per node (see NodeFlag).
+
+        Elements are numbered x + y * width. By default nodes are numbered in
+        the same way, i.e. x + y * (width + 1), but they can instead be stored
+        in square blocks (see NodeOrdering) to improve the locality of operations
+        on neighbouring nodes, such as stencils that reach several rows above
+        and below a node. The mesh is divided into blocks of nodes that are
+        numbered row by row. Nodes within a block are numbered in Z-order
+        (MORTON) or row by row (TILED). Nodes in the incomplete blocks along the
+        top and right edges of the mesh are always numbered row by row. Use
+        xyToIndex to convert coordinates to a node index, rather than assuming
+        a layout.
+     */
+    class CompactMesh
+    {
+    public:
+        //! Constructor.
+        /*! \param width_
+                The width of the mesh.
+
+            \param height_
+                The height of the mesh.
+
+            \param ordering_
+                The numbering scheme for the nodes.
+         */
+        CompactMesh(unsigned int, unsigned int,
+            NodeOrdering::NodeOrdering ordering_ = NodeOrdering::ROW_MAJOR);
+
+        //! Return the index of the node at a given position.
+        /*! \param x
+                The x coordinate of the node.
+
+            \param y
+                The y coordinate of the node.
+
+            \return
+                The node index.
+         */
+        unsigned int xyToIndex(unsigned int, unsigned int) const;
+
+        //! Return the index of the node at a given position (block numbering).
+        /*! \param x
+                The x coordinate of the node.
+
+            \param y
+                The y coordinate of the node.
+
+            \return
+                The node index.
+         */
+        unsigned int blockIndex(unsigned int, unsigned int) const;
+
+        //! Return a nearest neighbour of a node.
+        /*! \param node
+                The node index.
+
+            \param direction
+                The direction of the neighbour (left, right, down, up).
+
+            \return
+                The index of the neighbour (nNodes if it lies outside the mesh).
+         */
+        unsigned int getNeighbour(unsigned int, unsigned int) const;
+
+        //! Return a corner node of an element.
+        /*! \param element
+                The element index.
+
+            \param corner
+                The corner (bottom left, bottom right, top right, top left).
+
+            \return
+                The index of the node.
+         */
+        unsigned int getElementNode(unsigned int, unsigned int) const;
+
+        //! Find the four corner nodes of an element.
+        /*! \param element
+                The element index.
+
+            \param nodes
+                An array (of length four) for the indices of the nodes
+                (bottom left, bottom right, top right, top left).
+         */
+        void getElementNodes(unsigned int, unsigned int*) const;
+
+        //! Find the elements that a node is connected to.
+        /*! \param node
+                The node index.
+
+            \param elements
+                An array (of length four) for the indices of the elements,
+                in ascending order.
+
+            \return
+                The number of elements that the node is connected to.
+         */
+        unsigned int getNodeElements(unsigned int, unsigned int*) const;
+
+        const unsigned int width;       //!< The grid width (number of elements in x).
+        const unsigned int height;      //!< The grid height (number of elements in y).
+        const unsigned int nElements;   //!< The total number of grid elements.
+        const unsigned int nNodes;      //!< The total number of nodes.
+
+        /// The numbering scheme for the nodes.
+        const NodeOrdering::NodeOrdering ordering;
+
+        /// The size of the blocks of nodes for block orderings (a power of two).
+        const unsigned int blockSize;
+
+        /// The x coordinate of each node (integer, since nodes lie on the grid).
+        std::vector<unsigned int> nodeX;
+
+        /// The y coordinate of each node (integer, since nodes lie on the grid).
+        std::vector<unsigned int> nodeY;
+
+        /// The packed flags of each node (a combination of NodeFlag values).
+        std::vector<unsigned char> nodeFlags;
+
+        /// The material area fraction of each element.
+        std::vector<double> elementArea;
+
+        /// The status of each element (an ElementStatus value).
+        std::vector<unsigned char> elementStatus;
+
+        /// Indices for the boundary segments associated with each element (two per element).
+        std::vector<unsigned int> elementSegments;
+
+        /// The number of boundary segments associated with each element.
+        std::vector<unsigned char> nElementSegments;
+    };
+
+    // ADAPTER TYPES
+
+    //! \brief An array-like view of the nearest neighbours of a node.
+    class NodeNeighbours
+    {
+    public:
+        //! Constructor.
+        /*! \param mesh_
+                A reference to the mesh storage.
+
+            \param node_
+                The node index.
+         */
+        NodeNeighbours(const CompactMesh& mesh_, unsigned int node_) : mesh(mesh_), node(node_) {}
+
+        //! Return the neighbour in a given direction (left, right, down, up).
+        unsigned int operator[](unsigned int direction) const { return mesh.getNeighbour(node, direction); }
+
+    private:
+        const CompactMesh& mesh;    //!< A reference to the mesh storage.
+        unsigned int node;          //!< The node index.
+    };
+
+    //! \brief An array-like view of the elements that a node is connected to.
+    class NodeElements
+    {
+    public:
+        //! Constructor.
+        /*! \param mesh_
+                A reference to the mesh storage.
+
+            \param node_
+                The node index.
+         */
+        NodeElements(const CompactMesh& mesh_, unsigned int node_) : mesh(mesh_), node(node_) {}
+
+        //! Return the i-th element (in ascending order).
+        unsigned int operator[](unsigned int i) const
+        {
+            unsigned int elements[4] = {0, 0, 0, 0};
+            mesh.getNodeElements(node, elements);
+            return elements[i];
+        }
+
+    private:
+        const CompactMesh& mesh;    //!< A reference to the mesh storage.
+        unsigned int node;          //!< The node index.
+    };
+
+    //! \brief An array-like view of the nodes of an element.
+    class ElementNodes
+    {
+    public:
+        //! Constructor.
+        /*! \param mesh_
+                A reference to the mesh storage.
+
+            \param element_
+                The element index.
+         */
+        ElementNodes(const CompactMesh& mesh_, unsigned int element_) : mesh(mesh_), element(element_) {}
+
+        //! Return the node at a given corner (bottom left, bottom right, top right, top left).
+        unsigned int operator[](unsigned int corner) const { return mesh.getElementNode(element, corner); }
+
+    private:
+        const CompactMesh& mesh;    //!< A reference to the mesh storage.
+        unsigned int element;       //!< The element index.
+    };
+
+    /*! \brief A reference to the attributes of an individual grid element.
+
+        This is a lightweight view of the element data held by CompactMesh.
+        Writing to the area, status, or boundary segment data modifies the
+        mesh. Connectivity is computed on access, and the centre coordinate
+        on construction.
+     */
     struct Element
     {
         //! Constructor.
-        Element();
+        /*! \param mesh
+                A reference to the mesh storage.
+
+            \param element
+                The element index.
+         */
+        Element(CompactMesh&, unsigned int);
+
+        Coord coord;                                //!< Element coordinate (centre).
+        double& area;                               //!< Material area fraction.
+        ElementNodes nodes;                         //!< Indices for nodes of the element.
+        unsigned int* boundarySegments;             //!< Indices for boundary segments associated with the element.
+        unsigned char& nBoundarySegments;           //!< The number of boundary segments associated with the element.
+        FieldRef<ElementStatus::ElementStatus> status;  //!< Whether the element (or its centre) lies inside or outside the structure.
+    };
+
+    /*! \brief A read-only copy of the attributes of an individual element.
+
+        This is returned when accessing the elements of a const mesh. The area,
+        boundary segments, and status are copied on construction, so they
+        can't be used to modify the mesh.
+     */
+    struct ConstElement
+    {
+        //! Constructor.
+        /*! \param mesh
+                A reference to the mesh storage.
+
+            \param element
+                The element index.
+         */
+        ConstElement(const CompactMesh&, unsigned int);
 
         Coord coord;                                //!< Element coordinate (centre).
         double area;                                //!< Material area fraction.
-        std::vector<unsigned int> nodes;            //!< Indices for nodes of the element.
-        std::vector<unsigned int> boundarySegments; //!< Indices for boundary segments associated with the element.
+        ElementNodes nodes;                         //!< Indices for nodes of the element.
+        unsigned int boundarySegments[2];           //!< Indices for boundary segments associated with the element.
         unsigned int nBoundarySegments;             //!< The number of boundary segments associated with the element.
         ElementStatus::ElementStatus status;        //!< Whether the element (or its centre) lies inside or outside the structure.
     };
 
-    //! Structure containing attributes for an individual grid node.
+    /*! \brief A reference to the attributes of an individual grid node.
+
+        This is a lightweight view of the node data held by CompactMesh.
+        Writing to the flags or status modifies the mesh. Connectivity is
+        computed on access, and the remaining members on construction.
+     */
     struct Node
     {
         //! Constructor.
-        Node();
+        /*! \param mesh
+                A reference to the mesh storage.
+
+            \param node
+                The node index.
+         */
+        Node(CompactMesh&, unsigned int);
 
         Coord coord;                                //!< Node coordinate.
-        std::vector<unsigned int> neighbours;       //!< Indices of nearest neighbour nodes.
-        std::vector<unsigned int> elements;         //!< Indices of elements the node is connected to.
+        NodeNeighbours neighbours;                  //!< Indices of nearest neighbour nodes.
+        NodeElements elements;                      //!< Indices of elements the node is connected to.
+        unsigned int nElements;                     //!< Number of elements that the node is connected to.
+        FieldRef<bool> isActive;                    //!< Whether the node is active (part of narrow band, and not fixed).
+        FieldRef<bool> isDomain;                    //!< Whether the node lies on the domain boundary.
+        FieldRef<bool> isMasked;                    //!< Whether the node lies in a masked region.
+        FieldRef<bool> isMine;                      //!< Whether the node lies on the edge of the narrow band.
+        FieldRef<NodeStatus::NodeStatus> status;    //!< Whether node is outside, inside, or on the boundary.
+    };
+
+    /*! \brief A read-only copy of the attributes of an individual grid node.
+
+        This is returned when accessing the nodes of a const mesh. The flags
+        and status are copied on construction, so they can't be used to modify
+        the mesh.
+     */
+    struct ConstNode
+    {
+        //! Constructor.
+        /*! \param mesh
+                A reference to the mesh storage.
+
+            \param node
+                The node index.
+         */
+        ConstNode(const CompactMesh&, unsigned int);
+
+        Coord coord;                                //!< Node coordinate.
+        NodeNeighbours neighbours;                  //!< Indices of nearest neighbour nodes.
+        NodeElements elements;                      //!< Indices of elements the node is connected to.
         unsigned int nElements;                     //!< Number of elements that the node is connected to.
-        std::vector<unsigned int> boundaryPoints;   //!< Indices of boundary points associated with the node.
-        unsigned int nBoundaryPoints;               //!< The number of boundary points associated with the node.
         bool isActive;                              //!< Whether the node is active (part of narrow band, and not fixed).
         bool isDomain;                              //!< Whether the node lies on the domain boundary.
         bool isMasked;                              //!< Whether the node lies in a masked region.
@@ -102,6 +518,52 @@ namespace slsm
         NodeStatus::NodeStatus status;              //!< Whether node is outside, inside, or on the boundary.
     };
 
+    //! \brief An array-like view of the mesh elements.
+    class ElementArray
+    {
+    public:
+        //! Constructor.
+        /*! \param mesh_
+                A reference to the mesh storage.
+         */
+        ElementArray(CompactMesh& mesh_) : mesh(&mesh_) {}
+
+        //! Access an element.
+        Element operator[](unsigned int element) { return Element(*mesh, element); }
+
+        //! Access an element (read only).
+        ConstElement operator[](unsigned int element) const { return ConstElement(*mesh, element); }
+
+        //! Return the number of elements.
+        unsigned int size() const { return mesh->nElements; }
+
+    private:
+        CompactMesh* mesh;          //!< A pointer to the mesh storage.
+    };
+
+    //! \brief An array-like view of the mesh nodes.
+    class NodeArray
+    {
+    public:
+        //! Constructor.
+        /*! \param mesh_
+                A reference to the mesh storage.
+         */
+        NodeArray(CompactMesh& mesh_) : mesh(&mesh_) {}
+
+        //! Access a node.
+        Node operator[](unsigned int node) { return Node(*mesh, node); }
+
+        //! Access a node (read only).
+        ConstNode operator[](unsigned int node) const { return ConstNode(*mesh, node); }
+
+        //! Return the number of nodes.
+        unsigned int size() const { return mesh->nNodes; }
+
+    private:
+        CompactMesh* mesh;          //!< A pointer to the mesh storage.
+    };
+
     // MAIN CLASS
 
     /*! \brief A class for the level-set domain fixed-grid mesh.
@@ -127,12 +589,19 @@ namespace slsm
         given the value nNodes, i.e. one past the end of the node array, which
         runs from 0 to nNodes - 1.
 
+        Data is held in the compact storage of the CompactMesh base class. The
+        nodes and elements members are adapters that present this data as an
+        array of Node and Element structures, so nodes[i].isActive and the like
+        behave as before. The storage arrays and connectivity functions of the
+        base class can be used directly where the overhead of assembling a
+        complete Node or Element matters.
+
         Note that this mesh is store information related to the nodes and
         elements of the level-set domain and is not related to the mesh used
         in finite element calculations (which may be a different geometry or
         resolution).
      */
-    class Mesh
+    class Mesh : public CompactMesh
     {
     public:
         //! Constructor.
@@ -141,8 +610,18 @@ namespace slsm
 
             \param height_
                 The height of the mesh.
+
+            \param ordering_
+                The numbering scheme for the nodes.
          */
-        Mesh(unsigned int, unsigned int);
+        Mesh(unsigned int, unsigned int,
+            NodeOrdering::NodeOrdering ordering_ = NodeOrdering::ROW_MAJOR);
+
+        //! Copy constructor.
+        /*! \param mesh
+                A reference to the mesh to copy.
+         */
+        Mesh(const Mesh&);
 
         //! For a given x-y coordinate, find the index of the closest node.
         /*! \param point
@@ -186,36 +665,197 @@ namespace slsm
          */
         unsigned int getElement(double, double) const;
 
-        std::vector<Element> elements;  //!< Fixed-grid elements (cells).
-        std::vector<Node> nodes;        //!< Fixed-grid nodes.
+        ElementArray elements;          //!< Fixed-grid elements (cells).
+        NodeArray nodes;                //!< Fixed-grid nodes.
+    };
 
-        const unsigned int width;       //!< The grid width (number of elements in x).
-        const unsigned int height;      //!< The grid height (number of elements in y).
-        const unsigned int nElements;   //!< The total number of grid elements.
-        const unsigned int nNodes;      //!< The total number of nodes.
+    // INLINE DEFINITIONS
 
-        /// Mapping between (x, y) coordinates and one dimensional nodes indices.
-        std::vector<std::vector<unsigned int> > xyToIndex;
+    /* These are called from the inner loops of the level set and boundary
+       code, so are defined here to allow the compiler to discard any parts
+       of a Node or Element that aren't used.
+     */
 
-    private:
-        //! Initialise mesh nodes.
-        void initialiseNodes();
+    inline unsigned int CompactMesh::blockIndex(unsigned int x, unsigned int y) const
+    {
+        // Position of the block, and of the node within it.
+        unsigned int mask = blockSize - 1;
+        unsigned int blockX = x & ~mask;
+        unsigned int blockY = y & ~mask;
+
+        // Size of the block (smaller along the top and right edges).
+        unsigned int blockWidth  = std::min(blockSize, width + 1 - blockX);
+        unsigned int blockHeight = std::min(blockSize, height + 1 - blockY);
+
+        // Index of the first node in the block: all nodes in the rows of blocks
+        // below, plus the blocks to the left in the same row.
+        unsigned int first = blockY*(width + 1) + blockX*blockHeight;
+
+        if ((ordering == NodeOrdering::MORTON) && (blockWidth == blockSize) && (blockHeight == blockSize))
+            return first + mortonIndex(x & mask, y & mask);
+        else
+            return first + rowMajorIndex(x & mask, y & mask, blockWidth);
+    }
 
-        //! Initialise mesh elements.
-        void initialiseElements();
+    inline unsigned int CompactMesh::xyToIndex(unsigned int x, unsigned int y) const
+    {
+        if (ordering == NodeOrdering::ROW_MAJOR) return rowMajorIndex(x, y, width + 1);
+        else return blockIndex(x, y);
+    }
 
-        //! Compute the nearest neighbours of a node.
-        /*! \param node
-                The node index.
+    inline unsigned int CompactMesh::getNeighbour(unsigned int node, unsigned int direction) const
+    {
+        if (ordering == NodeOrdering::ROW_MAJOR)
+        {
+            switch (direction)
+            {
+                case 0:  return (nodeX[node] > 0) ? node - 1 : nNodes;
+                case 1:  return (nodeX[node] < width) ? node + 1 : nNodes;
+                case 2:  return (nodeY[node] > 0) ? node - (width + 1) : nNodes;
+                default: return (nodeY[node] < height) ? node + (width + 1) : nNodes;
+            }
+        }
+
+        unsigned int x = nodeX[node];
+        unsigned int y = nodeY[node];
+
+        switch (direction)
+        {
+            case 0:  return (x > 0) ? xyToIndex(x - 1, y) : nNodes;
+            case 1:  return (x < width) ? xyToIndex(x + 1, y) : nNodes;
+            case 2:  return (y > 0) ? xyToIndex(x, y - 1) : nNodes;
+            default: return (y < height) ? xyToIndex(x, y + 1) : nNodes;
+        }
+    }
 
-            \param x
-                The x coordinate of the node.
+    inline unsigned int CompactMesh::getElementNode(unsigned int element, unsigned int corner) const
+    {
+        // Position of the element (and its bottom left node).
+        unsigned int y = element / width;
+        unsigned int x = element - y*width;
 
-            \param y
-                The y coordinate of the node.
-         */
-        void initialiseNeighbours(unsigned int, unsigned int, unsigned int);
-    };
+        if ((corner == 1) || (corner == 2)) x++;
+        if (corner > 1) y++;
+
+        if (ordering == NodeOrdering::ROW_MAJOR) return rowMajorIndex(x, y, width + 1);
+        else return blockIndex(x, y);
+    }
+
+    inline void CompactMesh::getElementNodes(unsigned int element, unsigned int* nodes) const
+    {
+        // Position of the element (and its bottom left node).
+        unsigned int y = element / width;
+        unsigned int x = element - y*width;
+
+        if (ordering == NodeOrdering::ROW_MAJOR)
+        {
+            nodes[0] = rowMajorIndex(x, y, width + 1);
+            nodes[1] = nodes[0] + 1;
+            nodes[3] = nodes[0] + width + 1;
+            nodes[2] = nodes[3] + 1;
+            return;
+        }
+
+        // For tiles, the nodes usually lie within the same block.
+        unsigned int mask = blockSize - 1;
+        if ((ordering == NodeOrdering::TILED) && ((x & mask) != mask) && ((y & mask) != mask))
+        {
+            unsigned int blockWidth = std::min(blockSize, width + 1 - (x & ~mask));
+
+            nodes[0] = blockIndex(x, y);
+            nodes[1] = nodes[0] + 1;
+            nodes[3] = nodes[0] + blockWidth;
+            nodes[2] = nodes[3] + 1;
+        }
+        else
+        {
+            nodes[0] = blockIndex(x, y);
+            nodes[1] = blockIndex(x + 1, y);
+            nodes[2] = blockIndex(x + 1, y + 1);
+            nodes[3] = blockIndex(x, y + 1);
+        }
+    }
+
+    inline unsigned int CompactMesh::getNodeElements(unsigned int node, unsigned int* elements) const
+    {
+        unsigned int x = nodeX[node];
+        unsigned int y = nodeY[node];
+        unsigned int n = 0;
+
+        // Elements below the node.
+        if (y > 0)
+        {
+            if (x > 0) elements[n++] = (x - 1) + (y - 1) * width;
+            if (x < width) elements[n++] = x + (y - 1) * width;
+        }
+
+        // Elements above the node.
+        if (y < height)
+        {
+            if (x > 0) elements[n++] = (x - 1) + y * width;
+            if (x < width) elements[n++] = x + y * width;
+        }
+
+        return n;
+    }
+
+    inline Element::Element(CompactMesh& mesh, unsigned int element) :
+        area(mesh.elementArea[element]),
+        nodes(mesh, element),
+        boundarySegments(&mesh.elementSegments[2*element]),
+        nBoundarySegments(mesh.nElementSegments[element]),
+        status(mesh.elementStatus[element], 0xff, 0)
+    {
+        unsigned int y = element / mesh.width;
+
+        coord.x = (element - y*mesh.width) + 0.5;
+        coord.y = y + 0.5;
+    }
+
+    inline ConstElement::ConstElement(const CompactMesh& mesh, unsigned int element) :
+        area(mesh.elementArea[element]),
+        nodes(mesh, element),
+        nBoundarySegments(mesh.nElementSegments[element]),
+        status(static_cast<ElementStatus::ElementStatus>(mesh.elementStatus[element]))
+    {
+        boundarySegments[0] = mesh.elementSegments[2*element];
+        boundarySegments[1] = mesh.elementSegments[2*element + 1];
+
+        unsigned int y = element / mesh.width;
+
+        coord.x = (element - y*mesh.width) + 0.5;
+        coord.y = y + 0.5;
+    }
+
+    inline Node::Node(CompactMesh& mesh, unsigned int node) :
+        coord(mesh.nodeX[node], mesh.nodeY[node]),
+        neighbours(mesh, node),
+        elements(mesh, node),
+        isActive(mesh.nodeFlags[node], NodeFlag::ACTIVE, 0),
+        isDomain(mesh.nodeFlags[node], NodeFlag::DOMAIN, 1),
+        isMasked(mesh.nodeFlags[node], NodeFlag::MASKED, 2),
+        isMine(mesh.nodeFlags[node], NodeFlag::MINE, 3),
+        status(mesh.nodeFlags[node], NodeFlag::STATUS, 4)
+    {
+        // Nodes on an edge of the mesh have half the number of elements in
+        // that direction.
+        nElements = ((coord.x > 0) && (coord.x < mesh.width)) ? 2 : 1;
+        if ((coord.y > 0) && (coord.y < mesh.height)) nElements *= 2;
+    }
+
+    inline ConstNode::ConstNode(const CompactMesh& mesh, unsigned int node) :
+        coord(mesh.nodeX[node], mesh.nodeY[node]),
+        neighbours(mesh, node),
+        elements(mesh, node),
+        isActive(mesh.nodeFlags[node] & NodeFlag::ACTIVE),
+        isDomain(mesh.nodeFlags[node] & NodeFlag::DOMAIN),
+        isMasked(mesh.nodeFlags[node] & NodeFlag::MASKED),
+        isMine(mesh.nodeFlags[node] & NodeFlag::MINE),
+        status(static_cast<NodeStatus::NodeStatus>((mesh.nodeFlags[node] & NodeFlag::STATUS) >> 4))
+    {
+        nElements = ((coord.x > 0) && (coord.x < mesh.width)) ? 2 : 1;
+        if ((coord.y > 0) && (coord.y < mesh.height)) nElements *= 2;
+    }
 }
 
 #endif  /* _MESH_H */
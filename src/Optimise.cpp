@@ -16,7 +16,9 @@
 */
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <numeric>
 
 #include "Boundary.h"
@@ -29,6 +31,32 @@
 
 namespace slsm
 {
+    const unsigned int Optimise::blockSize;
+
+    //! Sum the element-wise product of three arrays.
+    //! Separate partial sums are kept for each lane, so that the loop can be
+    //! vectorised without reordering the floating point additions, i.e. the
+    //! result is the same whether or not the loop is vectorised.
+    static double productSum(unsigned int n, const double* __restrict__ a,
+        const double* __restrict__ b, const double* __restrict__ c)
+    {
+        const unsigned int nLanes = 4;
+
+        double lanes[nLanes] = {0, 0, 0, 0};
+
+        // The number of points in complete groups of lanes.
+        unsigned int nGrouped = n - (n % nLanes);
+
+        for (unsigned int i=0;i<nGrouped;i+=nLanes)
+            for (unsigned int j=0;j<nLanes;j++)
+                lanes[j] += a[i+j] * b[i+j] * c[i+j];
+
+        for (unsigned int i=nGrouped;i<n;i++)
+            lanes[i - nGrouped] += a[i] * b[i] * c[i];
+
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
     double callbackWrapper(const std::vector<double>& lambda, std::vector<double>& gradient, void* data)
     {
         NLoptWrapper* wrapperData = reinterpret_cast<NLoptWrapper*>(data);
@@ -42,19 +70,25 @@ namespace slsm
                        double maxDisplacement_,
                        bool isMax_,
                        const std::vector<bool>& isEquality_,
-					   nlopt::algorithm algorithm_) :
-                       boundaryPoints(boundaryPoints_),
+                       nlopt::algorithm algorithm_,
+                       Communicator* communicator_) :
+                       boundaryPoints(&boundaryPoints_),
                        constraintDistances(constraintDistances_),
                        lambdas(lambdas_),
                        timeStep(timeStep_),
                        maxDisplacement(maxDisplacement_),
                        isMax(isMax_),
                        isEquality(isEquality_),
-                       algorithm(algorithm_)
+                       algorithm(algorithm_),
+                       solver(Solver::NLOPT),
+                       optDimension(0),
+                       communicator(communicator_)
     {
         errno = EINVAL;
         slsm_check(((maxDisplacement > 0) && (maxDisplacement_ < 1)), "Move limit must be between 0 and 1.");
-        slsm_check(boundaryPoints.size() > 0, "There are no boundary points.");
+
+        // For a distributed level set, some ranks may not have any boundary points.
+        slsm_check(reduce(boundaryPoints->size(), ReduceOp::SUM) > 0, "There are no boundary points.");
 
         // Store the initial number of constraints.
         nConstraints = lambdas.size() - 1;
@@ -76,12 +110,30 @@ namespace slsm
         // Set default as inequality constraints.
         if (isEquality.size() == 0) isEquality.resize(nConstraints, false);
 
+        // Store the initial constraint types.
+        isEqualityInitial = isEquality;
+
         return;
 
     error:
         exit(EXIT_FAILURE);
     }
 
+    Optimise::Optimise(std::vector<BoundaryPoint>& boundaryPoints_,
+                       std::vector<double> constraintDistances_,
+                       std::vector<double>& lambdas_,
+                       double& timeStep_,
+                       double maxDisplacement_,
+                       bool isMax_,
+                       const std::vector<bool>& isEquality_,
+                       Solver::Solver solver_,
+                       Communicator* communicator_) :
+                       Optimise(boundaryPoints_, constraintDistances_, lambdas_, timeStep_,
+                           maxDisplacement_, isMax_, isEquality_, nlopt::LD_SLSQP, communicator_)
+    {
+        solver = solver_;
+    }
+
 #ifdef PYBIND
     Optimise::Optimise(std::vector<BoundaryPoint>& boundaryPoints_,
                        std::vector<double> constraintDistances_,
@@ -90,18 +142,21 @@ namespace slsm
                        double maxDisplacement_,
                        bool isMax_,
                        const std::vector<bool>& isEquality_) :
-                       boundaryPoints(boundaryPoints_),
+                       boundaryPoints(&boundaryPoints_),
                        constraintDistances(constraintDistances_),
                        lambdas(lambdas_),
                        timeStep(timeStep_.value),
                        maxDisplacement(maxDisplacement_),
                        isMax(isMax_),
                        isEquality(isEquality_),
-                       algorithm(nlopt::LD_SLSQP)
+                       algorithm(nlopt::LD_SLSQP),
+                       solver(Solver::NLOPT),
+                       optDimension(0),
+                       communicator(nullptr)
     {
         errno = EINVAL;
         slsm_check(((maxDisplacement > 0) && (maxDisplacement_ < 1)), "Move limit must be between 0 and 1.");
-        slsm_check(boundaryPoints.size() > 0, "There are no boundary points.");
+        slsm_check(boundaryPoints->size() > 0, "There are no boundary points.");
 
         // Store the initial number of constraints.
         nConstraints = lambdas.size() - 1;
@@ -123,6 +178,9 @@ namespace slsm
         // Set default as inequality constraints.
         if (isEquality.size() == 0) isEquality.resize(nConstraints, false);
 
+        // Store the initial constraint types.
+        isEqualityInitial = isEquality;
+
         return;
 
     error:
@@ -130,24 +188,81 @@ namespace slsm
     }
 #endif
 
+    void Optimise::reset(std::vector<BoundaryPoint>& boundaryPoints_,
+                         const std::vector<double>& constraintDistances_)
+    {
+        /* Inactive constraints are removed from the working data during a
+           solve, so the data for the initial set of constraints is restored
+           here. Vectors are assigned or resized in place, so their memory is
+           retained between iterations.
+         */
+
+        errno = EINVAL;
+        slsm_check(reduce(boundaryPoints_.size(), ReduceOp::SUM) > 0, "There are no boundary points.");
+        slsm_check(nConstraintsInitial == constraintDistances_.size(), "Incorrect number of constraints.");
+        slsm_check(nConstraintsInitial == (lambdas.size() - 1), "Incorrect number of lambda values.");
+
+        boundaryPoints = &boundaryPoints_;
+
+        // Restore the initial number of constraints.
+        nConstraints = nConstraintsInitial;
+
+        // Copy constraint distances.
+        constraintDistances = constraintDistances_;
+        constraintDistancesScaled = constraintDistances;
+
+        // Restore the constraint types.
+        isEquality = isEqualityInitial;
+
+        // Resize data structures.
+        negativeLambdaLimits.resize(nConstraints + 1);
+        positiveLambdaLimits.resize(nConstraints + 1);
+        scaleFactors.resize(nConstraints + 1);
+
+        return;
+
+    error:
+        exit(EXIT_FAILURE);
+    }
+
     double Optimise::callback(const std::vector<double>& lambda, std::vector<double>& gradient, unsigned int index)
     {
-        // Calculate the boundary displacement vector.
-        computeDisplacements(lambda);
+        /* Away from the side limits, the change in each function is linear in
+           the lambda values, with coefficients given by the Gram matrix of
+           sensitivity products. Points that are clamped by a side limit are
+           corrected for individually, so an evaluation doesn't depend on the
+           total number of boundary points.
+         */
+
+        // The objective and constraints are evaluated at the same lambda values,
+        // so the corrections are only updated when the lambda values change.
+        if (lambda != correctionLambda) computeCorrections(lambda);
 
         // Compute the gradients.
         if (!gradient.empty())
             gradient = gradients[index];
 
-        // Return the function value.
-        return computeFunction(index);
+        // Offset of the Gram matrix row for the function (original index).
+        unsigned int row = indexMap[index] * (nConstraintsInitial + 1);
+
+        // Initialise function with the side limit correction.
+        double func = corrections[index];
+
+        // Add the linear change due to each lambda.
+        for (unsigned int j=0;j<nConstraints+1;j++)
+            func += scaleFactors[j] * lambda[j] * gramMatrix[row + indexMap[j]];
+
+        func *= scaleFactors[index];
+
+        if (index == 0) return func;
+        else return (func - (scaleFactors[index] * constraintDistancesScaled[index - 1]));
     }
 
     double Optimise::solve()
     {
         // Store the number of boundary points.
         // This can change between successive optimisation calls.
-        nPoints = boundaryPoints.size();
+        nPoints = boundaryPoints->size();
 
         // Resize boundary point dependent data structures.
         displacements.resize(nPoints);
@@ -156,6 +271,12 @@ namespace slsm
         indexMap.resize(nConstraints + 1);
         std::iota(indexMap.begin(), indexMap.end(), 0);
 
+        // Take a snapshot of the boundary point data.
+        packBoundaryPoints();
+
+        // Compute the boundary integrals of sensitivity products.
+        computeGramMatrix();
+
         // Compute the scale factors for the objective end constraints.
         computeScaleFactors();
 
@@ -176,87 +297,105 @@ namespace slsm
         // Calculate and store the gradient for each function.
         for (unsigned int i=0;i<nConstraints+1;i++)
         {
-            std::vector<double> gradient(nConstraints + 1);
-
-            // Calculate the gradient.
-            computeGradients(gradient, i);
-
-            // Store the gradient.
-            gradients[i] = gradient;
+            gradients[i].resize(nConstraints + 1);
+            computeGradients(gradients[i], i);
         }
 
-        // Create wrapper for objective.
-        NLoptWrapper objectiveWrapper;
-        objectiveWrapper.index = 0;
-        objectiveWrapper.callback = this;
-
-        // Create wrappers for constraints.
-        NLoptWrapper constraintWrappers[nConstraints];
-        for (unsigned int i=0;i<nConstraints;i++)
-        {
-            constraintWrappers[i].index = i + 1;
-            constraintWrappers[i].callback = this;
-        }
+        // Invalidate the side limit corrections.
+        correctionLambda.clear();
 
-        // Instantiate NLopt optimisation object.
-        nlopt::opt opt(algorithm, 1 + nConstraints);
+        // The optimum value of the objective function.
+        double optObjective = 0;
 
-        // Set limits.
-        opt.set_lower_bounds(negativeLambdaLimits);
-        opt.set_upper_bounds(positiveLambdaLimits);
+        // Use the built-in solver.
+        if (solver == Solver::SIMPLEX) optObjective = solveLinear();
 
-        // Set a maximum of 500 iterations.
-        opt.set_maxeval(500);
+        else
+        {
+            // Create wrapper for objective.
+            objectiveWrapper.index = 0;
+            objectiveWrapper.callback = this;
 
-        // Set convergence tolerance.
-        opt.set_xtol_rel(1e-8);
+            // Create wrappers for constraints.
+            constraintWrappers.resize(nConstraints);
+            for (unsigned int i=0;i<nConstraints;i++)
+            {
+                constraintWrappers[i].index = i + 1;
+                constraintWrappers[i].callback = this;
+            }
 
-        // Specify whether we want to minimise or maximise the objective function.
-        if (isMax) opt.set_max_objective(callbackWrapper, &objectiveWrapper);
-        else       opt.set_min_objective(callbackWrapper, &objectiveWrapper);
+            /* The NLopt object is only instantiated when the number of active
+               constraints changes. Otherwise, the constraints from the previous
+               solve are removed and the object is reused.
+             */
+            if (optDimension != (1 + nConstraints))
+            {
+                // Instantiate NLopt optimisation object.
+                opt = nlopt::opt(algorithm, 1 + nConstraints);
+                optDimension = 1 + nConstraints;
 
-        // Add the constraints.
-        for (unsigned int i=0;i<nConstraints;i++)
-        {
-            // Add equality constraint.
-            if (isEquality[i])
-                opt.add_equality_constraint(callbackWrapper, &constraintWrappers[i], 1e-8);
+                // Set a maximum of 500 iterations.
+                opt.set_maxeval(500);
 
-            // Add inequality constraint.
+                // Set convergence tolerance.
+                opt.set_xtol_rel(1e-8);
+            }
             else
-                opt.add_inequality_constraint(callbackWrapper, &constraintWrappers[i], 1e-8);
-        }
-
-        // The optimum value of the objective function.
-        double optObjective;
+            {
+                opt.remove_inequality_constraints();
+                opt.remove_equality_constraints();
+            }
 
-        // Whether a single optimisation has been attempted.
-        bool isAttempted = false;
+            // Set limits.
+            opt.set_lower_bounds(negativeLambdaLimits);
+            opt.set_upper_bounds(positiveLambdaLimits);
 
-        // Keep trying optmisation until a solution is found.
-        while (!isAttempted || (returnCode < 0))
-        {
-            isAttempted = true;
+            // Specify whether we want to minimise or maximise the objective function.
+            if (isMax) opt.set_max_objective(callbackWrapper, &objectiveWrapper);
+            else       opt.set_min_objective(callbackWrapper, &objectiveWrapper);
 
-            // Attempt optimisation.
-            try
+            // Add the constraints.
+            for (unsigned int i=0;i<nConstraints;i++)
             {
-                returnCode = opt.optimize(lambdas, optObjective);
-            }
+                // Add equality constraint.
+                if (isEquality[i])
+                    opt.add_equality_constraint(callbackWrapper, &constraintWrappers[i], 1e-8);
 
-            // Catch roundoff errors.
-            catch (nlopt::roundoff_limited)
-            {
-                // Reduce the constraint change targets.
-                for (unsigned int i=0;i<nConstraints;i++)
-                    constraintDistancesScaled[i] *= 0.7;
+                // Add inequality constraint.
+                else
+                    opt.add_inequality_constraint(callbackWrapper, &constraintWrappers[i], 1e-8);
             }
 
-            // Catch argument errors.
-            catch (std::invalid_argument)
+            // Clear the return code from any previous solve.
+            returnCode = nlopt::FAILURE;
+
+            // Keep trying optmisation until a solution is found.
+            while (returnCode < 0)
             {
-                errno = EINVAL;
-                slsm_log_err("Invalid arguments!");
+                // Attempt optimisation.
+                try
+                {
+                    returnCode = opt.optimize(lambdas, optObjective);
+                }
+
+                // Catch roundoff errors.
+                catch (nlopt::roundoff_limited)
+                {
+                    // Reduce the constraint change targets.
+                    for (unsigned int i=0;i<nConstraints;i++)
+                        constraintDistancesScaled[i] *= 0.7;
+                }
+
+                // Catch argument errors.
+                catch (std::invalid_argument)
+                {
+                    errno = EINVAL;
+                    slsm_log_err("Invalid arguments!");
+
+                    // Retrying with the same arguments won't help.
+                    returnCode = nlopt::INVALID_ARGS;
+                    break;
+                }
             }
         }
 
@@ -274,8 +413,14 @@ namespace slsm
         timeStep = std::abs(lambdas[0]);
 
         // Calculate boundary point velocities.
-        for (unsigned int i=0;i<nPoints;i++)
-            boundaryPoints[i].velocity = displacements[i] / timeStep;
+        threadPool.run([&](unsigned int thread)
+        {
+            unsigned int start, end;
+            threadPool.range(nPoints, thread, start, end);
+
+            for (unsigned int i=start;i<end;i++)
+                (*boundaryPoints)[i].velocity = displacements[i] / timeStep;
+        });
 
         // Remap data if there are inactive constraints.
         if (nConstraints < nConstraintsInitial)
@@ -297,6 +442,456 @@ namespace slsm
         return (optObjective / scaleFactors[0]);
     }
 
+    double Optimise::solveLinear()
+    {
+        /* Apart from points that are clamped by a side limit, the change in
+           each function is linear in the lambda values. The functions are
+           linearised about the current lambda values, with the set of clamped
+           points held fixed, and the resulting linear program is solved. This
+           is repeated until the set of clamped points stops changing. The
+           first linearisation is about the previous lambda values, so a single
+           linear program is usually sufficient. Each linear program is warm
+           started from the current lambda values.
+
+           If the constraints can't be satisfied simultaneously, the constraint
+           change targets are reduced, as for NLopt roundoff errors.
+         */
+
+        // The maximum number of linearisations.
+        const unsigned int maxIterations = 20;
+
+        // The number of lambda dimensions.
+        unsigned int nDim = nConstraints + 1;
+
+        // The number of functions (objective and initial constraints).
+        unsigned int nFunctions = nConstraintsInitial + 1;
+
+        // Resize the linear program data (the storage is reused between calls).
+        coeffs.resize(nDim*nDim + nDim);
+        cost.resize(nDim);
+        matrix.resize(nConstraints*nDim);
+        rhs.resize(nConstraints);
+        lower.resize(nDim);
+        upper.resize(nDim);
+        isClamped.assign(domainPoints.size(), false);
+
+        // The best solution found (in case the clamped points don't converge).
+        double bestObjective = 0;
+        double bestViolation = 0;
+
+        returnCode = nlopt::SUCCESS;
+
+        for (unsigned int n=0;n<maxIterations;n++)
+        {
+            /*********************************************************
+             * Find the side limit contribution at the current lambda.
+             *********************************************************/
+
+            std::fill(coeffs.begin(), coeffs.end(), 0.0);
+
+            // The number of points whose clamping has changed.
+            double nChanged = 0;
+
+            for (unsigned int k=0;k<domainPoints.size();k++)
+            {
+                unsigned int i = domainPoints[k];
+
+                // Compute the unclamped displacement.
+                double displacement = 0;
+                for (unsigned int j=0;j<nDim;j++)
+                    displacement += scaleFactors[j] * lambdas[j] * pointSensitivities[indexMap[j]*nPoints + i];
+
+                bool isLimited = (displacement < pointLimits[i]);
+
+                if (isLimited != bool(isClamped[k])) nChanged++;
+                isClamped[k] = isLimited;
+
+                // Replace the linear displacement by the limit.
+                if (isLimited)
+                {
+                    for (unsigned int f=0;f<nDim;f++)
+                    {
+                        double weight = pointSensitivities[indexMap[f]*nPoints + i] * pointLengths[i];
+
+                        for (unsigned int j=0;j<nDim;j++)
+                            coeffs[f*nDim + j] -= weight * scaleFactors[j] * pointSensitivities[indexMap[j]*nPoints + i];
+
+                        coeffs[nDim*nDim + f] += weight * pointLimits[i];
+                    }
+                }
+            }
+
+            // Sum across all ranks.
+            if (communicator != nullptr)
+                communicator->allReduce(coeffs, ReduceOp::SUM);
+            nChanged = reduce(nChanged, ReduceOp::SUM);
+
+            // The set of clamped points has converged.
+            if ((n > 0) && (nChanged == 0)) break;
+
+            /**************************************
+             * Solve the linearised problem.
+             **************************************/
+
+            // Add the linear change, and apply the function scale factors.
+            for (unsigned int f=0;f<nDim;f++)
+            {
+                unsigned int row = indexMap[f] * nFunctions;
+
+                for (unsigned int j=0;j<nDim;j++)
+                {
+                    coeffs[f*nDim + j] += scaleFactors[j] * gramMatrix[row + indexMap[j]];
+                    coeffs[f*nDim + j] *= scaleFactors[f];
+                }
+
+                coeffs[nDim*nDim + f] *= scaleFactors[f];
+            }
+
+            for (unsigned int j=0;j<nDim;j++)
+                cost[j] = isMax ? -coeffs[j] : coeffs[j];
+
+            for (unsigned int i=0;i<nConstraints;i++)
+            {
+                for (unsigned int j=0;j<nDim;j++)
+                    matrix[i*nDim + j] = coeffs[(i+1)*nDim + j];
+            }
+
+            /* After the first linearisation, the step is limited to a trust
+               region that halves in size each iteration, so that the solution
+               can't oscillate between different sets of clamped points.
+             */
+            for (unsigned int j=0;j<nDim;j++)
+            {
+                if (n == 0)
+                {
+                    lower[j] = negativeLambdaLimits[j];
+                    upper[j] = positiveLambdaLimits[j];
+                }
+                else
+                {
+                    double radius = std::ldexp(positiveLambdaLimits[j] - negativeLambdaLimits[j], -int(n));
+
+                    lower[j] = std::max(negativeLambdaLimits[j], lambdas[j] - radius);
+                    upper[j] = std::min(positiveLambdaLimits[j], lambdas[j] + radius);
+                }
+            }
+
+            // Warm start the simplex solver from the current lambda values.
+            solution = lambdas;
+
+            // Whether a solution has been found.
+            bool isSolved = false;
+
+            // Reduce the constraint change targets until the constraints can be met.
+            for (unsigned int attempt=0;attempt<maxIterations && !isSolved;attempt++)
+            {
+                for (unsigned int i=0;i<nConstraints;i++)
+                {
+                    rhs[i] = scaleFactors[i+1]
+                           * constraintDistancesScaled[i] - coeffs[nDim*nDim + i + 1];
+                }
+
+                SimplexStatus::SimplexStatus status = simplex.solve(cost, matrix,
+                    rhs, isEquality, lower, upper, solution);
+
+                if (status == SimplexStatus::INFEASIBLE)
+                {
+                    // The constraints can't be met within the trust region.
+                    if (n > 0) break;
+
+                    for (unsigned int i=0;i<nConstraints;i++)
+                        constraintDistancesScaled[i] *= 0.7;
+
+                    returnCode = nlopt::FAILURE;
+                }
+                else
+                {
+                    if (status == SimplexStatus::MAX_ITERATIONS)
+                        returnCode = nlopt::MAXEVAL_REACHED;
+                    else
+                        returnCode = nlopt::SUCCESS;
+
+                    isSolved = true;
+                }
+            }
+
+            // Keep the previous solution.
+            if ((n > 0) && !isSolved) break;
+
+            lambdas = solution;
+
+            /* Evaluate the solution, including the contribution of all clamped
+               points. The linearisation can oscillate between sets of clamped
+               points, so store the solution with the smallest constraint
+               violation, then the best objective.
+             */
+
+            std::vector<double> gradient;
+            double objective = callback(lambdas, gradient, 0);
+            if (isMax) objective = -objective;
+
+            double violation = 0;
+            for (unsigned int i=0;i<nConstraints;i++)
+            {
+                double value = callback(lambdas, gradient, i + 1);
+
+                if (isEquality[i]) violation = std::max(violation, std::abs(value));
+                else violation = std::max(violation, value);
+            }
+
+            // Allow for rounding.
+            violation = std::max(violation, 1e-8);
+
+            if ((n == 0) || (violation < bestViolation)
+                || ((violation == bestViolation) && (objective < bestObjective)))
+            {
+                bestLambdas = lambdas;
+                bestObjective = objective;
+                bestViolation = violation;
+            }
+
+            // The set of clamped points didn't converge.
+            if (n == (maxIterations - 1)) returnCode = nlopt::MAXEVAL_REACHED;
+        }
+
+        lambdas = bestLambdas;
+
+        return isMax ? -bestObjective : bestObjective;
+    }
+
+    bool Optimise::isCounted(unsigned int point) const
+    {
+        return (!(*boundaryPoints)[point].isFixed && !(*boundaryPoints)[point].isGhost);
+    }
+
+    double Optimise::reduce(double value, ReduceOp::ReduceOp op)
+    {
+        if (communicator == nullptr) return value;
+        else return communicator->allReduce(value, op);
+    }
+
+    void Optimise::setThreads(unsigned int nThreads)
+    {
+        threadPool.resize(nThreads);
+    }
+
+    void Optimise::packBoundaryPoints()
+    {
+        /* The sensitivities for each function are stored contiguously, so that
+           loops over the boundary points have unit stride. Branches on the type
+           of point are replaced by masks: fixed and ghost points have zero
+           length, so don't contribute to boundary integrals, and points away
+           from the domain boundary have a side limit that can never be reached.
+         */
+
+        // The number of functions (objective and initial constraints).
+        unsigned int nFunctions = nConstraintsInitial + 1;
+
+        // The number of threads.
+        unsigned int nThreads = threadPool.size();
+
+        // Resize data structures (memory is retained between calls).
+        pointSensitivities.resize(nFunctions*nPoints);
+        pointLengths.resize(nPoints);
+        pointLimits.resize(nPoints);
+        pointMasks.resize(nPoints);
+        pointCounted.resize(nPoints);
+        threadMaxima.assign(nThreads*nFunctions, 0.0);
+        threadDomainPoints.resize(nThreads);
+
+        threadPool.run([&](unsigned int thread)
+        {
+            unsigned int start, end;
+            threadPool.range(nPoints, thread, start, end);
+
+            double* maxima = &threadMaxima[thread*nFunctions];
+
+            std::vector<unsigned int>& points = threadDomainPoints[thread];
+            points.clear();
+
+            for (unsigned int i=start;i<end;i++)
+            {
+                const BoundaryPoint& point = (*boundaryPoints)[i];
+
+                // Don't consider fixed or ghost points.
+                bool isPointCounted = isCounted(i);
+
+                for (unsigned int j=0;j<nFunctions;j++)
+                {
+                    pointSensitivities[j*nPoints + i] = point.sensitivities[j];
+
+                    if (isPointCounted)
+                        maxima[j] = std::max(maxima[j], std::abs(point.sensitivities[j]));
+                }
+
+                pointLengths[i] = isPointCounted ? point.length : 0.0;
+                pointLimits[i] = point.isDomain ? point.negativeLimit : std::numeric_limits<double>::lowest();
+                pointMasks[i] = point.isFixed ? 0.0 : 1.0;
+                pointCounted[i] = isPointCounted ? 1.0 : 0.0;
+
+                // Store points that may be clamped by a side limit.
+                if (isPointCounted && point.isDomain) points.push_back(i);
+            }
+        });
+
+        // Combine the results from each thread (in order).
+        maxSensitivities.assign(nFunctions, 0.0);
+        domainPoints.clear();
+
+        for (unsigned int i=0;i<nThreads;i++)
+        {
+            for (unsigned int j=0;j<nFunctions;j++)
+                maxSensitivities[j] = std::max(maxSensitivities[j], threadMaxima[i*nFunctions + j]);
+
+            domainPoints.insert(domainPoints.end(),
+                threadDomainPoints[i].begin(), threadDomainPoints[i].end());
+        }
+
+        // Find the maxima across all ranks.
+        if (communicator != nullptr)
+            communicator->allReduce(maxSensitivities, ReduceOp::MAX);
+    }
+
+    double Optimise::integrate(const std::vector<double>& values, unsigned int function)
+    {
+        // The number of blocks of points.
+        unsigned int nBlocks = (nPoints + blockSize - 1) / blockSize;
+
+        blockSums.resize(nBlocks);
+
+        threadPool.run([&](unsigned int thread)
+        {
+            unsigned int start, end;
+            threadPool.range(nBlocks, thread, start, end);
+
+            for (unsigned int i=start;i<end;i++)
+            {
+                unsigned int first = i*blockSize;
+
+                blockSums[i] = productSum(std::min(blockSize, nPoints - first), values.data() + first,
+                    pointSensitivities.data() + function*nPoints + first, pointLengths.data() + first);
+            }
+        });
+
+        // Sum the blocks in order.
+        double sum = 0;
+        for (unsigned int i=0;i<nBlocks;i++) sum += blockSums[i];
+
+        // Sum the integral across all ranks.
+        return reduce(sum, ReduceOp::SUM);
+    }
+
+    void Optimise::computeGramMatrix()
+    {
+        /* Other than for points that are clamped by a side limit, the change
+           in function f is linear in the lambda values, i.e.
+
+             dF_f = sum_j lambda_j G_fj,   G_fj = sum_i s^f_i * s^j_i * l_i
+
+           (ignoring scale factors). The Gram matrix G is computed once per
+           solve, for all of the initial functions, so that the optimiser
+           callbacks don't need to loop over the boundary points.
+
+           The upper triangle is accumulated separately for each block of
+           points, then the block totals are summed in order, so that the
+           result doesn't depend on the number of threads.
+         */
+
+        // The number of functions (objective and initial constraints).
+        unsigned int nFunctions = nConstraintsInitial + 1;
+
+        // The number of entries in the upper triangle.
+        unsigned int nPairs = (nFunctions*(nFunctions + 1)) / 2;
+
+        // The number of blocks of points.
+        unsigned int nBlocks = (nPoints + blockSize - 1) / blockSize;
+
+        blockSums.resize(nBlocks*nPairs);
+
+        threadPool.run([&](unsigned int thread)
+        {
+            unsigned int start, end;
+            threadPool.range(nBlocks, thread, start, end);
+
+            for (unsigned int i=start;i<end;i++)
+            {
+                unsigned int first = i*blockSize;
+                unsigned int n = std::min(blockSize, nPoints - first);
+
+                const double* lengths = pointLengths.data() + first;
+
+                // Index of the upper triangle entry.
+                unsigned int pair = i*nPairs;
+
+                for (unsigned int j=0;j<nFunctions;j++)
+                {
+                    const double* sensitivities = pointSensitivities.data() + j*nPoints + first;
+
+                    for (unsigned int k=j;k<nFunctions;k++)
+                    {
+                        blockSums[pair++] = productSum(n, sensitivities, lengths,
+                            pointSensitivities.data() + k*nPoints + first);
+                    }
+                }
+            }
+        });
+
+        // Zero the Gram matrix.
+        gramMatrix.assign(nFunctions*nFunctions, 0.0);
+
+        // Sum the blocks in order.
+        for (unsigned int i=0;i<nBlocks;i++)
+        {
+            unsigned int pair = i*nPairs;
+
+            for (unsigned int j=0;j<nFunctions;j++)
+                for (unsigned int k=j;k<nFunctions;k++)
+                    gramMatrix[j*nFunctions + k] += blockSums[pair++];
+        }
+
+        // Sum the matrix across all ranks.
+        if (communicator != nullptr)
+            communicator->allReduce(gramMatrix, ReduceOp::SUM);
+
+        // Fill the lower triangle.
+        for (unsigned int j=1;j<nFunctions;j++)
+            for (unsigned int k=0;k<j;k++)
+                gramMatrix[j*nFunctions + k] = gramMatrix[k*nFunctions + j];
+    }
+
+    void Optimise::computeCorrections(const std::vector<double>& lambda)
+    {
+        // Store the lambda values.
+        correctionLambda = lambda;
+
+        // Zero the corrections.
+        corrections.assign(nConstraints + 1, 0.0);
+
+        // Loop over all points that may be clamped by a side limit.
+        for (unsigned int n=0;n<domainPoints.size();n++)
+        {
+            unsigned int i = domainPoints[n];
+
+            // Compute the unclamped displacement.
+            double displacement = 0;
+            for (unsigned int j=0;j<nConstraints+1;j++)
+                displacement += scaleFactors[j] * lambda[j] * pointSensitivities[indexMap[j]*nPoints + i];
+
+            // Apply side limit (the point can't move outside the domain).
+            if (displacement < pointLimits[i])
+            {
+                double change = (pointLimits[i] - displacement) * pointLengths[i];
+
+                for (unsigned int j=0;j<nConstraints+1;j++)
+                    corrections[j] += change * pointSensitivities[indexMap[j]*nPoints + i];
+            }
+        }
+
+        // Sum the corrections across all ranks.
+        if (communicator != nullptr)
+            communicator->allReduce(corrections, ReduceOp::SUM);
+    }
+
     void Optimise::computeScaleFactors()
     {
         /* In order for the optimiser to work effectively it is important
@@ -331,23 +926,9 @@ namespace slsm
         // Loop over all functions: objective first, then constraints.
         for (unsigned int i=0;i<nConstraints+1;i++)
         {
-            // Initialise maximum sensitivity.
-            double maxSens = 0;
-
-            // Loop over all boundary points.
-            for (unsigned int j=0;j<nPoints;j++)
-            {
-                // Don't consider fixed points.
-                if (!boundaryPoints[j].isFixed)
-                {
-                    // Test whether sensitivity magnitude is current maximum.
-                    double sens = std::abs(boundaryPoints[j].sensitivities[i]);
-                    if (sens > maxSens) maxSens = sens;
-                }
-            }
-
-            // Store scale factor.
-            scaleFactors[i] = (1.0 / maxSens);
+            // Store scale factor. The maximum sensitivity (excluding fixed
+            // and ghost points) is found when packing the boundary points.
+            scaleFactors[i] = (1.0 / maxSensitivities[i]);
         }
 
         // Create lambda vector (all zeros, i.e. at the origin).
@@ -380,13 +961,28 @@ namespace slsm
            problem. Here we create a map between indices for the vector of active
            constraints and the original constraints vector.
 
-           Constraint change estimates are computed by evaluating boundary point
-           displacements at the vertices of the lambda search hypercube. For each
-           variable, the constraint changes are computed at each vertex, then
-           sorted into ascending order (from which the min and max change can be
-           extracted). Here we assume that all of the current constraints are
-           active. To self-consistently solve for the constraint change targets
-           while remove inactive constraints we recursively call this method until
+           Constraint change estimates are the minimum and maximum change over
+           the lambda search hypercube. Away from the side limits, the change is
+           a linear function of the lambda values (with coefficients from the
+           Gram matrix), so its extrema are found independently for each lambda,
+           i.e. at the hypercube vertex where each term is smallest (or largest).
+           A point that is clamped by a side limit only ever moves less far
+           inwards than it would otherwise, by at most the limit minus its
+           smallest unclamped displacement, so its effect on the constraint is
+           bounded by an interval. Summing these gives a conservative
+           estimate, at a cost that is linear in the number of points and
+           constraints.
+
+           When there are only a few constraints and some points may be clamped,
+           the exact extrema are found instead by evaluating the change at each
+           of the 2^(n+1) vertices of the hypercube, as for the callback (i.e.
+           from the Gram matrix plus the side limit corrections). This costs
+           2^(n+1) passes over the points that are subject to a side limit, so
+           the bound is used for larger numbers of constraints.
+
+           Here we assume that all of the current constraints are active. To
+           self-consistently solve for the constraint change targets while
+           remove inactive constraints we recursively call this method until
            the number of active constraints stops changing. As such, the estimated
            constraint changes are computed within a hypercube of ever decreasing
            dimension.
@@ -395,41 +991,91 @@ namespace slsm
         // Whether each constraint is active.
         std::vector<bool> isActive(nCurrentConstraints);
 
-        /*******************************************************************
-         * Generate a vector of vertex coordinates for the lambda hypercube.
-         *******************************************************************/
-
-        // The dimensionality of the hypercube.
+        // The number of lambda dimensions.
         unsigned int nDim = nCurrentConstraints + 1;
 
-        // The number of vertices.
-        unsigned int nVertices = std::pow(2, nDim);
+        // The number of functions (objective and initial constraints).
+        unsigned int nFunctions = nConstraintsInitial + 1;
+
+        // The largest number of constraints for which the vertices are enumerated.
+        const unsigned int maxExactConstraints = 10;
 
-        // Initialise data structures.
-        std::vector<unsigned int> temp(nVertices);
-        std::vector<std::vector <bool> > vertices(nVertices);
+        // Whether any point (on any rank) may be clamped by a side limit.
+        bool isClampable = (reduce(domainPoints.size(), ReduceOp::MAX) > 0);
 
-        for (unsigned int i=0;i<nVertices;i++)
+        // Whether to find the exact extrema by enumerating the hypercube vertices.
+        bool isExact = isClampable && (nCurrentConstraints <= maxExactConstraints);
+
+        // The exact min and max change for each constraint.
+        std::vector<double> exactMin(nCurrentConstraints, std::numeric_limits<double>::max());
+        std::vector<double> exactMax(nCurrentConstraints, std::numeric_limits<double>::lowest());
+
+        /*****************************************************************
+         * Evaluate the constraint change at each vertex of the hypercube.
+         *****************************************************************/
+
+        if (isExact)
         {
-            temp[i] = i;
-            vertices[i].resize(nDim);
+            // The number of vertices.
+            unsigned int nVertices = 1u << nDim;
+
+            // Lambda vector.
+            std::vector<double> lambda(nDim);
+
+            for (unsigned int v=0;v<nVertices;v++)
+            {
+                // Populate the lambda vector (bit j set for the positive limit).
+                for (unsigned int j=0;j<nDim;j++)
+                {
+                    if ((v >> j) & 1) lambda[j] = positiveLambdaLimits[j];
+                    else              lambda[j] = negativeLambdaLimits[j];
+                }
+
+                // Compute the side limit corrections at the vertex.
+                computeCorrections(lambda);
+
+                for (unsigned int i=0;i<nCurrentConstraints;i++)
+                {
+                    // Offset of the Gram matrix row for the constraint (original index).
+                    unsigned int row = indexMap[i+1] * nFunctions;
+
+                    double change = corrections[i+1];
+                    for (unsigned int j=0;j<nDim;j++)
+                        change += scaleFactors[j] * lambda[j] * gramMatrix[row + indexMap[j]];
+
+                    exactMin[i] = std::min(exactMin[i], change);
+                    exactMax[i] = std::max(exactMax[i], change);
+                }
+            }
+
+            // The corrections are only valid for the vertex lambda values.
+            correctionLambda.clear();
         }
 
-        // Compute the vertices.
-        for (unsigned int i=0;i<nVertices;i++)
+        /*********************************************************************
+         * Bound the side limit correction for each point that may be clamped.
+         *********************************************************************/
+
+        // The largest amount by which each side limit can reduce the inward displacement.
+        std::vector<double> maxCorrections(isExact ? 0 : domainPoints.size());
+
+        for (unsigned int n=0;n<maxCorrections.size();n++)
         {
-            // Loop over all lambda dimensions.
-            for (int j=nDim-1;j>=0;j--)
-            {
-                unsigned int k = temp[i] >> j;
+            unsigned int i = domainPoints[n];
 
-                if (k & 1) vertices[i][j] = true;   // Positive lambda limit.
-                else       vertices[i][j] = false;  // Negative lambda limit.
+            // Find the smallest unclamped displacement within the hypercube.
+            double minDisplacement = 0;
+            for (unsigned int j=0;j<nDim;j++)
+            {
+                double coeff = scaleFactors[j] * pointSensitivities[indexMap[j]*nPoints + i];
+                minDisplacement += std::min(coeff * negativeLambdaLimits[j], coeff * positiveLambdaLimits[j]);
             }
+
+            maxCorrections[n] = std::max(0.0, pointLimits[i] - minDisplacement);
         }
 
         /*****************************************************************
-         * Evaluate the constraint change at each vertex to deduce limits.
+         * Bound the constraint change within the hypercube.
          *****************************************************************/
 
         // Loop over all constraints.
@@ -438,49 +1084,49 @@ namespace slsm
             // Flag constraint as active.
             isActive[i] = true;
 
-            // Vector to hold all possible constraint changes.
-            std::vector<double> constraintChanges(nVertices);
+            // Offset of the Gram matrix row for the constraint (original index).
+            unsigned int row = indexMap[i+1] * nFunctions;
 
-            // Loop over all vertices.
-            for (unsigned int j=0;j<nVertices;j++)
-            {
-                // Lambda vector.
-                std::vector<double> lambda(nDim);
+            // The min and max changes.
+            double min = 0;
+            double max = 0;
 
-                // Populate the lambda vector.
-                for (unsigned int k=0;k<nDim;k++)
+            if (isExact)
+            {
+                min = exactMin[i];
+                max = exactMax[i];
+            }
+            else
+            {
+                // Add the extrema of the linear change due to each lambda.
+                for (unsigned int j=0;j<nDim;j++)
                 {
-                    if (vertices[j][k]) lambda[k] = positiveLambdaLimits[k];
-                    else                lambda[k] = negativeLambdaLimits[k];
-                }
+                    double coeff = scaleFactors[j] * gramMatrix[row + indexMap[j]];
 
-                // Compute displacement vector.
-                computeDisplacements(lambda);
+                    min += std::min(coeff * negativeLambdaLimits[j], coeff * positiveLambdaLimits[j]);
+                    max += std::max(coeff * negativeLambdaLimits[j], coeff * positiveLambdaLimits[j]);
+                }
 
-                double constraintChange = 0;
+                // Bound the change due to the side limits.
+                double minCorrection = 0;
+                double maxCorrection = 0;
 
-                // Compute the constraint change.
-                for (unsigned int k=0;k<nPoints;k++)
+                for (unsigned int n=0;n<maxCorrections.size();n++)
                 {
-                    // Don't consider fixed points.
-                    if(!boundaryPoints[k].isFixed)
-                    {
-                        constraintChange += displacements[k]
-                                          * boundaryPoints[k].sensitivities[indexMap[i+1]]
-                                          * boundaryPoints[k].length;
-                    }
-                }
+                    unsigned int k = domainPoints[n];
 
-                // Store the constraint change.
-                constraintChanges[j] = constraintChange;
-            }
+                    double correction = maxCorrections[n]
+                                      * pointSensitivities[indexMap[i+1]*nPoints + k]
+                                      * pointLengths[k];
 
-            // Sort the constraint changes.
-            std::sort(constraintChanges.begin(), constraintChanges.end());
+                    if (correction < 0) minCorrection += correction;
+                    else                maxCorrection += correction;
+                }
 
-            // Extract the min and max changes.
-            double min = constraintChanges[0];
-            double max = constraintChanges.back();
+                // Sum the corrections across all ranks.
+                min += reduce(minCorrection, ReduceOp::SUM);
+                max += reduce(maxCorrection, ReduceOp::SUM);
+            }
 
             /* We reduce the limits slightly to ensure that the optimiser can
                find a solution, i.e. the change in the constraint function must
@@ -588,22 +1234,8 @@ namespace slsm
             // Remap the sensitivity index: active --> original.
             unsigned int k = indexMap[i];
 
-            // Initialise max sensitivity.
-            double maxSens = std::numeric_limits<double>::min();
-
-            // Loop over all boundary points.
-            for (unsigned int j=0;j<boundaryPoints.size();j++)
-            {
-                // Don't consider fixed points.
-                if (!boundaryPoints[j].isFixed)
-                {
-                    // Take absolute sensitivity.
-                    double sens = std::abs(boundaryPoints[j].sensitivities[k]);
-
-                    // Check max sensitivity.
-                    if (sens > maxSens) maxSens = sens;
-                }
-            }
+            // Max sensitivity (excluding fixed and ghost points).
+            double maxSens = std::max(maxSensitivities[k], std::numeric_limits<double>::min());
 
             // Store limits.
             negativeLambdaLimits[i] = -maxDisplacement / maxSens;
@@ -627,53 +1259,52 @@ namespace slsm
 
     void Optimise::computeDisplacements(const std::vector<double>& lambda)
     {
-        // Loop over all boundary points.
-        for (unsigned int i=0;i<nPoints;i++)
+        threadPool.run([&](unsigned int thread)
         {
-            // Don't consider fixed points.
-            if (!boundaryPoints[i].isFixed)
+            unsigned int start, end;
+            threadPool.range(nPoints, thread, start, end);
+
+            double* __restrict__ disp = displacements.data();
+            const double* __restrict__ limits = pointLimits.data();
+            const double* __restrict__ masks = pointMasks.data();
+
+            // Loop over all functions (objective, then active constraints).
+            for (unsigned int j=0;j<nConstraints+1;j++)
             {
-                // Initialise component for objective.
-                displacements[i] = scaleFactors[0] * lambda[0] * boundaryPoints[i].sensitivities[0];
+                double coeff = scaleFactors[j] * lambda[j];
 
-                // Add components for active constraints.
-                for (unsigned int j=1;j<nConstraints+1;j++)
-                {
-                    // Remap the sensitivity index: active --> original.
-                    unsigned int k = indexMap[j];
+                // Remap the sensitivity index: active --> original.
+                const double* __restrict__ sens = pointSensitivities.data() + indexMap[j]*nPoints;
 
-                    // Update displacement vector.
-                    displacements[i] += scaleFactors[j] * lambda[j] * boundaryPoints[i].sensitivities[k];
+                // Initialise component for objective.
+                if (j == 0)
+                {
+                    for (unsigned int i=start;i<end;i++)
+                        disp[i] = coeff * sens[i];
                 }
 
-                // Check side limits if point lies close to domain boundary.
-                if (boundaryPoints[i].isDomain)
+                // Update displacement vector.
+                else
                 {
-                    // Apply side limit (the point can't move outside the domain).
-                    if (displacements[i] < boundaryPoints[i].negativeLimit)
-                        displacements[i] = boundaryPoints[i].negativeLimit;
+                    for (unsigned int i=start;i<end;i++)
+                        disp[i] += coeff * sens[i];
                 }
             }
-        }
+
+            // Apply side limits (points can't move outside the domain), and
+            // zero the displacement of fixed points.
+            for (unsigned int i=start;i<end;i++)
+                disp[i] = masks[i] * std::max(disp[i], limits[i]);
+        });
     }
 
     double Optimise::computeFunction(unsigned int index)
     {
         // This method assumes that displacements have already been calculated.
 
-        // Remap the sensitivity index: active --> original.
-        unsigned int j = indexMap[index];
-
-        // Initialise function.
-        double func = 0;
-
-        // Integrate function over boundary points.
-        for (unsigned int i=0;i<nPoints;i++)
-        {
-            // Don't consider fixed points.
-            if (!boundaryPoints[i].isFixed)
-                func += (scaleFactors[index] * displacements[i] * boundaryPoints[i].sensitivities[j] * boundaryPoints[i].length);
-        }
+        // Integrate function over boundary points (the sensitivity index is
+        // remapped: active --> original).
+        double func = scaleFactors[index] * integrate(displacements, indexMap[index]);
 
         if (index == 0) return func;
         else return (func - (scaleFactors[index] * constraintDistancesScaled[index - 1]));
@@ -681,10 +1312,6 @@ namespace slsm
 
     void Optimise::computeGradients(std::vector<double>& gradient, unsigned int index)
     {
-        // Zero the gradients.
-        gradient[0] = 0;
-        for (unsigned int i=1;i<nConstraints+1;i++) gradient[i] = 0;
-
         /* Calculate the derivative with respect to each lambda.
 
            Note that this isn't strictly correct, since points lying close to the
@@ -696,28 +1323,12 @@ namespace slsm
            boundary lying on, or close to, the domain boundary.)
          */
 
-        // Loop over all points.
-        for (unsigned int i=0;i<nPoints;i++)
-        {
-            // Don't consider fixed points.
-            if (!boundaryPoints[i].isFixed)
-            {
-                // Loop over all functions (objective, then constraints).
-                for (unsigned int j=0;j<nConstraints+1;j++)
-                {
-                    // Remap the sensitivity index: active --> original.
-                    unsigned int k = indexMap[j];
-
-                    // Scale factor.
-                    double scaleFactor = scaleFactors[index] * scaleFactors[j];
+        // Offset of the Gram matrix row for the function (original index).
+        unsigned int row = indexMap[index] * (nConstraintsInitial + 1);
 
-                    gradient[k] += (boundaryPoints[i].sensitivities[indexMap[index]]
-                                 *  boundaryPoints[i].sensitivities[k]
-                                 *  boundaryPoints[i].length
-                                 *  scaleFactor);
-                }
-            }
-        }
+        // Loop over all functions (objective, then constraints).
+        for (unsigned int j=0;j<nConstraints+1;j++)
+            gradient[j] = scaleFactors[index] * scaleFactors[j] * gramMatrix[row + indexMap[j]];
     }
 
     double Optimise::rescaleDisplacements()
@@ -725,38 +1336,36 @@ namespace slsm
         // Check for CFL violation and rescale the displacments
         // and lambda values if necessary.
 
-        // Maximum displacement magnitude.
-        double maxDisp = 0;
+        // The number of threads.
+        unsigned int nThreads = threadPool.size();
 
-        // Displacment scale factor.
-        double scale;
+        threadMaxima.resize(nThreads);
 
-        // Loop over all boundary points.
-        for (unsigned int i=0;i<nPoints;i++)
+        threadPool.run([&](unsigned int thread)
         {
-            // Don't consider fixed points.
-            if (!boundaryPoints[i].isFixed)
-            {
-                // Absolute displacement.
-                double disp = std::abs(displacements[i]);
+            unsigned int start, end;
+            threadPool.range(nPoints, thread, start, end);
 
-                // Displacement exceeds the CFL limit.
-                if (disp > maxDisplacement)
-                {
-                    // Check if current maximum is exceeded.
-                    if (disp > maxDisp)
-                    {
-                        // Store maximum displacement and scaling factor.
-                        maxDisp = disp;
-                        scale = maxDisplacement / maxDisp;
-                    }
-                }
-            }
-        }
+            // Maximum displacement magnitude (ignoring fixed and ghost points).
+            double maxDisp = 0;
+            for (unsigned int i=start;i<end;i++)
+                maxDisp = std::max(maxDisp, pointCounted[i] * std::abs(displacements[i]));
+
+            threadMaxima[thread] = maxDisp;
+        });
+
+        // Maximum displacement magnitude.
+        double maxDisp = *std::max_element(threadMaxima.begin(), threadMaxima.end());
+
+        // Find the maximum across all ranks.
+        maxDisp = reduce(maxDisp, ReduceOp::MAX);
 
         // CFL condition is violated, rescale displacements.
-        if (maxDisp)
+        if (maxDisp > maxDisplacement)
         {
+            // Compute the scaling factor.
+            double scale = maxDisplacement / maxDisp;
+
             // Scale lambda values.
             for (unsigned int i=0;i<nConstraints+1;i++)
                 lambdas[i] *= scale;
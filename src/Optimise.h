@@ -24,6 +24,10 @@
 
 #include <nlopt.hpp>
 
+#include "Communicator.h"
+#include "Simplex.h"
+#include "ThreadPool.h"
+
 namespace slsm
 {
     // FORWARD DECLARATIONS
@@ -32,6 +36,16 @@ namespace slsm
 
     // ASSOCIATED DATA TYPES
 
+    //! \brief Solvers for the lambda optimisation problem.
+    namespace Solver
+    {
+        enum Solver
+        {
+            NLOPT,          //!< An NLopt algorithm (default).
+            SIMPLEX,        //!< Built-in sequential linear programming (see Simplex).
+        };
+    }
+
     //! Wrapper structure for interfacing with NLopt.
     struct NLoptWrapper
     {
@@ -69,6 +83,27 @@ namespace slsm
 
             http://ab-initio.mit.edu/wiki/index.php/NLopt_Algorithms#SLSQP
 
+        Alternatively, passing Solver::SIMPLEX to the constructor uses a built-in
+        sequential linear programming solver. This is deterministic, doesn't
+        throw, and avoids constructing an NLopt object for each solve.
+
+        An Optimise object can be reused for successive iterations of a level
+        set simulation by calling reset() with the new boundary points and
+        constraint distances before each solve. This only avoids reallocating
+        memory: the buffers, the NLopt object (when the number of active
+        constraints is unchanged) and the simplex work arrays are kept, but
+        the problem is set up afresh. The lambda values from the previous
+        solve are used as the starting point for NLopt, or as the first
+        linearisation point and warm start for the built-in solver.
+
+        At the start of each solve the boundary point data is packed into
+        contiguous arrays, with one array per function for the sensitivities.
+        Loops over the boundary points are then branch free, so the compiler
+        can vectorise them, and are shared between the threads of a thread pool
+        (see setThreads). Sums are accumulated over fixed blocks of points, then
+        the block totals are added in order, so the result is independent of
+        the number of threads.
+
 		Support for alternative algorithms is provided through an optional constructor
         argument. Note that the chosen algorithm must support the type of constraints
         that are imposed in the optimisation problem. Check the NLopt algorithms page
@@ -110,10 +145,48 @@ namespace slsm
 
             \param algorithm_
                 (Optional) The NLopt algorithm (default = LD_SLSQP).
+
+            \param communicator_
+                (Optional) The communicator for a distributed level set (default = none).
          */
         Optimise(std::vector<BoundaryPoint>&, std::vector<double>, std::vector<double>&,
             double&, double maxDisplacement_ = 0.5, bool isMax_ = false,
-            const std::vector<bool>& isEquality_ = {}, nlopt::algorithm algorithm_ = nlopt::LD_SLSQP);
+            const std::vector<bool>& isEquality_ = {}, nlopt::algorithm algorithm_ = nlopt::LD_SLSQP,
+            Communicator* communicator_ = nullptr);
+
+        //! Constructor.
+        /*! \param boundaryPoints_
+                A reference to a vector of boundary points.
+
+            \param constraintDistances_
+                Distance from each constraint (negative values indicate that the
+                constraint is satisfied).
+
+            \param lambdas_
+                The optimum lambda values. This array is modified.
+
+            \param timeStep_
+                The effective time step (see above).
+
+            \param maxDisplacement_
+                The maximum displacement.
+
+            \param isMax_
+                Whether to maximise the objective function.
+
+            \param isEquality_
+                Whether each constraint is an equality.
+
+            \param solver_
+                The solver, i.e. Solver::SIMPLEX to use the built-in solver in
+                place of an NLopt algorithm.
+
+            \param communicator_
+                (Optional) The communicator for a distributed level set (default = none).
+         */
+        Optimise(std::vector<BoundaryPoint>&, std::vector<double>, std::vector<double>&,
+            double&, double maxDisplacement_, bool isMax_, const std::vector<bool>& isEquality_,
+            Solver::Solver solver_, Communicator* communicator_ = nullptr);
 
 #ifdef PYBIND
         //! Constructor.
@@ -150,6 +223,16 @@ namespace slsm
             const std::vector<bool>& isEquality_ = {});
 #endif
 
+        //! Reset the optimiser for a new iteration.
+        /*! \param boundaryPoints_
+                A reference to a vector of boundary points.
+
+            \param constraintDistances_
+                Distance from each constraint (negative values indicate that the
+                constraint is satisfied).
+         */
+        void reset(std::vector<BoundaryPoint>&, const std::vector<double>&);
+
         //! Execute the NLopt solver.
         /*! \return
                 The optimum change in the objective function.
@@ -171,6 +254,13 @@ namespace slsm
         //! Query the NLopt return code.
         void queryReturnCode();
 
+        //! Set the number of threads used for boundary point loops.
+        /*! \param nThreads
+                The number of threads. The result of the optimisation is
+                independent of the number of threads.
+         */
+        void setThreads(unsigned int);
+
     private:
         /// The number of boundary points.
         unsigned int nPoints;
@@ -181,8 +271,8 @@ namespace slsm
         /// The number of initial constraints.
         unsigned int nConstraintsInitial;
 
-        /// A reference to a vector of boundary points.
-        std::vector<BoundaryPoint>& boundaryPoints;
+        /// A pointer to a vector of boundary points.
+        std::vector<BoundaryPoint>* boundaryPoints;
 
         /// A vector of distances from the constraint manifold.
         std::vector<double> constraintDistances;
@@ -202,9 +292,30 @@ namespace slsm
         /// Whether the constraints are equality constraints.
         std::vector<bool> isEquality;
 
+        /// Whether each initial constraint is an equality constraint.
+        std::vector<bool> isEqualityInitial;
+
         /// The NLopt algorithm.
         nlopt::algorithm algorithm;
 
+        /// The solver.
+        Solver::Solver solver;
+
+        /// The NLopt optimisation object (retained between solves).
+        nlopt::opt opt;
+
+        /// The dimension of the NLopt optimisation object (zero if not created).
+        unsigned int optDimension;
+
+        /// NLopt wrapper for the objective.
+        NLoptWrapper objectiveWrapper;
+
+        /// NLopt wrappers for the active constraints.
+        std::vector<NLoptWrapper> constraintWrappers;
+
+        /// The built-in linear program solver.
+        Simplex simplex;
+
         /// A map between indices for active constraints.
         std::vector<unsigned int> indexMap;
 
@@ -226,9 +337,135 @@ namespace slsm
         /// Gradients of the objective and constraint functions.
         std::vector<std::vector<double> > gradients;
 
+        /// Boundary integrals of the product of sensitivities for each pair of
+        /// functions (original indices, row-major).
+        std::vector<double> gramMatrix;
+
+        /// Counted boundary points that are subject to a side limit.
+        std::vector<unsigned int> domainPoints;
+
+        /// The lambda values at which the side limit corrections were computed.
+        std::vector<double> correctionLambda;
+
+        /// Side limit corrections to the change in each function (unscaled).
+        std::vector<double> corrections;
+
         /// Optimiser return code.
         nlopt::result returnCode;
 
+        /// The communicator for a distributed level set (optional).
+        Communicator* communicator;
+
+        /// Threads for boundary point loops.
+        ThreadPool threadPool;
+
+        /// Packed boundary point sensitivities (one array of nPoints values per function).
+        std::vector<double> pointSensitivities;
+
+        /// Packed boundary point lengths (zero for fixed and ghost points).
+        std::vector<double> pointLengths;
+
+        /// Packed side limits (the lowest double for points away from the domain boundary).
+        std::vector<double> pointLimits;
+
+        /// Packed mask for points that can move (zero for fixed points).
+        std::vector<double> pointMasks;
+
+        /// Packed mask for points that are counted (zero for fixed and ghost points).
+        std::vector<double> pointCounted;
+
+        /// The largest absolute sensitivity for each function (original indices).
+        std::vector<double> maxSensitivities;
+
+        /// Partial sums for each block of points.
+        std::vector<double> blockSums;
+
+        /// Per-thread partial maxima.
+        std::vector<double> threadMaxima;
+
+        /// Per-thread lists of points that are subject to a side limit.
+        std::vector<std::vector<unsigned int> > threadDomainPoints;
+
+        /// Linearised function coefficients (row-major, one row per function),
+        /// followed by the constant term for each function.
+        std::vector<double> coeffs;
+
+        /// Linear program costs.
+        std::vector<double> cost;
+
+        /// Linear program constraint matrix (row-major).
+        std::vector<double> matrix;
+
+        /// Linear program constraint right-hand sides.
+        std::vector<double> rhs;
+
+        /// Linear program lower bounds.
+        std::vector<double> lower;
+
+        /// Linear program upper bounds.
+        std::vector<double> upper;
+
+        /// Linear program solution.
+        std::vector<double> solution;
+
+        /// Whether each domain point was clamped at the previous linearisation.
+        std::vector<char> isClamped;
+
+        /// The best lambda values found by the linear solver.
+        std::vector<double> bestLambdas;
+
+        /// The number of points in each block for partial sums.
+        static const unsigned int blockSize = 1024;
+
+        //! Whether a boundary point contributes to boundary integrals and limits.
+        /*! \param point
+                The index of the boundary point.
+
+            \return
+                Whether the point is counted (it is neither fixed nor a ghost).
+         */
+        bool isCounted(unsigned int) const;
+
+        //! Combine a value across all ranks (if distributed).
+        /*! \param value
+                The value on this rank.
+
+            \param op
+                The reduction operation.
+
+            \return
+                The combined value.
+         */
+        double reduce(double, ReduceOp::ReduceOp);
+
+        //! Pack the boundary point data into contiguous arrays, find the largest
+        //! absolute sensitivity for each function, and find the points subject
+        //! to a side limit.
+        void packBoundaryPoints();
+
+        //! Compute the boundary integral of the product of a vector with the
+        //! sensitivities of a function.
+        /*! \param values
+                The value at each boundary point.
+
+            \param function
+                The function index (original).
+
+            \return
+                The boundary integral (summed across all ranks).
+         */
+        double integrate(const std::vector<double>&, unsigned int);
+
+        //! Compute the boundary integral of the product of sensitivities for
+        //! each pair of functions.
+        void computeGramMatrix();
+
+        //! Compute the side limit corrections to the change in each function.
+        /*! \param lambda
+                A vector of lambda values (objective, then active constraints).
+         */
+        void computeCorrections(const std::vector<double>&);
+
         //! Compute scale factors.
         void computeScaleFactors();
 
@@ -262,6 +499,12 @@ namespace slsm
          */
         void computeGradients(std::vector<double>&, unsigned int index);
 
+        //! Solve for the optimum lambda values by sequential linear programming.
+        /*! \return
+                The optimum change in the (scaled) objective function.
+         */
+        double solveLinear();
+
         //! Rescale displacements and lambda values if the CFL condition is violated.
         /*! \return
                 The scale factor.
@@ -0,0 +1,342 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Simplex.h"
+
+/*! \file Simplex.cpp
+    \brief A dense simplex solver for small, bounded linear programs.
+ */
+
+namespace slsm
+{
+    Simplex::Simplex(double tolerance_) :
+        nIterations(0),
+        tolerance(tolerance_),
+        nRows(0),
+        nColumns(0),
+        maxIterations(0)
+    {
+    }
+
+    SimplexStatus::SimplexStatus Simplex::solve(const std::vector<double>& cost,
+                                                const std::vector<double>& matrix,
+                                                const std::vector<double>& rhs,
+                                                const std::vector<bool>& isEquality,
+                                                const std::vector<double>& lower,
+                                                const std::vector<double>& upper,
+                                                std::vector<double>& x)
+    {
+        /* The variables are shifted and scaled to y = (x - lower) / (upper - lower),
+           so that 0 <= y <= 1. Each upper bound becomes a constraint row with its
+           own slack variable, and each inequality constraint gets a slack. Rows
+           whose slack can't form part of the initial basis, i.e. equalities and
+           inequalities that are violated at y = 0, get an artificial variable.
+
+           To warm start from an incoming solution, a variable that is closer
+           to its upper bound is reflected, y = (upper - x) / (upper - lower),
+           so that the initial basis has it at the upper bound instead.
+
+           The tableau columns are ordered as follows:
+
+             [0, n)                         The scaled variables.
+             [n, n + nInequality)           Constraint slacks.
+             [n + nInequality, 2n + ...)    Bound slacks.
+             [firstArtificial, nColumns)    Artificial variables.
+         */
+
+        unsigned int n = cost.size();
+        unsigned int m = rhs.size();
+
+        nIterations = 0;
+
+        // Resize data structures (memory is retained between calls).
+        columnScales.resize(n);
+        isReflected.assign(n, false);
+
+        for (unsigned int j=0;j<n;j++)
+        {
+            columnScales[j] = std::max(0.0, upper[j] - lower[j]);
+
+            // Start from the nearest bound to the incoming solution.
+            if (x.size() == n)
+                isReflected[j] = ((x[j] - lower[j]) > (upper[j] - x[j]));
+
+            if (isReflected[j]) columnScales[j] = -columnScales[j];
+        }
+
+        // Count the number of slack and artificial variables.
+        unsigned int nInequality = 0;
+        unsigned int nArtificial = 0;
+
+        // Right-hand side of each constraint row at y = 0.
+        shiftedRhs.resize(m);
+
+        for (unsigned int i=0;i<m;i++)
+        {
+            shiftedRhs[i] = rhs[i];
+            for (unsigned int j=0;j<n;j++)
+                shiftedRhs[i] -= matrix[i*n + j] * (isReflected[j] ? upper[j] : lower[j]);
+
+            if (!isEquality[i]) nInequality++;
+            if (isEquality[i] || (shiftedRhs[i] < 0)) nArtificial++;
+        }
+
+        nRows = m + n;
+        nColumns = 2*n + nInequality + nArtificial;
+        maxIterations = 50*(nRows + nColumns);
+
+        unsigned int firstArtificial = 2*n + nInequality;
+
+        tableau.assign((nRows + 1)*(nColumns + 1), 0.0);
+        basis.resize(nRows);
+
+        /**********************************
+         * Fill the constraint rows.
+         **********************************/
+
+        unsigned int slack = n;
+        unsigned int artificial = firstArtificial;
+
+        for (unsigned int i=0;i<m;i++)
+        {
+            // Normalise the row by its largest coefficient.
+            double maxCoeff = 0;
+            for (unsigned int j=0;j<n;j++)
+                maxCoeff = std::max(maxCoeff, std::abs(matrix[i*n + j] * columnScales[j]));
+
+            double scale = (maxCoeff > 0) ? (1.0 / maxCoeff) : 1.0;
+
+            // Flip the row so that the right-hand side is non-negative.
+            if (shiftedRhs[i] < 0) scale = -scale;
+
+            for (unsigned int j=0;j<n;j++)
+                entry(i, j) = scale * matrix[i*n + j] * columnScales[j];
+
+            entry(i, nColumns) = scale * shiftedRhs[i];
+
+            if (!isEquality[i])
+            {
+                entry(i, slack) = (scale > 0) ? 1.0 : -1.0;
+
+                // The slack is feasible at y = 0.
+                if (scale > 0) basis[i] = slack;
+
+                slack++;
+            }
+
+            if (isEquality[i] || (scale < 0))
+            {
+                entry(i, artificial) = 1.0;
+                basis[i] = artificial;
+                artificial++;
+            }
+        }
+
+        // Fill the bound rows, y_j + t_j = 1.
+        for (unsigned int j=0;j<n;j++)
+        {
+            entry(m + j, j) = 1.0;
+            entry(m + j, slack) = 1.0;
+            entry(m + j, nColumns) = 1.0;
+            basis[m + j] = slack;
+            slack++;
+        }
+
+        // Whether a basis was found within the iteration limit.
+        bool isConverged = true;
+
+        // Whether the constraints are satisfied.
+        bool isFeasible = true;
+
+        /*************************************************************
+         * Phase one: minimise the sum of the artificial variables.
+         *************************************************************/
+
+        if (nArtificial > 0)
+        {
+            for (unsigned int j=firstArtificial;j<nColumns;j++)
+                entry(nRows, j) = 1.0;
+
+            // Express the objective in terms of the non-basic variables.
+            for (unsigned int i=0;i<m;i++)
+            {
+                if (basis[i] >= firstArtificial)
+                {
+                    for (unsigned int j=0;j<=nColumns;j++)
+                        entry(nRows, j) -= entry(i, j);
+                }
+            }
+
+            isConverged = iterate(nColumns);
+
+            // The constraint rows are normalised, so the residual violation is
+            // on the same scale as the tolerance.
+            if (-entry(nRows, nColumns) > std::sqrt(tolerance)) isFeasible = false;
+
+            // Drive any remaining artificial variables out of the basis.
+            for (unsigned int i=0;i<m;i++)
+            {
+                if (basis[i] >= firstArtificial)
+                {
+                    for (unsigned int j=0;j<firstArtificial;j++)
+                    {
+                        if (std::abs(entry(i, j)) > tolerance)
+                        {
+                            pivot(i, j);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        /*************************************************
+         * Phase two: minimise the (scaled) cost function.
+         *************************************************/
+
+        if (isConverged && isFeasible)
+        {
+            // Normalise the cost by its largest coefficient.
+            double maxCost = 0;
+            for (unsigned int j=0;j<n;j++)
+                maxCost = std::max(maxCost, std::abs(cost[j] * columnScales[j]));
+
+            double scale = (maxCost > 0) ? (1.0 / maxCost) : 1.0;
+
+            for (unsigned int j=0;j<=nColumns;j++)
+                entry(nRows, j) = (j < n) ? (scale * cost[j] * columnScales[j]) : 0.0;
+
+            // Express the objective in terms of the non-basic variables.
+            for (unsigned int i=0;i<nRows;i++)
+            {
+                double coeff = entry(nRows, basis[i]);
+
+                if (coeff != 0)
+                {
+                    for (unsigned int j=0;j<=nColumns;j++)
+                        entry(nRows, j) -= coeff * entry(i, j);
+                }
+            }
+
+            // Artificial variables may not re-enter the basis.
+            isConverged = iterate(firstArtificial);
+        }
+
+        /*************************
+         * Extract the solution.
+         *************************/
+
+        x.resize(n);
+        for (unsigned int j=0;j<n;j++) x[j] = isReflected[j] ? upper[j] : lower[j];
+
+        for (unsigned int i=0;i<nRows;i++)
+        {
+            if (basis[i] < n)
+            {
+                // Clamp to the bounds to remove rounding errors.
+                double y = std::min(1.0, std::max(0.0, entry(i, nColumns)));
+                x[basis[i]] += y*columnScales[basis[i]];
+            }
+        }
+
+        if (!isFeasible) return SimplexStatus::INFEASIBLE;
+        else if (!isConverged) return SimplexStatus::MAX_ITERATIONS;
+        else return SimplexStatus::OPTIMAL;
+    }
+
+    void Simplex::pivot(unsigned int row, unsigned int column)
+    {
+        // Normalise the pivot row.
+        double factor = 1.0 / entry(row, column);
+        for (unsigned int j=0;j<=nColumns;j++)
+            entry(row, j) *= factor;
+
+        entry(row, column) = 1.0;
+
+        // Eliminate the column from all other rows (including the objective).
+        for (unsigned int i=0;i<=nRows;i++)
+        {
+            if (i == row) continue;
+
+            double coeff = entry(i, column);
+
+            if (coeff != 0)
+            {
+                for (unsigned int j=0;j<=nColumns;j++)
+                    entry(i, j) -= coeff * entry(row, j);
+
+                entry(i, column) = 0;
+            }
+        }
+
+        basis[row] = column;
+    }
+
+    bool Simplex::iterate(unsigned int nAllowed)
+    {
+        while (true)
+        {
+            // Choose the first column with a negative reduced cost (Bland's rule).
+            unsigned int column = nAllowed;
+            for (unsigned int j=0;j<nAllowed;j++)
+            {
+                if (entry(nRows, j) < -tolerance)
+                {
+                    column = j;
+                    break;
+                }
+            }
+
+            // The basis is optimal.
+            if (column == nAllowed) return true;
+
+            if (nIterations == maxIterations) return false;
+
+            // Ratio test: choose the row that limits the step, breaking ties
+            // by the smallest basic variable index (Bland's rule).
+            unsigned int row = nRows;
+            double minRatio = std::numeric_limits<double>::max();
+
+            for (unsigned int i=0;i<nRows;i++)
+            {
+                double coeff = entry(i, column);
+
+                if (coeff > tolerance)
+                {
+                    double ratio = std::max(0.0, entry(i, nColumns)) / coeff;
+
+                    if ((ratio < minRatio) || ((ratio == minRatio) && (row < nRows) && (basis[i] < basis[row])))
+                    {
+                        minRatio = ratio;
+                        row = i;
+                    }
+                }
+            }
+
+            // The step is unbounded. This can't happen when all variables are
+            // bounded, other than through rounding errors.
+            if (row == nRows) return true;
+
+            pivot(row, column);
+            nIterations++;
+        }
+    }
+}
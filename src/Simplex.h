@@ -0,0 +1,174 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SIMPLEX_H
+#define _SIMPLEX_H
+
+#include <vector>
+
+/*! \file Simplex.h
+    \brief A dense simplex solver for small, bounded linear programs.
+ */
+
+namespace slsm
+{
+    // ASSOCIATED DATA TYPES
+
+    //! \brief The outcome of a linear program solve.
+    namespace SimplexStatus
+    {
+        enum SimplexStatus
+        {
+            OPTIMAL,                //!< An optimal solution was found.
+            INFEASIBLE,             //!< The constraints can't be satisfied.
+            MAX_ITERATIONS,         //!< The iteration limit was reached.
+        };
+    }
+
+    /*!\brief A dense simplex solver for small, bounded linear programs.
+
+        Solves problems of the form
+
+            minimise    c.x
+            subject to  A_i.x <= b_i   (or A_i.x = b_i)
+                        lower <= x <= upper
+
+        using a two-phase tableau simplex method (an active-set method for
+        linear programs). The problems solved by the Optimise class have a few
+        tens of variables at most, so the tableau is stored densely. Variables
+        are scaled to the unit interval and each constraint row is normalised,
+        so a single absolute tolerance can be used for all pivoting decisions.
+
+        Entering and leaving variables are chosen with Bland's rule, which
+        prevents cycling, so the sequence of pivots (and hence the number of
+        iterations) is fully determined by the input. Memory is retained
+        between calls, and no exceptions are thrown.
+
+        The solve can be warm started from a previous solution: each variable
+        starts at the bound that is nearest to its incoming value, rather than
+        at its lower bound. The tableau itself is rebuilt for each solve.
+     */
+    class Simplex
+    {
+    public:
+        //! Constructor.
+        /*! \param tolerance_
+                The pivoting tolerance (optional).
+         */
+        Simplex(double tolerance_ = 1e-10);
+
+        //! Solve a linear program.
+        /*! \param cost
+                The cost coefficient for each variable.
+
+            \param matrix
+                The constraint coefficients (row-major, one row per constraint).
+
+            \param rhs
+                The right-hand side of each constraint.
+
+            \param isEquality
+                Whether each constraint is an equality (otherwise less than or equal).
+
+            \param lower
+                The lower bound of each variable.
+
+            \param upper
+                The upper bound of each variable.
+
+            \param x
+                The solution vector. This array is modified. If it has an entry
+                for each variable on input, it is used as a warm start. If the
+                constraints can't be satisfied, the point that minimises the
+                total violation is returned.
+
+            \return
+                The status of the solution.
+         */
+        SimplexStatus::SimplexStatus solve(const std::vector<double>&, const std::vector<double>&,
+            const std::vector<double>&, const std::vector<bool>&, const std::vector<double>&,
+            const std::vector<double>&, std::vector<double>&);
+
+        /// The number of pivots performed by the last solve.
+        unsigned int nIterations;
+
+    private:
+        /// The pivoting tolerance.
+        double tolerance;
+
+        /// The number of tableau rows (excluding the objective).
+        unsigned int nRows;
+
+        /// The number of tableau columns (excluding the right-hand side).
+        unsigned int nColumns;
+
+        /// The maximum number of pivots.
+        unsigned int maxIterations;
+
+        /// The simplex tableau (row-major, objective row last, right-hand side column last).
+        std::vector<double> tableau;
+
+        /// The basic variable for each row.
+        std::vector<unsigned int> basis;
+
+        /// The scale factor for each variable (the width of its bounds, negative if reflected).
+        std::vector<double> columnScales;
+
+        /// Whether each variable is measured down from its upper bound.
+        std::vector<bool> isReflected;
+
+        /// The right-hand side of each constraint row at the starting bounds.
+        std::vector<double> shiftedRhs;
+
+        //! Return a reference to a tableau entry.
+        /*! \param row
+                The row index.
+
+            \param column
+                The column index.
+
+            \return
+                A reference to the entry.
+         */
+        double& entry(unsigned int, unsigned int);
+
+        //! Pivot the tableau.
+        /*! \param row
+                The pivot row.
+
+            \param column
+                The pivot column.
+         */
+        void pivot(unsigned int, unsigned int);
+
+        //! Perform simplex iterations until the objective row is optimal.
+        /*! \param nAllowed
+                The number of columns that may enter the basis.
+
+            \return
+                Whether an optimal basis was found within the iteration limit.
+         */
+        bool iterate(unsigned int);
+    };
+
+    inline double& Simplex::entry(unsigned int row, unsigned int column)
+    {
+        return tableau[row*(nColumns + 1) + column];
+    }
+}
+
+#endif  /* _SIMPLEX_H */
@@ -0,0 +1,1220 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Boundary.h"
+#include "Debug.h"
+#include "FastMarchingMethod.h"
+#include "Hole.h"
+#include "LevelSet.h"
+#include "SparseLevelSet.h"
+
+/*! \file SparseLevelSet.cpp
+    \brief A class for a sparse (tiled) level set function.
+ */
+
+namespace slsm
+{
+    // Definitions of static constants (needed if they are bound to a reference).
+    const unsigned int SparseLevelSet::tileSize;
+    const unsigned int SparseLevelSet::tileNodes;
+    const unsigned int SparseLevelSet::blockSize;
+    const unsigned int SparseLevelSet::insideTile;
+    const unsigned int SparseLevelSet::outsideTile;
+    const unsigned int SparseLevelSet::none;
+
+    // Coordinate offsets to the neighbours of a node (left, right, down, up).
+    static const int neighbourX[4] = {-1, 1, 0, 0};
+    static const int neighbourY[4] = {0, 0, -1, 1};
+
+    SparseLevelSet::SparseLevelSet(unsigned int width_, unsigned int height_, const std::vector<Hole>& holes,
+        double moveLimit_, unsigned int bandWidth_, bool isFixedDomain_) :
+        width(width_),
+        height(height_),
+        moveLimit(moveLimit_),
+        bandWidth(bandWidth_),
+        isFixedDomain(isFixedDomain_),
+        farDistance(bandWidth_ + 1),
+        nTiles(0),
+        nNarrowBand(0),
+        isMineTriggered(1)
+    {
+        errno = EINVAL;
+        slsm_check(bandWidth > 2, "Width of the narrow band must be greater than 2.");
+        slsm_check(((moveLimit > 0) && (moveLimit < 1)), "Move limit must be between 0 and 1.");
+
+        // Tiles cover all nodes, so may overhang the top and right of the domain.
+        nTilesX = (width + tileSize) / tileSize;
+        nTilesY = (height + tileSize) / tileSize;
+        nBlocksX = (nTilesX + blockSize - 1) / blockSize;
+        nBlocksY = (nTilesY + blockSize - 1) / blockSize;
+
+        // All tiles start inside the structure.
+        root.assign(nBlocksX*nBlocksY, insideTile);
+
+        // Initialise level set function from hole array.
+        initialise(holes);
+
+        // Initialise the narrow band.
+        initialiseNarrowBand();
+
+        return;
+
+    error:
+        exit(EXIT_FAILURE);
+    }
+
+    bool SparseLevelSet::update(double timeStep)
+    {
+        // Allocated tiles that contain narrow band nodes are partitioned between threads.
+        threadPool.run([&](unsigned int thread)
+        {
+            unsigned int start, end;
+            threadPool.range(activeTiles.size(), thread, start, end);
+
+            // Whether the boundary is within one grid spacing of a mine.
+            bool isTriggered = false;
+
+            for (unsigned int i=start;i<end;i++)
+            {
+                unsigned int first = activeTiles[i]*tileNodes;
+
+                for (unsigned int node=first;node<first+tileNodes;node++)
+                {
+                    if (nodeFlags[node] & SparseNodeFlag::ACTIVE)
+                    {
+                        signedDistance[node] -= timeStep * gradient[node] * velocity[node];
+
+                        // Enforce boundary condition.
+                        if ((nodeFlags[node] & SparseNodeFlag::DOMAIN) && (signedDistance[node] > 0))
+                            signedDistance[node] = 0;
+
+                        // Check mine nodes.
+                        if ((nodeFlags[node] & SparseNodeFlag::MINE) && (std::abs(signedDistance[node]) < 1.0))
+                            isTriggered = true;
+                    }
+                }
+            }
+
+            isMineTriggered[thread] = isTriggered;
+        });
+
+        // Check whether any thread triggered a mine.
+        for (unsigned int i=0;i<threadPool.size();i++)
+        {
+            if (isMineTriggered[i])
+            {
+                reinitialise();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void SparseLevelSet::reinitialise()
+    {
+        // Reinitialise the signed distance function, reallocating tiles.
+        march(false);
+
+        // Reinitialise the narrow band.
+        initialiseNarrowBand();
+    }
+
+    void SparseLevelSet::computeVelocities(const std::vector<BoundaryPoint>& boundaryPoints)
+    {
+        // Initialise velocity (map boundary points to boundary nodes).
+        initialiseVelocities(boundaryPoints);
+
+        // Extend the velocities across the narrow band.
+        march(true);
+    }
+
+    void SparseLevelSet::computeGradients()
+    {
+        // Reset gradients.
+        std::fill(gradient.begin(), gradient.end(), 0.0);
+
+        threadPool.run([&](unsigned int thread)
+        {
+            unsigned int start, end;
+            threadPool.range(activeTiles.size(), thread, start, end);
+
+            // Storage for the signed distance across a tile and its surroundings.
+            std::vector<double> patch((tileSize + 6)*(tileSize + 6));
+
+            for (unsigned int i=start;i<end;i++)
+                computeTileGradients(activeTiles[i], patch);
+        });
+    }
+
+    void SparseLevelSet::setThreads(unsigned int nThreads)
+    {
+        threadPool.resize(nThreads);
+        isMineTriggered.resize(threadPool.size());
+    }
+
+    double SparseLevelSet::getVelocity(unsigned int x, unsigned int y) const
+    {
+        unsigned int node = findNode(x, y);
+
+        if (node == none) return 0;
+        else return velocity[node];
+    }
+
+    double SparseLevelSet::getGradient(unsigned int x, unsigned int y) const
+    {
+        unsigned int node = findNode(x, y);
+
+        if (node == none) return 0;
+        else return gradient[node];
+    }
+
+    std::size_t SparseLevelSet::memoryUsage() const
+    {
+        std::size_t bytes = 0;
+
+        // Nodal data.
+        bytes += (signedDistance.capacity() + velocity.capacity() + gradient.capacity()
+            + signedDistanceCopy.capacity()) * sizeof(Real);
+        bytes += nodeFlags.capacity() + marchStatus.capacity() + isVelocitySet.capacity();
+        bytes += velocityWeight.capacity() * sizeof(double);
+
+        // Tile and block tables.
+        bytes += (tileX.capacity() + tileY.capacity() + root.capacity() + blockTiles.capacity()
+            + blockRoot.capacity() + blockCount.capacity() + freeTiles.capacity()
+            + freeBlocks.capacity() + activeTiles.capacity() + toFreeze.capacity()) * sizeof(unsigned int);
+        bytes += isTileFree.capacity();
+
+        return bytes;
+    }
+
+    void SparseLevelSet::initialise(const std::vector<Hole>& holes)
+    {
+        /* As for LevelSet, the signed distance is the distance from the closest
+           domain boundary, or hole surface. Only tiles that lie within reach of
+           the domain boundary, or a hole, can contain nodes in the narrow band,
+           or be outside of the structure. Any other tile is left inside.
+         */
+
+        // The last tile row (or column) that is within reach of the bottom (or left) edge.
+        unsigned int lowX = std::min(nTilesX - 1, (unsigned int) (farDistance / tileSize));
+        unsigned int lowY = std::min(nTilesY - 1, (unsigned int) (farDistance / tileSize));
+
+        // The first tile row (or column) that is within reach of the top (or right) edge.
+        unsigned int highX = (unsigned int) (std::max(0.0, width - farDistance) / tileSize);
+        unsigned int highY = (unsigned int) (std::max(0.0, height - farDistance) / tileSize);
+
+        // Tiles along the bottom and top edges.
+        for (unsigned int i=0;i<nTilesX;i++)
+        {
+            for (unsigned int j=0;j<=lowY;j++) initialiseTile(i, j, holes);
+            for (unsigned int j=highY;j<nTilesY;j++) initialiseTile(i, j, holes);
+        }
+
+        // Tiles along the left and right edges.
+        for (unsigned int j=0;j<nTilesY;j++)
+        {
+            for (unsigned int i=0;i<=lowX;i++) initialiseTile(i, j, holes);
+            for (unsigned int i=highX;i<nTilesX;i++) initialiseTile(i, j, holes);
+        }
+
+        // Tiles that overlap the bounding box of each hole (and its band).
+        for (unsigned int k=0;k<holes.size();k++)
+        {
+            double reach = holes[k].r + farDistance;
+
+            double minX = std::max(0.0, holes[k].coord.x - reach);
+            double maxX = std::min(double(width), holes[k].coord.x + reach);
+            double minY = std::max(0.0, holes[k].coord.y - reach);
+            double maxY = std::min(double(height), holes[k].coord.y + reach);
+
+            // Hole lies outside of the domain.
+            if ((minX > maxX) || (minY > maxY)) continue;
+
+            for (unsigned int j=(unsigned int) minY / tileSize;j<=(unsigned int) maxY / tileSize;j++)
+            {
+                for (unsigned int i=(unsigned int) minX / tileSize;i<=(unsigned int) maxX / tileSize;i++)
+                    initialiseTile(i, j, holes);
+            }
+        }
+    }
+
+    void SparseLevelSet::initialiseTile(unsigned int tileX_, unsigned int tileY_, const std::vector<Hole>& holes)
+    {
+        // Tile has already been allocated, or found to be outside.
+        if (findTile(tileX_, tileY_) != insideTile) return;
+
+        // Extent of the tile within the domain.
+        unsigned int x0 = tileX_*tileSize;
+        unsigned int y0 = tileY_*tileSize;
+        unsigned int x1 = std::min(x0 + tileSize - 1, width);
+        unsigned int y1 = std::min(y0 + tileSize - 1, height);
+
+        // Bounds on the distance from the closest domain boundary.
+        double lower = std::min(std::min(x0, width - x1), std::min(y0, height - y1));
+        double upper = std::min(std::min(x1, width - x0), std::min(y1, height - y0));
+
+        // Bounds on the distance from the surface of each hole.
+        for (unsigned int k=0;k<holes.size();k++)
+        {
+            double cx = holes[k].coord.x;
+            double cy = holes[k].coord.y;
+
+            // Closest and furthest separations in each direction.
+            double nearX = std::max(0.0, std::max(x0 - cx, cx - x1));
+            double nearY = std::max(0.0, std::max(y0 - cy, cy - y1));
+            double farX = std::max(std::abs(x0 - cx), std::abs(x1 - cx));
+            double farY = std::max(std::abs(y0 - cy), std::abs(y1 - cy));
+
+            lower = std::min(lower, sqrt(nearX*nearX + nearY*nearY) - holes[k].r);
+            upper = std::min(upper, sqrt(farX*farX + farY*farY) - holes[k].r);
+        }
+
+        // All nodes are far inside the structure.
+        if (lower >= farDistance) return;
+
+        // All nodes are far outside the structure.
+        if (upper <= -farDistance)
+        {
+            setTileFlag(tileX_, tileY_, outsideTile);
+            return;
+        }
+
+        unsigned int slot = allocateTile(tileX_, tileY_);
+
+        // Whether any node lies within the band.
+        bool isBand = false;
+
+        // Compute the signed distance at each node.
+        for (unsigned int y=y0;y<=y1;y++)
+        {
+            for (unsigned int x=x0;x<=x1;x++)
+            {
+                double dist = std::min(std::min(x, width - x), std::min(y, height - y));
+
+                for (unsigned int k=0;k<holes.size();k++)
+                {
+                    // Work out x and y distance of the node from the hole centre.
+                    double dx = holes[k].coord.x - x;
+                    double dy = holes[k].coord.y - y;
+
+                    // Signed distance from the hole surface.
+                    dist = std::min(dist, sqrt(dx*dx + dy*dy) - holes[k].r);
+                }
+
+                if (std::abs(dist) < farDistance) isBand = true;
+
+                // Clamp to the far field.
+                dist = std::max(-farDistance, std::min(farDistance, dist));
+
+                signedDistance[slot*tileNodes + (x - x0) + (y - y0)*tileSize] = dist;
+            }
+        }
+
+        // The bounds weren't tight enough, store the tile as a flag.
+        if (!isBand)
+        {
+            bool isInside = signedDistance[slot*tileNodes] > 0;
+            freeTile(slot, isInside ? insideTile : outsideTile);
+        }
+    }
+
+    void SparseLevelSet::initialiseNarrowBand()
+    {
+        unsigned int mineWidth = bandWidth - 1;
+
+        // Reset the number of nodes in the narrow band.
+        nNarrowBand = 0;
+
+        // Reset the list of tiles that contain narrow band nodes.
+        activeTiles.clear();
+
+        for (unsigned int slot=0;slot<isTileFree.size();slot++)
+        {
+            if (isTileFree[slot]) continue;
+
+            // Whether the tile contains a narrow band node.
+            bool isActive = false;
+
+            for (unsigned int node=slot*tileNodes;node<(slot+1)*tileNodes;node++)
+            {
+                // Flag node as inactive.
+                nodeFlags[node] &= ~(SparseNodeFlag::ACTIVE | SparseNodeFlag::MINE);
+
+                // Node lies outside the domain, or on a fixed domain boundary.
+                if ((nodeFlags[node] & SparseNodeFlag::PADDING) ||
+                    ((nodeFlags[node] & SparseNodeFlag::DOMAIN) && isFixedDomain)) continue;
+
+                // Absolute value of the signed distance function.
+                double absoluteSignedDistance = std::abs(signedDistance[node]);
+
+                // Node lies inside band.
+                if (absoluteSignedDistance < bandWidth)
+                {
+                    nodeFlags[node] |= SparseNodeFlag::ACTIVE;
+                    nNarrowBand++;
+                    isActive = true;
+
+                    // Node lies at edge of band.
+                    if (absoluteSignedDistance > mineWidth)
+                        nodeFlags[node] |= SparseNodeFlag::MINE;
+                }
+            }
+
+            if (isActive) activeTiles.push_back(slot);
+        }
+    }
+
+    unsigned int SparseLevelSet::allocateBlock(unsigned int block)
+    {
+        unsigned int entry = root[block];
+
+        // Block already has a tile table.
+        if (entry < outsideTile) return entry;
+
+        // The number of tiles in a block.
+        const unsigned int blockTileCount = blockSize*blockSize;
+
+        unsigned int index;
+
+        // Reuse a free table.
+        if (!freeBlocks.empty())
+        {
+            index = freeBlocks.back();
+            freeBlocks.pop_back();
+            std::fill(blockTiles.begin() + index*blockTileCount,
+                      blockTiles.begin() + (index + 1)*blockTileCount, entry);
+        }
+
+        // Add a table to the end of the array.
+        else
+        {
+            index = blockRoot.size();
+            blockTiles.resize(blockTiles.size() + blockTileCount, entry);
+            blockRoot.push_back(0);
+            blockCount.push_back(0);
+        }
+
+        // All tiles inherit the flag of the block.
+        blockRoot[index] = block;
+        blockCount[index] = 0;
+        root[block] = index;
+
+        return index;
+    }
+
+    unsigned int SparseLevelSet::allocateTile(unsigned int tileX_, unsigned int tileY_)
+    {
+        unsigned int block = allocateBlock((tileX_ / blockSize) + (tileY_ / blockSize) * nBlocksX);
+        unsigned int entry = block*blockSize*blockSize + (tileX_ % blockSize) + (tileY_ % blockSize) * blockSize;
+
+        // The signed distance of nodes in the unallocated tile.
+        Real value = (blockTiles[entry] == insideTile) ? farDistance : -farDistance;
+
+        unsigned int slot;
+
+        // Reuse a free slot.
+        if (!freeTiles.empty())
+        {
+            slot = freeTiles.back();
+            freeTiles.pop_back();
+        }
+
+        // Add a slot to the end of the arrays.
+        else
+        {
+            slot = isTileFree.size();
+
+            signedDistance.resize(signedDistance.size() + tileNodes);
+            velocity.resize(velocity.size() + tileNodes);
+            gradient.resize(gradient.size() + tileNodes);
+            nodeFlags.resize(nodeFlags.size() + tileNodes);
+            signedDistanceCopy.resize(signedDistanceCopy.size() + tileNodes);
+            marchStatus.resize(marchStatus.size() + tileNodes);
+            tileX.push_back(0);
+            tileY.push_back(0);
+            isTileFree.push_back(false);
+        }
+
+        blockTiles[entry] = slot;
+        blockCount[block]++;
+
+        tileX[slot] = tileX_;
+        tileY[slot] = tileY_;
+        isTileFree[slot] = false;
+        nTiles++;
+
+        // Initialise the nodes of the tile.
+        for (unsigned int i=0;i<tileNodes;i++)
+        {
+            unsigned int node = slot*tileNodes + i;
+            unsigned int x = tileX_*tileSize + (i % tileSize);
+            unsigned int y = tileY_*tileSize + (i / tileSize);
+
+            signedDistance[node] = value;
+            signedDistanceCopy[node] = value;
+            velocity[node] = 0;
+            gradient[node] = 0;
+            marchStatus[node] = FMM_NodeStatus::NONE;
+
+            if ((x > width) || (y > height)) nodeFlags[node] = SparseNodeFlag::PADDING;
+            else if ((x == 0) || (x == width) || (y == 0) || (y == height)) nodeFlags[node] = SparseNodeFlag::DOMAIN;
+            else nodeFlags[node] = SparseNodeFlag::NONE;
+        }
+
+        return slot;
+    }
+
+    void SparseLevelSet::freeTile(unsigned int slot, unsigned int flag)
+    {
+        unsigned int block = root[(tileX[slot] / blockSize) + (tileY[slot] / blockSize) * nBlocksX];
+
+        blockTiles[block*blockSize*blockSize + (tileX[slot] % blockSize)
+            + (tileY[slot] % blockSize) * blockSize] = flag;
+        blockCount[block]--;
+
+        isTileFree[slot] = true;
+        freeTiles.push_back(slot);
+        nTiles--;
+
+        // Collapse the block if it's now uniform.
+        compactBlock(block);
+    }
+
+    void SparseLevelSet::setTileFlag(unsigned int tileX_, unsigned int tileY_, unsigned int flag)
+    {
+        unsigned int index = (tileX_ / blockSize) + (tileY_ / blockSize) * nBlocksX;
+
+        // The whole block already has the same flag.
+        if (root[index] == flag) return;
+
+        unsigned int block = allocateBlock(index);
+
+        blockTiles[block*blockSize*blockSize + (tileX_ % blockSize) + (tileY_ % blockSize) * blockSize] = flag;
+
+        // Collapse the block if it's now uniform.
+        compactBlock(block);
+    }
+
+    void SparseLevelSet::compactBlock(unsigned int block)
+    {
+        // Block contains allocated tiles.
+        if (blockCount[block] > 0) return;
+
+        const unsigned int blockTileCount = blockSize*blockSize;
+        unsigned int flag = blockTiles[block*blockTileCount];
+
+        // Check that all tiles have the same flag.
+        for (unsigned int i=1;i<blockTileCount;i++)
+        {
+            if (blockTiles[block*blockTileCount + i] != flag) return;
+        }
+
+        // Replace the table by the flag.
+        root[blockRoot[block]] = flag;
+        freeBlocks.push_back(block);
+    }
+
+    bool SparseLevelSet::nodeCoord(unsigned int node, unsigned int& x, unsigned int& y) const
+    {
+        unsigned int slot = node / tileNodes;
+        unsigned int local = node - slot*tileNodes;
+
+        x = tileX[slot]*tileSize + (local % tileSize);
+        y = tileY[slot]*tileSize + (local / tileSize);
+
+        return ((x <= width) && (y <= height));
+    }
+
+    unsigned int SparseLevelSet::findNeighbour(unsigned int node, unsigned int direction) const
+    {
+        unsigned int x, y;
+        nodeCoord(node, x, y);
+
+        unsigned int local = node % tileNodes;
+
+        // Neighbours are ordered: left, right, down, up.
+        switch (direction)
+        {
+            case 0:
+                if (x == 0) return none;
+                else if ((local % tileSize) > 0) return node - 1;
+                else return findNode(x - 1, y);
+
+            case 1:
+                if (x == width) return none;
+                else if ((local % tileSize) < (tileSize - 1)) return node + 1;
+                else return findNode(x + 1, y);
+
+            case 2:
+                if (y == 0) return none;
+                else if (local >= tileSize) return node - tileSize;
+                else return findNode(x, y - 1);
+
+            default:
+                if (y == height) return none;
+                else if (local < (tileNodes - tileSize)) return node + tileSize;
+                else return findNode(x, y + 1);
+        }
+    }
+
+    unsigned int SparseLevelSet::getNeighbour(unsigned int node, unsigned int direction, bool isAllocate)
+    {
+        unsigned int neighbour = findNeighbour(node, direction);
+
+        if ((neighbour != none) || !isAllocate) return neighbour;
+
+        unsigned int x, y;
+        nodeCoord(node, x, y);
+
+        // Neighbour lies outside of the domain.
+        if (((direction == 0) && (x == 0)) || ((direction == 1) && (x == width)) ||
+            ((direction == 2) && (y == 0)) || ((direction == 3) && (y == height))) return none;
+
+        x += neighbourX[direction];
+        y += neighbourY[direction];
+
+        // Allocate the tile that contains the neighbour.
+        allocateTile(x / tileSize, y / tileSize);
+
+        return findNode(x, y);
+    }
+
+    void SparseLevelSet::march(bool isVelocity)
+    {
+        // Clear the status of all nodes and store a copy of the level set.
+        for (unsigned int slot=0;slot<isTileFree.size();slot++)
+        {
+            if (isTileFree[slot]) continue;
+
+            for (unsigned int node=slot*tileNodes;node<(slot+1)*tileNodes;node++)
+            {
+                marchStatus[node] = FMM_NodeStatus::NONE;
+                signedDistanceCopy[node] = signedDistance[node];
+            }
+        }
+
+        // Empty the priority queue.
+        while (!queue.empty()) queue.pop();
+
+        // Initialise the set of frozen boundary nodes.
+        initialiseFrozen();
+
+        // Initialise the set of trial nodes adjacent to the boundary.
+        initialiseTrial(isVelocity);
+
+        // Find the fast marching solution.
+        solve(isVelocity);
+
+        // Restore the original signed distance function. Only update velocities.
+        if (isVelocity)
+        {
+            for (unsigned int slot=0;slot<isTileFree.size();slot++)
+            {
+                if (isTileFree[slot]) continue;
+
+                for (unsigned int node=slot*tileNodes;node<(slot+1)*tileNodes;node++)
+                    signedDistance[node] = signedDistanceCopy[node];
+            }
+        }
+
+        // Clamp the far field and release unused tiles.
+        else finaliseMarch();
+    }
+
+    void SparseLevelSet::initialiseFrozen()
+    {
+        // The number of frozen nodes.
+        unsigned int nFrozen = 0;
+
+        // First find all zero values of the level set.
+        for (unsigned int slot=0;slot<isTileFree.size();slot++)
+        {
+            if (isTileFree[slot]) continue;
+
+            for (unsigned int node=slot*tileNodes;node<(slot+1)*tileNodes;node++)
+            {
+                if (!(nodeFlags[node] & SparseNodeFlag::PADDING) && (signedDistanceCopy[node] == 0))
+                {
+                    marchStatus[node] = FMM_NodeStatus::FROZEN;
+                    nFrozen++;
+                }
+            }
+        }
+
+        // Now check whether the neighbours of each node (in any direction)
+        // are on opposite sides of the zero contour.
+        for (unsigned int slot=0;slot<isTileFree.size();slot++)
+        {
+            if (isTileFree[slot]) continue;
+
+            for (unsigned int node=slot*tileNodes;node<(slot+1)*tileNodes;node++)
+            {
+                // Only consider nodes in the domain that haven't yet been frozen.
+                if ((nodeFlags[node] & SparseNodeFlag::PADDING) ||
+                    (marchStatus[node] != FMM_NodeStatus::NONE)) continue;
+
+                // Whether level set changes sign between a node and its neighbour.
+                bool isBorder = false;
+
+                // Initialise distance array.
+                double dist[2] = {0, 0};
+
+                // Loop over all neighbours.
+                for (unsigned int j=0;j<4;j++)
+                {
+                    unsigned int neighbour = findNeighbour(node, j);
+
+                    // Neighbour lies outside the domain, or far from the zero contour.
+                    if (neighbour == none) continue;
+
+                    // Level set changes sign along direction.
+                    if ((signedDistanceCopy[node] * signedDistanceCopy[neighbour]) < 0)
+                    {
+                        isBorder = true;
+
+                        // Calculate the distance to the zero contour (linear interpolation).
+                        double d = signedDistanceCopy[node] / (signedDistanceCopy[node] - signedDistanceCopy[neighbour]);
+
+                        // Set dimension (neighbours 0 and 1 are x dimension, 2 and 3 are y).
+                        unsigned int dim = (j < 2) ? 0 : 1;
+
+                        // Check if distance is less than current value.
+                        if (dist[dim] == 0 || dist[dim] > d)
+                            dist[dim] = d;
+                    }
+                }
+
+                // Node and neighbour span the zero contour.
+                if (isBorder)
+                {
+                    double distSum = 0;
+
+                    // Calculate perpendicular distance to boundary (Pythag.)
+                    for (unsigned int j=0;j<2;j++)
+                    {
+                        if (dist[j] > 0)
+                            distSum += 1.0 / (dist[j] * dist[j]);
+                    }
+
+                    // Update signed distance.
+                    if (signedDistanceCopy[node] < 0) signedDistance[node] = -sqrt(1.0 / distSum);
+                    else signedDistance[node] = sqrt(1.0 / distSum);
+
+                    marchStatus[node] = FMM_NodeStatus::FROZEN;
+                    nFrozen++;
+                }
+            }
+        }
+
+        errno = 0;
+        slsm_check(nFrozen > 0, "There are no frozen nodes!");
+
+        return;
+
+    error:
+        exit(EXIT_FAILURE);
+    }
+
+    void SparseLevelSet::initialiseTrial(bool isVelocity)
+    {
+        // For each node, check whether it has a frozen neighbour.
+        // If so, calculate the distance from the zero contour and insert into queue.
+        for (unsigned int slot=0;slot<isTileFree.size();slot++)
+        {
+            if (isTileFree[slot]) continue;
+
+            for (unsigned int node=slot*tileNodes;node<(slot+1)*tileNodes;node++)
+            {
+                // Node is outside the domain, or already has a status.
+                if ((nodeFlags[node] & SparseNodeFlag::PADDING) ||
+                    (marchStatus[node] != FMM_NodeStatus::NONE)) continue;
+
+                // Velocities are only extended to nodes inside the narrow band.
+                if (isVelocity && !(nodeFlags[node] & SparseNodeFlag::ACTIVE)) continue;
+
+                for (unsigned int j=0;j<4;j++)
+                {
+                    unsigned int neighbour = findNeighbour(node, j);
+
+                    if ((neighbour != none) && (marchStatus[neighbour] & FMM_NodeStatus::FROZEN))
+                    {
+                        // Flag node as in trial band.
+                        marchStatus[node] = FMM_NodeStatus::TRIAL;
+
+                        // Get distance from zero contour and add to queue.
+                        signedDistance[node] = updateNode(node);
+                        queue.push(std::make_pair(std::abs(double(signedDistance[node])), node));
+
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    void SparseLevelSet::solve(bool isVelocity)
+    {
+        /* This is the same as the main loop of FastMarchingMethod::solve, except
+           that tiles are allocated when the front reaches them (when computing
+           the signed distance), and marching stops at the far field distance.
+           Velocity extension is already limited to the narrow band, so it runs
+           until the queue is empty, as in the dense case.
+         */
+
+        unsigned int node;
+        double value;
+
+        // Distance beyond which marching stops.
+        double maxDistance = isVelocity ? std::numeric_limits<double>::max() : farDistance;
+
+        while (queuePeek() <= maxDistance)
+        {
+            // Pop top entry off queue.
+            queuePop(node, value);
+
+            toFreeze.clear();
+
+            // Mark node as frozen.
+            marchStatus[node] = FMM_NodeStatus::FROZEN;
+            if (isVelocity) finaliseVelocity(node);
+            toFreeze.push_back(node);
+
+            // Freeze all other nodes at the same distance.
+            while (queuePeek() == value)
+            {
+                queuePop(node, value);
+
+                marchStatus[node] = FMM_NodeStatus::FROZEN;
+                if (isVelocity) finaliseVelocity(node);
+                toFreeze.push_back(node);
+            }
+
+            // Loop over all frozen nodes.
+            for (unsigned int i=0;i<toFreeze.size();i++)
+            {
+                // Loop over all neighbours of frozen node.
+                for (unsigned int j=0;j<4;j++)
+                {
+                    unsigned int neighbour = getNeighbour(toFreeze[i], j, !isVelocity);
+
+                    // Neighbour lies within domain boundary and hasn't been frozen.
+                    if ((neighbour == none) || (marchStatus[neighbour] & FMM_NodeStatus::FROZEN)) continue;
+
+                    // Calculate and store updated distance estimate.
+                    signedDistance[neighbour] = updateNode(neighbour);
+
+                    // Neighbour is in trial band, push the updated value
+                    // (the previous entry becomes stale).
+                    if (marchStatus[neighbour] & FMM_NodeStatus::TRIAL)
+                        queue.push(std::make_pair(std::abs(double(signedDistance[neighbour])), neighbour));
+
+                    // Neighbour has no status (far field).
+                    else if (!isVelocity || (nodeFlags[neighbour] & SparseNodeFlag::ACTIVE))
+                    {
+                        marchStatus[neighbour] = FMM_NodeStatus::TRIAL;
+                        queue.push(std::make_pair(std::abs(double(signedDistance[neighbour])), neighbour));
+                    }
+
+                    // Now update the far field point in the second order stencil.
+                    unsigned int next = findNeighbour(neighbour, j);
+
+                    if ((next != none) && (marchStatus[next] & FMM_NodeStatus::TRIAL))
+                    {
+                        signedDistance[next] = updateNode(next);
+                        queue.push(std::make_pair(std::abs(double(signedDistance[next])), next));
+                    }
+                }
+            }
+        }
+    }
+
+    void SparseLevelSet::finaliseMarch()
+    {
+        for (unsigned int slot=0;slot<isTileFree.size();slot++)
+        {
+            if (isTileFree[slot]) continue;
+
+            // Whether any node lies within the band.
+            bool isBand = false;
+
+            for (unsigned int node=slot*tileNodes;node<(slot+1)*tileNodes;node++)
+            {
+                if (nodeFlags[node] & SparseNodeFlag::PADDING) continue;
+
+                // Nodes that weren't frozen lie beyond the cutoff.
+                if (marchStatus[node] != FMM_NodeStatus::FROZEN)
+                {
+                    if (signedDistanceCopy[node] < 0) signedDistance[node] = -farDistance;
+                    else signedDistance[node] = farDistance;
+                }
+                else if (std::abs(signedDistance[node]) < farDistance) isBand = true;
+            }
+
+            // The tile can be represented by its sign.
+            if (!isBand)
+            {
+                bool isInside = signedDistance[slot*tileNodes] > 0;
+                freeTile(slot, isInside ? insideTile : outsideTile);
+            }
+        }
+    }
+
+    bool SparseLevelSet::queuePop(unsigned int& node, double& value)
+    {
+        while (!queue.empty())
+        {
+            value = queue.top().first;
+            node = queue.top().second;
+            queue.pop();
+
+            // Skip entries for nodes that have since been updated, or frozen.
+            if ((marchStatus[node] == FMM_NodeStatus::TRIAL) &&
+                (value == std::abs(double(signedDistance[node])))) return true;
+        }
+
+        return false;
+    }
+
+    double SparseLevelSet::queuePeek()
+    {
+        while (!queue.empty())
+        {
+            unsigned int node = queue.top().second;
+
+            if ((marchStatus[node] == FMM_NodeStatus::TRIAL) &&
+                (queue.top().first == std::abs(double(signedDistance[node])))) return queue.top().first;
+
+            // Discard the stale entry.
+            queue.pop();
+        }
+
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double SparseLevelSet::updateNode(unsigned int node) const
+    {
+        // Reused constants.
+        const double aa = 9.0/4.0;
+        const double oneThird = 1.0/3.0;
+        const double maxDouble = std::numeric_limits<double>::max();
+
+        // Quadratic coefficients.
+        double a, b, c;
+
+        // Zero coefficients.
+        a = b = c = 0;
+
+        double dist1, dist2;
+
+        // Loop over all dimensions.
+        for (unsigned int i=0;i<2;i++)
+        {
+            // Initialise distances.
+            dist1 = maxDouble;
+            dist2 = maxDouble;
+
+            // Loop over all directions.
+            for (unsigned int j=0;j<2;j++)
+            {
+                // First neighbour.
+                unsigned int n1 = findNeighbour(node, 2*i + j);
+
+                // Neighbour is frozen.
+                if ((n1 != none) && (marchStatus[n1] & FMM_NodeStatus::FROZEN))
+                {
+                    // Make sure neighbour is closer to the zero contour (upwind).
+                    if (std::abs(signedDistance[n1]) < std::abs(dist1))
+                    {
+                        // Store distance.
+                        dist1 = signedDistance[n1];
+
+                        // Second neighbour in same direction.
+                        unsigned int n2 = findNeighbour(n1, 2*i + j);
+
+                        // Neighbour is frozen and closer to the zero contour (upwind).
+                        if ((n2 != none) && (marchStatus[n2] & FMM_NodeStatus::FROZEN)
+                            && (std::abs(signedDistance[n2]) <= std::abs(dist1)))
+                        {
+                            // Store distance.
+                            dist2 = signedDistance[n2];
+                        }
+                    }
+                }
+            }
+
+            // Second order finite difference.
+            if (dist2 < maxDouble)
+            {
+                double tp = oneThird*(4*dist1 - dist2);
+
+                a += aa;
+                b -= 2*aa*tp;
+                c += aa*tp*tp;
+            }
+            // First order finite difference.
+            else if (dist1 < maxDouble)
+            {
+                a += 1;
+                b -= 2*dist1;
+                c += dist1*dist1;
+            }
+        }
+
+        // Update coefficient.
+        c -= 1;
+
+        return FastMarchingMethod::solveQuadratic(a, b, c, signedDistance[node],
+            signedDistanceCopy[node] > std::numeric_limits<double>::epsilon());
+    }
+
+    void SparseLevelSet::finaliseVelocity(unsigned int node)
+    {
+        // Set the velocity of this node, i.e.
+        // find v_ext, where grad v_ext . grad phi = 0
+
+        // Initialise distance array.
+        double dist[2] = {0, 0};
+
+        // Initialise front (zero contour) distance array.
+        double frontDist[2] = {0, 0};
+
+        // Whether the front distance has been set.
+        bool isSet[2] = {false, false};
+
+        // Initialise velocity array.
+        double vel[2] = {0, 0};
+
+        // Loop over all neighbours of the node.
+        for (unsigned int i=0;i<4;i++)
+        {
+            // Set dimension (neighbours 0 and 1 are x dimension, 2 and 3 are y).
+            unsigned int dim = (i < 2) ? 0 : 1;
+
+            unsigned int neighbour = findNeighbour(node, i);
+
+            // Neighbour is frozen.
+            if ((neighbour != none) && (marchStatus[neighbour] & FMM_NodeStatus::FROZEN))
+            {
+                // Absolute signed distance of the neighbouring node.
+                double d = std::abs(signedDistance[neighbour]);
+
+                // Check whether the neighbour is closer to the zero contour.
+                if (!isSet[dim] || (frontDist[dim] > d))
+                {
+                    // Store updated distance to the front.
+                    frontDist[dim] = d;
+
+                    // Flag that the front distance has been set.
+                    isSet[dim] = true;
+
+                    // Calculate the distance to the front in this direction.
+                    d = signedDistance[node] - signedDistance[neighbour];
+
+                    // Store absolute distance and velocity.
+                    dist[dim] = std::abs(d);
+                    vel[dim] = velocity[neighbour];
+                }
+            }
+        }
+
+        double numerator = 0;
+        double denominator = 0;
+
+        for (unsigned int i=0;i<2;i++)
+        {
+            numerator += dist[i] * vel[i];
+            denominator += dist[i];
+        }
+
+        errno = 0;
+        slsm_check(denominator != 0, "Divide by zero error.");
+
+        velocity[node] = numerator / denominator;
+
+        return;
+
+    error:
+        exit(EXIT_FAILURE);
+    }
+
+    void SparseLevelSet::initialiseVelocities(const std::vector<BoundaryPoint>& boundaryPoints)
+    {
+        // Map boundary point velocities to nodes of the level set domain
+        // using inverse squared distance interpolation.
+
+        // Resize scratch arrays (memory is retained between calls).
+        isVelocitySet.resize(signedDistance.size());
+        velocityWeight.resize(signedDistance.size());
+
+        // Initialise arrays.
+        std::fill(isVelocitySet.begin(), isVelocitySet.end(), false);
+        std::fill(velocityWeight.begin(), velocityWeight.end(), 0.0);
+        std::fill(velocity.begin(), velocity.end(), 0.0);
+
+        // Loop over all boundary points.
+        for (unsigned int i=0;i<boundaryPoints.size();i++)
+        {
+            // Find the closest node.
+            double px = std::max(0.0, std::min(double(width), boundaryPoints[i].coord.x));
+            double py = std::max(0.0, std::min(double(height), boundaryPoints[i].coord.y));
+            unsigned int node = findNode(std::floor(px + 0.5), std::floor(py + 0.5));
+
+            // The zero contour must lie within an allocated tile.
+            if (node == none) continue;
+
+            // Loop over the node and its neighbours.
+            for (unsigned int j=0;j<5;j++)
+            {
+                unsigned int neighbour = (j == 0) ? node : findNeighbour(node, j - 1);
+
+                // Make sure neighbour is in bounds.
+                if (neighbour == none) continue;
+
+                unsigned int x, y;
+                nodeCoord(neighbour, x, y);
+
+                // Distance from the boundary point to the node.
+                double dx = x - boundaryPoints[i].coord.x;
+                double dy = y - boundaryPoints[i].coord.y;
+
+                // Squared distance.
+                double rSqd = dx*dx + dy*dy;
+
+                // If boundary point lies exactly on the node, then set velocity
+                // to that of the boundary point.
+                if (rSqd < 1e-6)
+                {
+                    velocity[neighbour] = boundaryPoints[i].velocity;
+                    velocityWeight[neighbour] = 1.0;
+                    isVelocitySet[neighbour] = true;
+                }
+                else if ((j == 0) || (rSqd <= 1.0))
+                {
+                    // Update velocity estimate if not already set.
+                    if (!isVelocitySet[neighbour])
+                    {
+                        velocity[neighbour] += boundaryPoints[i].velocity / rSqd;
+                        velocityWeight[neighbour] += 1.0 / rSqd;
+                    }
+                }
+            }
+        }
+
+        // Compute interpolated velocity.
+        for (unsigned int i=0;i<activeTiles.size();i++)
+        {
+            for (unsigned int node=activeTiles[i]*tileNodes;node<(activeTiles[i]+1)*tileNodes;node++)
+            {
+                if ((nodeFlags[node] & SparseNodeFlag::ACTIVE) && velocity[node])
+                    velocity[node] /= velocityWeight[node];
+            }
+        }
+    }
+
+    void SparseLevelSet::computeTileGradients(unsigned int slot, std::vector<double>& patch)
+    {
+        // The width of the patch.
+        const int patchSize = tileSize + 6;
+
+        // Position of the bottom left node of the tile.
+        int x0 = tileX[slot]*tileSize;
+        int y0 = tileY[slot]*tileSize;
+
+        // Gather the signed distance across the tile and its surroundings. Nodes
+        // outside of the domain are never used, so are given clamped values.
+        for (int j=0;j<patchSize;j++)
+        {
+            unsigned int y = std::max(0, std::min(int(height), y0 + j - 3));
+
+            for (int i=0;i<patchSize;i++)
+            {
+                unsigned int x = std::max(0, std::min(int(width), x0 + i - 3));
+                patch[i + j*patchSize] = getSignedDistance(x, y);
+            }
+        }
+
+        for (unsigned int i=0;i<tileNodes;i++)
+        {
+            unsigned int node = slot*tileNodes + i;
+
+            if (!(nodeFlags[node] & SparseNodeFlag::ACTIVE)) continue;
+
+            // Nodal coordinates.
+            int x = x0 + (i % tileSize);
+            int y = y0 + (i / tileSize);
+
+            // Index of the node in the patch.
+            int p = (x - x0 + 3) + (y - y0 + 3)*patchSize;
+
+            // Nodal signed distance.
+            double lsf = patch[p];
+
+            // Corner nodes use the diagonal node if the signed distance is the
+            // same at both neighbours (see LevelSet::computeGradient).
+            if (((x == 0) || (x == int(width))) && ((y == 0) || (y == int(height))))
+            {
+                int dx = (x == 0) ? 1 : -1;
+                int dy = (y == 0) ? patchSize : -patchSize;
+
+                if ((std::abs(patch[p + dx] - lsf) < 1e-6) && (std::abs(patch[p + dy] - lsf) < 1e-6))
+                {
+                    gradient[node] = sqrt(2.0) * std::abs(lsf - patch[p + dx + dy]);
+                    continue;
+                }
+            }
+
+            /* Differences between neighbouring nodes. Differences that lie
+               outside of the domain are replaced by those at the edge, which is
+               equivalent to the extrapolation used by LevelSet::computeGradient.
+             */
+            double dX[6], dY[6];
+
+            for (int k=0;k<6;k++)
+            {
+                // Difference between node x+k-2 (or y+k-2) and the one before.
+                int xk = std::max(1, std::min(int(width), x + k - 2));
+                int yk = std::max(1, std::min(int(height), y + k - 2));
+
+                dX[k] = patch[p + (xk - x)] - patch[p + (xk - x) - 1];
+                dY[k] = patch[p + (yk - y)*patchSize] - patch[p + (yk - y - 1)*patchSize];
+            }
+
+            // Upwind direction.
+            int sign = velocity[node] < 0 ? -1 : 1;
+
+            double gradRight = sign * LevelSet::gradHJWENO(dX[5], dX[4], dX[3], dX[2], dX[1]);
+            double gradLeft  = sign * LevelSet::gradHJWENO(dX[0], dX[1], dX[2], dX[3], dX[4]);
+            double gradUp    = sign * LevelSet::gradHJWENO(dY[5], dY[4], dY[3], dY[2], dY[1]);
+            double gradDown  = sign * LevelSet::gradHJWENO(dY[0], dY[1], dY[2], dY[3], dY[4]);
+
+            // Compute gradient using upwind scheme.
+            double grad = 0;
+
+            if (gradDown > 0)   grad += gradDown * gradDown;
+            if (gradLeft > 0)   grad += gradLeft * gradLeft;
+            if (gradUp < 0)     grad += gradUp * gradUp;
+            if (gradRight < 0)  grad += gradRight * gradRight;
+
+            gradient[node] = sqrt(grad);
+        }
+    }
+}
@@ -0,0 +1,495 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SPARSELEVELSET_H
+#define _SPARSELEVELSET_H
+
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "Common.h"
+#include "ThreadPool.h"
+
+/*! \file SparseLevelSet.h
+    \brief A class for a sparse (tiled) level set function.
+ */
+
+namespace slsm
+{
+    // FORWARD DECLARATIONS
+
+    class BoundaryPoint;
+    class Hole;
+
+    // ASSOCIATED DATA TYPES
+
+    //! Flags for the nodes of a sparse level set.
+    namespace SparseNodeFlag
+    {
+        // Left bit shift enumerated types to allow the creation
+        // of sets and simple bit masking operations.
+        enum SparseNodeFlag
+        {
+            NONE    = 0,        //!< No flags.
+            ACTIVE  = (1 << 0), //!< Node lies in the narrow band.
+            MINE    = (1 << 1), //!< Node lies at the edge of the narrow band.
+            DOMAIN  = (1 << 2), //!< Node lies on the domain boundary.
+            PADDING = (1 << 3), //!< Node lies in a tile, but outside of the domain.
+        };
+    }
+
+    // MAIN CLASS
+
+    /*! \brief A class for a level set function that is only stored close to the zero contour.
+
+        The domain is divided into square tiles of nodes. Tiles are only
+        allocated if they contain a node that lies within the narrow band, i.e.
+        within bandWidth + 1 of the zero contour. Any other tile is represented
+        by a single flag, which records whether it lies inside or outside of the
+        structure, and nodes in these tiles have a signed distance of plus or
+        minus bandWidth + 1. Memory use therefore scales with the length of the
+        boundary, rather than the area of the domain, which allows the use of
+        domains that are far too large to store as dense arrays.
+
+        Tiles are looked up using a two level tree (similar to OpenVDB). A dense
+        root table covers the domain in blocks of tiles. Each entry of the root
+        table either holds the flag for a block that contains no allocated tiles,
+        or the index of a table of tiles for the block, which holds either the
+        slot of an allocated tile, or a flag. Data for allocated tiles is held in
+        flat arrays with one entry per node, tile by tile, with nodes in each tile
+        numbered row by row. A node is referred to by its index in these arrays.
+        Slots of deallocated tiles are reused.
+
+        The signed distance function is reinitialised using a narrow band
+        implementation of the Fast Marching Method, which uses the same
+        second-order upwind stencil as FastMarchingMethod, and allocates new
+        tiles as the front advances. Tiles that don't contain any nodes within
+        the band are then deallocated. Velocities are extended from the boundary
+        in the same way. The gradient of the signed distance function is computed
+        using the Hamilton-Jacobi WENO approximation, as in the LevelSet class.
+
+        Only the default domain boundary and circular holes are supported for
+        initialisation. Use Boundary::discretise to compute the discretised zero
+        contour.
+     */
+    class SparseLevelSet
+    {
+    public:
+        //! Constructor.
+        /*! \param width_
+                The width of the domain.
+
+            \param height_
+                The height of the domain.
+
+            \param holes
+                A vector of holes.
+
+            \param moveLimit_
+                The CFL limit (in units of the mesh grid spacing).
+
+            \param bandWidth_
+                The width of the narrow band region.
+
+            \param isFixedDomain_
+                Whether the domain boundary is fixed.
+         */
+        SparseLevelSet(unsigned int, unsigned int, const std::vector<Hole>&,
+            double moveLimit_ = 0.5, unsigned int bandWidth_ = 6, bool isFixedDomain_ = false);
+
+        //! Update the level set function.
+        /*! \param timeStep
+                The time step.
+
+            \return
+                Whether the signed distance was reinitialised.
+         */
+        bool update(double);
+
+        //! Reinitialise the level set to a signed distance function.
+        void reinitialise();
+
+        //! Extend boundary point velocities to the level set nodes.
+        /*! \param boundaryPoints
+                A reference to a vector of boundary points.
+         */
+        void computeVelocities(const std::vector<BoundaryPoint>&);
+
+        //! Compute the modulus of the gradient of the signed distance function.
+        void computeGradients();
+
+        //! Set the number of threads used for narrow band operations.
+        /*! \param nThreads
+                The number of threads. The result of each operation is
+                independent of the number of threads.
+         */
+        void setThreads(unsigned int);
+
+        //! Return the signed distance at a node.
+        /*! \param x
+                The x coordinate of the node.
+
+            \param y
+                The y coordinate of the node.
+
+            \return
+                The signed distance.
+         */
+        double getSignedDistance(unsigned int, unsigned int) const;
+
+        //! Return the normal velocity at a node.
+        /*! \param x
+                The x coordinate of the node.
+
+            \param y
+                The y coordinate of the node.
+
+            \return
+                The velocity (zero outside of the allocated tiles).
+         */
+        double getVelocity(unsigned int, unsigned int) const;
+
+        //! Return the modulus of the gradient of the signed distance function at a node.
+        /*! \param x
+                The x coordinate of the node.
+
+            \param y
+                The y coordinate of the node.
+
+            \return
+                The gradient (zero outside of the allocated tiles).
+         */
+        double getGradient(unsigned int, unsigned int) const;
+
+        //! Return the index of a node in the tile arrays.
+        /*! \param x
+                The x coordinate of the node.
+
+            \param y
+                The y coordinate of the node.
+
+            \return
+                The index of the node (none if its tile isn't allocated).
+         */
+        unsigned int findNode(unsigned int, unsigned int) const;
+
+        //! Return the tile slot at a given position.
+        /*! \param tileX
+                The x coordinate of the tile (in units of tiles).
+
+            \param tileY
+                The y coordinate of the tile (in units of tiles).
+
+            \return
+                The slot of the tile, or insideTile or outsideTile if the
+                tile isn't allocated.
+         */
+        unsigned int findTile(unsigned int, unsigned int) const;
+
+        //! Return the memory used by the level set data.
+        /*! \return
+                The memory (in bytes).
+         */
+        std::size_t memoryUsage() const;
+
+        /// The number of nodes along each side of a tile.
+        static const unsigned int tileSize = 8;
+
+        /// The number of nodes in a tile.
+        static const unsigned int tileNodes = tileSize*tileSize;
+
+        /// The number of tiles along each side of a block.
+        static const unsigned int blockSize = 16;
+
+        /// Table entry for an unallocated tile (or block) inside the structure.
+        static const unsigned int insideTile = 0xffffffff;
+
+        /// Table entry for an unallocated tile (or block) outside the structure.
+        static const unsigned int outsideTile = 0xfffffffe;
+
+        /// Null node index.
+        static const unsigned int none = 0xffffffff;
+
+        const unsigned int width;               //!< The width of the domain (number of elements in x).
+        const unsigned int height;              //!< The height of the domain (number of elements in y).
+        const double moveLimit;                 //!< The boundary movement limit (CFL condition).
+        const unsigned int bandWidth;           //!< The width of the narrow band region.
+        const bool isFixedDomain;               //!< Whether the domain boundary is fixed.
+        const double farDistance;               //!< The absolute signed distance outside of the narrow band.
+
+        unsigned int nTiles;                    //!< The number of allocated tiles.
+        unsigned int nNarrowBand;               //!< The number of nodes in the narrow band.
+
+        std::vector<Real> signedDistance;       //!< The nodal signed distance function (one tile per slot).
+        std::vector<Real> velocity;             //!< The nodal normal velocity.
+        std::vector<Real> gradient;             //!< The nodal gradient of the level set function (modulus).
+        std::vector<unsigned char> nodeFlags;   //!< The packed flags of each node (SparseNodeFlag values).
+        std::vector<unsigned int> tileX;        //!< The x coordinate of the tile in each slot (in units of tiles).
+        std::vector<unsigned int> tileY;        //!< The y coordinate of the tile in each slot (in units of tiles).
+        std::vector<char> isTileFree;           //!< Whether each tile slot is free.
+
+    private:
+        unsigned int nTilesX;                   //!< The number of tiles in the x direction.
+        unsigned int nTilesY;                   //!< The number of tiles in the y direction.
+        unsigned int nBlocksX;                  //!< The number of blocks in the x direction.
+        unsigned int nBlocksY;                  //!< The number of blocks in the y direction.
+
+        std::vector<unsigned int> root;         //!< The block index, or flag, for each block of tiles.
+        std::vector<unsigned int> blockTiles;   //!< The tile slot, or flag, for each tile in each allocated block.
+        std::vector<unsigned int> blockRoot;    //!< The root table entry of each allocated block.
+        std::vector<unsigned int> blockCount;   //!< The number of allocated tiles in each block.
+        std::vector<unsigned int> freeTiles;    //!< Indices of free tile slots.
+        std::vector<unsigned int> freeBlocks;   //!< Indices of free blocks.
+
+        ThreadPool threadPool;                  //!< Threads for narrow band operations.
+        std::vector<char> isMineTriggered;      //!< Whether a mine was triggered (for each thread).
+        std::vector<unsigned int> activeTiles;  //!< Slots of the allocated tiles (scratch).
+
+        std::vector<Real> signedDistanceCopy;   //!< A copy of the signed distance function (fast marching).
+        std::vector<unsigned char> marchStatus; //!< The fast marching status of each node (FMM_NodeStatus).
+        std::vector<char> isVelocitySet;        //!< Whether the velocity at a node has been set (scratch).
+        std::vector<double> velocityWeight;     //!< Velocity interpolation weight for each node (scratch).
+        std::vector<unsigned int> toFreeze;     //!< Nodes that are frozen together (scratch).
+
+        /// Priority queue of trial nodes, ordered by absolute distance. Entries
+        /// are never updated: stale ones are skipped when they reach the top.
+        std::priority_queue<std::pair<double, unsigned int>,
+            std::vector<std::pair<double, unsigned int> >,
+            std::greater<std::pair<double, unsigned int> > > queue;
+
+        //! Initialise the level set from a vector of holes.
+        /*! \param holes
+                A vector of holes.
+         */
+        void initialise(const std::vector<Hole>&);
+
+        //! Initialise the signed distance function within a tile, allocating it if needed.
+        /*! \param tileX
+                The x coordinate of the tile (in units of tiles).
+
+            \param tileY
+                The y coordinate of the tile (in units of tiles).
+
+            \param holes
+                A vector of holes.
+         */
+        void initialiseTile(unsigned int, unsigned int, const std::vector<Hole>&);
+
+        //! Initialise the narrow band region (flag active and mine nodes).
+        void initialiseNarrowBand();
+
+        //! Allocate a tile.
+        /*! \param tileX
+                The x coordinate of the tile (in units of tiles).
+
+            \param tileY
+                The y coordinate of the tile (in units of tiles).
+
+            \return
+                The slot of the tile.
+         */
+        unsigned int allocateTile(unsigned int, unsigned int);
+
+        //! Return the index of the tile table of a block, creating one if needed.
+        /*! \param block
+                The index of the block in the root table.
+
+            \return
+                The index of the tile table.
+         */
+        unsigned int allocateBlock(unsigned int);
+
+        //! Deallocate a tile.
+        /*! \param slot
+                The slot of the tile.
+
+            \param flag
+                The table entry for the tile (insideTile or outsideTile).
+         */
+        void freeTile(unsigned int, unsigned int);
+
+        //! Set the table entry for an unallocated tile.
+        /*! \param tileX
+                The x coordinate of the tile (in units of tiles).
+
+            \param tileY
+                The y coordinate of the tile (in units of tiles).
+
+            \param flag
+                The table entry for the tile (insideTile or outsideTile).
+         */
+        void setTileFlag(unsigned int, unsigned int, unsigned int);
+
+        //! Collapse a block that contains no allocated tiles into a single flag, if possible.
+        /*! \param block
+                The index of the block.
+         */
+        void compactBlock(unsigned int);
+
+        //! Return the position of a node.
+        /*! \param node
+                The index of the node.
+
+            \param x
+                The x coordinate of the node (to be determined).
+
+            \param y
+                The y coordinate of the node (to be determined).
+
+            \return
+                Whether the node lies inside the domain.
+         */
+        bool nodeCoord(unsigned int, unsigned int&, unsigned int&) const;
+
+        //! Return a nearest neighbour of a node.
+        /*! \param node
+                The index of the node.
+
+            \param direction
+                The direction of the neighbour (left, right, down, up).
+
+            \param isAllocate
+                Whether to allocate the tile of the neighbour, if needed.
+
+            \return
+                The index of the neighbour (none if it lies outside the domain,
+                or in an unallocated tile).
+         */
+        unsigned int getNeighbour(unsigned int, unsigned int, bool isAllocate = false);
+
+        //! Return a nearest neighbour of a node (without allocation).
+        /*! \param node
+                The index of the node.
+
+            \param direction
+                The direction of the neighbour (left, right, down, up).
+
+            \return
+                The index of the neighbour (none if it lies outside the domain,
+                or in an unallocated tile).
+         */
+        unsigned int findNeighbour(unsigned int, unsigned int) const;
+
+        //! Reinitialise the signed distance function using the Fast Marching Method.
+        /*! \param isVelocity
+                Whether to also extend the boundary velocities.
+         */
+        void march(bool);
+
+        //! Freeze the nodes closest to the zero contour.
+        void initialiseFrozen();
+
+        //! Add the neighbours of frozen nodes to the trial band.
+        /*! \param isVelocity
+                Whether velocities are being extended (only narrow band
+                nodes are added).
+         */
+        void initialiseTrial(bool);
+
+        //! The fast marching main loop.
+        /*! \param isVelocity
+                Whether to also extend the boundary velocities.
+         */
+        void solve(bool);
+
+        //! Clamp the nodes that weren't frozen, and deallocate tiles outside the band.
+        void finaliseMarch();
+
+        //! Pop the closest trial node from the queue, skipping stale entries.
+        /*! \param node
+                The index of the node (to be determined).
+
+            \param value
+                The absolute distance of the node (to be determined).
+
+            \return
+                Whether a node was found.
+         */
+        bool queuePop(unsigned int&, double&);
+
+        //! Return the absolute distance of the closest trial node.
+        /*! \return
+                The absolute distance (infinity if there are no trial nodes).
+         */
+        double queuePeek();
+
+        //! Calculate the distance of a node from the zero contour using its frozen neighbours.
+        /*! \param node
+                The index of the node.
+
+            \return
+                The signed distance.
+         */
+        double updateNode(unsigned int) const;
+
+        //! Set the extension velocity of a node from its frozen neighbours.
+        /*! \param node
+                The index of the node.
+         */
+        void finaliseVelocity(unsigned int);
+
+        //! Initialise velocities for boundary nodes.
+        /*! \param boundaryPoints
+                A reference to a vector of boundary points.
+         */
+        void initialiseVelocities(const std::vector<BoundaryPoint>&);
+
+        //! Compute the gradient at each active node of a tile.
+        /*! \param slot
+                The slot of the tile.
+
+            \param patch
+                Storage for the signed distance function across the tile and
+                three layers of surrounding nodes.
+         */
+        void computeTileGradients(unsigned int, std::vector<double>&);
+    };
+
+    // INLINE DEFINITIONS
+
+    inline unsigned int SparseLevelSet::findTile(unsigned int tileX, unsigned int tileY) const
+    {
+        unsigned int entry = root[(tileX / blockSize) + (tileY / blockSize) * nBlocksX];
+
+        // The whole block is inside or outside.
+        if (entry >= outsideTile) return entry;
+
+        return blockTiles[entry*blockSize*blockSize + (tileX % blockSize) + (tileY % blockSize) * blockSize];
+    }
+
+    inline unsigned int SparseLevelSet::findNode(unsigned int x, unsigned int y) const
+    {
+        unsigned int slot = findTile(x / tileSize, y / tileSize);
+
+        if (slot >= outsideTile) return none;
+        else return slot*tileNodes + (x % tileSize) + (y % tileSize) * tileSize;
+    }
+
+    inline double SparseLevelSet::getSignedDistance(unsigned int x, unsigned int y) const
+    {
+        unsigned int slot = findTile(x / tileSize, y / tileSize);
+
+        if (slot == insideTile) return farDistance;
+        else if (slot == outsideTile) return -farDistance;
+        else return signedDistance[slot*tileNodes + (x % tileSize) + (y % tileSize) * tileSize];
+    }
+}
+
+#endif  /* _SPARSELEVELSET_H */
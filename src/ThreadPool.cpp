@@ -0,0 +1,138 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ThreadPool.h"
+
+/*! \file ThreadPool.cpp
+    \brief A simple fork-join thread pool.
+ */
+
+namespace slsm
+{
+    ThreadPool::ThreadPool(unsigned int nThreads_) :
+        nThreads(nThreads_),
+        task(nullptr),
+        generation(0),
+        nPending(0),
+        isStop(false)
+    {
+        if (nThreads == 0) nThreads = 1;
+
+        start();
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        stop();
+    }
+
+    void ThreadPool::resize(unsigned int nThreads_)
+    {
+        if (nThreads_ == 0) nThreads_ = 1;
+
+        // Nothing to do.
+        if (nThreads_ == nThreads) return;
+
+        stop();
+        nThreads = nThreads_;
+        start();
+    }
+
+    unsigned int ThreadPool::size() const
+    {
+        return nThreads;
+    }
+
+    void ThreadPool::run(const std::function<void(unsigned int)>& task_)
+    {
+        // Execute serially.
+        if (workers.empty())
+        {
+            task_(0);
+            return;
+        }
+
+        // Issue the task to the workers.
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &task_;
+            nPending = workers.size();
+            generation++;
+        }
+        wake.notify_all();
+
+        // The calling thread is thread zero.
+        task_(0);
+
+        // Wait for the workers to finish.
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]{ return nPending == 0; });
+        task = nullptr;
+    }
+
+    void ThreadPool::range(unsigned int n, unsigned int thread, unsigned int& start, unsigned int& end) const
+    {
+        start = (unsigned int) (((unsigned long) n * thread) / nThreads);
+        end   = (unsigned int) (((unsigned long) n * (thread + 1)) / nThreads);
+    }
+
+    void ThreadPool::start()
+    {
+        isStop = false;
+
+        for (unsigned int i=1;i<nThreads;i++)
+            workers.push_back(std::thread(&ThreadPool::work, this, i, generation));
+    }
+
+    void ThreadPool::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStop = true;
+        }
+        wake.notify_all();
+
+        for (unsigned int i=0;i<workers.size();i++)
+            workers[i].join();
+
+        workers.clear();
+    }
+
+    void ThreadPool::work(unsigned int thread, unsigned long seen)
+    {
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            // Wait for a new task, or a request to exit.
+            wake.wait(lock, [&]{ return isStop || (generation != seen); });
+            if (isStop) return;
+
+            seen = generation;
+            const std::function<void(unsigned int)>* current = task;
+            lock.unlock();
+
+            // Execute the task.
+            (*current)(thread);
+
+            // Flag that the task is complete.
+            lock.lock();
+            nPending--;
+            if (nPending == 0) done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,140 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _THREADPOOL_H
+#define _THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*! \file ThreadPool.h
+    \brief A simple fork-join thread pool.
+ */
+
+namespace slsm
+{
+    /*! \brief A simple fork-join thread pool.
+
+        A fixed number of worker threads is created on construction and kept
+        alive for the lifetime of the pool, so that parallel loops that are
+        executed every iteration don't pay the cost of creating threads. A task
+        is run once on every thread, with the calling thread acting as thread
+        zero, and the run method blocks until all threads have finished.
+
+        Work is shared using a static partition of the loop range (see range),
+        so a given thread count always assigns the same elements to the same
+        thread. With a single thread, tasks are executed directly by the caller
+        and no worker threads are created.
+     */
+    class ThreadPool
+    {
+    public:
+        //! Constructor.
+        /*! \param nThreads_
+                The number of threads (including the calling thread).
+         */
+        ThreadPool(unsigned int nThreads_ = 1);
+
+        //! Destructor.
+        ~ThreadPool();
+
+        //! Change the number of threads.
+        /*! \param nThreads_
+                The number of threads (including the calling thread).
+         */
+        void resize(unsigned int);
+
+        //! Return the number of threads.
+        /*! \return
+                The number of threads (including the calling thread).
+         */
+        unsigned int size() const;
+
+        //! Execute a task on all threads and wait for completion.
+        /*! \param task
+                The task, which is passed the index of the thread.
+         */
+        void run(const std::function<void(unsigned int)>&);
+
+        //! Compute the range of a loop that is assigned to a thread.
+        /*! \param n
+                The number of loop iterations.
+
+            \param thread
+                The index of the thread.
+
+            \param start
+                The first iteration (output).
+
+            \param end
+                One past the last iteration (output).
+         */
+        void range(unsigned int, unsigned int, unsigned int&, unsigned int&) const;
+
+    private:
+        /// The number of threads (including the calling thread).
+        unsigned int nThreads;
+
+        /// The worker threads.
+        std::vector<std::thread> workers;
+
+        /// The task that is currently being executed.
+        const std::function<void(unsigned int)>* task;
+
+        /// The number of tasks that have been issued.
+        unsigned long generation;
+
+        /// The number of workers that are still executing the current task.
+        unsigned int nPending;
+
+        /// Whether the workers should exit.
+        bool isStop;
+
+        /// Mutex for the shared state.
+        std::mutex mutex;
+
+        /// Signals workers that a new task is available.
+        std::condition_variable wake;
+
+        /// Signals the calling thread that all workers have finished.
+        std::condition_variable done;
+
+        //! Start the worker threads.
+        void start();
+
+        //! Stop and join the worker threads.
+        void stop();
+
+        //! The main loop of a worker thread.
+        /*! \param thread
+                The index of the thread.
+
+            \param seen
+                The number of tasks issued before the thread was started.
+         */
+        void work(unsigned int, unsigned long);
+
+        // Threads can't be copied.
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+    };
+}
+
+#endif  /* _THREADPOOL_H */
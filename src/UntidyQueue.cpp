@@ -0,0 +1,228 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <limits>
+
+#include "Debug.h"
+#include "UntidyQueue.h"
+
+/*! \file UntidyQueue.cpp
+    \brief An implementation of an untidy (bucketed) priority queue.
+ */
+
+namespace slsm
+{
+    UntidyQueue::UntidyQueue(unsigned int maxLength_, double bucketWidth_, double maxSpan) :
+        maxLength(maxLength_),
+        bucketWidth(bucketWidth_),
+        queueLength(0),
+        listLength(0),
+        current(0),
+        maxKey(0),
+        isPopped(false),
+        none(std::numeric_limits<unsigned int>::max())
+    {
+        errno = 0;
+        slsm_check(bucketWidth > 0, "Bucket width must be positive!");
+
+        // Work out the number of buckets needed to span the range of values.
+        nBuckets = std::ceil(maxSpan / bucketWidth) + 1;
+
+        // Resize data structures.
+        distance.resize(maxLength);
+        address.resize(maxLength);
+        keys.resize(maxLength);
+        next.resize(maxLength);
+        previous.resize(maxLength);
+        head.resize(nBuckets, none);
+        tail.resize(nBuckets, none);
+
+        return;
+
+    error:
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned int UntidyQueue::push(unsigned int address_, double value)
+    {
+        // Make sure the queue isn't full.
+        errno = 0;
+        slsm_check(listLength < maxLength, "push: Queue is full!");
+
+        // Reset the range of occupied buckets.
+        if (queueLength == 0)
+        {
+            current  = (unsigned long) (value / bucketWidth);
+            maxKey   = current;
+            isPopped = false;
+        }
+
+        // Add entry to the list.
+        address[listLength]  = address_;
+        distance[listLength] = value;
+        keys[listLength]     = key(value);
+
+        // Add entry to its bucket.
+        insert(listLength);
+
+        // Increment queue size.
+        queueLength++;
+
+        // Increment list size.
+        listLength++;
+
+        return listLength - 1;
+
+    error:
+        exit(EXIT_FAILURE);
+    }
+
+    void UntidyQueue::pop(unsigned int& address_, double& value)
+    {
+        // Make sure the queue isn't empty.
+        errno = 0;
+        slsm_check(queueLength != 0, "pop: Queue is empty!");
+
+        {
+            // Entry at the front of the lowest occupied bucket.
+            unsigned int index = head[current % nBuckets];
+
+            address_ = address[index];
+            value    = distance[index];
+
+            // Remove entry from its bucket.
+            remove(index);
+
+            // Decrement queue size.
+            queueLength--;
+
+            // Flag that the front has started to move.
+            isPopped = true;
+
+            // Find the next occupied bucket.
+            if (queueLength > 0) advance();
+        }
+
+        return;
+
+    error:
+        exit(EXIT_FAILURE);
+    }
+
+    void UntidyQueue::set(unsigned int index, double newDistance)
+    {
+        // Remove entry from its current bucket.
+        remove(index);
+
+        // Update distance.
+        distance[index] = newDistance;
+        keys[index]     = key(newDistance);
+
+        // Add entry to its new bucket.
+        insert(index);
+
+        // The entry may have been the last in the lowest occupied bucket.
+        advance();
+    }
+
+    void UntidyQueue::clear()
+    {
+        // Empty all buckets.
+        for (unsigned int i=0;i<nBuckets;i++)
+        {
+            head[i] = none;
+            tail[i] = none;
+        }
+
+        queueLength = 0;
+        listLength = 0;
+        isPopped = false;
+    }
+
+    bool UntidyQueue::empty() const
+    {
+        return (queueLength == 0);
+    }
+
+    const double& UntidyQueue::peek() const
+    {
+        return distance[head[current % nBuckets]];
+    }
+
+    const unsigned int& UntidyQueue::size() const
+    {
+        return queueLength;
+    }
+
+    unsigned long UntidyQueue::key(double value)
+    {
+        unsigned long k = (unsigned long) (value / bucketWidth);
+
+        if (k < current)
+        {
+            /* Until the first entry is popped the lowest occupied bucket can be
+               moved back, as long as the buckets don't wrap around. After that,
+               entries that fall behind the front (which can only happen because
+               of the untidy ordering) are placed in the current bucket.
+             */
+            if (!isPopped && ((maxKey - k) < nBuckets)) current = k;
+            else k = current;
+        }
+
+        /* Values beyond the range of the queue are provisional estimates that
+           will be updated before they reach the front, so it's safe to hold
+           them in the last bucket.
+         */
+        if (k >= (current + nBuckets)) k = current + nBuckets - 1;
+
+        if (k > maxKey) maxKey = k;
+
+        return k;
+    }
+
+    void UntidyQueue::insert(unsigned int index)
+    {
+        unsigned int bucket = keys[index] % nBuckets;
+
+        // Link entry to the back of the bucket.
+        next[index] = none;
+        previous[index] = tail[bucket];
+
+        if (tail[bucket] != none) next[tail[bucket]] = index;
+        else head[bucket] = index;
+
+        tail[bucket] = index;
+    }
+
+    void UntidyQueue::remove(unsigned int index)
+    {
+        unsigned int bucket = keys[index] % nBuckets;
+
+        // Unlink entry from its neighbours.
+        if (previous[index] != none) next[previous[index]] = next[index];
+        else head[bucket] = next[index];
+
+        if (next[index] != none) previous[next[index]] = previous[index];
+        else tail[bucket] = previous[index];
+    }
+
+    void UntidyQueue::advance()
+    {
+        while (head[current % nBuckets] == none) current++;
+    }
+}
@@ -0,0 +1,193 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _UNTIDYQUEUE_H
+#define _UNTIDYQUEUE_H
+
+#include <vector>
+
+/*! \file UntidyQueue.h
+    \brief An implementation of an untidy (bucketed) priority queue.
+ */
+
+namespace slsm
+{
+    /*! \brief An implementation of an untidy (bucketed) priority queue.
+
+        Entries are placed in buckets of fixed width according to their value
+        and the buckets are stored in a circular array. Within a bucket, entries
+        are kept in a doubly linked list and are popped in first-in first-out
+        order, so the queue is only sorted to within the bucket width. In return,
+        push, pop, and set all run in constant time. See:
+
+            L. Yatziv, A. Bartesaghi, and G. Sapiro, "O(N) implementation of the
+            fast marching algorithm", J. Comput. Phys. 212, 393-399 (2006).
+
+        When used by the FastMarchingMethod class, the values of all trial nodes
+        lie within a few grid spacings of the front, so only a small, fixed number
+        of buckets is needed. The bucket width is given as a fraction of the grid
+        spacing and controls the accuracy of the ordering: a bucket width of zero
+        would recover the binary heap solution.
+
+        The interface mirrors that of the Heap class, so the two can be used
+        interchangeably.
+     */
+    class UntidyQueue
+    {
+    public:
+        //! Constructor.
+        /*! \param maxLength_
+                The maximum number of entries in the queue.
+
+            \param bucketWidth_
+                The width of each bucket, in units of the grid spacing (optional).
+
+            \param maxSpan
+                The range of values covered by the circular array of buckets,
+                in units of the grid spacing (optional). Values further than
+                this from the front are held in the last bucket.
+         */
+        UntidyQueue(unsigned int, double bucketWidth_ = 0.05, double maxSpan = 4);
+
+        //! Push a value onto the queue.
+        /*! \param address_
+                The address of the element to push (its array index).
+
+            \param value
+                The value of the element.
+
+            \return
+                The index of the value in the queue.
+         */
+        unsigned int push(unsigned int, double);
+
+        //! Pop an entry from the lowest occupied bucket.
+        /*! \param address_
+                The address (index) of the entry.
+
+            \param value
+                The value of the entry.
+         */
+        void pop(unsigned int&, double&);
+
+        //! Set a specific queue entry.
+        /*! \param index
+                The index in the queue.
+
+            \param newDistance
+                The new distance value to insert into the queue.
+         */
+        void set(unsigned int, double);
+
+        //! Empty the queue, retaining the allocated storage for reuse.
+        void clear();
+
+        //! Test whether the queue is empty.
+        /*! \return
+                Whether the queue is empty (true) or contains entries (false).
+         */
+        bool empty() const;
+
+        //! Return the value of the next entry to be popped from the queue.
+        /*! \return
+                The value of the entry at the front of the lowest occupied bucket.
+         */
+        const double& peek() const;
+
+        //! Return the current size of the queue.
+        /*! \return
+                The current size of the queue.
+         */
+        const unsigned int& size() const;
+
+    private:
+        //! Compute the (absolute) bucket key for a value, updating the
+        //! range of occupied buckets.
+        /*! \param value
+                The value of the entry.
+
+            \return
+                The bucket key.
+         */
+        unsigned long key(double);
+
+        //! Add an entry to the back of a bucket.
+        /*! \param index
+                The index in the queue.
+         */
+        void insert(unsigned int);
+
+        //! Remove an entry from its bucket.
+        /*! \param index
+                The index in the queue.
+         */
+        void remove(unsigned int);
+
+        //! Advance the current key to the lowest occupied bucket.
+        void advance();
+
+        /// The maximum number of entries in the queue.
+        unsigned int maxLength;
+
+        /// The width of each bucket.
+        double bucketWidth;
+
+        /// The number of buckets.
+        unsigned int nBuckets;
+
+        /// The current number of entries in the queue.
+        unsigned int queueLength;
+
+        /// The current size of the list.
+        unsigned int listLength;
+
+        /// The key of the lowest occupied bucket.
+        unsigned long current;
+
+        /// The largest key added since the queue was last empty.
+        unsigned long maxKey;
+
+        /// Whether an entry has been popped since the queue was last empty.
+        bool isPopped;
+
+        /// The unsigned distance from the zero level set iso-contour.
+        std::vector<double> distance;
+
+        /// The (original) grid address of each element in the queue.
+        std::vector<unsigned int> address;
+
+        /// The key of the bucket holding each entry.
+        std::vector<unsigned long> keys;
+
+        /// The next entry in the same bucket.
+        std::vector<unsigned int> next;
+
+        /// The previous entry in the same bucket.
+        std::vector<unsigned int> previous;
+
+        /// The first entry in each bucket.
+        std::vector<unsigned int> head;
+
+        /// The last entry in each bucket.
+        std::vector<unsigned int> tail;
+
+        /// Null link for the bucket lists.
+        unsigned int none;
+    };
+}
+
+#endif  /* _UNTIDYQUEUE_H */
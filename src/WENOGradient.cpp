@@ -0,0 +1,293 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "Mesh.h"
+#include "ThreadPool.h"
+#include "WENOGradient.h"
+
+/*! \file WENOGradient.cpp
+    \brief A vectorised kernel for the Hamilton-Jacobi WENO gradient.
+ */
+
+/* Compile the batch kernel for multiple instruction sets and dispatch at run
+   time. This relies on indirect functions, so is limited to GCC on x86-64 Linux
+   (and is incompatible with the thread sanitizer). Floating point contraction
+   is disabled so that fused multiply-add instructions aren't used, i.e. the
+   result doesn't depend on the instruction set.
+ */
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__) \
+    && !defined(__SANITIZE_THREAD__)
+#define SLSM_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default"), optimize("fp-contract=off")))
+#else
+#define SLSM_TARGET_CLONES
+#endif
+
+namespace slsm
+{
+    const unsigned int WENOGradient::batchSize;
+
+    //! Compute the Hamilton-Jacobi WENO gradient approximation.
+    //! This is identical to LevelSet::gradHJWENO, but can be inlined into the batch kernel
+    //! (and is evaluated in the scalar type of the level set fields).
+    static inline Real gradHJWENO(Real v1, Real v2, Real v3, Real v4, Real v5)
+    {
+        const Real oneQuarter        = 1.0  / 4.0;
+        const Real thirteenTwelths   = 13.0 / 12.0;
+        const Real eps               = 1e-6;
+
+        // Estimate the smoothness of each stencil.
+
+        Real s1 = thirteenTwelths * (v1 - 2*v2 + v3)*(v1 - 2*v2 + v3)
+                + oneQuarter * (v1 - 4*v2 + 3*v3)*(v1 - 4*v2 + 3*v3);
+
+        Real s2 = thirteenTwelths * (v2 - 2*v3 + v4)*(v2 - 2*v3 + v4)
+                + oneQuarter * (v2 - v4)*(v2 - v4);
+
+        Real s3 = thirteenTwelths * (v3 - 2*v4 + v5)*(v3 - 2*v4 + v5)
+                + oneQuarter * (3*v3 - 4*v4 + v5)*(3*v3 - 4*v4 + v5);
+
+        // Compute the alpha values for each stencil.
+
+        Real alpha1 = Real(0.1) / ((s1 + eps)*(s1 + eps));
+        Real alpha2 = Real(0.6) / ((s2 + eps)*(s2 + eps));
+        Real alpha3 = Real(0.3) / ((s3 + eps)*(s3 + eps));
+
+        // Calculate the normalised weights.
+
+        Real totalWeight = alpha1 + alpha2 + alpha3;
+
+        Real w1 = alpha1 / totalWeight;
+        Real w2 = alpha2 / totalWeight;
+        Real w3 = alpha3 / totalWeight;
+
+        // Sum the three stencil components.
+        Real grad = w1 * (2*v1 - 7*v2 + 11*v3)
+                  + w2 * (5*v3 - v2 + 2*v4)
+                  + w3 * (2*v3 + 5*v4 - v5);
+
+        grad *= Real(1.0 / 6.0);
+
+        return grad;
+    }
+
+    //! Compute the upwind gradient for a batch of nodes.
+    /*! \param n
+            The number of nodes in the batch.
+
+        \param stride
+            The stride between stencil points in the stencil array.
+
+        \param stencil
+            The stencil values, ordered by direction, then point, then node.
+
+        \param sign
+            The upwind direction for each node.
+
+        \param gradient
+            The squared gradient for each node (output).
+     */
+    SLSM_TARGET_CLONES
+    static void upwindGradient(unsigned int n, unsigned int stride,
+        const Real* __restrict__ stencil, const Real* __restrict__ sign, Real* __restrict__ gradient)
+    {
+        // Stencils for each direction.
+        const Real* __restrict__ right = stencil;
+        const Real* __restrict__ left  = stencil + 5*stride;
+        const Real* __restrict__ up    = stencil + 10*stride;
+        const Real* __restrict__ down  = stencil + 15*stride;
+
+        for (unsigned int i=0;i<n;i++)
+        {
+            Real gradRight = sign[i] * gradHJWENO(right[i], right[i+stride],
+                right[i+2*stride], right[i+3*stride], right[i+4*stride]);
+            Real gradLeft  = sign[i] * gradHJWENO(left[i], left[i+stride],
+                left[i+2*stride], left[i+3*stride], left[i+4*stride]);
+            Real gradUp    = sign[i] * gradHJWENO(up[i], up[i+stride],
+                up[i+2*stride], up[i+3*stride], up[i+4*stride]);
+            Real gradDown  = sign[i] * gradHJWENO(down[i], down[i+stride],
+                down[i+2*stride], down[i+3*stride], down[i+4*stride]);
+
+            // Compute gradient using upwind scheme (branch free).
+
+            Real grad = 0;
+
+            grad += (gradDown > 0)  ? gradDown * gradDown   : 0;
+            grad += (gradLeft > 0)  ? gradLeft * gradLeft   : 0;
+            grad += (gradUp < 0)    ? gradUp * gradUp       : 0;
+            grad += (gradRight < 0) ? gradRight * gradRight : 0;
+
+            // The square root is taken when scattering the result, since the
+            // library call (which may set errno) would prevent vectorisation.
+            gradient[i] = grad;
+        }
+    }
+
+    WENOGradient::WENOGradient(const Mesh& mesh_) :
+        mesh(mesh_),
+        nx(mesh_.width + 1),
+        ny(mesh_.height + 1)
+    {
+        // Resize batch arrays (for a single thread).
+        stencil.resize(20 * batchSize);
+        sign.resize(batchSize);
+        batchGradient.resize(batchSize);
+    }
+
+    void WENOGradient::compute(const std::vector<Real>& signedDistance, const std::vector<Real>& velocity,
+        const std::vector<unsigned int>& nodes, unsigned int nNodes, std::vector<Real>& gradient,
+        ThreadPool& threadPool)
+    {
+        compute(signedDistance, velocity, nodes, nNodes, gradient, threadPool,
+            std::function<void(unsigned int, unsigned int, unsigned int)>());
+    }
+
+    void WENOGradient::compute(const std::vector<Real>& signedDistance, const std::vector<Real>& velocity,
+        const std::vector<unsigned int>& nodes, unsigned int nNodes, std::vector<Real>& gradient,
+        ThreadPool& threadPool, const std::function<void(unsigned int, unsigned int, unsigned int)>& callback)
+    {
+        // Each thread needs its own batch arrays.
+        unsigned int nThreads = threadPool.size();
+        if (sign.size() < (nThreads * batchSize))
+        {
+            stencil.resize(20 * batchSize * nThreads);
+            sign.resize(batchSize * nThreads);
+            batchGradient.resize(batchSize * nThreads);
+        }
+
+        // Evaluate the gradient (partitioned by node).
+        threadPool.run([&](unsigned int thread)
+        {
+            unsigned int start, end;
+            threadPool.range(nNodes, thread, start, end);
+            computeGradients(signedDistance, velocity, nodes, start, end, gradient, thread);
+        });
+
+        // Pass each batch to the caller. This is done once all stencils have
+        // been read, since the callback may modify the signed distance function.
+        if (callback)
+        {
+            threadPool.run([&](unsigned int thread)
+            {
+                unsigned int start, end;
+                threadPool.range(nNodes, thread, start, end);
+
+                for (unsigned int first=start;first<end;first+=batchSize)
+                    callback(first, std::min(first + batchSize, end), thread);
+            });
+        }
+    }
+
+    void WENOGradient::computeGradients(const std::vector<Real>& signedDistance, const std::vector<Real>& velocity,
+        const std::vector<unsigned int>& nodes, unsigned int start, unsigned int end, std::vector<Real>& gradient,
+        unsigned int thread)
+    {
+        // Batch arrays for this thread.
+        Real* stencil = &this->stencil[20 * batchSize * thread];
+        Real* sign = &this->sign[batchSize * thread];
+        Real* batchGradient = &this->batchGradient[batchSize * thread];
+
+        for (unsigned int first=start;first<end;first+=batchSize)
+        {
+            // The number of nodes in this batch.
+            unsigned int n = std::min(batchSize, end - first);
+
+            // Gather stencil values.
+            for (unsigned int i=0;i<n;i++)
+            {
+                unsigned int node = nodes[first + i];
+
+                // Differences either side of the node.
+                Real dx[6], dy[6];
+                computeDifferences(signedDistance, node, dx, dy);
+
+                // Derivatives to right.
+                stencil[i]                 = dx[5];
+                stencil[i + batchSize]     = dx[4];
+                stencil[i + 2*batchSize]   = dx[3];
+                stencil[i + 3*batchSize]   = dx[2];
+                stencil[i + 4*batchSize]   = dx[1];
+
+                // Derivatives to left.
+                stencil[i + 5*batchSize]   = dx[0];
+                stencil[i + 6*batchSize]   = dx[1];
+                stencil[i + 7*batchSize]   = dx[2];
+                stencil[i + 8*batchSize]   = dx[3];
+                stencil[i + 9*batchSize]   = dx[4];
+
+                // Upward derivatives.
+                stencil[i + 10*batchSize]  = dy[5];
+                stencil[i + 11*batchSize]  = dy[4];
+                stencil[i + 12*batchSize]  = dy[3];
+                stencil[i + 13*batchSize]  = dy[2];
+                stencil[i + 14*batchSize]  = dy[1];
+
+                // Downward derivatives.
+                stencil[i + 15*batchSize]  = dy[0];
+                stencil[i + 16*batchSize]  = dy[1];
+                stencil[i + 17*batchSize]  = dy[2];
+                stencil[i + 18*batchSize]  = dy[3];
+                stencil[i + 19*batchSize]  = dy[4];
+
+                // Upwind direction.
+                sign[i] = (velocity[node] < 0) ? -1 : 1;
+            }
+
+            // Evaluate the gradient for the batch.
+            upwindGradient(n, batchSize, stencil, sign, batchGradient);
+
+            // Scatter gradients.
+            for (unsigned int i=0;i<n;i++)
+                gradient[nodes[first + i]] = std::sqrt(batchGradient[i]);
+        }
+    }
+
+    void WENOGradient::computeDifferences(const std::vector<Real>& signedDistance,
+        unsigned int node, Real* dx, Real* dy) const
+    {
+        // Nodal coordinates.
+        int x = mesh.nodeX[node];
+        int y = mesh.nodeY[node];
+
+        // The stencil lies within the mesh, and neighbouring nodes are at fixed offsets.
+        if ((mesh.ordering == NodeOrdering::ROW_MAJOR)
+            && (x >= 3) && ((x + 3) < int(nx)) && (y >= 3) && ((y + 3) < int(ny)))
+        {
+            const Real* sd = &signedDistance[node];
+
+            for (int k=-3;k<3;k++)
+            {
+                dx[k + 3] = sd[k + 1] - sd[k];
+                dy[k + 3] = sd[(k + 1)*int(nx)] - sd[k*int(nx)];
+            }
+        }
+        else
+        {
+            for (int k=-3;k<3;k++)
+            {
+                // Differences beyond the edge of the mesh are copies of the difference at the edge.
+                unsigned int xk = std::min(std::max(x + k, 0), int(nx) - 2);
+                unsigned int yk = std::min(std::max(y + k, 0), int(ny) - 2);
+
+                dx[k + 3] = signedDistance[mesh.xyToIndex(xk + 1, y)] - signedDistance[mesh.xyToIndex(xk, y)];
+                dy[k + 3] = signedDistance[mesh.xyToIndex(x, yk + 1)] - signedDistance[mesh.xyToIndex(x, yk)];
+            }
+        }
+    }
+}
@@ -0,0 +1,195 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _WENOGRADIENT_H
+#define _WENOGRADIENT_H
+
+#include <functional>
+#include <vector>
+
+#include "Common.h"
+
+/*! \file WENOGradient.h
+    \brief A vectorised kernel for the Hamilton-Jacobi WENO gradient.
+ */
+
+namespace slsm
+{
+    // FORWARD DECLARATIONS
+
+    class Mesh;
+    class ThreadPool;
+
+    // MAIN CLASS
+
+    /*! \brief A vectorised kernel for computing the upwind Hamilton-Jacobi WENO
+        approximation to the modulus of the gradient of the level set function.
+
+        Nodes are processed in batches. Finite differences of the signed distance
+        function are gathered directly from the nodal values into contiguous
+        stencil arrays for the batch, so the cost is proportional to the number
+        of nodes, rather than the size of the mesh. Close to the edge of the
+        mesh, differences beyond the edge are replaced by the difference at the
+        edge, which is equivalent to the extrapolation used by
+        LevelSet::computeGradient. The WENO approximation is then evaluated for
+        the whole batch in a single branch free loop that the compiler can
+        vectorise. When building with GCC on x86-64 Linux, the loop is compiled
+        for AVX-512, AVX2, and generic targets, with the best version being
+        selected at run time for the host processor.
+
+        The gradient evaluation can be shared between the threads of a thread
+        pool. Each node is computed independently, so the result doesn't depend
+        on the number of threads.
+
+        The diagonal stencil used at the corners of the domain isn't handled by
+        the kernel, i.e. corner nodes should be treated separately.
+
+        Once all gradients have been computed the signed distance function is
+        no longer read, so it can then be updated batch by batch, using the same
+        partition of nodes between threads (see the batch callback overload of
+        compute).
+     */
+    class WENOGradient
+    {
+    public:
+        //! Constructor.
+        /*! \param mesh_
+                A reference to the level set mesh.
+         */
+        WENOGradient(const Mesh&);
+
+        //! Compute the gradient of the signed distance function at a set of nodes.
+        /*! \param signedDistance
+                The nodal signed distance function (level set).
+
+            \param velocity
+                The nodal velocities (used to determine the upwind direction).
+
+            \param nodes
+                The indices of the nodes.
+
+            \param nNodes
+                The number of nodes.
+
+            \param gradient
+                The nodal gradient of the level set function (modulus).
+
+            \param threadPool
+                The pool of threads used to perform the computation.
+         */
+        void compute(const std::vector<Real>&, const std::vector<Real>&,
+            const std::vector<unsigned int>&, unsigned int, std::vector<Real>&, ThreadPool&);
+
+        //! Compute the gradient of the signed distance function at a set of nodes,
+        //! then call a function for each batch of nodes.
+        /*! \param signedDistance
+                The nodal signed distance function (level set). This may be
+                modified by the callback, which is only called once the gradient
+                has been computed at all nodes.
+
+            \param velocity
+                The nodal velocities (used to determine the upwind direction).
+
+            \param nodes
+                The indices of the nodes.
+
+            \param nNodes
+                The number of nodes.
+
+            \param gradient
+                The nodal gradient of the level set function (modulus).
+
+            \param threadPool
+                The pool of threads used to perform the computation.
+
+            \param callback
+                A function that is passed the range of entries in the nodes
+                vector (first, one past the last) for each batch, along with
+                the index of the thread that computed it.
+         */
+        void compute(const std::vector<Real>&, const std::vector<Real>&,
+            const std::vector<unsigned int>&, unsigned int, std::vector<Real>&, ThreadPool&,
+            const std::function<void(unsigned int, unsigned int, unsigned int)>&);
+
+    private:
+        /// A reference to the level set mesh.
+        const Mesh& mesh;
+
+        /// The number of nodes in the x direction.
+        unsigned int nx;
+
+        /// The number of nodes in the y direction.
+        unsigned int ny;
+
+        /// The number of nodes in each batch.
+        static const unsigned int batchSize = 64;
+
+        /// The stencil values for each node in the batch, for each of the four
+        /// directions (right, left, up, down). One batch is stored per thread.
+        std::vector<Real> stencil;
+
+        /// The upwind direction for each node in the batch.
+        std::vector<Real> sign;
+
+        /// The squared gradient for each node in the batch.
+        std::vector<Real> batchGradient;
+
+        //! Compute the gradient for a range of nodes.
+        /*! \param signedDistance
+                The nodal signed distance function (level set).
+
+            \param velocity
+                The nodal velocities (used to determine the upwind direction).
+
+            \param nodes
+                The indices of the nodes.
+
+            \param start
+                The first entry in the nodes vector.
+
+            \param end
+                One past the last entry in the nodes vector.
+
+            \param gradient
+                The nodal gradient of the level set function (modulus).
+
+            \param thread
+                The index of the thread (selects the batch arrays).
+         */
+        void computeGradients(const std::vector<Real>&, const std::vector<Real>&,
+            const std::vector<unsigned int>&, unsigned int, unsigned int, std::vector<Real>&, unsigned int);
+
+        //! Compute the finite differences either side of a node.
+        /*! \param signedDistance
+                The nodal signed distance function (level set).
+
+            \param node
+                The index of the node.
+
+            \param dx
+                The six differences in the x direction, starting three nodes
+                to the left (output).
+
+            \param dy
+                The six differences in the y direction, starting three nodes
+                below (output).
+         */
+        void computeDifferences(const std::vector<Real>&, unsigned int, Real*, Real*) const;
+    };
+}
+
+#endif  /* _WENOGRADIENT_H */
@@ -397,25 +397,28 @@ int testConnectivity()
 
     // Check connectivity between nodes and boundary points.
 
+    // Boundary points associated with a node.
+    unsigned int nodePoints[4];
+
     // First node.
-    slsm_check((levelSet.mesh.nodes[0].nBoundaryPoints == 2), "Incorrect number of boundary points associated with node 0!");
-    slsm_check((levelSet.mesh.nodes[0].boundaryPoints[0] == 0), "Boundary point 0 of node 0 is incorrect!");
-    slsm_check((levelSet.mesh.nodes[0].boundaryPoints[1] == 3), "Boundary point 1 of node 0 is incorrect!");
+    slsm_check((boundary.getNodePoints(levelSet.mesh, 0, nodePoints) == 2), "Incorrect number of boundary points associated with node 0!");
+    slsm_check((nodePoints[0] == 0), "Boundary point 0 of node 0 is incorrect!");
+    slsm_check((nodePoints[1] == 3), "Boundary point 1 of node 0 is incorrect!");
 
     // Second node.
-    slsm_check((levelSet.mesh.nodes[1].nBoundaryPoints == 2), "Incorrect number of boundary points associated with node 1!");
-    slsm_check((levelSet.mesh.nodes[1].boundaryPoints[0] == 0), "Boundary point 0 of node 1 is incorrect!");
-    slsm_check((levelSet.mesh.nodes[1].boundaryPoints[1] == 1), "Boundary point 1 of node 1 is incorrect!");
+    slsm_check((boundary.getNodePoints(levelSet.mesh, 1, nodePoints) == 2), "Incorrect number of boundary points associated with node 1!");
+    slsm_check((nodePoints[0] == 0), "Boundary point 0 of node 1 is incorrect!");
+    slsm_check((nodePoints[1] == 1), "Boundary point 1 of node 1 is incorrect!");
 
     // Third node.
-    slsm_check((levelSet.mesh.nodes[2].nBoundaryPoints == 2), "Incorrect number of boundary points associated with node 2!");
-    slsm_check((levelSet.mesh.nodes[2].boundaryPoints[0] == 2), "Boundary point 0 of node 2 is incorrect!");
-    slsm_check((levelSet.mesh.nodes[2].boundaryPoints[1] == 3), "Boundary point 1 of node 2 is incorrect!");
+    slsm_check((boundary.getNodePoints(levelSet.mesh, 2, nodePoints) == 2), "Incorrect number of boundary points associated with node 2!");
+    slsm_check((nodePoints[0] == 2), "Boundary point 0 of node 2 is incorrect!");
+    slsm_check((nodePoints[1] == 3), "Boundary point 1 of node 2 is incorrect!");
 
     // Fourth node.
-    slsm_check((levelSet.mesh.nodes[3].nBoundaryPoints == 2), "Incorrect number of boundary points associated with node 3!");
-    slsm_check((levelSet.mesh.nodes[3].boundaryPoints[0] == 1), "Boundary point 0 of node 3 is incorrect!");
-    slsm_check((levelSet.mesh.nodes[3].boundaryPoints[1] == 2), "Boundary point 1 of node 3 is incorrect!");
+    slsm_check((boundary.getNodePoints(levelSet.mesh, 3, nodePoints) == 2), "Incorrect number of boundary points associated with node 3!");
+    slsm_check((nodePoints[0] == 1), "Boundary point 0 of node 3 is incorrect!");
+    slsm_check((nodePoints[1] == 2), "Boundary point 1 of node 3 is incorrect!");
 
     // Check boundary segment connectivity.
     slsm_check((levelSet.mesh.elements[0].nBoundarySegments == 2), "Incorrect number of boundary segments for node 0!");
@@ -551,6 +554,102 @@ error:
     return 1;
 }
 
+int testIncremental()
+{
+    // A test that the incremental discretisation matches a full discretisation
+    // of the same level set.
+
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(20.3, 19.9, 8));
+    holes.push_back(slsm::Hole(8, 32, 4));
+
+    // Initialise two 40x40 level set domains.
+    slsm::LevelSet levelSet1(40, 40, holes, 0.5, 6);
+    slsm::LevelSet levelSet2(40, 40, holes, 0.5, 6);
+
+    // Initialise the boundary objects (the first is updated incrementally).
+    slsm::Boundary boundary1(true);
+    slsm::Boundary boundary2;
+
+    // Set error number.
+    errno = 0;
+
+    boundary1.discretise(levelSet1);
+    boundary2.discretise(levelSet2);
+
+    // Deform the holes until the narrow band has been reinitialised a few times.
+    for (unsigned int n=0;n<30;n++)
+    {
+        for (unsigned int i=0;i<levelSet1.mesh.nNodes;i++)
+        {
+            double x = levelSet1.mesh.nodes[i].coord.x;
+            double y = levelSet1.mesh.nodes[i].coord.y;
+
+            levelSet1.velocity[i] = 0.5*sin(0.3*x + 0.2*n)*cos(0.2*y);
+            levelSet2.velocity[i] = levelSet1.velocity[i];
+        }
+
+        levelSet1.computeGradients();
+        levelSet2.computeGradients();
+
+        levelSet1.update(0.5);
+        levelSet2.update(0.5);
+
+        boundary1.discretise(levelSet1);
+        boundary2.discretise(levelSet2);
+
+        // Check the number of points and segments.
+        slsm_check((boundary1.nPoints == boundary2.nPoints), "The number of boundary points is incorrect!");
+        slsm_check((boundary1.nSegments == boundary2.nSegments), "The number of boundary segments is incorrect!");
+        slsm_check((boundary1.points.size() == boundary1.nPoints), "The boundary point vector has the wrong size!");
+        slsm_check((std::abs(boundary1.length - boundary2.length) < 1e-6), "The boundary length is incorrect!");
+
+        // Every point must lie at the position of a point in the full discretisation.
+        for (unsigned int i=0;i<boundary1.nPoints;i++)
+        {
+            bool isFound = false;
+
+            for (unsigned int j=0;j<boundary2.nPoints;j++)
+            {
+                if ((boundary1.points[i].coord.x == boundary2.points[j].coord.x) &&
+                    (boundary1.points[i].coord.y == boundary2.points[j].coord.y))
+                {
+                    slsm_check((std::abs(boundary1.points[i].length - boundary2.points[j].length) < 1e-6),
+                        "Integral length of boundary point is incorrect!");
+                    isFound = true;
+                    break;
+                }
+            }
+
+            slsm_check(isFound, "Position of boundary point is incorrect!");
+        }
+
+        // Check that the area fractions agree.
+        slsm_check((std::abs(levelSet1.computeAreaFractions(boundary1)
+            - levelSet2.computeAreaFractions(boundary2)) < 1e-6), "Area fraction is incorrect!");
+    }
+
+    // Discretising an unchanged level set should leave the points in place.
+    {
+        std::vector<slsm::BoundaryPoint> points = boundary1.points;
+
+        boundary1.discretise(levelSet1);
+
+        slsm_check((boundary1.nPoints == points.size()), "The number of boundary points is incorrect!");
+
+        for (unsigned int i=0;i<boundary1.nPoints;i++)
+        {
+            slsm_check(((boundary1.points[i].coord.x == points[i].coord.x) &&
+                        (boundary1.points[i].coord.y == points[i].coord.y)), "Boundary point has moved!");
+        }
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
 int all_tests()
 {
     mu_suite_start();
@@ -560,6 +659,7 @@ int all_tests()
     mu_run_test(testBoundarySymmetry);
     mu_run_test(testConnectivity);
     mu_run_test(testAreaFraction);
+    mu_run_test(testIncremental);
 
     return 0;
 }
@@ -0,0 +1,324 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <limits>
+#include <thread>
+
+#include "slsm.h"
+
+// Serial reference data for a single iteration.
+struct Snapshot
+{
+    std::vector<double> velocity;
+    std::vector<double> gradient;
+    std::vector<double> signedDistance;
+    double length;
+    bool isReinitialised;
+};
+
+// Run a function on each rank of a local communicator group, returning the number of failures.
+template <typename Function>
+int runRanks(unsigned int nRanks, Function function)
+{
+    std::vector<slsm::LocalCommunicator> comms = slsm::LocalCommunicator::create(nRanks);
+    std::vector<int> results(nRanks);
+    std::vector<std::thread> threads;
+
+    for (unsigned int i=0;i<nRanks;i++)
+        threads.push_back(std::thread([&, i] { results[i] = function(comms[i]); }));
+
+    for (unsigned int i=0;i<nRanks;i++)
+        threads[i].join();
+
+    int nFailed = 0;
+    for (unsigned int i=0;i<nRanks;i++) nFailed += results[i];
+
+    return nFailed;
+}
+
+int communicatorRank(slsm::Communicator& comm)
+{
+    unsigned int rank = comm.rank();
+    unsigned int size = comm.size();
+
+    // Send a message of length rank + 1 to every other rank.
+    std::vector<unsigned int> ranks;
+    std::vector<std::vector<double> > send;
+    std::vector<std::vector<double> > receive;
+
+    for (unsigned int i=0;i<size;i++)
+    {
+        if (i != rank)
+        {
+            ranks.push_back(i);
+            send.push_back(std::vector<double>(rank + 1, rank));
+            receive.push_back(std::vector<double>(i + 1));
+        }
+    }
+
+    std::vector<double> values = {double(rank), -double(rank)};
+
+    // Set error number.
+    errno = 0;
+
+    slsm_check((comm.allReduce(rank + 1, slsm::ReduceOp::SUM) == (size*(size + 1))/2), "Sum mismatch!");
+    slsm_check((comm.allReduce(rank, slsm::ReduceOp::MIN) == 0), "Minimum mismatch!");
+    slsm_check((comm.allReduce(rank, slsm::ReduceOp::MAX) == (size - 1)), "Maximum mismatch!");
+
+    comm.allReduce(values, slsm::ReduceOp::MAX);
+    slsm_check(((values[0] == (size - 1)) && (values[1] == 0)), "Vector maximum mismatch!");
+
+    comm.exchange(ranks, send, receive);
+
+    for (unsigned int i=0;i<receive.size();i++)
+    {
+        for (unsigned int j=0;j<receive[i].size();j++)
+            slsm_check((receive[i][j] == ranks[i]), "Message mismatch!");
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testLocalCommunicator()
+{
+    // A test of collective operations between threads.
+
+    // Set error number.
+    errno = 0;
+
+    slsm_check((runRanks(1, communicatorRank) == 0), "Communication failed on a single rank!");
+    slsm_check((runRanks(2, communicatorRank) == 0), "Communication failed on two ranks!");
+    slsm_check((runRanks(5, communicatorRank) == 0), "Communication failed on five ranks!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testDistributedInitialisation()
+{
+    // A test that the distributed level set matches a single one at owned nodes.
+
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(50.3, 49.9, 20));
+    holes.push_back(slsm::Hole(25, 25, 10));
+    holes.push_back(slsm::Hole(80, 20, 30));
+
+    // Initialise a 100x80 level set domain.
+    slsm::LevelSet levelSet(100, 80, holes, 0.5, 6);
+
+    auto rank = [&](slsm::Communicator& comm)
+    {
+        // Decompose the domain into 3x2 sub-domains.
+        slsm::DistributedLevelSet distributed(comm, 100, 80, holes, 3, 2, 0.5, 6);
+
+        const slsm::Mesh& mesh = distributed.levelSet.mesh;
+
+        // The number of mismatched owned nodes, and narrow band nodes.
+        std::vector<double> counts(2, 0);
+
+        // Set error number.
+        errno = 0;
+
+        for (unsigned int i=0;i<mesh.nNodes;i++)
+        {
+            unsigned int x = mesh.nodes[i].coord.x + distributed.originX;
+            unsigned int y = mesh.nodes[i].coord.y + distributed.originY;
+
+            if (distributed.isOwned(slsm::Coord(x, y)))
+            {
+                unsigned int node = levelSet.mesh.xyToIndex(x, y);
+
+                if ((std::abs(distributed.levelSet.signedDistance[i] - levelSet.signedDistance[node]) > 1e-10)
+                    || (mesh.nodes[i].isActive != levelSet.mesh.nodes[node].isActive)) counts[0]++;
+
+                if (mesh.nodes[i].isActive) counts[1]++;
+            }
+        }
+
+        // Each node is owned by exactly one rank.
+        comm.allReduce(counts, slsm::ReduceOp::SUM);
+
+        slsm_check((counts[0] == 0), "Signed distance mismatch!");
+        slsm_check((counts[1] == levelSet.nNarrowBand), "Narrow band mismatch!");
+
+        return 0;
+
+    error:
+        return 1;
+    };
+
+    // Set error number.
+    errno = 0;
+
+    slsm_check((runRanks(6, rank) == 0), "Initialisation mismatch!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testDistributedEvolution()
+{
+    // A test that boundary discretisation, velocity extension, gradient
+    // computation, and reinitialisation match a single level set.
+
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(50.3, 49.9, 20));
+    holes.push_back(slsm::Hole(20, 25, 8));
+
+    // Initialise a 100x100 level set domain.
+    slsm::LevelSet levelSet(100, 100, holes, 0.5, 6);
+
+    slsm::Boundary boundary;
+
+    // Reference data for each iteration.
+    std::vector<Snapshot> snapshots;
+
+    // Evolve up to, and including, the first reinitialisation.
+    for (unsigned int n=0;n<20 && (snapshots.empty() || !snapshots.back().isReinitialised);n++)
+    {
+        Snapshot snapshot;
+
+        boundary.discretise(levelSet);
+
+        // Move the holes outwards, at a rate that varies around the boundary.
+        snapshot.length = 0;
+        for (unsigned int i=0;i<boundary.nPoints;i++)
+        {
+            boundary.points[i].velocity = -1 + 0.5*sin(0.2*boundary.points[i].coord.x);
+            snapshot.length += boundary.points[i].length;
+        }
+
+        levelSet.computeVelocities(boundary.points);
+        levelSet.computeGradients();
+
+        snapshot.velocity.assign(levelSet.velocity.begin(), levelSet.velocity.end());
+        snapshot.gradient.assign(levelSet.gradient.begin(), levelSet.gradient.end());
+
+        snapshot.isReinitialised = levelSet.update(0.5);
+        snapshot.signedDistance.assign(levelSet.signedDistance.begin(), levelSet.signedDistance.end());
+
+        snapshots.push_back(snapshot);
+    }
+
+    auto rank = [&](slsm::Communicator& comm)
+    {
+        // Decompose the domain into 2x2 sub-domains.
+        slsm::DistributedLevelSet distributed(comm, 100, 100, holes, 2, 2, 0.5, 6);
+
+        const slsm::Mesh& mesh = distributed.levelSet.mesh;
+        slsm::Boundary localBoundary;
+
+        // Set error number.
+        errno = 0;
+
+        for (unsigned int n=0;n<snapshots.size();n++)
+        {
+            distributed.discretise(localBoundary);
+
+            double length = 0;
+            for (unsigned int i=0;i<localBoundary.nPoints;i++)
+            {
+                double x = localBoundary.points[i].coord.x + distributed.originX;
+                localBoundary.points[i].velocity = -1 + 0.5*sin(0.2*x);
+
+                // Only count points owned by this rank.
+                if (!localBoundary.points[i].isGhost) length += localBoundary.points[i].length;
+            }
+
+            distributed.computeVelocities(localBoundary.points);
+            distributed.computeGradients();
+
+            bool isReinitialised = distributed.update(0.5);
+
+            // Maximum errors at owned nodes in the narrow band.
+            std::vector<double> errors(3, 0);
+
+            for (unsigned int i=0;i<mesh.nNodes;i++)
+            {
+                unsigned int x = mesh.nodes[i].coord.x + distributed.originX;
+                unsigned int y = mesh.nodes[i].coord.y + distributed.originY;
+                unsigned int node = levelSet.mesh.xyToIndex(x, y);
+
+                if (distributed.isOwned(slsm::Coord(x, y)) && mesh.nodes[i].isActive)
+                {
+                    errors[0] = std::max(errors[0], std::abs(distributed.levelSet.velocity[i] - snapshots[n].velocity[node]));
+                    errors[1] = std::max(errors[1], std::abs(distributed.levelSet.gradient[i] - snapshots[n].gradient[node]));
+                    errors[2] = std::max(errors[2], std::abs(distributed.levelSet.signedDistance[i] - snapshots[n].signedDistance[node]));
+                }
+            }
+
+            // Check on all ranks together, so that they fail together.
+            comm.allReduce(errors, slsm::ReduceOp::MAX);
+
+            /* Boundary points are found from the nodal signed distance function,
+               so in a single precision build the total length only agrees to
+               within the rounding error of the level set fields.
+             */
+            double tolerance = std::max(1e-8,
+                double(std::numeric_limits<slsm::Real>::epsilon()) * snapshots[n].length);
+
+            slsm_check((std::abs(comm.allReduce(length, slsm::ReduceOp::SUM) - snapshots[n].length) < tolerance),
+                "Boundary length mismatch!");
+            slsm_check((isReinitialised == snapshots[n].isReinitialised), "Reinitialisation mismatch!");
+
+            /* Each rank extends velocities using the part of the boundary on its
+               own mesh. The zero contour is truncated at the edge of the ghost
+               layer, which slightly perturbs velocities at owned nodes close to
+               the edge of the sub-domain.
+             */
+            slsm_check((errors[0] < 1e-4), "Velocity mismatch!");
+            slsm_check((errors[1] < 1e-4), "Gradient mismatch!");
+            slsm_check((errors[2] < 1e-4), "Signed distance mismatch!");
+        }
+
+        return 0;
+
+    error:
+        return 1;
+    };
+
+    // Set error number.
+    errno = 0;
+
+    slsm_check(snapshots.back().isReinitialised, "Level set wasn't reinitialised!");
+    slsm_check((runRanks(4, rank) == 0), "Evolution mismatch!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int all_tests()
+{
+    mu_suite_start();
+
+    mu_run_test(testLocalCommunicator);
+    mu_run_test(testDistributedInitialisation);
+    mu_run_test(testDistributedEvolution);
+
+    return 0;
+}
+
+RUN_TESTS(all_tests)
@@ -60,11 +60,353 @@ error:
     return 1;
 }
 
+int testWorkspaceReuse()
+{
+    // A test that the persistent fast marching workspace is correctly reset
+    // between consecutive marches.
+
+    // Create a single hole (just to pass to constructor).
+    std::vector<slsm::Hole> hole;
+
+    // Initialise a 4x4 level set domain.
+    slsm::LevelSet levelSet(4, 4, hole, 0.5, 3);
+
+    // Place all nodes inside the structure, apart from the central node.
+    for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        levelSet.signedDistance[i] = 1;
+    levelSet.signedDistance[12] = -1;
+
+    // Reinitialise the signed distance function (result is discarded).
+    levelSet.reinitialise();
+
+    // Now use the configuration from the upwind finite difference test.
+    for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        levelSet.signedDistance[i] = -1;
+    levelSet.signedDistance[0] = 1;
+    levelSet.signedDistance[levelSet.mesh.nNodes-1] = 1;
+
+    // Take a copy of the initial signed distance function.
+    std::vector<slsm::Real> signedDistance = levelSet.signedDistance;
+
+    // Reinitialise the signed distance function using the existing workspace.
+    levelSet.reinitialise();
+
+    // Reinitialise the copy using a newly constructed object.
+    slsm::FastMarchingMethod fmm(levelSet.mesh);
+    fmm.march(signedDistance);
+
+    // Set error number.
+    errno = 0;
+
+    // Check that the two signed distance functions match.
+    for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        slsm_check((levelSet.signedDistance[i] == signedDistance[i]), "Signed distance mismatch!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testBandedReinitialisation()
+{
+    // A test that reinitialisation restricted to the narrow band matches
+    // reinitialisation over the entire domain within the band.
+
+    // Initialise a hole.
+    slsm::Hole hole;
+
+    // Place hole in the centre of the mesh.
+    hole.coord.x = 30;
+    hole.coord.y = 30;
+    hole.r = 10;
+
+    // Push hole into a vector container.
+    std::vector<slsm::Hole> holes;
+    holes.push_back(hole);
+
+    // Initialise two identical 60x60 level set domains.
+    slsm::LevelSet levelSet1(60, 60, holes, 0.5, 6);
+    slsm::LevelSet levelSet2(60, 60, holes, 0.5, 6);
+
+    // Shift the signed distance function within the narrow band,
+    // i.e. move the boundary as would happen during an update.
+    for (unsigned int i=0;i<levelSet1.nNarrowBand;i++)
+    {
+        unsigned int node = levelSet1.narrowBand[i];
+        levelSet1.signedDistance[node] -= 2.5;
+        levelSet2.signedDistance[node] -= 2.5;
+    }
+
+    // Reinitialise the first level set over the entire domain.
+    levelSet1.reinitialise();
+
+    // Reinitialise the second level set within the narrow band.
+    levelSet2.reinitialise(true);
+
+    // Set error number.
+    errno = 0;
+
+    // Check that the narrow band regions match.
+    slsm_check((levelSet1.nNarrowBand == levelSet2.nNarrowBand), "Narrow band mismatch!");
+    slsm_check((levelSet1.nMines == levelSet2.nMines), "Mine mismatch!");
+
+    for (unsigned int i=0;i<levelSet1.nNarrowBand;i++)
+        slsm_check((levelSet1.narrowBand[i] == levelSet2.narrowBand[i]), "Narrow band mismatch!");
+
+    for (unsigned int i=0;i<levelSet1.nMines;i++)
+        slsm_check((levelSet1.mines[i] == levelSet2.mines[i]), "Mine mismatch!");
+
+    // Check signed distance within the band.
+    for (unsigned int i=0;i<levelSet1.mesh.nNodes;i++)
+    {
+        if (std::abs(levelSet1.signedDistance[i]) < 6)
+        {
+            slsm_check((std::abs(levelSet1.signedDistance[i] - levelSet2.signedDistance[i]) < 1e-10),
+                "Signed distance mismatch!");
+        }
+        else
+        {
+            slsm_check((std::abs(levelSet2.signedDistance[i]) >= 6), "Signed distance mismatch!");
+        }
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testUntidyQueue()
+{
+    // A test that the untidy priority queue reproduces the binary heap
+    // solution to within the documented tolerance.
+
+    // Create a single hole (just to pass to constructor).
+    std::vector<slsm::Hole> hole;
+
+    // Initialise a 4x4 level set domain.
+    slsm::LevelSet levelSet(4, 4, hole, 0.5, 3);
+
+    // Place all nodes outside the structure.
+    for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        levelSet.signedDistance[i] = -1;
+
+    // Place nodes at bottom left and top right of mesh inside the structure.
+    levelSet.signedDistance[0] = 1;
+    levelSet.signedDistance[levelSet.mesh.nNodes-1] = 1;
+
+    // Fill array with expected values (see testUpwindFiniteDifference).
+    double expected[25] =
+        {0.35355339, -0.50000000, -1.45118446, -2.43491262, -3.23422652,
+        -0.50000000, -1.20710678, -2.00007282, -2.73579936, -2.43491262,
+        -1.45118446, -2.00007282, -2.65444013, -2.00007282, -1.45118446,
+        -2.43491262, -2.73579936, -2.00007282, -1.20710678, -0.50000000,
+        -3.23422652, -2.43491262, -1.45118446, -0.50000000,  0.35355339};
+
+    // Initialise fast marching method object using the untidy queue.
+    slsm::FastMarchingMethod fmm(levelSet.mesh, false, slsm::FMM_Queue::UNTIDY);
+
+    // Reinitialise the signed distance function.
+    fmm.march(levelSet.signedDistance);
+
+    // Set error number.
+    errno = 0;
+
+    // Check signed distance against expected values.
+    for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        slsm_check((std::abs(levelSet.signedDistance[i] - expected[i]) < 1e-6), "Signed distance mismatch!");
+
+    // Now compare against the binary heap for a larger domain with two holes.
+    {
+        std::vector<slsm::Hole> holes;
+        holes.push_back(slsm::Hole(50.3, 49.9, 20));
+        holes.push_back(slsm::Hole(25, 25, 10));
+
+        // Initialise a 100x100 level set domain.
+        slsm::LevelSet levelSet2(100, 100, holes, 0.5, 6);
+
+        // Take copies of the signed distance function.
+        std::vector<slsm::Real> signedDistance1 = levelSet2.signedDistance;
+        std::vector<slsm::Real> signedDistance2 = levelSet2.signedDistance;
+
+        // Initialise fast marching method objects.
+        slsm::FastMarchingMethod fmm1(levelSet2.mesh, false, slsm::FMM_Queue::BINARY_HEAP);
+        slsm::FastMarchingMethod fmm2(levelSet2.mesh, false, slsm::FMM_Queue::UNTIDY);
+
+        // Reinitialise the signed distance functions.
+        fmm1.march(signedDistance1);
+        fmm2.march(signedDistance2);
+
+        // Mean absolute difference.
+        double mean = 0;
+
+        for (unsigned int i=0;i<levelSet2.mesh.nNodes;i++)
+        {
+            double difference = std::abs(signedDistance1[i] - signedDistance2[i]);
+            slsm_check((difference < 0.05), "Signed distance mismatch!");
+
+            mean += difference;
+        }
+        mean /= levelSet2.mesh.nNodes;
+
+        slsm_check((mean < 1e-3), "Signed distance mismatch!");
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testFastSweeping()
+{
+    // A test that the parallel Fast Sweeping Method reproduces the
+    // Fast Marching Method solution to within the documented tolerance.
+
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(50.3, 49.9, 20));
+    holes.push_back(slsm::Hole(25, 25, 10));
+
+    // Initialise a 100x100 level set domain.
+    slsm::LevelSet levelSet(100, 100, holes, 0.5, 6);
+
+    // Initialise fast marching method object.
+    slsm::FastMarchingMethod fmm(levelSet.mesh);
+
+    // Reinitialise the signed distance function.
+    std::vector<slsm::Real> signedDistance = levelSet.signedDistance;
+    fmm.march(signedDistance);
+
+    // Set error number.
+    errno = 0;
+
+    // Test serial and parallel sweeping.
+    for (unsigned int n=1;n<=4;n*=4)
+    {
+        slsm::FastSweepingMethod fsm(levelSet.mesh, n);
+
+        // Reinitialise the signed distance function.
+        std::vector<slsm::Real> signedDistance2 = levelSet.signedDistance;
+        fsm.march(signedDistance2);
+
+        // Compare solutions within the narrow band.
+        for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        {
+            if (std::abs(signedDistance[i]) < 6)
+            {
+                // Zero contour must be unchanged.
+                slsm_check(((signedDistance[i] < 0) == (signedDistance2[i] < 0)), "Sign mismatch!");
+                slsm_check((std::abs(signedDistance[i] - signedDistance2[i]) < 0.05), "Signed distance mismatch!");
+            }
+        }
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testTiledOrdering()
+{
+    // A test that the march gives identical results when the mesh nodes are
+    // stored in tiles, rather than row by row.
+
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(50.3, 49.9, 20));
+    holes.push_back(slsm::Hole(25, 25, 10));
+
+    // Initialise a pair of 100x70 level set domains (with partial tiles).
+    slsm::LevelSet levelSet1(100, 70, holes, 0.5, 6, false, slsm::NodeOrdering::ROW_MAJOR);
+    slsm::LevelSet levelSet2(100, 70, holes, 0.5, 6, false, slsm::NodeOrdering::TILED);
+
+    // Initialise fast marching method objects.
+    slsm::FastMarchingMethod fmm1(levelSet1.mesh);
+    slsm::FastMarchingMethod fmm2(levelSet2.mesh);
+
+    // Reinitialise the signed distance functions.
+    fmm1.march(levelSet1.signedDistance);
+    fmm2.march(levelSet2.signedDistance);
+
+    // Set error number.
+    errno = 0;
+
+    // Compare the signed distance at each position.
+    for (unsigned int y=0;y<=70;y++)
+    {
+        for (unsigned int x=0;x<=100;x++)
+        {
+            slsm_check(levelSet1.signedDistance[levelSet1.mesh.xyToIndex(x, y)]
+                == levelSet2.signedDistance[levelSet2.mesh.xyToIndex(x, y)], "Signed distance mismatch!");
+        }
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testVelocityExtension()
+{
+    // A test that velocity extension leaves the signed distance function
+    // untouched, and that the result doesn't depend on the previous march.
+
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(50.3, 49.9, 20));
+    holes.push_back(slsm::Hole(25, 25, 10));
+
+    // Initialise a 100x100 level set domain.
+    slsm::LevelSet levelSet(100, 100, holes, 0.5, 6);
+
+    // Initialise fast marching method object.
+    slsm::FastMarchingMethod fmm(levelSet.mesh);
+
+    // Set a velocity that varies with position. Only values at nodes
+    // adjacent to the zero contour are used.
+    std::vector<slsm::Real> velocity(levelSet.mesh.nNodes);
+    for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        velocity[i] = -1 + 0.5*sin(0.2*levelSet.mesh.nodes[i].coord.x);
+
+    // Store the signed distance function and initial velocities.
+    std::vector<slsm::Real> signedDistance = levelSet.signedDistance;
+    std::vector<slsm::Real> velocity2 = velocity;
+
+    // Extend velocities to the narrow band.
+    fmm.march(levelSet.signedDistance, velocity);
+
+    // Set error number.
+    errno = 0;
+
+    for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        slsm_check((levelSet.signedDistance[i] == signedDistance[i]), "Signed distance was modified!");
+
+    // Reinitialise a copy of the signed distance function with the same
+    // object, which overwrites its workspace, then extend velocities again.
+    fmm.march(signedDistance);
+    fmm.march(levelSet.signedDistance, velocity2);
+
+    for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        slsm_check((velocity[i] == velocity2[i]), "Velocity mismatch!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
 int all_tests()
 {
     mu_suite_start();
 
     mu_run_test(testUpwindFiniteDifference);
+    mu_run_test(testWorkspaceReuse);
+    mu_run_test(testBandedReinitialisation);
+    mu_run_test(testUntidyQueue);
+    mu_run_test(testFastSweeping);
+    mu_run_test(testTiledOrdering);
+    mu_run_test(testVelocityExtension);
 
     return 0;
 }
@@ -39,8 +39,8 @@ int testSignedDistance()
     // Diagonal of reduced 3x3 box.
     double diag = sqrt(18);
 
-    // Difference between diag and hole radius.
-    double d = diag - hole.r;
+    // Difference between diag and hole radius (at the precision of the level set).
+    slsm::Real d = diag - hole.r;
 
     // Check signed distance against expected values.
 
@@ -88,11 +88,294 @@ error:
     return 1;
 }
 
+int testGradient()
+{
+    // A test that the gradient of a linear signed distance function is
+    // recovered exactly at all nodes, including those at the domain edges.
+
+    // Create a single hole (just to pass to constructor).
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(10, 7, 3));
+
+    // Initialise a 20x15 level set domain.
+    slsm::LevelSet levelSet(20, 15, holes);
+
+    // Add all nodes to the narrow band.
+    levelSet.nNarrowBand = levelSet.mesh.nNodes;
+    levelSet.narrowBand.resize(levelSet.mesh.nNodes);
+
+    for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+    {
+        // Distance from a line with unit normal (0.6, 0.8).
+        double x = levelSet.mesh.nodes[i].coord.x;
+        double y = levelSet.mesh.nodes[i].coord.y;
+        levelSet.signedDistance[i] = 0.6*x + 0.8*y - 10.3;
+
+        // Alternate the upwind direction.
+        levelSet.velocity[i] = (i % 3) ? 1 : -1;
+
+        levelSet.narrowBand[i] = i;
+        levelSet.mesh.nodes[i].isActive = true;
+    }
+
+    // Compute the gradient of the signed distance function.
+    levelSet.computeGradients();
+
+    // The expected rounding error.
+    double tolerance = (sizeof(slsm::Real) < sizeof(double)) ? 1e-5 : 1e-10;
+
+    // Set error number.
+    errno = 0;
+
+    // Check that the gradient is unity everywhere (to within the precision
+    // of the level set).
+    for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        slsm_check((std::abs(levelSet.gradient[i] - 1.0) < tolerance), "Gradient mismatch!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testThreads()
+{
+    // A test that narrow band operations give identical results when
+    // run with multiple threads.
+
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(30.3, 29.9, 12));
+    holes.push_back(slsm::Hole(12, 45, 5));
+
+    // Initialise two 60x60 level set domains.
+    slsm::LevelSet levelSet1(60, 60, holes, 0.5, 6);
+    slsm::LevelSet levelSet2(60, 60, holes, 0.5, 6);
+
+    // Use multiple threads for the second level set.
+    levelSet2.setThreads(4);
+
+    // Set error number.
+    errno = 0;
+
+    // Shrink the holes until the narrow band has been reinitialised a few times.
+    for (unsigned int n=0;n<20;n++)
+    {
+        for (unsigned int i=0;i<levelSet1.mesh.nNodes;i++)
+        {
+            levelSet1.velocity[i] = 0.5 + 0.1*sin(levelSet1.signedDistance[i]);
+            levelSet2.velocity[i] = 0.5 + 0.1*sin(levelSet2.signedDistance[i]);
+        }
+
+        levelSet1.computeGradients();
+        levelSet2.computeGradients();
+
+        bool isReinitialised1 = levelSet1.update(0.5);
+        bool isReinitialised2 = levelSet2.update(0.5);
+
+        slsm_check((isReinitialised1 == isReinitialised2), "Reinitialisation mismatch!");
+        slsm_check((levelSet1.nNarrowBand == levelSet2.nNarrowBand), "Narrow band mismatch!");
+
+        // Results must be bitwise identical.
+        for (unsigned int i=0;i<levelSet1.mesh.nNodes;i++)
+        {
+            slsm_check((levelSet1.gradient[i] == levelSet2.gradient[i]), "Gradient mismatch!");
+            slsm_check((levelSet1.signedDistance[i] == levelSet2.signedDistance[i]), "Signed distance mismatch!");
+        }
+    }
+
+    {
+        slsm::Boundary boundary1;
+        slsm::Boundary boundary2;
+
+        boundary1.discretise(levelSet1);
+        boundary2.discretise(levelSet2);
+
+        // The total area is summed in the same order for any number of threads.
+        slsm_check((levelSet1.computeAreaFractions(boundary1) ==
+                    levelSet2.computeAreaFractions(boundary2)), "Area mismatch!");
+
+        for (unsigned int i=0;i<levelSet1.mesh.nElements;i++)
+            slsm_check((levelSet1.mesh.elements[i].area == levelSet2.mesh.elements[i].area), "Area fraction mismatch!");
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testClosestPointVelocities()
+{
+    // A test that closest point velocity extension is constant along the
+    // normal to the boundary, and doesn't touch the signed distance function.
+
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(30.3, 29.9, 12));
+
+    // Initialise two 60x60 level set domains.
+    slsm::LevelSet levelSet1(60, 60, holes, 0.5, 6);
+    slsm::LevelSet levelSet2(60, 60, holes, 0.5, 6);
+
+    // Use multiple threads for the second level set.
+    levelSet2.setThreads(4);
+
+    // Discretise the boundary.
+    slsm::Boundary boundary;
+    boundary.discretise(levelSet1);
+
+    // Store a copy of the signed distance function.
+    std::vector<slsm::Real> signedDistance = levelSet1.signedDistance;
+
+    // The velocity varies with the angle around the hole centre.
+    for (unsigned int i=0;i<boundary.nPoints;i++)
+    {
+        double dx = boundary.points[i].coord.x - holes[0].coord.x;
+        double dy = boundary.points[i].coord.y - holes[0].coord.y;
+        boundary.points[i].velocity = cos(atan2(dy, dx));
+    }
+
+    levelSet1.computeVelocities(boundary);
+    levelSet2.computeVelocities(boundary);
+
+    // Set error number.
+    errno = 0;
+
+    for (unsigned int i=0;i<levelSet1.mesh.nNodes;i++)
+    {
+        slsm_check((levelSet1.signedDistance[i] == signedDistance[i]), "Signed distance was modified!");
+        slsm_check((levelSet1.velocity[i] == levelSet2.velocity[i]), "Thread mismatch!");
+
+        double x = levelSet1.mesh.nodes[i].coord.x;
+        double y = levelSet1.mesh.nodes[i].coord.y;
+        double dx = x - holes[0].coord.x;
+        double dy = y - holes[0].coord.y;
+
+        // Distance from the hole, and from the domain edge.
+        double holeDistance = std::abs(sqrt(dx*dx + dy*dy) - holes[0].r);
+        double edgeDistance = std::min(std::min(x, 60 - x), std::min(y, 60 - y));
+
+        // Nodes in the narrow band that are closest to the hole. Outside of the
+        // hole, nodes project onto the vertices of the piecewise linear boundary,
+        // so the velocity is accurate to within half the angle between points.
+        if (levelSet1.mesh.nodes[i].isActive && (holeDistance < (edgeDistance - 1)))
+        {
+            slsm_check((std::abs(levelSet1.velocity[i] - cos(atan2(dy, dx))) < 0.5/holes[0].r), "Velocity mismatch!");
+        }
+
+        // Nodes outside of the narrow band.
+        else if (!levelSet1.mesh.nodes[i].isActive)
+        {
+            slsm_check((levelSet1.velocity[i] == 0), "Velocity outside of the narrow band!");
+        }
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testStep()
+{
+    // A test that the fused step matches the separate stages of an iteration.
+
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(30.3, 29.9, 12));
+    holes.push_back(slsm::Hole(12, 45, 5));
+
+    // Initialise two 60x60 level set domains.
+    slsm::LevelSet levelSet1(60, 60, holes, 0.5, 6);
+    slsm::LevelSet levelSet2(60, 60, holes, 0.5, 6);
+
+    // Use multiple threads for the second level set.
+    levelSet2.setThreads(4);
+
+    // Discretise the boundaries and compute the initial area fractions.
+    slsm::Boundary boundary1;
+    slsm::Boundary boundary2;
+    boundary1.discretise(levelSet1);
+    boundary2.discretise(levelSet2);
+    levelSet1.computeAreaFractions(boundary1);
+    levelSet2.computeAreaFractions(boundary2);
+
+    // The number of narrow band reinitialisations.
+    unsigned int nReinit = 0;
+
+    // Set error number.
+    errno = 0;
+
+    for (unsigned int n=0;n<20;n++)
+    {
+        // Shrink the holes at a rate that varies around the boundary.
+        for (unsigned int i=0;i<boundary1.nPoints;i++)
+        {
+            boundary1.points[i].velocity = 0.5 + 0.3*sin(0.3*boundary1.points[i].coord.y);
+            boundary2.points[i].velocity = 0.5 + 0.3*sin(0.3*boundary2.points[i].coord.y);
+        }
+
+        // Reinitialise the full signed distance function once.
+        bool isFull = (n == 14);
+
+        // Perform the stages of the iteration separately.
+        levelSet1.computeVelocities(boundary1.points);
+        levelSet1.computeGradients();
+        bool isReinitialised1 = levelSet1.update(0.5);
+        if (!isReinitialised1 && isFull)
+        {
+            levelSet1.reinitialise();
+            isReinitialised1 = true;
+        }
+        else if (isReinitialised1) nReinit++;
+        boundary1.discretise(levelSet1);
+        levelSet1.computeAreaFractions(boundary1);
+        boundary1.computeNormalVectors(levelSet1);
+
+        // Perform the fused iteration.
+        bool isReinitialised2 = levelSet2.step(boundary2, 0.5, isFull);
+
+        slsm_check((isReinitialised1 == isReinitialised2), "Reinitialisation mismatch!");
+        slsm_check((levelSet1.nNarrowBand == levelSet2.nNarrowBand), "Narrow band mismatch!");
+        slsm_check((boundary1.nPoints == boundary2.nPoints), "Boundary point mismatch!");
+        slsm_check((std::abs(levelSet1.area - levelSet2.area) < 1e-10), "Area mismatch!");
+
+        // Results must be bitwise identical.
+        for (unsigned int i=0;i<levelSet1.mesh.nNodes;i++)
+        {
+            slsm_check((levelSet1.velocity[i] == levelSet2.velocity[i]), "Velocity mismatch!");
+            slsm_check((levelSet1.gradient[i] == levelSet2.gradient[i]), "Gradient mismatch!");
+            slsm_check((levelSet1.signedDistance[i] == levelSet2.signedDistance[i]), "Signed distance mismatch!");
+        }
+
+        for (unsigned int i=0;i<levelSet1.mesh.nElements;i++)
+            slsm_check((levelSet1.mesh.elements[i].area == levelSet2.mesh.elements[i].area), "Area fraction mismatch!");
+
+        for (unsigned int i=0;i<boundary1.nPoints;i++)
+        {
+            slsm_check((boundary1.points[i].coord.x == boundary2.points[i].coord.x), "Boundary point mismatch!");
+            slsm_check((boundary1.points[i].coord.y == boundary2.points[i].coord.y), "Boundary point mismatch!");
+            slsm_check((boundary1.points[i].normal.x == boundary2.points[i].normal.x), "Normal vector mismatch!");
+            slsm_check((boundary1.points[i].normal.y == boundary2.points[i].normal.y), "Normal vector mismatch!");
+        }
+    }
+
+    // Make sure that the narrow band was reinitialised.
+    slsm_check((nReinit > 0), "Narrow band wasn't reinitialised!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
 int all_tests()
 {
     mu_suite_start();
 
     mu_run_test(testSignedDistance);
+    mu_run_test(testGradient);
+    mu_run_test(testThreads);
+    mu_run_test(testClosestPointVelocities);
+    mu_run_test(testStep);
 
     return 0;
 }
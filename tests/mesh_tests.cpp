@@ -232,6 +232,177 @@ error:
     return 1;
 }
 
+int testCompactStorage()
+{
+    // Initialise a 3x3 mesh.
+    slsm::Mesh mesh(3, 3);
+
+    // Set error number.
+    errno = 0;
+
+    // Check that node flags are packed independently.
+    mesh.nodes[5].isActive = true;
+    mesh.nodes[5].status = slsm::NodeStatus::OUTSIDE;
+    slsm_check(mesh.nodes[5].isActive, "Node 5 should be active!");
+    slsm_check(!mesh.nodes[5].isMasked, "Node 5 shouldn't be masked!");
+    slsm_check(!mesh.nodes[5].isDomain, "Node 5 shouldn't lie on the domain boundary!");
+    slsm_check(mesh.nodes[5].status == slsm::NodeStatus::OUTSIDE, "Status of node 5 is incorrect!");
+    slsm_check(mesh.nodeFlags[5] == (slsm::NodeFlag::ACTIVE | (slsm::NodeStatus::OUTSIDE << 4)),
+        "Packed flags of node 5 are incorrect!");
+
+    // Check that element data is written to the compact storage.
+    mesh.elements[4].area = 0.5;
+    mesh.elements[4].status = slsm::ElementStatus::CENTRE_INSIDE;
+    slsm_check(mesh.elementArea[4] == 0.5, "Area of element 4 is incorrect!");
+    slsm_check(mesh.elementStatus[4] == slsm::ElementStatus::CENTRE_INSIDE, "Status of element 4 is incorrect!");
+
+    // Check that the nodes of a const mesh are read only copies.
+    {
+        const slsm::Mesh& constMesh = mesh;
+        slsm::ConstNode node = constMesh.nodes[5];
+        node.isActive = false;
+        slsm_check(mesh.nodes[5].isActive, "Node 5 was modified through a const mesh!");
+        slsm_check(node.status == slsm::NodeStatus::OUTSIDE, "Status of const node 5 is incorrect!");
+        slsm_check((node.coord.x == 1) && (node.coord.y == 1), "Coordinates of const node 5 are incorrect!");
+        slsm_check(node.neighbours[3] == 9, "Upper neighbour of const node 5 is incorrect!");
+    }
+
+    // Check that the elements of a const mesh are read only copies.
+    {
+        const slsm::Mesh& constMesh = mesh;
+        slsm::ConstElement element = constMesh.elements[4];
+        element.area = 1;
+        element.status = slsm::ElementStatus::NONE;
+        slsm_check(mesh.elementArea[4] == 0.5, "Element 4 was modified through a const mesh!");
+        slsm_check(mesh.elementStatus[4] == slsm::ElementStatus::CENTRE_INSIDE, "Element 4 was modified through a const mesh!");
+        slsm_check(element.nodes[2] == 10, "Node 2 of const element 4 is incorrect!");
+        slsm_check((element.coord.x == 1.5) && (element.coord.y == 1.5), "Coordinates of const element 4 are incorrect!");
+    }
+
+    // Check that the connectivity of a copied mesh refers to the copy.
+    {
+        slsm::Mesh copy(mesh);
+        copy.nodes[5].isActive = false;
+        copy.elements[4].area = 1;
+        slsm_check(mesh.nodes[5].isActive, "Node 5 of original mesh was modified!");
+        slsm_check(mesh.elements[4].area == 0.5, "Element 4 of original mesh was modified!");
+        slsm_check(copy.elements[4].nodes[2] == 10, "Node 2 of element 4 of copied mesh is incorrect!");
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
+// Check the numbering and connectivity of a mesh with a block node ordering.
+int checkBlockOrdering(const slsm::Mesh& mesh)
+{
+    // Whether each node index has been visited.
+    std::vector<bool> isVisited(mesh.nNodes, false);
+
+    // Set error number.
+    errno = 0;
+
+    // Check that the numbering is a one-to-one mapping.
+    for (unsigned int y=0;y<=mesh.height;y++)
+    {
+        for (unsigned int x=0;x<=mesh.width;x++)
+        {
+            unsigned int node = mesh.xyToIndex(x, y);
+
+            slsm_check(node < mesh.nNodes, "Node index is out of range!");
+            slsm_check(!isVisited[node], "Node index is repeated!");
+            slsm_check((mesh.nodes[node].coord.x == x) && (mesh.nodes[node].coord.y == y),
+                "Node coordinates are incorrect!");
+
+            isVisited[node] = true;
+        }
+    }
+
+    // Check the connectivity against the node coordinates.
+    for (unsigned int i=0;i<mesh.nNodes;i++)
+    {
+        unsigned int x = mesh.nodes[i].coord.x;
+        unsigned int y = mesh.nodes[i].coord.y;
+
+        unsigned int left  = (x > 0)  ? mesh.xyToIndex(x-1, y) : mesh.nNodes;
+        unsigned int right = (x < mesh.width) ? mesh.xyToIndex(x+1, y) : mesh.nNodes;
+        unsigned int down  = (y > 0)  ? mesh.xyToIndex(x, y-1) : mesh.nNodes;
+        unsigned int up    = (y < mesh.height) ? mesh.xyToIndex(x, y+1) : mesh.nNodes;
+
+        slsm_check(mesh.nodes[i].neighbours[0] == left, "Left neighbour is incorrect!");
+        slsm_check(mesh.nodes[i].neighbours[1] == right, "Right neighbour is incorrect!");
+        slsm_check(mesh.nodes[i].neighbours[2] == down, "Lower neighbour is incorrect!");
+        slsm_check(mesh.nodes[i].neighbours[3] == up, "Upper neighbour is incorrect!");
+    }
+
+    // Check that element nodes are ordered anticlockwise from the bottom left.
+    for (unsigned int i=0;i<mesh.nElements;i++)
+    {
+        unsigned int x = i % mesh.width;
+        unsigned int y = i / mesh.width;
+
+        slsm_check(mesh.elements[i].nodes[0] == mesh.xyToIndex(x, y), "Element node 0 is incorrect!");
+        slsm_check(mesh.elements[i].nodes[1] == mesh.xyToIndex(x+1, y), "Element node 1 is incorrect!");
+        slsm_check(mesh.elements[i].nodes[2] == mesh.xyToIndex(x+1, y+1), "Element node 2 is incorrect!");
+        slsm_check(mesh.elements[i].nodes[3] == mesh.xyToIndex(x, y+1), "Element node 3 is incorrect!");
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testMortonOrdering()
+{
+    // Initialise a 40x20 mesh with Z-order node numbering, so that
+    // there are both complete and incomplete blocks of nodes.
+    slsm::Mesh mesh(40, 20, slsm::NodeOrdering::MORTON);
+
+    // Set error number.
+    errno = 0;
+
+    slsm_check(checkBlockOrdering(mesh) == 0, "Z-order numbering is inconsistent!");
+
+    // Nodes within the first block are numbered in Z-order.
+    slsm_check(mesh.xyToIndex(1, 0) == 1, "Index of node (1, 0) is incorrect!");
+    slsm_check(mesh.xyToIndex(0, 1) == 2, "Index of node (0, 1) is incorrect!");
+    slsm_check(mesh.xyToIndex(1, 1) == 3, "Index of node (1, 1) is incorrect!");
+    slsm_check(mesh.xyToIndex(2, 0) == 4, "Index of node (2, 0) is incorrect!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testTiledOrdering()
+{
+    // Initialise a 40x20 mesh with tiled node numbering.
+    slsm::Mesh mesh(40, 20, slsm::NodeOrdering::TILED);
+
+    // Set error number.
+    errno = 0;
+
+    slsm_check(checkBlockOrdering(mesh) == 0, "Tiled numbering is inconsistent!");
+
+    // Nodes within the first block are numbered row by row.
+    slsm_check(mesh.xyToIndex(15, 0) == 15, "Index of node (15, 0) is incorrect!");
+    slsm_check(mesh.xyToIndex(0, 1) == 16, "Index of node (0, 1) is incorrect!");
+    slsm_check(mesh.xyToIndex(16, 0) == 256, "Index of node (16, 0) is incorrect!");
+
+    // The incomplete block in the top right corner is 9 nodes wide and 5 high.
+    slsm_check(mesh.xyToIndex(32, 16) == (16*41 + 32*5), "Index of node (32, 16) is incorrect!");
+    slsm_check(mesh.xyToIndex(32, 17) == (16*41 + 32*5 + 9), "Index of node (32, 17) is incorrect!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
 int all_tests()
 {
     mu_suite_start();
@@ -243,6 +414,9 @@ int all_tests()
     mu_run_test(testElementNodeConnectivity);
     mu_run_test(testNodeElementConnectivity);
     mu_run_test(testCoordinateMapping);
+    mu_run_test(testCompactStorage);
+    mu_run_test(testMortonOrdering);
+    mu_run_test(testTiledOrdering);
 
     return 0;
 }
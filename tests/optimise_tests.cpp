@@ -0,0 +1,320 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "slsm.h"
+
+// Create a set of random boundary points.
+// If isDisjoint, each point is only sensitive to a single function.
+void createPoints(std::vector<slsm::BoundaryPoint>& points, unsigned int nPoints,
+    unsigned int nFunctions, bool isDisjoint, bool isDomain, slsm::MersenneTwister& rng)
+{
+    points.resize(nPoints);
+
+    for (unsigned int i=0;i<nPoints;i++)
+    {
+        slsm::BoundaryPoint& point = points[i];
+
+        point.length = 0.5 + rng();
+        point.isFixed = ((i % 50) == 0);
+
+        // Points near the domain boundary can only move a short distance inwards.
+        point.isDomain = isDomain && ((i % 5) == 0);
+        point.negativeLimit = -0.1*rng();
+        point.positiveLimit = 0.5;
+
+        point.sensitivities.resize(nFunctions);
+        for (unsigned int j=0;j<nFunctions;j++)
+        {
+            if (isDisjoint && (j != (i % nFunctions))) point.sensitivities[j] = 0;
+            else point.sensitivities[j] = 2*rng() - 1;
+        }
+    }
+}
+
+// Sum the change in a function directly over the boundary points.
+double computeChange(const std::vector<slsm::BoundaryPoint>& points, unsigned int function, double timeStep)
+{
+    double change = 0;
+
+    for (unsigned int i=0;i<points.size();i++)
+    {
+        if (!points[i].isFixed && !points[i].isGhost)
+            change += points[i].velocity * timeStep * points[i].sensitivities[function] * points[i].length;
+    }
+
+    return change;
+}
+
+int testGramCallback()
+{
+    // Check that the objective change returned by the optimiser, which is
+    // evaluated from the Gram matrix and side limit corrections, matches a
+    // direct sum over the boundary points, including clamped domain points.
+    // Each point is only sensitive to one function, so that no displacement
+    // exceeds the limit and the solution isn't rescaled.
+
+    slsm::MersenneTwister rng;
+
+    std::vector<slsm::BoundaryPoint> points;
+    createPoints(points, 2000, 2, true, true, rng);
+
+    std::vector<double> constraintDistances = {1.0};
+    std::vector<bool> isEquality = {true};
+    std::vector<double> lambdas(2, 0);
+    double timeStep;
+
+    slsm::Optimise optimise(points, constraintDistances, lambdas, timeStep,
+        0.5, false, isEquality, slsm::Solver::SIMPLEX);
+
+    double objective = optimise.solve();
+
+    // Set error number.
+    errno = 0;
+
+    // Count the clamped domain points.
+    {
+        unsigned int nClamped = 0;
+
+        for (unsigned int i=0;i<points.size();i++)
+        {
+            if (points[i].isDomain && !points[i].isFixed &&
+                (std::abs(points[i].velocity * timeStep - points[i].negativeLimit) < 1e-12))
+                nClamped++;
+        }
+
+        slsm_check((nClamped > 0), "No points are clamped!");
+    }
+
+    // Check the objective change.
+    {
+        double change = computeChange(points, 0, timeStep);
+        slsm_check((std::abs(change - objective) < 1e-8*std::abs(change)), "Objective mismatch!");
+    }
+
+    // Check that the constraint is satisfied (to within the solver tolerance,
+    // since the side limits are linearised).
+    slsm_check((std::abs(computeChange(points, 1, timeStep) - 1.0) < 1e-4), "Constraint mismatch!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testConstraintBound()
+{
+    // Constraint targets that are out of reach are reduced to 99% of the
+    // extreme change over the lambda search hypercube. Check the change in
+    // each constraint against the extrema found by enumerating the vertices
+    // of the hypercube, with and without points that are clamped by a side
+    // limit. Each point is only sensitive to one function, so that the
+    // reduced targets can be met simultaneously.
+
+    slsm::MersenneTwister rng;
+
+    // The number of constraints.
+    const unsigned int nConstraints = 3;
+
+    // The maximum displacement.
+    const double maxDisplacement = 0.5;
+
+    for (unsigned int n=0;n<2;n++)
+    {
+        std::vector<slsm::BoundaryPoint> points;
+        createPoints(points, 2000, nConstraints + 1, true, (n == 1), rng);
+
+        // Alternate between targets above the maximum and below the minimum change.
+        std::vector<double> constraintDistances(nConstraints);
+        for (unsigned int i=0;i<nConstraints;i++)
+            constraintDistances[i] = (i % 2) ? -1e6 : 1e6;
+
+        std::vector<bool> isEquality(nConstraints, true);
+        std::vector<double> lambdas(nConstraints + 1, 0);
+        double timeStep;
+
+        slsm::Optimise optimise(points, constraintDistances, lambdas, timeStep,
+            maxDisplacement, false, isEquality, slsm::Solver::SIMPLEX);
+
+        optimise.solve();
+
+        // The lambda limits for each function (in units of displacement per unit sensitivity).
+        std::vector<double> limits(nConstraints + 1, 0);
+        for (unsigned int i=0;i<points.size();i++)
+        {
+            if (!points[i].isFixed)
+            {
+                for (unsigned int j=0;j<nConstraints+1;j++)
+                    limits[j] = std::max(limits[j], std::abs(points[i].sensitivities[j]));
+            }
+        }
+        for (unsigned int j=0;j<nConstraints+1;j++)
+            limits[j] = maxDisplacement / limits[j];
+
+        // Find the min and max change in each constraint over the hypercube vertices.
+        std::vector<double> min(nConstraints, std::numeric_limits<double>::max());
+        std::vector<double> max(nConstraints, std::numeric_limits<double>::lowest());
+
+        for (unsigned int v=0;v<(1u << (nConstraints + 1));v++)
+        {
+            std::vector<double> changes(nConstraints, 0);
+
+            for (unsigned int i=0;i<points.size();i++)
+            {
+                if (points[i].isFixed) continue;
+
+                double displacement = 0;
+                for (unsigned int j=0;j<nConstraints+1;j++)
+                    displacement += (((v >> j) & 1) ? 1 : -1) * limits[j] * points[i].sensitivities[j];
+
+                if (points[i].isDomain)
+                    displacement = std::max(displacement, points[i].negativeLimit);
+
+                for (unsigned int j=0;j<nConstraints;j++)
+                    changes[j] += displacement * points[i].sensitivities[j+1] * points[i].length;
+            }
+
+            for (unsigned int j=0;j<nConstraints;j++)
+            {
+                min[j] = std::min(min[j], changes[j]);
+                max[j] = std::max(max[j], changes[j]);
+            }
+        }
+
+        // Set error number.
+        errno = 0;
+
+        for (unsigned int i=0;i<nConstraints;i++)
+        {
+            double target = 0.99 * ((i % 2) ? min[i] : max[i]);
+            double change = computeChange(points, i + 1, timeStep);
+
+            slsm_check((std::abs(change - target) < 1e-4*std::abs(target)), "Constraint bound mismatch!");
+        }
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testThreads()
+{
+    // Check that the solution is independent of the number of threads.
+
+    slsm::MersenneTwister rng;
+
+    std::vector<slsm::BoundaryPoint> points;
+    createPoints(points, 20000, 3, false, true, rng);
+
+    std::vector<slsm::BoundaryPoint> pointsThreaded = points;
+
+    std::vector<double> constraintDistances = {-10.0, 5.0};
+    std::vector<bool> isEquality = {false, true};
+
+    std::vector<double> lambdas(3, 0);
+    std::vector<double> lambdasThreaded(3, 0);
+    double timeStep, timeStepThreaded;
+
+    slsm::Optimise optimise(points, constraintDistances, lambdas, timeStep,
+        0.5, false, isEquality, slsm::Solver::SIMPLEX);
+
+    slsm::Optimise optimiseThreaded(pointsThreaded, constraintDistances, lambdasThreaded,
+        timeStepThreaded, 0.5, false, isEquality, slsm::Solver::SIMPLEX);
+    optimiseThreaded.setThreads(4);
+
+    double objective = optimise.solve();
+    double objectiveThreaded = optimiseThreaded.solve();
+
+    // Set error number.
+    errno = 0;
+
+    slsm_check((objective == objectiveThreaded), "Objective mismatch!");
+    slsm_check((lambdas == lambdasThreaded), "Lambda mismatch!");
+
+    for (unsigned int i=0;i<points.size();i++)
+        slsm_check((points[i].velocity == pointsThreaded[i].velocity), "Velocity mismatch!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testResetRoundoff()
+{
+    // Reuse an NLopt optimiser for a problem with incompatible equality
+    // constraints. Both constraints have the same sensitivities but different
+    // targets, so the first attempt fails with a roundoff error and the
+    // targets must be reduced until a solution is found. Check that the
+    // objective change returned after the retries matches a direct sum.
+
+    slsm::MersenneTwister rng;
+
+    std::vector<slsm::BoundaryPoint> points;
+    createPoints(points, 2000, 3, false, false, rng);
+
+    for (unsigned int i=0;i<points.size();i++)
+        points[i].sensitivities[2] = points[i].sensitivities[1];
+
+    std::vector<double> constraintDistances = {1.0, 1.0};
+    std::vector<bool> isEquality = {true, true};
+    std::vector<double> lambdas(3, 0);
+    double timeStep;
+
+    slsm::Optimise optimise(points, constraintDistances, lambdas, timeStep,
+        0.5, false, isEquality);
+
+    // A first solve with compatible targets.
+    optimise.solve();
+
+    // Now make the targets incompatible.
+    constraintDistances = {1.0, 2.0};
+    optimise.reset(points, constraintDistances);
+
+    double objective = optimise.solve();
+
+    // Set error number.
+    errno = 0;
+
+    slsm_check(std::isfinite(objective), "Objective isn't finite!");
+
+    // Check the objective change.
+    {
+        double change = computeChange(points, 0, timeStep);
+        slsm_check((std::abs(change - objective) < 1e-8*std::abs(change)), "Objective mismatch!");
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int all_tests()
+{
+    mu_suite_start();
+
+    mu_run_test(testGramCallback);
+    mu_run_test(testConstraintBound);
+    mu_run_test(testThreads);
+    mu_run_test(testResetRoundoff);
+
+    return 0;
+}
+
+RUN_TESTS(all_tests)
@@ -0,0 +1,194 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "slsm.h"
+
+int testInequality()
+{
+    // Maximise x + y subject to x + 2y <= 4 and 3x + y <= 6.
+
+    slsm::Simplex simplex;
+
+    std::vector<double> cost = {-1, -1};
+    std::vector<double> matrix = {1, 2, 3, 1};
+    std::vector<double> rhs = {4, 6};
+    std::vector<bool> isEquality = {false, false};
+    std::vector<double> lower = {0, 0};
+    std::vector<double> upper = {10, 10};
+    std::vector<double> x;
+
+    // Set error number.
+    errno = 0;
+
+    slsm_check((simplex.solve(cost, matrix, rhs, isEquality, lower, upper, x)
+        == slsm::SimplexStatus::OPTIMAL), "Solution isn't optimal!");
+
+    slsm_check((std::abs(x[0] - 1.6) < 1e-12), "Incorrect solution!");
+    slsm_check((std::abs(x[1] - 1.2) < 1e-12), "Incorrect solution!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testEquality()
+{
+    // Minimise x - y subject to x + y = 1, with negative lower bounds,
+    // where the solution lies on a bound.
+
+    slsm::Simplex simplex;
+
+    std::vector<double> cost = {1, -1};
+    std::vector<double> matrix = {1, 1};
+    std::vector<double> rhs = {1};
+    std::vector<bool> isEquality = {true};
+    std::vector<double> lower = {-5, -5};
+    std::vector<double> upper = {5, 5};
+    std::vector<double> x;
+
+    // Set error number.
+    errno = 0;
+
+    slsm_check((simplex.solve(cost, matrix, rhs, isEquality, lower, upper, x)
+        == slsm::SimplexStatus::OPTIMAL), "Solution isn't optimal!");
+
+    slsm_check((std::abs(x[0] + 4) < 1e-12), "Incorrect solution!");
+    slsm_check((std::abs(x[1] - 5) < 1e-12), "Incorrect solution!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testInfeasible()
+{
+    // A constraint that can't be satisfied within the bounds.
+
+    slsm::Simplex simplex;
+
+    std::vector<double> cost = {1, 1};
+    std::vector<double> matrix = {1, 1};
+    std::vector<double> rhs = {-3};
+    std::vector<bool> isEquality = {false};
+    std::vector<double> lower = {0, 0};
+    std::vector<double> upper = {1, 1};
+    std::vector<double> x;
+
+    // Set error number.
+    errno = 0;
+
+    slsm_check((simplex.solve(cost, matrix, rhs, isEquality, lower, upper, x)
+        == slsm::SimplexStatus::INFEASIBLE), "Infeasible problem wasn't detected!");
+
+    // The returned point minimises the violation.
+    slsm_check(((x[0] == 0) && (x[1] == 0)), "Incorrect solution!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testDegenerate()
+{
+    // Beale's example, for which the simplex method cycles without an
+    // anti-cycling rule. The optimum is -5/4 at x = (1, 0, 1, 0).
+
+    slsm::Simplex simplex;
+
+    std::vector<double> cost = {-0.75, 20, -0.5, 6};
+    std::vector<double> matrix = {0.25, -8, -1, 9, 0.5, -12, -0.5, 3};
+    std::vector<double> rhs = {0, 0};
+    std::vector<bool> isEquality = {false, false};
+    std::vector<double> lower = {0, 0, 0, 0};
+    std::vector<double> upper = {10, 10, 1, 10};
+    std::vector<double> x;
+
+    // Set error number.
+    errno = 0;
+
+    slsm_check((simplex.solve(cost, matrix, rhs, isEquality, lower, upper, x)
+        == slsm::SimplexStatus::OPTIMAL), "Solution isn't optimal!");
+
+    slsm_check((std::abs(-0.75*x[0] + 20*x[1] - 0.5*x[2] + 6*x[3] + 1.25) < 1e-12),
+        "Incorrect objective!");
+
+    // The pivot sequence is deterministic (solve again without a warm start).
+    {
+        unsigned int nIterations = simplex.nIterations;
+        std::vector<double> y;
+        simplex.solve(cost, matrix, rhs, isEquality, lower, upper, y);
+        slsm_check((simplex.nIterations == nIterations), "Iteration count mismatch!");
+    }
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testWarmStart()
+{
+    // Re-solve the problem from testEquality, warm started from its solution,
+    // which lies on the upper bound of y. The solution should be unchanged
+    // and found with fewer pivots.
+
+    slsm::Simplex simplex;
+
+    std::vector<double> cost = {1, -1};
+    std::vector<double> matrix = {1, 1};
+    std::vector<double> rhs = {1};
+    std::vector<bool> isEquality = {true};
+    std::vector<double> lower = {-5, -5};
+    std::vector<double> upper = {5, 5};
+    std::vector<double> x;
+
+    // Set error number.
+    errno = 0;
+
+    simplex.solve(cost, matrix, rhs, isEquality, lower, upper, x);
+    unsigned int nIterations = simplex.nIterations;
+
+    slsm_check((simplex.solve(cost, matrix, rhs, isEquality, lower, upper, x)
+        == slsm::SimplexStatus::OPTIMAL), "Solution isn't optimal!");
+
+    slsm_check((std::abs(x[0] + 4) < 1e-12), "Incorrect solution!");
+    slsm_check((std::abs(x[1] - 5) < 1e-12), "Incorrect solution!");
+    slsm_check((simplex.nIterations < nIterations), "Warm start isn't faster!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int all_tests()
+{
+    mu_suite_start();
+
+    mu_run_test(testInequality);
+    mu_run_test(testEquality);
+    mu_run_test(testInfeasible);
+    mu_run_test(testDegenerate);
+    mu_run_test(testWarmStart);
+
+    return 0;
+}
+
+RUN_TESTS(all_tests)
@@ -0,0 +1,210 @@
+/*
+  Copyright (c) 2015-2017 Lester Hedges <lester.hedges+slsm@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <limits>
+
+#include "slsm.h"
+
+// Tolerance for comparing the sparse and dense level sets. In a single precision
+// build the dense gradient kernel works in single precision, whereas the sparse
+// level set evaluates gradients in double precision, so the two drift apart by
+// a small multiple of the rounding error over successive updates.
+const double tolerance = std::max(1e-10, 1000*double(std::numeric_limits<slsm::Real>::epsilon()));
+
+int testSparseInitialisation()
+{
+    // A test that the sparse level set matches the dense one within the band.
+
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(50.3, 49.9, 20));
+    holes.push_back(slsm::Hole(25, 25, 10));
+    holes.push_back(slsm::Hole(80, 20, 30));
+
+    // Initialise 100x80 level set domains.
+    slsm::LevelSet levelSet(100, 80, holes, 0.5, 6);
+    slsm::SparseLevelSet sparseLevelSet(100, 80, holes, 0.5, 6);
+
+    // Set error number.
+    errno = 0;
+
+    for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+    {
+        unsigned int x = levelSet.mesh.nodes[i].coord.x;
+        unsigned int y = levelSet.mesh.nodes[i].coord.y;
+
+        // Values are clamped outside of the band.
+        double expected = std::max(-7.0, std::min(7.0, double(levelSet.signedDistance[i])));
+
+        slsm_check((sparseLevelSet.getSignedDistance(x, y) == expected), "Signed distance mismatch!");
+    }
+
+    slsm_check((sparseLevelSet.nNarrowBand == levelSet.nNarrowBand), "Narrow band mismatch!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testSparseEvolution()
+{
+    // A test that boundary discretisation, velocity extension, gradient
+    // computation, and reinitialisation match the dense level set.
+
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(50.3, 49.9, 20));
+    holes.push_back(slsm::Hole(20, 25, 8));
+
+    // Initialise 100x100 level set domains.
+    slsm::LevelSet levelSet(100, 100, holes, 0.5, 6);
+    slsm::SparseLevelSet sparseLevelSet(100, 100, holes, 0.5, 6);
+
+    // Use multiple threads for the sparse level set.
+    sparseLevelSet.setThreads(4);
+
+    // The sparse level set stores the far field as a sign, so clamp the
+    // dense signed distance function in the same way.
+    for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        levelSet.signedDistance[i] = std::max(-7.0, std::min(7.0, double(levelSet.signedDistance[i])));
+
+    slsm::Boundary boundary;
+    slsm::Boundary sparseBoundary;
+
+    // Whether the level set has been reinitialised.
+    bool isReinitialised = false;
+
+    // Set error number.
+    errno = 0;
+
+    // Evolve up to, and including, the first reinitialisation. Beyond this
+    // the dense level set only updates nodes close to the previous narrow band,
+    // so values at the far edge of the band will differ slightly.
+    for (unsigned int n=0;n<20 && !isReinitialised;n++)
+    {
+        boundary.discretise(levelSet);
+        sparseBoundary.discretise(sparseLevelSet);
+
+        slsm_check((boundary.nPoints == sparseBoundary.nPoints), "Boundary point mismatch!");
+        slsm_check((boundary.nSegments == sparseBoundary.nSegments), "Boundary segment mismatch!");
+        slsm_check((std::abs(boundary.length - sparseBoundary.length) < tolerance), "Boundary length mismatch!");
+
+        // Move the holes outwards, at a rate that varies around the boundary.
+        for (unsigned int i=0;i<boundary.nPoints;i++)
+            boundary.points[i].velocity = -1 + 0.5*sin(0.2*boundary.points[i].coord.x);
+        for (unsigned int i=0;i<sparseBoundary.nPoints;i++)
+            sparseBoundary.points[i].velocity = -1 + 0.5*sin(0.2*sparseBoundary.points[i].coord.x);
+
+        levelSet.computeVelocities(boundary.points);
+        sparseLevelSet.computeVelocities(sparseBoundary.points);
+
+        levelSet.computeGradients();
+        sparseLevelSet.computeGradients();
+
+        for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        {
+            if (levelSet.mesh.nodes[i].isActive)
+            {
+                unsigned int x = levelSet.mesh.nodes[i].coord.x;
+                unsigned int y = levelSet.mesh.nodes[i].coord.y;
+
+                slsm_check((std::abs(levelSet.velocity[i] - sparseLevelSet.getVelocity(x, y)) < tolerance),
+                    "Velocity mismatch!");
+                slsm_check((std::abs(levelSet.gradient[i] - sparseLevelSet.getGradient(x, y)) < tolerance),
+                    "Gradient mismatch!");
+            }
+        }
+
+        isReinitialised = levelSet.update(0.5);
+        slsm_check((isReinitialised == sparseLevelSet.update(0.5)), "Reinitialisation mismatch!");
+        slsm_check((levelSet.nNarrowBand == sparseLevelSet.nNarrowBand), "Narrow band mismatch!");
+
+        for (unsigned int i=0;i<levelSet.mesh.nNodes;i++)
+        {
+            if (levelSet.mesh.nodes[i].isActive)
+            {
+                unsigned int x = levelSet.mesh.nodes[i].coord.x;
+                unsigned int y = levelSet.mesh.nodes[i].coord.y;
+
+                slsm_check((std::abs(levelSet.signedDistance[i] - sparseLevelSet.getSignedDistance(x, y)) < tolerance),
+                    "Signed distance mismatch!");
+            }
+        }
+    }
+
+    slsm_check(isReinitialised, "Level set wasn't reinitialised!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int testSparseLargeDomain()
+{
+    // A test that memory use scales with the length of the boundary.
+
+    std::vector<slsm::Hole> holes;
+    holes.push_back(slsm::Hole(10000.5, 10000.5, 5000));
+
+    // Initialise a 20000x20000 level set domain.
+    slsm::SparseLevelSet sparseLevelSet(20000, 20000, holes, 0.5, 6);
+
+    // Initialise the boundary object.
+    slsm::Boundary boundary;
+
+    // The expected length of the boundary (the domain edge and the hole).
+    double expected = 4*20000 + 2*M_PI*5000;
+
+    // Set error number.
+    errno = 0;
+
+    // A dense level set would need over a gigabyte for the signed distance,
+    // velocity, and gradient alone.
+    slsm_check((sparseLevelSet.memoryUsage() < 100000000), "Memory use is too large!");
+
+    // Check the far field.
+    slsm_check((sparseLevelSet.getSignedDistance(1000, 1000) == 7), "Signed distance mismatch!");
+    slsm_check((sparseLevelSet.getSignedDistance(10000, 10000) == -7), "Signed distance mismatch!");
+
+    // Discretise the boundary and check its length.
+    boundary.discretise(sparseLevelSet);
+    slsm_check((std::abs(boundary.length - expected) < 1e-3*expected), "Boundary length mismatch!");
+
+    // Reinitialise, then check that the structure hasn't changed.
+    sparseLevelSet.reinitialise();
+    slsm_check((sparseLevelSet.getSignedDistance(1000, 1000) == 7), "Signed distance mismatch!");
+    slsm_check((sparseLevelSet.getSignedDistance(10000, 10000) == -7), "Signed distance mismatch!");
+    slsm_check((std::abs(sparseLevelSet.getSignedDistance(15000, 10000)) < 1), "Signed distance mismatch!");
+
+    return 0;
+
+error:
+    return 1;
+}
+
+int all_tests()
+{
+    mu_suite_start();
+
+    mu_run_test(testSparseInitialisation);
+    mu_run_test(testSparseEvolution);
+    mu_run_test(testSparseLargeDomain);
+
+    return 0;
+}
+
+RUN_TESTS(all_tests)